@@ -0,0 +1,112 @@
+#ifndef CONE_ESTIMATOR_HPP
+#define CONE_ESTIMATOR_HPP
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "levelizer.hpp"
+
+/** \brief Class for estimating the transitive fan-in and fan-out cone sizes of the nets with HyperLogLog sketches.
+ *	Every net gets a sketch of 2^precision one byte registers. Sketches are merged by register-wise maximum while
+ *	walking the levels: forward for the fan-in gates and the reaching inputs, backward for the fan-out gates.
+ *	The gates of a level are processed in parallel. The relative error is about 1.04 / sqrt(2^precision),
+ *	small cones are counted almost exactly. Inside combinational loops only edges between different levels are followed.
+ */
+class Cone_estimator
+{
+public:
+
+	/** \brief Constructor with the levelized netlist.
+	 *	\param[in] levelizer - The Levelizer, levelize must already be called. Must outlive the estimator.
+	 *	\param[in] precision - Number of register index bits, in [4, 16]. The sketches take net count * 2^precision bytes.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Cone_estimator(const Levelizer& levelizer, unsigned precision = 8, unsigned thread_count = 0);
+
+	/// \brief Estimates the cone sizes of all nets. Must be called before the getters.
+	void estimate();
+
+	/// \brief Returns the estimated number of gates in the transitive fan-in of each net, including its driver.
+	const std::vector<float>& get_fanin_cone_sizes() const;
+
+	/// \brief Returns the estimated number of gates in the transitive fan-out of each net.
+	const std::vector<float>& get_fanout_cone_sizes() const;
+
+	/// \brief Returns the estimated number of input nets reaching each net, an input net reaches itself.
+	const std::vector<float>& get_input_counts() const;
+
+	/// \brief Returns the number of bytes of one sketch.
+	size_t get_sketch_size() const;
+
+private:
+
+	/** \brief Merges the fan-in and input sketches of a chunk of gates of one level into their outputs.
+	 *	\param[in] level - The level.
+	 *	\param[in] begin - First gate of the chunk in the level.
+	 *	\param[in] end - Gate after the last one of the chunk.
+	 */
+	void propagate_forward(unsigned level, size_t begin, size_t end);
+
+	/** \brief Merges the fan-out sketches of the fanout gates into a chunk of nets.
+	 *	Nets are processed by the level of their drivers from the top, so the nets read are already complete.
+	 *	\param[in] nets - The nets driven from one level, or the input nets.
+	 *	\param[in] begin - First net of the chunk.
+	 *	\param[in] end - Net after the last one of the chunk.
+	 */
+	void propagate_backward(const std::vector<Flat_id>* nets, size_t begin, size_t end);
+
+	/** \brief Computes the estimates of a chunk of nets from a sketch array.
+	 *	\param[in] sketches - The sketches of all nets.
+	 *	\param[out] estimates - The estimates of all nets.
+	 *	\param[in] begin - First net of the chunk.
+	 *	\param[in] end - Net after the last one of the chunk.
+	 */
+	void compute_estimates(const std::vector<boost::uint8_t>* sketches, std::vector<float>* estimates, size_t begin, size_t end) const;
+
+	/** \brief Adds an element to a sketch.
+	 *	\param[in,out] sketch - The sketch.
+	 *	\param[in] element - Id of the element.
+	 */
+	void add(boost::uint8_t* sketch, boost::uint64_t element) const;
+
+	/** \brief Merges a sketch into another.
+	 *	\param[in,out] sketch - The merged sketch.
+	 *	\param[in] other - The sketch to merge.
+	 */
+	void merge(boost::uint8_t* sketch, const boost::uint8_t* other) const;
+
+	/** \brief Returns true if the edge from the net to the gate is followed: the net is not driven from the level of the gate.
+	 *	\param[in] net - The net.
+	 *	\param[in] gate - The gate reading the net.
+	 */
+	bool is_followed(Flat_id net, Flat_id gate) const;
+
+private:
+
+	/// The levelized netlist.
+	const Levelizer& m_levelizer;
+
+	/// Number of register index bits.
+	unsigned m_precision;
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Fan-in sketches of the nets during the forward pass, fan-out sketches during the backward pass.
+	std::vector<boost::uint8_t> m_cone_sketches;
+
+	/// Input sketches of the nets.
+	std::vector<boost::uint8_t> m_input_sketches;
+
+	/// Estimated fan-in cone sizes.
+	std::vector<float> m_fanin_cone_sizes;
+
+	/// Estimated fan-out cone sizes.
+	std::vector<float> m_fanout_cone_sizes;
+
+	/// Estimated input counts.
+	std::vector<float> m_input_counts;
+
+};
+
+#endif // CONE_ESTIMATOR_HPP
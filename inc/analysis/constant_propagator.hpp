@@ -0,0 +1,82 @@
+#ifndef CONSTANT_PROPAGATOR_HPP
+#define CONSTANT_PROPAGATOR_HPP
+
+#include <vector>
+
+#include "levelizer.hpp"
+
+class Netlist;
+
+/** \brief Class for propagating literal constants (1'b0, 1'b1) through the built-in primitives of a levelized Flat Netlist.
+ *	Gates are evaluated level by level with three valued logic (0, 1, unknown), the gates of a level in parallel:
+ *	a controlling input decides the output of and, or, nand and nor, the other gates are constant only if all
+ *	their inputs are. Input nets and outputs of undefined modules are unknown. Inside combinational loops only
+ *	edges between different levels are followed, so loops are evaluated conservatively.
+ *	The tie-off sweep removes the primitive instances whose output is constant and ties their nets to the literal.
+ */
+class Constant_propagator
+{
+public:
+
+	/** \brief Constructor with the levelized netlist.
+	 *	\param[in] levelizer - The Levelizer, levelize must already be called. Must outlive the propagator.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Constant_propagator(const Levelizer& levelizer, unsigned thread_count = 0);
+
+	/// \brief Computes the values of all nets. Must be called before the getters.
+	void propagate();
+
+	/// \brief Returns the constant values of the nets, CONSTANT_NONE for the nets that are not constant.
+	const std::vector<LogicConstant>& get_net_values() const;
+
+	/// \brief Returns the gates driving a constant net, in increasing order.
+	const std::vector<Flat_id>& get_constant_gates() const;
+
+	/// \brief Returns the number of nets with a constant value, including the literal constants.
+	size_t get_constant_net_count() const;
+
+	/** \brief Removes the primitive instances whose output is the same constant in every place they appear below the top module
+	 *	and ties their output nets to the literal constant with an assignment. Instances driving input ports are kept.
+	 *	The instances are looked up in parallel and removed in one transaction of the Netlist, whose commit reconnects the edited
+	 *	modules. Logic feeding only removed instances is left floating.
+	 *	The modules are specialized for the top module, the Flat Netlist and the Levelizer must not be used afterwards.
+	 *	\param[in,out] netlist - The Netlist the Flat Netlist was built from.
+	 *	\ret The number of removed instances.
+	 */
+	size_t sweep(Netlist& netlist) const;
+
+private:
+
+	/** \brief Evaluates a chunk of gates of one level.
+	 *	\param[in] level - The level.
+	 *	\param[in] begin - First gate of the chunk in the level.
+	 *	\param[in] end - Gate after the last one of the chunk.
+	 */
+	void propagate_level(unsigned level, size_t begin, size_t end);
+
+	/** \brief Returns the value of the gate output from its input values.
+	 *	\param[in] gate - The gate.
+	 */
+	LogicConstant evaluate(Flat_id gate) const;
+
+private:
+
+	/// The levelized netlist.
+	const Levelizer& m_levelizer;
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Values of the nets.
+	std::vector<LogicConstant> m_net_values;
+
+	/// Gates driving constant nets.
+	std::vector<Flat_id> m_constant_gates;
+
+	/// Number of constant nets.
+	size_t m_constant_net_count;
+
+};
+
+#endif // CONSTANT_PROPAGATOR_HPP
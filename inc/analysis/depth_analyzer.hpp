@@ -0,0 +1,109 @@
+#ifndef DEPTH_ANALYZER_HPP
+#define DEPTH_ANALYZER_HPP
+
+#include <vector>
+
+#include "levelizer.hpp"
+
+/// A path of the Depth Analyzer, from a start net to an endpoint net.
+struct Depth_path
+{
+	/// Sum of the gate delays along the path.
+	unsigned depth;
+
+	/// Nets of the path, the start net first.
+	std::vector<Flat_id> nets;
+
+	/// Gates of the path, gate i drives net i + 1.
+	std::vector<Flat_id> gates;
+};
+
+/** \brief Class for computing logic depths of a levelized Flat Netlist with unit or per-primitive delays.
+ *	Paths start at the input nets and at the outputs of undefined module instances, which are the
+ *	register outputs of a gate-level netlist, and end at the top output nets and the inputs of undefined
+ *	module instances. Arrival depths are propagated level by level, the gates of a level in parallel.
+ *	Inside combinational loops only the inputs from lower levels are followed.
+ */
+class Depth_analyzer
+{
+public:
+
+	/** \brief Constructor with the levelized netlist, all delays are 1.
+	 *	\param[in] levelizer - The Levelizer, levelize must already be called. Must outlive the analyzer.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Depth_analyzer(const Levelizer& levelizer, unsigned thread_count = 0);
+
+	/** \brief Sets the delay of a primitive type, used by the next analyze.
+	 *	\param[in] type - The primitive type.
+	 *	\param[in] delay - The delay of the gates of the type.
+	 */
+	void set_delay(PrimitiveType type, unsigned delay);
+
+	/// \brief Returns the delay of a primitive type.
+	unsigned get_delay(PrimitiveType type) const;
+
+	/// \brief Computes the depths of all nets. Must be called before the getters.
+	void analyze();
+
+	/// \brief Returns the depths of the nets, 0 for start nets.
+	const std::vector<unsigned>& get_net_depths() const;
+
+	/// \brief Returns the endpoint nets, the top outputs come first.
+	const std::vector<Flat_id>& get_endpoints() const;
+
+	/// \brief Returns the largest depth of the endpoints.
+	unsigned get_max_depth() const;
+
+	/** \brief Returns the deepest paths to the endpoints, deepest first.
+	 *	Paths are enumerated best first from the endpoints backwards, bounded by the net depths, so only the returned paths are traced.
+	 *	\param[in] count - Maximal number of paths.
+	 */
+	std::vector<Depth_path> find_deepest_paths(size_t count) const;
+
+	/// \brief Returns the number of endpoints of each depth.
+	std::vector<size_t> get_endpoint_histogram() const;
+
+	/// \brief Returns the number of nets of each depth.
+	std::vector<size_t> get_net_histogram() const;
+
+private:
+
+	/** \brief Propagates the depths through a chunk of the gates of one level.
+	 *	\param[in] level - The level.
+	 *	\param[in] begin - First gate of the chunk in the level.
+	 *	\param[in] end - Gate after the last one of the chunk.
+	 */
+	void propagate_gates(unsigned level, size_t begin, size_t end);
+
+	/** \brief Returns true if the gate input is followed: it is not driven by a gate of the same level.
+	 *	\param[in] gate - The gate.
+	 *	\param[in] net - The input net of the gate.
+	 */
+	bool is_followed(Flat_id gate, Flat_id net) const;
+
+	/** \brief Returns the gate driving the net through a delay, invalid_id for start nets.
+	 *	\param[in] net - The net.
+	 */
+	Flat_id get_driving_gate(Flat_id net) const;
+
+private:
+
+	/// The levelized netlist.
+	const Levelizer& m_levelizer;
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Delays of the primitive types.
+	std::vector<unsigned> m_delays;
+
+	/// Depths of the nets.
+	std::vector<unsigned> m_net_depths;
+
+	/// The endpoint nets.
+	std::vector<Flat_id> m_endpoints;
+
+};
+
+#endif // DEPTH_ANALYZER_HPP
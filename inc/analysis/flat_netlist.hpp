@@ -0,0 +1,230 @@
+#ifndef FLAT_NETLIST_HPP
+#define FLAT_NETLIST_HPP
+
+#include <string>
+#include <vector>
+
+#include "database/primitives.hpp"
+#include "database/net.hpp"
+
+class Netlist;
+class Module_description;
+class Module_instance;
+
+/// Type of the dense ids of gates, nets and hierarchy nodes in the Flat Netlist.
+typedef unsigned int Flat_id;
+
+/** \brief Class for holding the flattened, resolved connectivity of a Netlist below a top module.
+ *	Every leaf instance (built-in primitive or instance of an undefined module) becomes a gate,
+ *	nets connected through the hierarchy are merged into one flat net. All the connectivity is kept
+ *	in dense arrays indexed by gate and net ids, in compressed (offsets + values) form.
+ *	Nets without a driving gate (top input ports and undriven internal nets) are treated as inputs,
+ *	except the nets tied to literal constants, which keep their constant value.
+ *	Aliased nets (assignments) are one net, ports aliased to each other join the nets bound to them.
+ */
+class Flat_netlist
+{
+public:
+
+	/// Id used for missing gates, nets or hierarchy nodes.
+	static const Flat_id invalid_id;
+
+	/** \brief Constructor, flattens the Netlist below the given module.
+	 *	Nets of the modules must already be connected. Throws if the module does not exist, instantiates itself
+	 *	or holds a leaf instance whose output pins drive more than one net.
+	 *	\param[in] netlist - The Netlist to flatten.
+	 *	\param[in] top_module_name - Name of the top Module Description.
+	 */
+	Flat_netlist(const Netlist& netlist, const std::string& top_module_name);
+
+	/// \brief Getter for the top Module Description.
+	const Module_description& get_top_module() const;
+
+	/// \brief Returns the number of gates.
+	size_t get_gate_count() const;
+
+	/// \brief Returns the number of nets.
+	size_t get_net_count() const;
+
+	/// \brief Returns the primitive types of the gates, PRIMITIVE_NONE for instances of undefined modules.
+	const std::vector<PrimitiveType>& get_gate_types() const;
+
+	/// \brief Returns the offsets of the gate inputs, inputs of gate i are in [offsets[i], offsets[i + 1]).
+	const std::vector<Flat_id>& get_gate_input_offsets() const;
+
+	/// \brief Returns the input nets of all gates.
+	const std::vector<Flat_id>& get_gate_inputs() const;
+
+	/// \brief Returns the output nets of the gates, invalid_id for gates without output.
+	const std::vector<Flat_id>& get_gate_outputs() const;
+
+	/// \brief Returns the driving gates of the nets, invalid_id for input nets.
+	const std::vector<Flat_id>& get_net_drivers() const;
+
+	/// \brief Returns the offsets of the net fanouts, fanout gates of net i are in [offsets[i], offsets[i + 1]).
+	const std::vector<Flat_id>& get_net_fanout_offsets() const;
+
+	/// \brief Returns the fanout gates of all nets, one entry per connected gate input.
+	const std::vector<Flat_id>& get_net_fanouts() const;
+
+	/// \brief Returns the nets without a driving gate, the top input ports come first. Constant nets are not inputs.
+	const std::vector<Flat_id>& get_input_nets() const;
+
+	/// \brief Returns the literal constants the nets are tied to, CONSTANT_NONE for the other nets.
+	const std::vector<LogicConstant>& get_net_constants() const;
+
+	/// \brief Returns the nets of the top output ports.
+	const std::vector<Flat_id>& get_output_nets() const;
+
+	/** \brief Returns the leaf Module Instance of the gate.
+	 *	\param[in] gate - Id of the gate.
+	 */
+	const Module_instance& get_gate_instance(Flat_id gate) const;
+
+	/** \brief Returns the hierarchy node containing the gate.
+	 *	\param[in] gate - Id of the gate.
+	 */
+	Flat_id get_gate_hierarchy(Flat_id gate) const;
+
+	/** \brief Returns the hierarchical name of the gate, instance names separated by '/'.
+	 *	\param[in] gate - Id of the gate.
+	 */
+	std::string get_gate_name(Flat_id gate) const;
+
+	/** \brief Returns the hierarchical name of the net, named after the highest module it appears in.
+	 *	\param[in] net - Id of the net.
+	 */
+	std::string get_net_name(Flat_id net) const;
+
+	/** \brief Returns the highest hierarchy node the net appears in, the node it is named after.
+	 *	\param[in] net - Id of the net.
+	 */
+	Flat_id get_net_hierarchy(Flat_id net) const;
+
+	/** \brief Returns the local name of the net in its highest hierarchy node.
+	 *	\param[in] net - Id of the net.
+	 */
+	const std::string& get_net_local_name(Flat_id net) const;
+
+	/** \brief Returns the flat net of a local net name in a hierarchy node, invalid_id if the node has no such net.
+	 *	Instance pins use the canonical local names, port names must be resolved with get_canonical_net_name first.
+	 *	\param[in] node - Id of the hierarchy node.
+	 *	\param[in] name - Local net name.
+	 */
+	Flat_id get_local_net(Flat_id node, const std::string& name) const;
+
+	/** \brief Returns the id of the net by its hierarchical name, invalid_id if not found. Linear in the number of nets.
+	 *	\param[in] name - Hierarchical name of the net.
+	 */
+	Flat_id find_net(const std::string& name) const;
+
+	/// \brief Returns the number of hierarchy nodes. Node 0 is the top module.
+	size_t get_hierarchy_count() const;
+
+	/** \brief Returns the parent of the hierarchy node, invalid_id for the top.
+	 *	\param[in] node - Id of the hierarchy node.
+	 */
+	Flat_id get_hierarchy_parent(Flat_id node) const;
+
+	/** \brief Returns the Module Instance of the hierarchy node, NULL for the top.
+	 *	\param[in] node - Id of the hierarchy node.
+	 */
+	const Module_instance* get_hierarchy_instance(Flat_id node) const;
+
+	/** \brief Returns the Module Description of the hierarchy node.
+	 *	\param[in] node - Id of the hierarchy node.
+	 */
+	const Module_description& get_hierarchy_description(Flat_id node) const;
+
+	/** \brief Returns the hierarchical name of the node, instance names separated by '/'. Empty for the top.
+	 *	\param[in] node - Id of the hierarchy node.
+	 */
+	std::string get_hierarchy_name(Flat_id node) const;
+
+private:
+
+	/** \brief Descends the hierarchy from the top module and creates all gates and nets.
+	 *	\param[out] aliased_nets - Pairs of flat nets joined by aliased ports of a module, e.g. feed-throughs.
+	 */
+	void flatten(std::vector<std::pair<Flat_id, Flat_id> >& aliased_nets);
+
+	/** \brief Merges the aliased flat nets with a union-find and renumbers the nets. The lowest id of a class names it.
+	 *	\param[in] aliased_nets - Pairs of flat nets to merge.
+	 */
+	void merge_aliased_nets(const std::vector<std::pair<Flat_id, Flat_id> >& aliased_nets);
+
+	/** \brief Creates a new net.
+	 *	\param[in] hierarchy - Hierarchy node the net belongs to.
+	 *	\param[in] name - Local name of the net in the node.
+	 *	\param[in] constant - Literal constant the net is tied to.
+	 */
+	Flat_id create_net(Flat_id hierarchy, const std::string* name, LogicConstant constant);
+
+	/// \brief Fills the drivers and fanouts of the nets from the gate connectivity.
+	void build_net_connectivity();
+
+private:
+
+	/// The top Module Description.
+	const Module_description* m_top_module;
+
+	/// Primitive types of the gates.
+	std::vector<PrimitiveType> m_gate_types;
+
+	/// Offsets of the gate inputs.
+	std::vector<Flat_id> m_gate_input_offsets;
+
+	/// Input nets of the gates.
+	std::vector<Flat_id> m_gate_inputs;
+
+	/// Output nets of the gates.
+	std::vector<Flat_id> m_gate_outputs;
+
+	/// Leaf Module Instances of the gates.
+	std::vector<const Module_instance*> m_gate_instances;
+
+	/// Hierarchy nodes containing the gates.
+	std::vector<Flat_id> m_gate_hierarchy;
+
+	/// Driving gates of the nets.
+	std::vector<Flat_id> m_net_drivers;
+
+	/// Offsets of the net fanouts.
+	std::vector<Flat_id> m_net_fanout_offsets;
+
+	/// Fanout gates of the nets.
+	std::vector<Flat_id> m_net_fanouts;
+
+	/// Hierarchy nodes owning the nets.
+	std::vector<Flat_id> m_net_hierarchy;
+
+	/// Local names of the nets, point to the names held by the Module Descriptions.
+	std::vector<const std::string*> m_net_names;
+
+	/// Literal constants of the nets.
+	std::vector<LogicConstant> m_net_constants;
+
+	/// Offsets of the local nets of the hierarchy nodes, nets of node i are in [offsets[i], offsets[i + 1]).
+	std::vector<Flat_id> m_local_net_offsets;
+
+	/// Local net names and flat nets of all hierarchy nodes, sorted by name in each node.
+	std::vector<std::pair<const std::string*, Flat_id> > m_local_nets;
+
+	/// Nets without a driving gate.
+	std::vector<Flat_id> m_input_nets;
+
+	/// Nets of the top output ports.
+	std::vector<Flat_id> m_output_nets;
+
+	/// Parents of the hierarchy nodes.
+	std::vector<Flat_id> m_hierarchy_parents;
+
+	/// Module Instances of the hierarchy nodes.
+	std::vector<const Module_instance*> m_hierarchy_instances;
+
+	/// Module Descriptions of the hierarchy nodes.
+	std::vector<const Module_description*> m_hierarchy_descriptions;
+
+};
+
+#endif // FLAT_NETLIST_HPP
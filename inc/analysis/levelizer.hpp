@@ -0,0 +1,105 @@
+#ifndef LEVELIZER_HPP
+#define LEVELIZER_HPP
+
+#include <vector>
+
+#include "flat_netlist.hpp"
+
+/** \brief Class for assigning logic levels to the gates of a Flat Netlist and finding combinational loops.
+ *	Strongly connected components of the gate graph are found with an iterative Tarjan algorithm, so deep
+ *	netlists do not overflow the stack. Levels are assigned to the components in parallel wavefronts:
+ *	the level of a gate is the length of the longest gate path from the inputs to its component,
+ *	gates fed only by input nets are at level 0. All gates of a loop share one level.
+ */
+class Levelizer
+{
+public:
+
+	/** \brief Constructor with the netlist to levelize.
+	 *	\param[in] netlist - The Flat Netlist, must outlive the Levelizer.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Levelizer(const Flat_netlist& netlist, unsigned thread_count = 0);
+
+	/// \brief Finds the loops and assigns the levels. Must be called before the getters.
+	void levelize();
+
+	/// \brief Getter for the levelized Flat Netlist.
+	const Flat_netlist& get_netlist() const;
+
+	/// \brief Returns the levels of the gates.
+	const std::vector<unsigned>& get_gate_levels() const;
+
+	/// \brief Returns the number of levels.
+	unsigned get_level_count() const;
+
+	/// \brief Returns all gates ordered by level.
+	const std::vector<Flat_id>& get_levelized_gates() const;
+
+	/// \brief Returns the offsets of the levels in the levelized gates, gates of level l are in [offsets[l], offsets[l + 1]).
+	const std::vector<Flat_id>& get_level_offsets() const;
+
+	/// \brief Returns the strongly connected component of each gate. Components are numbered in reverse topological order.
+	const std::vector<Flat_id>& get_gate_components() const;
+
+	/// \brief Returns the number of strongly connected components.
+	size_t get_component_count() const;
+
+	/// \brief Returns true if the netlist has combinational loops.
+	bool has_loops() const;
+
+	/// \brief Returns the number of combinational loops, i.e. components with more than one gate or a gate feeding itself.
+	size_t get_loop_count() const;
+
+	/// \brief Returns the offsets of the loops in the loop gates, gates of loop i are in [offsets[i], offsets[i + 1]).
+	const std::vector<Flat_id>& get_loop_offsets() const;
+
+	/// \brief Returns the gates of all loops, grouped by loop.
+	const std::vector<Flat_id>& get_loop_gates() const;
+
+private:
+
+	/// \brief Finds the strongly connected components of the gate graph without recursion.
+	void find_components();
+
+	/// \brief Groups the gates by component and collects the loops.
+	void collect_components();
+
+	/// \brief Assigns the component levels in parallel wavefronts and orders the gates by level.
+	void compute_levels();
+
+private:
+
+	/// The netlist to levelize.
+	const Flat_netlist& m_netlist;
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Levels of the gates.
+	std::vector<unsigned> m_gate_levels;
+
+	/// Gates ordered by level.
+	std::vector<Flat_id> m_levelized_gates;
+
+	/// Offsets of the levels in m_levelized_gates.
+	std::vector<Flat_id> m_level_offsets;
+
+	/// Components of the gates.
+	std::vector<Flat_id> m_gate_components;
+
+	/// Offsets of the components in m_component_gates.
+	std::vector<Flat_id> m_component_offsets;
+
+	/// Gates grouped by component.
+	std::vector<Flat_id> m_component_gates;
+
+	/// Offsets of the loops in m_loop_gates.
+	std::vector<Flat_id> m_loop_offsets;
+
+	/// Gates of the loops grouped by loop.
+	std::vector<Flat_id> m_loop_gates;
+
+};
+
+#endif // LEVELIZER_HPP
@@ -0,0 +1,108 @@
+#ifndef LINT_ENGINE_HPP
+#define LINT_ENGINE_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+class Netlist;
+class Module_description;
+
+/// A problem found by a lint rule.
+struct Lint_violation
+{
+	/// Name of the rule.
+	std::string rule;
+
+	/// Name of the Module Description.
+	std::string module;
+
+	/// Name of the offending net, instance or pin in the module.
+	std::string object;
+
+	/// Description of the problem.
+	std::string message;
+};
+
+/// Base class of the lint rules.
+class Lint_rule
+{
+public:
+
+	/// \brief Destructor.
+	virtual ~Lint_rule();
+
+	/// \brief Returns the name of the rule, unique in a Lint Engine.
+	virtual std::string get_name() const = 0;
+
+	/** \brief Checks one module and appends the violations. Called concurrently for different modules.
+	 *	\param[in] module - The Module Description, nets must already be connected.
+	 *	\param[in,out] violations - Violations found so far by the running thread.
+	 */
+	virtual void check(const Module_description& module, std::vector<Lint_violation>& violations) const = 0;
+};
+
+/** \brief Class for running lint rules over all Module Descriptions of a Netlist.
+ *	The engine starts with the built-in rules: multiple-drivers, undriven-net, floating-net,
+ *	unconnected-input, pin-count-mismatch, undefined-module and implicit-net. Modules are checked
+ *	in parallel on a Work Stealing Pool, every worker appends to its own buffer and the buffers
+ *	are merged at the end, so the result does not depend on the thread count.
+ */
+class Lint_engine
+{
+public:
+
+	/** \brief Constructor with the built-in rules.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Lint_engine(unsigned thread_count = 0);
+
+	/** \brief Adds a rule. Throws if a rule with the same name exists.
+	 *	\param[in] rule - The rule.
+	 */
+	void add_rule(const boost::shared_ptr<Lint_rule>& rule);
+
+	/** \brief Removes the rule with the given name.
+	 *	\param[in] name - Name of the rule.
+	 *	\ret True if the rule existed.
+	 */
+	bool remove_rule(const std::string& name);
+
+	/// \brief Returns the names of the rules in the order they run.
+	std::vector<std::string> get_rule_names() const;
+
+	/** \brief Runs all rules on all Module Descriptions. Rethrows the first string thrown by a rule.
+	 *	\param[in] netlist - The Netlist, nets must already be connected.
+	 *	\ret The violations ordered by module name, then by rule.
+	 */
+	std::vector<Lint_violation> run(const Netlist& netlist) const;
+
+	/** \brief Writes the violations, one tab-separated line per violation.
+	 *	\param[in] violations - The violations.
+	 *	\param[in,out] stream - Output stream.
+	 */
+	static void write(const std::vector<Lint_violation>& violations, std::ostream& stream);
+
+private:
+
+	/** \brief Checks one module with all rules.
+	 *	\param[in] module - The Module Description.
+	 *	\param[in] index - Index of the module in the Netlist order.
+	 *	\param[in,out] buffers - Violations of the workers.
+	 *	\param[in,out] module_indices - Module indices of the buffered violations.
+	 *	\param[in] worker - Index of the worker.
+	 */
+	void check_module(const Module_description* module, size_t index, std::vector<std::vector<Lint_violation> >* buffers, std::vector<std::vector<size_t> >* module_indices, unsigned worker) const;
+
+private:
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// The rules in run order.
+	std::vector<boost::shared_ptr<Lint_rule> > m_rules;
+
+};
+
+#endif // LINT_ENGINE_HPP
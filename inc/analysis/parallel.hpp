@@ -0,0 +1,31 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+#include <boost/function.hpp>
+
+/// This class has only static helpers for running loops on several threads.
+class Parallel
+{
+public:
+
+	/** \brief Function called for a sub-range of a parallel loop.
+	 *	Arguments are the first index, the index after the last one and the index of the running thread.
+	 */
+	typedef boost::function<void (size_t, size_t, unsigned)> Range_function;
+
+	/// \brief Returns the number of hardware threads, at least 1.
+	static unsigned get_thread_count();
+
+	/** \brief Splits the range [0, size) into contiguous chunks and runs the function on them in parallel.
+	 *	Ranges smaller than the grain run on the calling thread. Each thread gets a single chunk, thread indices are in [0, thread_count).
+	 *	\param[in] size - Size of the range.
+	 *	\param[in] function - Function to call for every chunk.
+	 *	\param[in] thread_count - Maximal number of threads to use, 0 for the hardware thread count.
+	 *	\param[in] grain - Minimal number of elements processed by a thread.
+	 */
+	static void for_range(size_t size, const Range_function& function, unsigned thread_count = 0, size_t grain = 4096);
+
+};
+
+#endif // PARALLEL_HPP
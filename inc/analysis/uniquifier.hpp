@@ -0,0 +1,76 @@
+#ifndef UNIQUIFIER_HPP
+#define UNIQUIFIER_HPP
+
+#include <map>
+#include <string>
+
+class Netlist;
+class Module_description;
+
+/** \brief Class for copy-on-write uniquification of the hierarchy of a Netlist before editing one instance.
+ *	Masters are reference counted by the number of instances pointing to them in the whole Netlist. Walking an
+ *	instance path from the top, a master with more than one reference is cloned, the instance on the path is bound
+ *	to the clone and the walk goes on in the clone; everything off the path stays shared. A clone copies only its
+ *	own module, its instances keep pointing to the shared submodules, so uniquifying a path costs at most one module
+ *	copy per level. Clones are named after their master with a "_<n>" suffix not used by any module of the Netlist.
+ *	Flat Netlists and other derived data must be rebuilt after a uniquification.
+ */
+class Uniquifier
+{
+public:
+
+	/** \brief Constructor, counts the references to all masters of the Netlist.
+	 *	\param[in,out] netlist - The Netlist, instances must already point to their Module Descriptions. Must outlive the uniquifier.
+	 *	\param[in] top_name - Name of the top module the paths start from.
+	 */
+	Uniquifier(Netlist& netlist, const std::string& top_name);
+
+	/** \brief Makes every module on the instance path private to the path and returns the last one, ready for editing.
+	 *	If the path ends with an instance of a built-in or undefined module, the module holding it is returned.
+	 *	Throws if an instance of the path does not exist.
+	 *	\param[in] path - Instance names separated by '/', empty for the top module.
+	 *	\ret The Module Description of the last instance of the path, only used by that instance.
+	 */
+	Module_description& uniquify(const std::string& path);
+
+	/** \brief Returns the number of instances pointing to the module.
+	 *	\param[in] module - The Module Description.
+	 */
+	size_t get_reference_count(const Module_description& module) const;
+
+	/// \brief Returns the number of modules cloned since the construction.
+	size_t get_clone_count() const;
+
+private:
+
+	/** \brief Returns a name for a clone of the master, not used by any module of the Netlist.
+	 *	\param[in] master - Name of the master.
+	 */
+	std::string get_clone_name(const std::string& master);
+
+	/** \brief Clones the module, adds the clone to the Netlist and counts the references of its instances.
+	 *	\param[in] module - The Module Description to clone.
+	 *	\ret The clone.
+	 */
+	Module_description& clone(const Module_description& module);
+
+private:
+
+	/// The Netlist.
+	Netlist& m_netlist;
+
+	/// Name of the top module.
+	std::string m_top_name;
+
+	/// Number of instances pointing to each master.
+	std::map<const Module_description*, size_t> m_reference_counts;
+
+	/// Next suffix to try for the clones of each master.
+	std::map<std::string, unsigned> m_next_suffixes;
+
+	/// Number of cloned modules.
+	size_t m_clone_count;
+
+};
+
+#endif // UNIQUIFIER_HPP
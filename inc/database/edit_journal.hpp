@@ -0,0 +1,128 @@
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+class Netlist;
+class Module_description;
+
+/// Kinds of the edits recorded by the Edit Journal.
+enum EditKind
+{
+	EDIT_ADD_MODULE,
+	EDIT_REMOVE_MODULE,
+	EDIT_ADD_INSTANCE,
+	EDIT_REMOVE_INSTANCE,
+	EDIT_ADD_PORT,
+	EDIT_ADD_NET,
+	EDIT_ADD_ASSIGN
+};
+
+/** \brief Class for recording the edits of a Netlist and its Module Descriptions, to undo and redo them.
+ *	Every edit is recorded with the object it added or removed, so undoing it runs the inverse operation and redoing it
+ *	puts back the same object: undo and redo cost the size of the edit, and the memory grows with the edits only.
+ *	A version is the number of applied edits, taking it is O(1) and restoring it undoes or redoes the edits in between.
+ *	Recording a new edit after an undo drops the undone edits and the versions after the current one.
+ *	Recording is disabled by default, so building a Netlist costs nothing; only edits made through the Netlist and
+ *	the Module Descriptions it holds are recorded. The edits of a Netlist transaction are one step of undo and redo,
+ *	every step is undone or redone inside a transaction of the Netlist, which connects the nets of the edited modules.
+ */
+class Edit_journal
+{
+public:
+
+	/** \brief Constructor with the journaled Netlist.
+	 *	\param[in] netlist - The Netlist owning the journal.
+	 */
+	Edit_journal(Netlist& netlist);
+
+	/** \brief Enables or disables recording. Disabling drops the recorded edits.
+	 *	\param[in] is_enabled - True to record the edits.
+	 */
+	void set_enabled(bool is_enabled);
+
+	/// \brief Returns true if the edits are recorded.
+	bool is_enabled() const;
+
+	/// \brief Starts a group of edits undone and redone as one step. Groups can be nested, the outermost one is the step.
+	void begin_group();
+
+	/// \brief Ends the current group of edits.
+	void end_group();
+
+	/** \brief Records an edit, called by the Netlist after the edit is made.
+	 *	Does nothing if recording is disabled or while an edit is undone or redone.
+	 *	\param[in] kind - Kind of the edit.
+	 *	\param[in] module - The edited Module Description, NULL for the edits of the Netlist.
+	 *	\param[in] object - The added or removed object: Module Description, Module Instance, Module Port, Net, or the (target, source) pair of an assignment.
+	 */
+	void record(EditKind kind, Module_description* module, const boost::shared_ptr<void>& object);
+
+	/// \brief Returns the current version, the number of applied edits.
+	size_t get_version() const;
+
+	/** \brief Undoes or redoes the edits up to the version, which can be inside a step. Throws if the version was dropped.
+	 *	\param[in] version - A version returned by get_version.
+	 */
+	void restore(size_t version);
+
+	/// \brief Undoes the last applied step, returns false if there is none.
+	bool undo();
+
+	/// \brief Redoes the last undone step, returns false if there is none.
+	bool redo();
+
+	/// \brief Returns the number of recorded edits, applied or undone.
+	size_t get_edit_count() const;
+
+private:
+
+	/// Recorded edit.
+	struct Edit
+	{
+		/// Kind of the edit.
+		EditKind kind;
+
+		/// The edited Module Description, NULL for the edits of the Netlist.
+		Module_description* module;
+
+		/// The added or removed object.
+		boost::shared_ptr<void> object;
+
+		/// True for the first edit of a step.
+		bool is_step_start;
+	};
+
+	/** \brief Applies the edit or its inverse.
+	 *	\param[in] edit - The edit.
+	 *	\param[in] is_inverse - True to apply the inverse operation.
+	 */
+	void apply(const Edit& edit, bool is_inverse);
+
+private:
+
+	/// The journaled Netlist.
+	Netlist& m_netlist;
+
+	/// Recorded edits, the applied ones first.
+	std::vector<Edit> m_edits;
+
+	/// Number of applied edits.
+	size_t m_version;
+
+	/// True if the edits are recorded.
+	bool m_is_enabled;
+
+	/// True while an edit is undone or redone.
+	bool m_is_replaying;
+
+	/// Depth of the nested groups.
+	unsigned m_group_depth;
+
+	/// True if the current group has an edit.
+	bool m_is_group_edited;
+
+};
+
+#endif // EDIT_JOURNAL_H
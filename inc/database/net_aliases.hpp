@@ -0,0 +1,79 @@
+#ifndef NET_ALIASES_HPP
+#define NET_ALIASES_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+/** \brief Class for holding the classes of aliased net names of a module, e.g. from assign statements.
+ *	Names are merged with a union-find structure (union by size, path compression), so merging
+ *	n names costs nearly linear time. Every class has one canonical name standing for all its names.
+ */
+class Net_aliases
+{
+public:
+
+	/// \brief Constructor, no name is aliased.
+	Net_aliases();
+
+	/** \brief Merges the classes of the two names. The canonical name of the first class stays canonical.
+	 *	\param[in] first - First net name.
+	 *	\param[in] second - Second net name.
+	 */
+	void merge(const std::string& first, const std::string& second);
+
+	/** \brief Makes the name the canonical name of its class. Does nothing for names that are not aliased.
+	 *	\param[in] name - Net name.
+	 */
+	void set_canonical(const std::string& name);
+
+	/** \brief Returns the canonical name of the class of the name, the name itself if it is not aliased.
+	 *	Does not modify the structure once compress() was called after the last merge, so it can then be called concurrently.
+	 *	\param[in] name - Net name.
+	 */
+	const std::string& get_canonical(const std::string& name) const;
+
+	/** \brief Returns true if the name was merged with another name.
+	 *	\param[in] name - Net name.
+	 */
+	bool is_aliased(const std::string& name) const;
+
+	/// \brief Returns true if no names are aliased.
+	bool is_empty() const;
+
+	/// \brief Returns all aliased names, sorted.
+	std::vector<std::string> get_names() const;
+
+	/// \brief Points every name directly to the root of its class.
+	void compress();
+
+	/// \brief Removes all aliases.
+	void clear();
+
+private:
+
+	/** \brief Returns the root of the class of the name, compressing the path.
+	 *	\param[in] index - Index of the name.
+	 */
+	size_t find_root(size_t index) const;
+
+private:
+
+	/// Indices of the aliased names.
+	std::map<std::string, size_t> m_indices;
+
+	/// The aliased names by index.
+	std::vector<const std::string*> m_names;
+
+	/// Parents of the names, roots are their own parents. Compressed on lookups.
+	mutable std::vector<size_t> m_parents;
+
+	/// Sizes of the classes, valid for the roots.
+	std::vector<size_t> m_sizes;
+
+	/// Canonical names of the classes, valid for the roots.
+	std::vector<size_t> m_canonicals;
+
+};
+
+#endif // NET_ALIASES_HPP
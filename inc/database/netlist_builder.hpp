@@ -36,6 +36,9 @@ private:
 	/// \brief Fixes the references to the Module Descriptions from instances. Must be called after reading all the Modules.
 	void fix_instance_to_description_pointers();
 
+	/// \brief Connects the Nets of all modules to their ports. Must be called after fixing instance to description pointers.
+	void connect_nets_to_ports();
+
 	/** \brief Must be called by parser when a new module starts.
 	 *	\param[in] info - The line of netlist that declares a new module.
 	 */
@@ -68,6 +71,12 @@ private:
 	 */
 	void add_wire( const std::string& info, const std::string& comment );
 
+	/** \brief Called by parser to add assignments "assign a = b, c = d;" to current module description.
+	 *	\param[in] info - The information part of the current string.
+	 *	\param[in] comment - The comment part of the current string.
+	 */
+	void add_assign( const std::string& info, const std::string& comment );
+
 	/** \brief Called by parser to add new instance to current module description.
 	 *	\param[in] info - The information part of the current string.
 	 *	\param[in] comment - The comment part of the current string.
@@ -0,0 +1,39 @@
+#ifndef NETLIST_READER_H
+#define NETLIST_READER_H
+
+class Netlist;
+
+/** \brief Guard pinning the published version of a Netlist for one reader thread, see the concurrency model of Netlist.
+ *	Pinning and unpinning are one store and one load each, without locks and without reference counting. The version
+ *	stays valid while the guard lives, even if the writer publishes newer versions meanwhile.
+ */
+class Netlist_reader
+{
+public:
+
+	/** \brief Constructor, pins the last published version. Throws if nothing was published or the index is not valid.
+	 *	\param[in] netlist - The live Netlist.
+	 *	\param[in] reader - Index of the reader in [0, Netlist::max_readers), used by one guard at a time.
+	 */
+	Netlist_reader(const Netlist& netlist, unsigned reader);
+
+	/// \brief Destructor, unpins the version.
+	~Netlist_reader();
+
+	/// \brief Returns the pinned version, an immutable Netlist.
+	const Netlist& get_netlist() const;
+
+private:
+
+	/// The live Netlist.
+	const Netlist& m_netlist;
+
+	/// Index of the reader.
+	unsigned m_reader;
+
+	/// The pinned version.
+	const Netlist& m_version;
+
+};
+
+#endif // NETLIST_READER_H
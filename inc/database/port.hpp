@@ -28,6 +28,11 @@ public:
 	/// \brief Getter for the type.
 	virtual PortType get_type() const;
 
+	/** \brief Setter for the type.
+	 *	\param[in] type - New type of the Port.
+	 */
+	void set_type(PortType type);
+
 private:
 
 	/// Name of the Port.
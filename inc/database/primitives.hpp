@@ -0,0 +1,46 @@
+#ifndef PRIMITIVES_HPP
+#define PRIMITIVES_HPP
+
+#include <string>
+
+/// Enum for holding the type of a built-in gate primitive.
+enum PrimitiveType
+{
+	PRIMITIVE_NONE = 0,
+	PRIMITIVE_AND = 1,
+	PRIMITIVE_OR = 2,
+	PRIMITIVE_NAND = 3,
+	PRIMITIVE_NOR = 4,
+	PRIMITIVE_XOR = 5,
+	PRIMITIVE_XNOR = 6,
+	PRIMITIVE_NOT = 7,
+	PRIMITIVE_BUF = 8
+};
+
+/// This class has only static members describing the built-in primitives (and, or, not ... etc.).
+class Primitives
+{
+public:
+
+	/** \brief Returns the primitive type for the given Module Description name.
+	 *	\param[in] description_name - Name of the Module Description of an instance.
+	 *	\ret The primitive type, PRIMITIVE_NONE if the name is not a built-in primitive.
+	 */
+	static PrimitiveType get_type(const std::string& description_name);
+
+	/** \brief Returns the netlist keyword of the given primitive type.
+	 *	\param[in] type - Type of the primitive.
+	 */
+	static const std::string& get_name(PrimitiveType type);
+
+	/** \brief Checks if the given pin of a primitive is its output.
+	 *	\param[in] pin_name - Name of the primitive pin.
+	 */
+	static bool is_output_pin(const std::string& pin_name);
+
+	/// Name of the output pin of all primitives.
+	static const std::string output_pin;
+
+};
+
+#endif // PRIMITIVES_HPP
@@ -0,0 +1,34 @@
+#ifndef BINARY_READER_HPP
+#define BINARY_READER_HPP
+
+#include <istream>
+#include <boost/shared_ptr.hpp>
+
+class Netlist;
+
+/** \brief Class for reading a Netlist written by the Binary Writer. The instances are bound to their Module Descriptions
+ *	and the modules are connected in parallel, as after reading Verilog with the Netlist Builder.
+ */
+class Binary_reader
+{
+public:
+
+	/** \brief Constructor.
+	 *	\param[in] thread_count - Number of threads used to connect the modules, 0 for the hardware thread count.
+	 */
+	Binary_reader(unsigned thread_count = 0);
+
+	/** \brief Reads a Netlist. Throws if the stream is not a binary netlist or is truncated.
+	 *	\param[in,out] stream - The input stream, opened in binary mode.
+	 *	\ret The Netlist.
+	 */
+	boost::shared_ptr<Netlist> read(std::istream& stream) const;
+
+private:
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+};
+
+#endif // BINARY_READER_HPP
@@ -0,0 +1,136 @@
+#ifndef GRAPH_WRITER_HPP
+#define GRAPH_WRITER_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <map>
+
+class Module_description;
+class Module_instance;
+class Module_port;
+class Net;
+class Port;
+
+/** \brief Class for writing the connectivity of a Module Description, or a selected region or cone of it, as Graphviz DOT or GraphML.
+ *	Nodes are the instances and module ports, edges go from the driver of a net to its sinks. The graph is built from the
+ *	connected Nets of the module, so it must be connected. The selection stops at a maximal node count and reports the
+ *	truncation. Nets with more sinks than the fanout limit (clocks, resets, enables) are clustered: they are drawn as one hub
+ *	node linked to the selected endpoints and are not followed by the selection, so they do not pull in half of the module.
+ *	The output is streamed, only the selected nodes are kept in memory.
+ */
+class Graph_writer
+{
+public:
+
+	/// Output formats.
+	enum Format
+	{
+		FORMAT_DOT,
+		FORMAT_GRAPHML
+	};
+
+	/** \brief Constructor with the module, nothing is selected.
+	 *	\param[in] module - The connected Module Description, must outlive the writer.
+	 *	\param[in] max_nodes - Maximal number of selected instances and ports.
+	 *	\param[in] max_fanout - Nets with more sinks are clustered into a hub node.
+	 */
+	Graph_writer(const Module_description& module, size_t max_nodes = 1000, size_t max_fanout = 16);
+
+	/// \brief Selects the ports and instances of the module in name order, up to the node limit.
+	void select_all();
+
+	/** \brief Selects the instances and ports within a number of nets of the seeds, breadth first, up to the node limit.
+	 *	\param[in] seeds - Names of the seed instances or ports. Throws if a name is not found.
+	 *	\param[in] radius - Number of nets to cross from the seeds, 0 for the seeds only.
+	 */
+	void select_region(const std::vector<std::string>& seeds, unsigned radius);
+
+	/** \brief Selects the fan-in cone of a net, breadth first through the drivers, up to the node limit.
+	 *	\param[in] net_name - Name of the net. Throws if the module has no such net.
+	 *	\param[in] depth - Number of instances to cross, 0 for the complete cone.
+	 */
+	void select_cone(const std::string& net_name, unsigned depth);
+
+	/** \brief Writes the selected nodes and the nets between them.
+	 *	\param[in,out] stream - The output stream.
+	 *	\param[in] format - The output format.
+	 */
+	void write(std::ostream& stream, Format format) const;
+
+	/// \brief Returns the number of selected instances and ports.
+	size_t get_node_count() const;
+
+	/// \brief Returns true if the last selection stopped at the node limit.
+	bool is_truncated() const;
+
+private:
+
+	/// A selected instance or module port, exactly one of the pointers is set.
+	struct Node
+	{
+		/// The instance.
+		const Module_instance* instance;
+
+		/// The module port.
+		const Module_port* port;
+	};
+
+	/// A node waiting in the breadth first selection, with its distance from the seeds.
+	typedef std::pair<size_t, unsigned> Pending_node;
+
+	/// \brief Clears the selection.
+	void clear();
+
+	/** \brief Selects the node owning the port, if it is not selected yet and the limit is not reached.
+	 *	\param[in] port - A module or instance port.
+	 *	\ret Index of the node, or the node count if it was not selected.
+	 */
+	size_t select(const Port& port);
+
+	/** \brief Selects the nodes reached from the pending nodes, breadth first.
+	 *	\param[in] pending - Seed nodes with distance 0.
+	 *	\param[in] max_distance - Nodes at this distance from the seeds are not expanded.
+	 *	\param[in] is_fanin_only - True to cross nets only from their sinks to their drivers.
+	 */
+	void expand(std::vector<Pending_node>& pending, unsigned max_distance, bool is_fanin_only);
+
+	/** \brief Returns the Nets connected to the node with the type of its port on them.
+	 *	\param[in] node - The node.
+	 *	\param[out] nets - The Nets, with true for the nets driven by the node.
+	 */
+	void get_nets(const Node& node, std::vector<std::pair<const Net*, bool> >& nets) const;
+
+	/** \brief Returns the index of the selected node owning the port, the node count if it is not selected.
+	 *	\param[in] port - A module or instance port.
+	 */
+	size_t find_node(const Port& port) const;
+
+	/** \brief Returns the identifier of a node in the output.
+	 *	\param[in] node - The node.
+	 */
+	std::string get_node_id(const Node& node) const;
+
+private:
+
+	/// The module.
+	const Module_description& m_module;
+
+	/// Maximal number of nodes.
+	size_t m_max_nodes;
+
+	/// Maximal fanout of the nets drawn as edges.
+	size_t m_max_fanout;
+
+	/// Selected nodes in selection order.
+	std::vector<Node> m_nodes;
+
+	/// Indices of the selected nodes by their instance or port.
+	std::map<const void*, size_t> m_node_indices;
+
+	/// True if the selection stopped at the node limit.
+	bool m_is_truncated;
+
+};
+
+#endif // GRAPH_WRITER_HPP
@@ -0,0 +1,64 @@
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include <map>
+
+#include "netlist_writer.hpp"
+
+/** \brief Class for writing a Netlist as JSON in the layout of the Yosys write_json command, without building a document.
+ *	Every module has "ports", "netnames" and "cells" objects. The nets of a module are numbered from 2 in name order,
+ *	bits of literal constants are "0" and "1", names aliased by assignments get the bits of their canonical net.
+ *	Cells are the instances, with their master as "type", their "port_directions" and "connections".
+ *	Formatting runs in parallel, see Netlist_writer; memory is bounded by the batch and the net index of the modules being written.
+ */
+class Json_writer : public Netlist_writer
+{
+public:
+
+	/** \brief Constructor with the Netlist.
+	 *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+	 *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+	 */
+	Json_writer(const Netlist& netlist, unsigned thread_count = 0);
+
+protected:
+
+	/** \brief Indexes the nets of the modules of the batch.
+	 *	\param[in] tasks - Tasks of the batch.
+	 */
+	virtual void prepare_batch(const std::vector<Task>& tasks);
+
+	/** \brief Appends the opening of the document.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_begin(std::string& buffer) const;
+
+	/** \brief Appends the closing of the document.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_end(std::string& buffer) const;
+
+	/** \brief Appends a task to the buffer.
+	 *	\param[in] task - The task.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_task(const Task& task, std::string& buffer) const;
+
+private:
+
+	/** \brief Appends the bits of a net name as a JSON array.
+	 *	\param[in] module - The module of the net.
+	 *	\param[in] nets - Net index of the module.
+	 *	\param[in] name - Name of the net, empty for an unconnected pin.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	void format_bits(const Module_description& module, const Net_index& nets, const std::string& name, std::string& buffer) const;
+
+private:
+
+	/// Net indices of the modules of the current batch.
+	std::map<const Module_description*, boost::shared_ptr<Net_index> > m_net_indices;
+
+};
+
+#endif // JSON_WRITER_HPP
@@ -0,0 +1,174 @@
+#ifndef NETLIST_WRITER_HPP
+#define NETLIST_WRITER_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
+
+class Netlist;
+class Module_description;
+class Module_instance;
+
+/** \brief Base class of the streaming Netlist writers, formatting the modules in parallel with bounded memory.
+ *	Modules are written in name order. They are cut into tasks of a bounded number of instances, a batch of tasks is
+ *	formatted in parallel into one buffer per thread and the buffers are written in thread order, so the output does
+ *	not depend on the thread count and the memory use is bounded by the batch size. Files are written with one vectored
+ *	write per batch. Compressed files are gzip files with one member per buffer, deflated in parallel; gzip and zlib
+ *	read them as a single stream. Derived classes format the tasks.
+ */
+class Netlist_writer
+{
+public:
+
+	/** \brief Constructor with the Netlist.
+	 *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+	 *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+	 */
+	Netlist_writer(const Netlist& netlist, unsigned thread_count);
+
+	/// \brief Destructor.
+	virtual ~Netlist_writer();
+
+	/** \brief Writes the Netlist to the stream. Throws if the stream fails.
+	 *	\param[in,out] stream - The output stream.
+	 */
+	void write(std::ostream& stream);
+
+	/** \brief Writes the Netlist to a file. Throws if the file can not be written.
+	 *	\param[in] file_name - Name of the file, replaced if it exists.
+	 *	\param[in] is_compressed - True to write a gzip file.
+	 */
+	void write(const std::string& file_name, bool is_compressed = false);
+
+	/// \brief Returns the number of bytes formatted by the last write, before compression.
+	unsigned long long get_byte_count() const;
+
+protected:
+
+	/// A part of a module formatted by one thread: the header, a run of instances, the end of the module.
+	struct Task
+	{
+		/// The module.
+		const Module_description* module;
+
+		/// Index of the module in the Netlist.
+		size_t module_index;
+
+		/// First instance of the task.
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator first_instance;
+
+		/// Index of the first instance of the task in the module.
+		size_t instance_index;
+
+		/// Number of instances of the task.
+		size_t instance_count;
+
+		/// True if the task starts the module.
+		bool is_first;
+
+		/// True if the task ends the module.
+		bool is_last;
+	};
+
+	/** \brief Called on the writing thread before a batch is formatted, to prepare the data shared by its tasks.
+	 *	\param[in] tasks - Tasks of the batch.
+	 */
+	virtual void prepare_batch(const std::vector<Task>& tasks);
+
+	/** \brief Appends the text written before the first module.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_begin(std::string& buffer) const;
+
+	/** \brief Appends the text written after the last module.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_end(std::string& buffer) const;
+
+	/** \brief Appends a task to the buffer. Called in parallel for the tasks of a batch.
+	 *	\param[in] task - The task.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_task(const Task& task, std::string& buffer) const = 0;
+
+	/// \brief Returns the Netlist.
+	const Netlist& get_netlist() const;
+
+private:
+
+	/// Function writing the buffers of a batch to the destination: a stream, a file or a compressed file.
+	typedef boost::function<void (std::vector<std::string>&)> Buffer_function;
+
+	/** \brief Formats all modules in batches and hands the buffers of each batch to the output function.
+	 *	\param[in] output - Function writing the buffers.
+	 */
+	void write_batches(const Buffer_function& output);
+
+	/** \brief Formats a chunk of tasks of the current batch into the buffer of the thread.
+	 *	\param[in] begin - First task of the chunk.
+	 *	\param[in] end - Task after the last one of the chunk.
+	 *	\param[in] thread - Index of the thread.
+	 */
+	void format_tasks(size_t begin, size_t end, unsigned thread);
+
+private:
+
+	/// The Netlist.
+	const Netlist& m_netlist;
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Tasks of the current batch.
+	std::vector<Task> m_tasks;
+
+	/// One buffer per thread, reused between batches.
+	std::vector<std::string> m_buffers;
+
+	/// Number of bytes formatted by the last write.
+	unsigned long long m_byte_count;
+
+};
+
+/// Dense indices of the nets of a module in name order, literal constants excluded, found by hashing the names.
+class Net_index
+{
+public:
+
+	/// Index returned for unknown net names.
+	static const size_t npos;
+
+	/** \brief Constructor, indexes the nets of the module.
+	 *	\param[in] module - The Module Description, must outlive the index.
+	 */
+	explicit Net_index(const Module_description& module);
+
+	/** \brief Returns the index of the net, npos for literal constants and names the module has no net for.
+	 *	\param[in] name - Name of the net.
+	 */
+	size_t find(const std::string& name) const;
+
+private:
+
+	/// Hashes the pointed name.
+	struct Name_hash
+	{
+		size_t operator()(const std::string* name) const;
+	};
+
+	/// Compares the pointed names.
+	struct Name_equal
+	{
+		bool operator()(const std::string* first, const std::string* second) const;
+	};
+
+	/// Indices of the nets by name.
+	boost::unordered_map<const std::string*, size_t, Name_hash, Name_equal> m_indices;
+
+};
+
+#endif // NETLIST_WRITER_HPP
@@ -0,0 +1,96 @@
+#ifndef EVENT_SIMULATOR_HPP
+#define EVENT_SIMULATOR_HPP
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "logic_word.hpp"
+#include "simulation_program.hpp"
+
+/** \brief Event-driven bit-parallel logic simulator for sparse input activity.
+ *	Changing a net schedules its fanout gates into a timing wheel with one bucket per level, and
+ *	only scheduled gates are evaluated. Gates are evaluated with the same kernels as the Cycle Simulator.
+ *	A gate scheduled at or below the level being processed (a combinational loop) is deferred to the
+ *	next cycle, which matches the loop semantics of the Cycle Simulator.
+ */
+class Event_simulator
+{
+public:
+
+	/** \brief Constructor with the program to simulate. All inputs start at 0 and all gates are evaluated once.
+	 *	\param[in] program - The Simulation Program, must outlive the simulator.
+	 */
+	Event_simulator(const Simulation_program& program);
+
+	/// \brief Getter for the Simulation Program.
+	const Simulation_program& get_program() const;
+
+	/** \brief Sets the value of a net, usually an input net, and schedules its fanouts if it changes.
+	 *	\param[in] net - Id of the net.
+	 *	\param[in] value - The new value for all patterns.
+	 */
+	void set_value(Flat_id net, const Logic_word& value);
+
+	/** \brief Returns the value of a net.
+	 *	\param[in] net - Id of the net.
+	 */
+	const Logic_word& get_value(Flat_id net) const;
+
+	/// \brief Returns the values of all nets.
+	const std::vector<Logic_word>& get_values() const;
+
+	/// \brief Evaluates the scheduled gates until no more events are left in this cycle.
+	void simulate();
+
+	/// \brief Returns the number of events processed so far, i.e. net value changes.
+	boost::uint64_t get_event_count() const;
+
+	/// \brief Returns the number of gate evaluations done so far, counting words, not patterns.
+	boost::uint64_t get_evaluation_count() const;
+
+	/// \brief Returns the processed events per second of time spent in simulate.
+	double get_events_per_second() const;
+
+private:
+
+	/// Level passed to schedule_fanouts when no level is being processed.
+	static const unsigned no_level;
+
+	/** \brief Schedules the fanout gates of the changed net.
+	 *	\param[in] net - Id of the net.
+	 *	\param[in] current_level - Level being processed, gates at or below it are deferred to the next cycle. no_level outside of simulate.
+	 */
+	void schedule_fanouts(Flat_id net, unsigned current_level);
+
+private:
+
+	/// The Simulation Program.
+	const Simulation_program& m_program;
+
+	/// Values of all nets.
+	std::vector<Logic_word> m_values;
+
+	/// Timing wheel, scheduled gate positions by level.
+	std::vector<std::vector<Flat_id> > m_wheel;
+
+	/// Gate positions deferred to the next cycle.
+	std::vector<Flat_id> m_deferred;
+
+	/// Flags of the scheduled gate positions.
+	std::vector<char> m_scheduled;
+
+	/// The lowest level with scheduled gates.
+	unsigned m_first_level;
+
+	/// Number of processed events.
+	boost::uint64_t m_event_count;
+
+	/// Number of gate evaluations.
+	boost::uint64_t m_evaluation_count;
+
+	/// Processor time spent in simulate, in seconds.
+	double m_seconds;
+
+};
+
+#endif // EVENT_SIMULATOR_HPP
@@ -0,0 +1,105 @@
+#ifndef SIMULATION_PROGRAM_HPP
+#define SIMULATION_PROGRAM_HPP
+
+#include <vector>
+
+#include "logic_word.hpp"
+#include "analysis/levelizer.hpp"
+
+/** \brief Class for holding the gates of a levelized Flat Netlist in evaluation order.
+ *	Gates are ordered by level and by type inside a level, so that runs of gates of the same type
+ *	can be evaluated with one kernel. Gates without output or without kernel are left out.
+ */
+class Simulation_program
+{
+public:
+
+	/// Consecutive gates of the same type and level.
+	struct Run
+	{
+		/// Position of the first gate of the run.
+		Flat_id begin;
+
+		/// Position after the last gate of the run.
+		Flat_id end;
+
+		/// Type of all gates of the run.
+		PrimitiveType type;
+	};
+
+	/** \brief Constructor from a levelized netlist.
+	 *	\param[in] levelizer - The Levelizer, levelize must already be called. The netlist must outlive the program.
+	 */
+	Simulation_program(const Levelizer& levelizer);
+
+	/// \brief Getter for the Flat Netlist.
+	const Flat_netlist& get_netlist() const;
+
+	/// \brief Returns the number of gates in the program.
+	size_t get_gate_count() const;
+
+	/// \brief Returns the Flat Netlist gates by position.
+	const std::vector<Flat_id>& get_gates() const;
+
+	/// \brief Returns the positions of the Flat Netlist gates, invalid_id for gates left out.
+	const std::vector<Flat_id>& get_positions() const;
+
+	/// \brief Returns the types of the gates by position.
+	const std::vector<PrimitiveType>& get_types() const;
+
+	/// \brief Returns the output nets of the gates by position.
+	const std::vector<Flat_id>& get_outputs() const;
+
+	/// \brief Returns the offsets of the gate inputs by position.
+	const std::vector<Flat_id>& get_input_offsets() const;
+
+	/// \brief Returns the input nets of all gates.
+	const std::vector<Flat_id>& get_inputs() const;
+
+	/// \brief Returns the levels of the gates by position.
+	const std::vector<unsigned>& get_levels() const;
+
+	/// \brief Returns the offsets of the levels, gates of level l are at positions [offsets[l], offsets[l + 1]).
+	const std::vector<Flat_id>& get_level_offsets() const;
+
+	/// \brief Returns the runs of gates of the same type, in evaluation order.
+	const std::vector<Run>& get_runs() const;
+
+	/// \brief Returns the values of all nets before simulation: nets tied to 1'b1 are all ones, the other nets all zeros.
+	std::vector<Logic_word> get_initial_values() const;
+
+private:
+
+	/// The Flat Netlist.
+	const Flat_netlist& m_netlist;
+
+	/// Flat Netlist gates by position.
+	std::vector<Flat_id> m_gates;
+
+	/// Positions of the Flat Netlist gates.
+	std::vector<Flat_id> m_positions;
+
+	/// Types by position.
+	std::vector<PrimitiveType> m_types;
+
+	/// Output nets by position.
+	std::vector<Flat_id> m_outputs;
+
+	/// Offsets of the inputs by position.
+	std::vector<Flat_id> m_input_offsets;
+
+	/// Input nets.
+	std::vector<Flat_id> m_inputs;
+
+	/// Levels by position.
+	std::vector<unsigned> m_levels;
+
+	/// Offsets of the levels.
+	std::vector<Flat_id> m_level_offsets;
+
+	/// Runs of gates of the same type.
+	std::vector<Run> m_runs;
+
+};
+
+#endif // SIMULATION_PROGRAM_HPP
@@ -0,0 +1,422 @@
+#include "aig.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+
+const Aig::Literal Aig::false_literal = 0;
+const Aig::Literal Aig::true_literal = 1;
+const Aig::Literal Aig::invalid_literal = ~0u;
+
+/// Helper functions.
+namespace
+{
+	/// Initial number of slots of the structural hashing table, must be a power of two.
+	const size_t initial_table_size = 1024;
+
+	/// Size of the buffer of the AIGER writer.
+	const size_t write_buffer_size = 1 << 16;
+
+	/// \brief Appends an unsigned number in the 7-bit variable length encoding of the binary AIGER format.
+	void encode_delta(boost::uint32_t delta, std::string& buffer)
+	{
+		while (delta & ~0x7fu)
+		{
+			buffer.push_back(static_cast<char>((delta & 0x7fu) | 0x80u));
+			delta >>= 7;
+		}
+		buffer.push_back(static_cast<char>(delta));
+	}
+
+	/// \brief Returns the patterns of a literal.
+	boost::uint64_t get_literal_value(const std::vector<boost::uint64_t>& values, Aig::Literal literal)
+	{
+		return values[Aig::get_variable(literal)] ^ (Aig::is_complemented(literal) ? ~boost::uint64_t(0) : 0);
+	}
+}
+
+/// \brief Constructor of an empty graph.
+Aig::Aig()
+	: m_input_count( 0 )
+	, m_table( initial_table_size, 0 )
+{
+}
+
+/** \brief Constructor converting the built-in primitives of a levelized netlist.
+ *	Input nets and outputs of undefined module instances become inputs, the top output ports become outputs.
+ *	Nets tied to literal constants become the constant literals, undriven nets are false.
+ *	Throws if the netlist has combinational loops.
+ *	\param[in] levelizer - The Levelizer, levelize must already be called.
+ */
+Aig::Aig(const Levelizer& levelizer)
+	: m_input_count( 0 )
+	, m_table( initial_table_size, 0 )
+{
+	if (levelizer.has_loops())
+	{
+		throw std::string("Unable to convert a netlist with combinational loops to an AIG.");
+	}
+
+	const Flat_netlist& netlist = levelizer.get_netlist();
+	const std::vector<PrimitiveType>& types = netlist.get_gate_types();
+	const std::vector<Flat_id>& outputs = netlist.get_gate_outputs();
+	const std::vector<Flat_id>& input_offsets = netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = netlist.get_gate_inputs();
+	const std::vector<Flat_id>& levelized = levelizer.get_levelized_gates();
+	size_t gate_count = netlist.get_gate_count();
+
+	// Most gates become one or two AND nodes, size the arrays once.
+	m_and_fanins.reserve(4 * gate_count);
+	size_t table_size = initial_table_size;
+	while (table_size < 4 * gate_count)
+	{
+		table_size *= 2;
+	}
+	m_table.assign(table_size, 0);
+	m_net_literals.assign(netlist.get_net_count(), invalid_literal);
+	const std::vector<LogicConstant>& constants = netlist.get_net_constants();
+	for (size_t net = 0; net < constants.size(); ++net)
+	{
+		if (CONSTANT_NONE != constants[net])
+		{
+			m_net_literals[net] = (CONSTANT_ONE == constants[net]) ? true_literal : false_literal;
+		}
+	}
+
+	const std::vector<Flat_id>& input_nets = netlist.get_input_nets();
+	std::vector<Flat_id>::const_iterator I;
+	for (I = input_nets.begin(); I != input_nets.end(); ++I)
+	{
+		m_net_literals[*I] = create_input(netlist.get_net_name(*I));
+	}
+	for (size_t gate = 0; gate < gate_count; ++gate)
+	{
+		if (PRIMITIVE_NONE == types[gate] && Flat_netlist::invalid_id != outputs[gate])
+		{
+			m_net_literals[outputs[gate]] = create_input(netlist.get_net_name(outputs[gate]));
+		}
+	}
+
+	std::vector<Literal> fanins;
+	for (I = levelized.begin(); I != levelized.end(); ++I)
+	{
+		if (PRIMITIVE_NONE == types[*I] || Flat_netlist::invalid_id == outputs[*I])
+		{
+			continue;
+		}
+		fanins.clear();
+		for (Flat_id i = input_offsets[*I]; i < input_offsets[*I + 1]; ++i)
+		{
+			Literal literal = m_net_literals[inputs[i]];
+			fanins.push_back((invalid_literal == literal) ? false_literal : literal);
+		}
+		m_net_literals[outputs[*I]] = convert_gate(types[*I], fanins);
+	}
+
+	const std::vector<Flat_id>& output_nets = netlist.get_output_nets();
+	for (I = output_nets.begin(); I != output_nets.end(); ++I)
+	{
+		Literal literal = m_net_literals[*I];
+		create_output((invalid_literal == literal) ? false_literal : literal, netlist.get_net_name(*I));
+	}
+}
+
+/** \brief Creates a new input. Inputs must be created before the AND nodes.
+ *	\param[in] name - Name of the input for the symbol table, may be empty.
+ *	\ret The literal of the input.
+ */
+Aig::Literal Aig::create_input(const std::string& name)
+{
+	if (!m_and_fanins.empty())
+	{
+		throw std::string("AIG inputs must be created before the AND nodes.");
+	}
+	++m_input_count;
+	m_input_names.push_back(name);
+	return static_cast<Literal>(2 * m_input_count);
+}
+
+/** \brief Returns the AND of two literals, the node is only created if no identical node exists.
+ *	\param[in] first - The first fanin.
+ *	\param[in] second - The second fanin.
+ */
+Aig::Literal Aig::create_and(Literal first, Literal second)
+{
+	if (first < second)
+	{
+		std::swap(first, second);
+	}
+	if (false_literal == second || first == negate(second))
+	{
+		return false_literal;
+	}
+	if (true_literal == second || first == second)
+	{
+		return first;
+	}
+
+	size_t slot = find_slot(first, second);
+	boost::uint32_t index = m_table[slot];
+	if (0 == index)
+	{
+		// Growing the table moves the nodes to new slots, the index is kept before.
+		m_and_fanins.push_back(first);
+		m_and_fanins.push_back(second);
+		index = static_cast<boost::uint32_t>(get_and_count());
+		m_table[slot] = index;
+		if (2 * get_and_count() > m_table.size())
+		{
+			grow_table();
+		}
+	}
+	return static_cast<Literal>(2 * (m_input_count + index));
+}
+
+/** \brief Returns the OR of two literals.
+ *	\param[in] first - The first fanin.
+ *	\param[in] second - The second fanin.
+ */
+Aig::Literal Aig::create_or(Literal first, Literal second)
+{
+	return negate(create_and(negate(first), negate(second)));
+}
+
+/** \brief Returns the XOR of two literals, built from three AND nodes.
+ *	\param[in] first - The first fanin.
+ *	\param[in] second - The second fanin.
+ */
+Aig::Literal Aig::create_xor(Literal first, Literal second)
+{
+	return create_or(create_and(first, negate(second)), create_and(negate(first), second));
+}
+
+/** \brief Adds an output.
+ *	\param[in] literal - Literal driving the output.
+ *	\param[in] name - Name of the output for the symbol table, may be empty.
+ */
+void Aig::create_output(Literal literal, const std::string& name)
+{
+	m_outputs.push_back(literal);
+	m_output_names.push_back(name);
+}
+
+/// \brief Returns the complement of a literal.
+Aig::Literal Aig::negate(Literal literal)
+{
+	return literal ^ 1;
+}
+
+/// \brief Returns the variable of a literal.
+Aig::Literal Aig::get_variable(Literal literal)
+{
+	return literal >> 1;
+}
+
+/// \brief Returns true if the literal is complemented.
+bool Aig::is_complemented(Literal literal)
+{
+	return 0 != (literal & 1);
+}
+
+/// \brief Returns the number of inputs.
+size_t Aig::get_input_count() const
+{
+	return m_input_count;
+}
+
+/// \brief Returns the number of AND nodes.
+size_t Aig::get_and_count() const
+{
+	return m_and_fanins.size() / 2;
+}
+
+/// \brief Returns the largest variable index.
+size_t Aig::get_max_variable() const
+{
+	return m_input_count + get_and_count();
+}
+
+/** \brief Returns the fanin literals of the AND nodes, the fanins of node i are at 2 * i and 2 * i + 1.
+ *	The variable of node i is get_input_count() + 1 + i.
+ */
+const std::vector<Aig::Literal>& Aig::get_and_fanins() const
+{
+	return m_and_fanins;
+}
+
+/// \brief Returns the output literals.
+const std::vector<Aig::Literal>& Aig::get_outputs() const
+{
+	return m_outputs;
+}
+
+/// \brief Returns the literals of the Flat Netlist nets, invalid_literal for nets without a function.
+const std::vector<Aig::Literal>& Aig::get_net_literals() const
+{
+	return m_net_literals;
+}
+
+/** \brief Simulates 64 patterns.
+ *	\param[in] input_values - One word of patterns per input.
+ *	\param[out] output_values - One word of patterns per output.
+ */
+void Aig::evaluate(const std::vector<boost::uint64_t>& input_values, std::vector<boost::uint64_t>& output_values) const
+{
+	std::vector<boost::uint64_t> values(get_max_variable() + 1, 0);
+	for (size_t i = 0; i < m_input_count && i < input_values.size(); ++i)
+	{
+		values[i + 1] = input_values[i];
+	}
+	for (size_t node = 0; node < get_and_count(); ++node)
+	{
+		values[m_input_count + 1 + node] = get_literal_value(values, m_and_fanins[2 * node]) & get_literal_value(values, m_and_fanins[2 * node + 1]);
+	}
+	output_values.resize(m_outputs.size());
+	for (size_t i = 0; i < m_outputs.size(); ++i)
+	{
+		output_values[i] = get_literal_value(values, m_outputs[i]);
+	}
+}
+
+/** \brief Writes the graph in the binary AIGER format, with the symbol table of the named inputs and outputs.
+ *	\param[in] stream - Stream to write to, must be opened in binary mode.
+ */
+void Aig::write_aiger(std::ostream& stream) const
+{
+	stream << "aig " << get_max_variable() << " " << m_input_count << " 0 " << m_outputs.size() << " " << get_and_count() << "\n";
+	std::vector<Literal>::const_iterator I;
+	for (I = m_outputs.begin(); I != m_outputs.end(); ++I)
+	{
+		stream << *I << "\n";
+	}
+
+	// AND nodes are stored as the deltas to their larger and smaller fanins.
+	std::string buffer;
+	buffer.reserve(write_buffer_size + 16);
+	for (size_t node = 0; node < get_and_count(); ++node)
+	{
+		Literal literal = static_cast<Literal>(2 * (m_input_count + 1 + node));
+		encode_delta(literal - m_and_fanins[2 * node], buffer);
+		encode_delta(m_and_fanins[2 * node] - m_and_fanins[2 * node + 1], buffer);
+		if (buffer.size() >= write_buffer_size)
+		{
+			stream.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	}
+	stream.write(buffer.data(), buffer.size());
+
+	for (size_t i = 0; i < m_input_names.size(); ++i)
+	{
+		if (!m_input_names[i].empty())
+		{
+			stream << "i" << i << " " << m_input_names[i] << "\n";
+		}
+	}
+	for (size_t i = 0; i < m_output_names.size(); ++i)
+	{
+		if (!m_output_names[i].empty())
+		{
+			stream << "o" << i << " " << m_output_names[i] << "\n";
+		}
+	}
+}
+
+/** \brief Writes the graph to a binary AIGER file. Throws if the file cannot be written.
+ *	\param[in] file_name - Name of the file.
+ */
+void Aig::write_aiger(const std::string& file_name) const
+{
+	std::ofstream file(file_name.c_str(), std::ios::out | std::ios::binary);
+	if (!file.good())
+	{
+		throw std::string("Unable to open the AIGER file for writing: " + file_name);
+	}
+	write_aiger(file);
+	if (!file.good())
+	{
+		throw std::string("Unable to write the AIGER file: " + file_name);
+	}
+}
+
+/** \brief Returns the slot of the structural hashing table holding the AND node of the fanins, or the empty slot where it belongs.
+ *	\param[in] first - The larger fanin.
+ *	\param[in] second - The smaller fanin.
+ */
+size_t Aig::find_slot(Literal first, Literal second) const
+{
+	size_t mask = m_table.size() - 1;
+	boost::uint32_t hash = first * 0x9e3779b1u ^ second * 0x85ebca6bu;
+	size_t slot = (hash ^ (hash >> 15)) & mask;
+	while (0 != m_table[slot])
+	{
+		size_t node = m_table[slot] - 1;
+		if (m_and_fanins[2 * node] == first && m_and_fanins[2 * node + 1] == second)
+		{
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+/// \brief Doubles the structural hashing table.
+void Aig::grow_table()
+{
+	m_table.assign(2 * m_table.size(), 0);
+	for (size_t node = 0; node < get_and_count(); ++node)
+	{
+		m_table[find_slot(m_and_fanins[2 * node], m_and_fanins[2 * node + 1])] = static_cast<boost::uint32_t>(node + 1);
+	}
+}
+
+/** \brief Converts a gate of the netlist, the fanins must already be converted.
+ *	\param[in] type - Primitive type of the gate.
+ *	\param[in] fanins - Literals of the gate inputs, used as scratch space.
+ */
+Aig::Literal Aig::convert_gate(PrimitiveType type, std::vector<Literal>& fanins)
+{
+	bool is_inverted = (PRIMITIVE_NAND == type || PRIMITIVE_NOR == type || PRIMITIVE_XNOR == type || PRIMITIVE_NOT == type);
+	bool is_or = (PRIMITIVE_OR == type || PRIMITIVE_NOR == type);
+	Literal result = false_literal;
+	if (PRIMITIVE_XOR == type || PRIMITIVE_XNOR == type)
+	{
+		for (size_t i = 0; i < fanins.size(); ++i)
+		{
+			result = create_xor(result, fanins[i]);
+		}
+	}
+	else if (PRIMITIVE_NOT == type || PRIMITIVE_BUF == type)
+	{
+		result = fanins.empty() ? false_literal : fanins[0];
+	}
+	else if (fanins.empty())
+	{
+		result = is_or ? false_literal : true_literal;
+	}
+	else
+	{
+		// Wide gates become balanced trees of AND nodes, OR through De Morgan.
+		for (size_t i = 0; is_or && i < fanins.size(); ++i)
+		{
+			fanins[i] = negate(fanins[i]);
+		}
+		size_t count = fanins.size();
+		while (count > 1)
+		{
+			size_t next = 0;
+			for (size_t i = 0; i + 1 < count; i += 2)
+			{
+				fanins[next++] = create_and(fanins[i], fanins[i + 1]);
+			}
+			if (count & 1)
+			{
+				fanins[next++] = fanins[count - 1];
+			}
+			count = next;
+		}
+		result = is_or ? negate(fanins[0]) : fanins[0];
+	}
+	return is_inverted ? negate(result) : result;
+}
+
@@ -0,0 +1,161 @@
+#ifndef AIG_HPP
+#define AIG_HPP
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "levelizer.hpp"
+
+/** \brief Class for holding an And-Inverter Graph.
+ *	Nodes are numbered as in the AIGER format: variable 0 is the constant false, the inputs come next,
+ *	then the AND nodes in topological order. A literal is twice the variable plus the complement bit.
+ *	The two fanin literals of all AND nodes are kept in one contiguous array, and a structural hashing
+ *	table merges identical AND nodes when they are created.
+ */
+class Aig
+{
+public:
+
+	/// Type of the literals.
+	typedef boost::uint32_t Literal;
+
+	/// The constant false literal.
+	static const Literal false_literal;
+
+	/// The constant true literal.
+	static const Literal true_literal;
+
+	/// Literal used for nets that are not converted.
+	static const Literal invalid_literal;
+
+	/// \brief Constructor of an empty graph.
+	Aig();
+
+	/** \brief Constructor converting the built-in primitives of a levelized netlist.
+	 *	Input nets and outputs of undefined module instances become inputs, the top output ports become outputs.
+	 *	Nets tied to literal constants become the constant literals, undriven nets are false.
+	 *	Throws if the netlist has combinational loops.
+	 *	\param[in] levelizer - The Levelizer, levelize must already be called.
+	 */
+	Aig(const Levelizer& levelizer);
+
+	/** \brief Creates a new input. Inputs must be created before the AND nodes.
+	 *	\param[in] name - Name of the input for the symbol table, may be empty.
+	 *	\ret The literal of the input.
+	 */
+	Literal create_input(const std::string& name = "");
+
+	/** \brief Returns the AND of two literals, the node is only created if no identical node exists.
+	 *	\param[in] first - The first fanin.
+	 *	\param[in] second - The second fanin.
+	 */
+	Literal create_and(Literal first, Literal second);
+
+	/** \brief Returns the OR of two literals.
+	 *	\param[in] first - The first fanin.
+	 *	\param[in] second - The second fanin.
+	 */
+	Literal create_or(Literal first, Literal second);
+
+	/** \brief Returns the XOR of two literals, built from three AND nodes.
+	 *	\param[in] first - The first fanin.
+	 *	\param[in] second - The second fanin.
+	 */
+	Literal create_xor(Literal first, Literal second);
+
+	/** \brief Adds an output.
+	 *	\param[in] literal - Literal driving the output.
+	 *	\param[in] name - Name of the output for the symbol table, may be empty.
+	 */
+	void create_output(Literal literal, const std::string& name = "");
+
+	/// \brief Returns the complement of a literal.
+	static Literal negate(Literal literal);
+
+	/// \brief Returns the variable of a literal.
+	static Literal get_variable(Literal literal);
+
+	/// \brief Returns true if the literal is complemented.
+	static bool is_complemented(Literal literal);
+
+	/// \brief Returns the number of inputs.
+	size_t get_input_count() const;
+
+	/// \brief Returns the number of AND nodes.
+	size_t get_and_count() const;
+
+	/// \brief Returns the largest variable index.
+	size_t get_max_variable() const;
+
+	/** \brief Returns the fanin literals of the AND nodes, the fanins of node i are at 2 * i and 2 * i + 1.
+	 *	The variable of node i is get_input_count() + 1 + i.
+	 */
+	const std::vector<Literal>& get_and_fanins() const;
+
+	/// \brief Returns the output literals.
+	const std::vector<Literal>& get_outputs() const;
+
+	/// \brief Returns the literals of the Flat Netlist nets, invalid_literal for nets without a function.
+	const std::vector<Literal>& get_net_literals() const;
+
+	/** \brief Simulates 64 patterns.
+	 *	\param[in] input_values - One word of patterns per input.
+	 *	\param[out] output_values - One word of patterns per output.
+	 */
+	void evaluate(const std::vector<boost::uint64_t>& input_values, std::vector<boost::uint64_t>& output_values) const;
+
+	/** \brief Writes the graph in the binary AIGER format, with the symbol table of the named inputs and outputs.
+	 *	\param[in] stream - Stream to write to, must be opened in binary mode.
+	 */
+	void write_aiger(std::ostream& stream) const;
+
+	/** \brief Writes the graph to a binary AIGER file. Throws if the file cannot be written.
+	 *	\param[in] file_name - Name of the file.
+	 */
+	void write_aiger(const std::string& file_name) const;
+
+private:
+
+	/** \brief Returns the slot of the structural hashing table holding the AND node of the fanins, or the empty slot where it belongs.
+	 *	\param[in] first - The larger fanin.
+	 *	\param[in] second - The smaller fanin.
+	 */
+	size_t find_slot(Literal first, Literal second) const;
+
+	/// \brief Doubles the structural hashing table.
+	void grow_table();
+
+	/** \brief Converts a gate of the netlist, the fanins must already be converted.
+	 *	\param[in] type - Primitive type of the gate.
+	 *	\param[in] fanins - Literals of the gate inputs, used as scratch space.
+	 */
+	Literal convert_gate(PrimitiveType type, std::vector<Literal>& fanins);
+
+private:
+
+	/// Number of inputs.
+	size_t m_input_count;
+
+	/// Fanins of the AND nodes, two per node.
+	std::vector<Literal> m_and_fanins;
+
+	/// Structural hashing table, holds AND node indices plus one, 0 for empty slots.
+	std::vector<boost::uint32_t> m_table;
+
+	/// Output literals.
+	std::vector<Literal> m_outputs;
+
+	/// Names of the inputs.
+	std::vector<std::string> m_input_names;
+
+	/// Names of the outputs.
+	std::vector<std::string> m_output_names;
+
+	/// Literals of the Flat Netlist nets.
+	std::vector<Literal> m_net_literals;
+
+};
+
+#endif // AIG_HPP
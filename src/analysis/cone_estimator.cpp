@@ -0,0 +1,252 @@
+#include "cone_estimator.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <boost/bind.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// \brief Returns a well mixed 64 bit hash of an element id.
+	boost::uint64_t hash_element(boost::uint64_t element)
+	{
+		element += 0x9e3779b97f4a7c15ull;
+		element = (element ^ (element >> 30)) * 0xbf58476d1ce4e5b9ull;
+		element = (element ^ (element >> 27)) * 0x94d049bb133111ebull;
+		return element ^ (element >> 31);
+	}
+}
+
+/** \brief Constructor with the levelized netlist.
+ *	\param[in] levelizer - The Levelizer, levelize must already be called. Must outlive the estimator.
+ *	\param[in] precision - Number of register index bits, in [4, 16]. The sketches take net count * 2^precision bytes.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Cone_estimator::Cone_estimator(const Levelizer& levelizer, unsigned precision, unsigned thread_count)
+	: m_levelizer( levelizer )
+	, m_precision( std::min(16u, std::max(4u, precision)) )
+	, m_thread_count( thread_count )
+{
+}
+
+/// \brief Estimates the cone sizes of all nets. Must be called before the getters.
+void Cone_estimator::estimate()
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<Flat_id>& outputs = netlist.get_gate_outputs();
+	const std::vector<Flat_id>& levelized = m_levelizer.get_levelized_gates();
+	const std::vector<Flat_id>& level_offsets = m_levelizer.get_level_offsets();
+	size_t net_count = netlist.get_net_count();
+	size_t sketch_size = get_sketch_size();
+
+	// Forward pass: fan-in gates and reaching inputs.
+	m_cone_sketches.assign(net_count * sketch_size, 0);
+	m_input_sketches.assign(net_count * sketch_size, 0);
+	const std::vector<Flat_id>& input_nets = netlist.get_input_nets();
+	std::vector<Flat_id>::const_iterator I;
+	for (I = input_nets.begin(); I != input_nets.end(); ++I)
+	{
+		add(&m_input_sketches[*I * sketch_size], *I);
+	}
+	for (unsigned level = 0; level < m_levelizer.get_level_count(); ++level)
+	{
+		Parallel::for_range(level_offsets[level + 1] - level_offsets[level],
+			boost::bind(&Cone_estimator::propagate_forward, this, level, _1, _2), m_thread_count, 256);
+	}
+	m_fanin_cone_sizes.resize(net_count);
+	m_input_counts.resize(net_count);
+	Parallel::for_range(net_count, boost::bind(&Cone_estimator::compute_estimates, this, &m_cone_sketches, &m_fanin_cone_sizes, _1, _2), m_thread_count);
+	Parallel::for_range(net_count, boost::bind(&Cone_estimator::compute_estimates, this, &m_input_sketches, &m_input_counts, _1, _2), m_thread_count);
+	std::vector<boost::uint8_t>().swap(m_input_sketches);
+
+	// Backward pass: fan-out gates, the nets by the level of their drivers from the top, the input nets last.
+	std::fill(m_cone_sketches.begin(), m_cone_sketches.end(), 0);
+	std::vector<Flat_id> nets;
+	for (unsigned level = m_levelizer.get_level_count(); level > 0; --level)
+	{
+		nets.clear();
+		for (Flat_id i = level_offsets[level - 1]; i < level_offsets[level]; ++i)
+		{
+			if (Flat_netlist::invalid_id != outputs[levelized[i]])
+			{
+				nets.push_back(outputs[levelized[i]]);
+			}
+		}
+		Parallel::for_range(nets.size(), boost::bind(&Cone_estimator::propagate_backward, this, &nets, _1, _2), m_thread_count, 256);
+	}
+	Parallel::for_range(input_nets.size(), boost::bind(&Cone_estimator::propagate_backward, this, &input_nets, _1, _2), m_thread_count, 256);
+	m_fanout_cone_sizes.resize(net_count);
+	Parallel::for_range(net_count, boost::bind(&Cone_estimator::compute_estimates, this, &m_cone_sketches, &m_fanout_cone_sizes, _1, _2), m_thread_count);
+	std::vector<boost::uint8_t>().swap(m_cone_sketches);
+}
+
+/// \brief Returns the estimated number of gates in the transitive fan-in of each net, including its driver.
+const std::vector<float>& Cone_estimator::get_fanin_cone_sizes() const
+{
+	return m_fanin_cone_sizes;
+}
+
+/// \brief Returns the estimated number of gates in the transitive fan-out of each net.
+const std::vector<float>& Cone_estimator::get_fanout_cone_sizes() const
+{
+	return m_fanout_cone_sizes;
+}
+
+/// \brief Returns the estimated number of input nets reaching each net, an input net reaches itself.
+const std::vector<float>& Cone_estimator::get_input_counts() const
+{
+	return m_input_counts;
+}
+
+/// \brief Returns the number of bytes of one sketch.
+size_t Cone_estimator::get_sketch_size() const
+{
+	return size_t(1) << m_precision;
+}
+
+/** \brief Merges the fan-in and input sketches of a chunk of gates of one level into their outputs.
+ *	\param[in] level - The level.
+ *	\param[in] begin - First gate of the chunk in the level.
+ *	\param[in] end - Gate after the last one of the chunk.
+ */
+void Cone_estimator::propagate_forward(unsigned level, size_t begin, size_t end)
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<Flat_id>& outputs = netlist.get_gate_outputs();
+	const std::vector<Flat_id>& input_offsets = netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = netlist.get_gate_inputs();
+	const std::vector<Flat_id>& levelized = m_levelizer.get_levelized_gates();
+	Flat_id first = m_levelizer.get_level_offsets()[level];
+	size_t sketch_size = get_sketch_size();
+
+	for (size_t i = first + begin; i < first + end; ++i)
+	{
+		Flat_id gate = levelized[i];
+		Flat_id output = outputs[gate];
+		if (Flat_netlist::invalid_id == output)
+		{
+			continue;
+		}
+		boost::uint8_t* cone = &m_cone_sketches[output * sketch_size];
+		boost::uint8_t* reached = &m_input_sketches[output * sketch_size];
+		add(cone, gate);
+		for (Flat_id j = input_offsets[gate]; j < input_offsets[gate + 1]; ++j)
+		{
+			if (is_followed(inputs[j], gate))
+			{
+				merge(cone, &m_cone_sketches[inputs[j] * sketch_size]);
+				merge(reached, &m_input_sketches[inputs[j] * sketch_size]);
+			}
+		}
+	}
+}
+
+/** \brief Merges the fan-out sketches of the fanout gates into a chunk of nets.
+ *	Nets are processed by the level of their drivers from the top, so the nets read are already complete.
+ *	\param[in] nets - The nets driven from one level, or the input nets.
+ *	\param[in] begin - First net of the chunk.
+ *	\param[in] end - Net after the last one of the chunk.
+ */
+void Cone_estimator::propagate_backward(const std::vector<Flat_id>* nets, size_t begin, size_t end)
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<Flat_id>& outputs = netlist.get_gate_outputs();
+	const std::vector<Flat_id>& fanout_offsets = netlist.get_net_fanout_offsets();
+	const std::vector<Flat_id>& fanouts = netlist.get_net_fanouts();
+	size_t sketch_size = get_sketch_size();
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		Flat_id net = (*nets)[i];
+		boost::uint8_t* cone = &m_cone_sketches[net * sketch_size];
+		for (Flat_id j = fanout_offsets[net]; j < fanout_offsets[net + 1]; ++j)
+		{
+			Flat_id gate = fanouts[j];
+			if (!is_followed(net, gate))
+			{
+				continue;
+			}
+			add(cone, gate);
+			if (Flat_netlist::invalid_id != outputs[gate])
+			{
+				merge(cone, &m_cone_sketches[outputs[gate] * sketch_size]);
+			}
+		}
+	}
+}
+
+/** \brief Computes the estimates of a chunk of nets from a sketch array.
+ *	\param[in] sketches - The sketches of all nets.
+ *	\param[out] estimates - The estimates of all nets.
+ *	\param[in] begin - First net of the chunk.
+ *	\param[in] end - Net after the last one of the chunk.
+ */
+void Cone_estimator::compute_estimates(const std::vector<boost::uint8_t>* sketches, std::vector<float>* estimates, size_t begin, size_t end) const
+{
+	size_t sketch_size = get_sketch_size();
+	double registers = double(sketch_size);
+	double alpha = 0.7213 / (1 + 1.079 / registers);
+	double powers[66];
+	for (int rank = 0; rank < 66; ++rank)
+	{
+		powers[rank] = std::ldexp(1.0, -rank);
+	}
+	for (size_t net = begin; net < end; ++net)
+	{
+		const boost::uint8_t* sketch = &(*sketches)[net * sketch_size];
+		double sum = 0;
+		size_t zeros = 0;
+		for (size_t i = 0; i < sketch_size; ++i)
+		{
+			sum += powers[sketch[i]];
+			zeros += (0 == sketch[i]);
+		}
+		double estimate = alpha * registers * registers / sum;
+
+		// Linear counting is more precise for small cones.
+		if (estimate <= 2.5 * registers && 0 != zeros)
+		{
+			estimate = registers * std::log(registers / zeros);
+		}
+		(*estimates)[net] = static_cast<float>(estimate);
+	}
+}
+
+/** \brief Adds an element to a sketch.
+ *	\param[in,out] sketch - The sketch.
+ *	\param[in] element - Id of the element.
+ */
+void Cone_estimator::add(boost::uint8_t* sketch, boost::uint64_t element) const
+{
+	boost::uint64_t hash = hash_element(element);
+	size_t index = static_cast<size_t>(hash >> (64 - m_precision));
+	boost::uint64_t rest = hash << m_precision;
+	boost::uint8_t rank = static_cast<boost::uint8_t>((0 == rest) ? 65 - m_precision : __builtin_clzll(rest) + 1);
+	sketch[index] = std::max(sketch[index], rank);
+}
+
+/** \brief Merges a sketch into another.
+ *	\param[in,out] sketch - The merged sketch.
+ *	\param[in] other - The sketch to merge.
+ */
+void Cone_estimator::merge(boost::uint8_t* sketch, const boost::uint8_t* other) const
+{
+	size_t sketch_size = get_sketch_size();
+	for (size_t i = 0; i < sketch_size; ++i)
+	{
+		sketch[i] = std::max(sketch[i], other[i]);
+	}
+}
+
+/** \brief Returns true if the edge from the net to the gate is followed: the net is not driven from the level of the gate.
+ *	\param[in] net - The net.
+ *	\param[in] gate - The gate reading the net.
+ */
+bool Cone_estimator::is_followed(Flat_id net, Flat_id gate) const
+{
+	Flat_id driver = m_levelizer.get_netlist().get_net_drivers()[net];
+	const std::vector<unsigned>& levels = m_levelizer.get_gate_levels();
+	return Flat_netlist::invalid_id == driver || levels[driver] != levels[gate];
+}
+
@@ -0,0 +1,498 @@
+#include "cone_extractor.hpp"
+#include "parallel.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <sstream>
+#include <boost/bind.hpp>
+
+/// Helper types and functions.
+namespace
+{
+	/// Net flags.
+	enum
+	{
+		NET_USED = 1,
+		NET_CUT = 2,
+		NET_EXTRACTED = 4
+	};
+
+	/// Copy of a hierarchy node holding only the cone.
+	struct Node_copy
+	{
+		/// The copied Module Description, empty for nodes that are not copied.
+		boost::shared_ptr<Module_description> module;
+
+		/// Ports punched through the node by the boundary nets.
+		std::vector<std::pair<std::string, PortType> > punched_ports;
+
+		/// Pins added to the instance of the node in its parent, as (pin name, net name) pairs.
+		std::vector<std::pair<std::string, std::string> > punched_pins;
+
+		/// Net names generated in the node.
+		std::set<std::string> generated_names;
+	};
+
+	/// \brief Returns a net name not used by the module nor generated before, based on the given name.
+	std::string get_unique_name(const Module_description& module, std::set<std::string>& generated_names, const std::string& base)
+	{
+		std::string name = base;
+		for (int suffix = 1; module.get_nets().count(name) || module.get_ports().count(name) || generated_names.count(name); ++suffix)
+		{
+			std::ostringstream stream;
+			stream << base << "_" << suffix;
+			name = stream.str();
+		}
+		generated_names.insert(name);
+		return name;
+	}
+
+	/** \brief Copies an instance with its pins. For an instance of a copied module only the pins of its ports are kept,
+	 *	the punched pins replace the original ones.
+	 */
+	boost::shared_ptr<Module_instance> copy_instance(const Module_instance& instance, const std::string& description_name, const Module_description* ports, const Node_copy* punched)
+	{
+		boost::shared_ptr<Module_instance> copy(new Module_instance(instance.get_name(), description_name));
+		std::set<std::string> punched_names;
+		if (0 != punched)
+		{
+			std::vector<std::pair<std::string, std::string> >::const_iterator J;
+			for (J = punched->punched_pins.begin(); J != punched->punched_pins.end(); ++J)
+			{
+				copy->create_new_port(J->first, J->second);
+				punched_names.insert(J->first);
+			}
+		}
+		const std::vector<Instance_port>& pins = instance.get_ports();
+		for (std::vector<Instance_port>::const_iterator I = pins.begin(); I != pins.end(); ++I)
+		{
+			if ((0 != ports && !ports->get_ports().count(I->get_name())) || punched_names.count(I->get_name()))
+			{
+				continue;
+			}
+			copy->create_new_port(I->get_name(), I->get_net_name());
+		}
+		return copy;
+	}
+
+	/// \brief Adds the Module Description and all Module Descriptions below it to the Netlist, sharing them.
+	size_t share_modules(Netlist& netlist, const Netlist& source, const Module_description& module, std::set<const Module_description*>& shared)
+	{
+		size_t count = 0;
+		std::vector<const Module_description*> pending(1, &module);
+		while (!pending.empty())
+		{
+			const Module_description* description = pending.back();
+			pending.pop_back();
+			if (!shared.insert(description).second)
+			{
+				continue;
+			}
+			netlist.add_module(source.get_modules().find(description->get_name())->second);
+			++count;
+			const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = description->get_module_instances();
+			for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+			{
+				if (I->second->has_description())
+				{
+					pending.push_back(&I->second->get_module_description());
+				}
+			}
+		}
+		return count;
+	}
+
+	/// \brief Connects the nets of a chunk of copied modules.
+	void connect_modules(std::vector<Module_description*>* modules, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			(*modules)[i]->connect_nets();
+		}
+	}
+}
+
+/** \brief Constructor with the Flat Netlist and the Netlist it was built from.
+ *	\param[in] flat - The Flat Netlist. Must outlive the extractor.
+ *	\param[in] netlist - The source Netlist, holding the master Module Descriptions. Must outlive the extractor.
+ *	\param[in] thread_count - Number of threads used to connect the copied modules, 0 for the hardware thread count.
+ */
+Cone_extractor::Cone_extractor(const Flat_netlist& flat, const Netlist& netlist, unsigned thread_count)
+	: m_flat( flat )
+	, m_netlist( netlist )
+	, m_thread_count( thread_count )
+	, m_copied_module_count( 0 )
+	, m_shared_module_count( 0 )
+{
+}
+
+/** \brief Extracts the fan-in cone of the nets into a new Netlist. The copied modules are connected.
+ *	\param[in] nets - Flat nets whose cone is extracted.
+ *	\param[in] name - Name of the new Netlist.
+ *	\param[in] max_depth - Maximal number of gates on a path from a cut net to an extracted net, 0 for the complete cone.
+ *	\ret The new Netlist.
+ */
+boost::shared_ptr<Netlist> Cone_extractor::extract(const std::vector<Flat_id>& nets, const std::string& name, unsigned max_depth)
+{
+	collect_cone(nets, max_depth);
+
+	// Count the cone gates and all gates below every node, children have higher ids than their parents.
+	// The gate counts do not depend on the cone, they are counted once.
+	size_t node_count = m_flat.get_hierarchy_count();
+	if (m_gate_counts.size() != node_count)
+	{
+		m_gate_counts.assign(node_count, 0);
+		for (size_t gate = 0; gate < m_flat.get_gate_count(); ++gate)
+		{
+			++m_gate_counts[m_flat.get_gate_hierarchy(gate)];
+		}
+		for (size_t node = node_count - 1; node > 0; --node)
+		{
+			m_gate_counts[m_flat.get_hierarchy_parent(node)] += m_gate_counts[node];
+		}
+	}
+	const std::vector<size_t>& gate_counts = m_gate_counts;
+	std::vector<size_t> cone_counts(node_count, 0);
+	std::vector<std::vector<Flat_id> > node_gates(node_count);
+	for (std::vector<Flat_id>::const_iterator I = m_cone_gates.begin(); I != m_cone_gates.end(); ++I)
+	{
+		++cone_counts[m_flat.get_gate_hierarchy(*I)];
+		node_gates[m_flat.get_gate_hierarchy(*I)].push_back(*I);
+	}
+	for (size_t node = node_count - 1; node > 0; --node)
+	{
+		cone_counts[m_flat.get_hierarchy_parent(node)] += cone_counts[node];
+	}
+
+	// Punch the boundary nets from the node they appear in up to the top, in net order so the names do not depend on the walk.
+	std::vector<Flat_id> boundary_nets;
+	for (std::vector<Flat_id>::const_iterator I = m_used_nets.begin(); I != m_used_nets.end(); ++I)
+	{
+		if (0 != (m_net_flags[*I] & (NET_CUT | NET_EXTRACTED)))
+		{
+			boundary_nets.push_back(*I);
+		}
+	}
+	std::sort(boundary_nets.begin(), boundary_nets.end());
+	std::vector<Node_copy> copies(node_count);
+	std::vector<bool> is_copied(node_count, false);
+	is_copied[0] = true;
+	for (std::vector<Flat_id>::const_iterator I = boundary_nets.begin(); I != boundary_nets.end(); ++I)
+	{
+		Flat_id net = *I;
+		PortType type = (m_net_flags[net] & NET_CUT) ? IN : OUT;
+		std::string net_name = m_flat.get_net_local_name(net);
+		Flat_id node = m_flat.get_net_hierarchy(net);
+		while (0 != node)
+		{
+			is_copied[node] = true;
+			copies[node].punched_ports.push_back(std::make_pair(net_name, type));
+			Flat_id parent = m_flat.get_hierarchy_parent(node);
+			std::string parent_name = get_unique_name(m_flat.get_hierarchy_description(parent), copies[parent].generated_names,
+				m_flat.get_hierarchy_instance(node)->get_name() + "_" + net_name);
+			copies[node].punched_pins.push_back(std::make_pair(net_name, parent_name));
+			net_name = parent_name;
+			node = parent;
+		}
+
+		// Extracted top ports keep their type.
+		if (IN == type || !m_flat.get_top_module().get_ports().count(net_name))
+		{
+			copies[0].punched_ports.push_back(std::make_pair(net_name, type));
+		}
+	}
+
+	// Nodes partly in the cone are copied, and so are the parents of copied nodes. Nodes without gates are kept if they connect used nets.
+	std::vector<bool> is_kept(node_count, false);
+	for (size_t node = node_count; node-- > 0;)
+	{
+		const Module_description& description = m_flat.get_hierarchy_description(node);
+		if (0 == gate_counts[node])
+		{
+			const std::map<std::string, boost::shared_ptr<Module_port> >& ports = description.get_ports();
+			for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I = ports.begin(); I != ports.end() && !is_kept[node]; ++I)
+			{
+				Flat_id net = m_flat.get_local_net(node, description.get_canonical_net_name(I->first));
+				is_kept[node] = (Flat_netlist::invalid_id != net && (m_net_flags[net] & NET_USED));
+			}
+		}
+		is_copied[node] = is_copied[node] || (0 != cone_counts[node] && cone_counts[node] != gate_counts[node]);
+		is_kept[node] = is_kept[node] || is_copied[node] || 0 != cone_counts[node];
+		if (0 != node && is_copied[node])
+		{
+			is_copied[m_flat.get_hierarchy_parent(node)] = true;
+		}
+	}
+
+	// Name the copies, the top keeps its name.
+	std::map<std::string, int> copy_counts;
+	std::set<std::string> copy_names;
+	for (size_t node = 0; node < node_count; ++node)
+	{
+		if (!is_copied[node])
+		{
+			continue;
+		}
+		const std::string& master = m_flat.get_hierarchy_description(node).get_name();
+		std::string copy_name = master;
+		while (0 != node && (m_netlist.get_modules().count(copy_name) || copy_names.count(copy_name)))
+		{
+			std::ostringstream stream;
+			stream << master << "_cone" << copy_counts[master]++;
+			copy_name = stream.str();
+		}
+		copy_names.insert(copy_name);
+		copies[node].module.reset(new Module_description(copy_name));
+	}
+
+	// Children of the nodes.
+	std::vector<std::vector<Flat_id> > children(node_count);
+	for (size_t node = 1; node < node_count; ++node)
+	{
+		if (is_kept[node])
+		{
+			children[m_flat.get_hierarchy_parent(node)].push_back(static_cast<Flat_id>(node));
+		}
+	}
+
+	boost::shared_ptr<Netlist> netlist(new Netlist(name));
+	std::set<const Module_description*> shared;
+	std::vector<Module_description*> copied_modules;
+	m_shared_module_count = 0;
+	for (size_t node = node_count; node-- > 0;)
+	{
+		if (!is_copied[node])
+		{
+			continue;
+		}
+		const Module_description& description = m_flat.get_hierarchy_description(node);
+		Module_description& copy = *copies[node].module;
+		netlist->add_module(copies[node].module);
+		copied_modules.push_back(&copy);
+
+		// Ports bound to used nets, nets cut inside the node are driven from the top.
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = description.get_ports();
+		for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I = ports.begin(); I != ports.end(); ++I)
+		{
+			Flat_id net = m_flat.get_local_net(node, description.get_canonical_net_name(I->first));
+			if (Flat_netlist::invalid_id != net && (m_net_flags[net] & NET_USED))
+			{
+				copy.add_port(boost::shared_ptr<Module_port>(new Module_port(I->first, (m_net_flags[net] & NET_CUT) ? IN : I->second->get_type(), &copy)));
+			}
+		}
+		std::vector<std::pair<std::string, PortType> >::const_iterator J;
+		for (J = copies[node].punched_ports.begin(); J != copies[node].punched_ports.end(); ++J)
+		{
+			if (copy.get_ports().count(J->first))
+			{
+				copy.get_module_port_by_name(J->first)->set_type(J->second);
+			}
+			else
+			{
+				copy.add_port(boost::shared_ptr<Module_port>(new Module_port(J->first, J->second, &copy)));
+			}
+		}
+
+		// Cone gates and kept children.
+		std::set<std::string> pin_nets;
+		for (std::vector<Flat_id>::const_iterator I = node_gates[node].begin(); I != node_gates[node].end(); ++I)
+		{
+			const Module_instance& instance = m_flat.get_gate_instance(*I);
+			copy.add_module_instance(copy_instance(instance, instance.get_description_name(), 0, 0));
+		}
+		for (std::vector<Flat_id>::const_iterator I = children[node].begin(); I != children[node].end(); ++I)
+		{
+			const Module_instance& instance = *m_flat.get_hierarchy_instance(*I);
+			if (is_copied[*I])
+			{
+				Module_description& child = *copies[*I].module;
+				boost::shared_ptr<Module_instance> child_instance = copy_instance(instance, child.get_name(), &child, &copies[*I]);
+				child_instance->set_module_description(child);
+				copy.add_module_instance(child_instance);
+			}
+			else
+			{
+				boost::shared_ptr<Module_instance> child_instance = copy_instance(instance, instance.get_description_name(), 0, 0);
+				child_instance->set_module_description(instance.get_module_description());
+				copy.add_module_instance(child_instance);
+				m_shared_module_count += share_modules(*netlist, m_netlist, instance.get_module_description(), shared);
+			}
+		}
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = copy.get_module_instances();
+		for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+		{
+			I->second->set_parent_module_description(&copy);
+			const std::vector<Instance_port>& pins = I->second->get_ports();
+			for (std::vector<Instance_port>::const_iterator K = pins.begin(); K != pins.end(); ++K)
+			{
+				pin_nets.insert(K->get_net_name());
+			}
+		}
+
+		// Declared nets used by the pins stay declared, assignments are kept.
+		const std::map<std::string, boost::shared_ptr<Net> >& declared = description.get_nets();
+		for (std::set<std::string>::const_iterator I = pin_nets.begin(); I != pin_nets.end(); ++I)
+		{
+			std::map<std::string, boost::shared_ptr<Net> >::const_iterator found = declared.find(*I);
+			if (declared.end() != found && !copy.get_ports().count(*I) && !found->second->is_constant())
+			{
+				boost::shared_ptr<Net> net(new Net(*I));
+				net->set_implicit(found->second->is_implicit());
+				copy.add_net(net);
+			}
+		}
+		const std::vector< std::pair<std::string, std::string> >& assigns = description.get_assigns();
+		for (std::vector< std::pair<std::string, std::string> >::const_iterator I = assigns.begin(); I != assigns.end(); ++I)
+		{
+			copy.add_assign(I->first, I->second);
+		}
+	}
+	m_copied_module_count = copied_modules.size();
+
+	Parallel::for_range(copied_modules.size(), boost::bind(&connect_modules, &copied_modules, _1, _2), m_thread_count, 64);
+	return netlist;
+}
+
+/** \brief Returns the flat nets with the given hierarchical names. Throws if a name is not found.
+ *	\param[in] names - Hierarchical net names, instance names separated by '/'.
+ */
+std::vector<Flat_id> Cone_extractor::find_nets(const std::vector<std::string>& names) const
+{
+	std::vector<Flat_id> nets;
+	for (std::vector<std::string>::const_iterator I = names.begin(); I != names.end(); ++I)
+	{
+		// Walk down the hierarchy by instance names, then look the net up in the node.
+		Flat_id node = 0;
+		size_t begin = 0;
+		for (size_t separator = I->find('/'); std::string::npos != separator && Flat_netlist::invalid_id != node; separator = I->find('/', begin))
+		{
+			std::string instance = I->substr(begin, separator - begin);
+			Flat_id child = Flat_netlist::invalid_id;
+			for (size_t candidate = node + 1; candidate < m_flat.get_hierarchy_count() && Flat_netlist::invalid_id == child; ++candidate)
+			{
+				if (node == m_flat.get_hierarchy_parent(candidate) && instance == m_flat.get_hierarchy_instance(candidate)->get_name())
+				{
+					child = static_cast<Flat_id>(candidate);
+				}
+			}
+			node = child;
+			begin = separator + 1;
+		}
+		Flat_id net = (Flat_netlist::invalid_id == node) ? node : m_flat.get_local_net(node, m_flat.get_hierarchy_description(node).get_canonical_net_name(I->substr(begin)));
+		if (Flat_netlist::invalid_id == net)
+		{
+			throw std::string("Unable to find the net: " + *I);
+		}
+		nets.push_back(net);
+	}
+	return nets;
+}
+
+/// \brief Returns the gates of the last extracted cone, in increasing order.
+const std::vector<Flat_id>& Cone_extractor::get_cone_gates() const
+{
+	return m_cone_gates;
+}
+
+/// \brief Returns the number of Module Descriptions copied by the last extraction, including the top.
+size_t Cone_extractor::get_copied_module_count() const
+{
+	return m_copied_module_count;
+}
+
+/// \brief Returns the number of master Module Descriptions shared by the last extraction.
+size_t Cone_extractor::get_shared_module_count() const
+{
+	return m_shared_module_count;
+}
+
+/** \brief Collects the cone gates and marks the used, cut and extracted nets.
+ *	\param[in] nets - Flat nets whose cone is extracted.
+ *	\param[in] max_depth - Maximal depth, 0 for the complete cone.
+ */
+void Cone_extractor::collect_cone(const std::vector<Flat_id>& nets, unsigned max_depth)
+{
+	const std::vector<Flat_id>& drivers = m_flat.get_net_drivers();
+	const std::vector<Flat_id>& outputs = m_flat.get_gate_outputs();
+	const std::vector<Flat_id>& input_offsets = m_flat.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = m_flat.get_gate_inputs();
+
+	// The marks of the previous cone are cleared through its lists, the arrays are only filled once.
+	if (m_net_flags.size() != m_flat.get_net_count() || m_gate_depths.size() != m_flat.get_gate_count())
+	{
+		m_net_flags.assign(m_flat.get_net_count(), 0);
+		m_gate_depths.assign(m_flat.get_gate_count(), 0);
+		m_used_nets.clear();
+		m_cone_gates.clear();
+	}
+	for (std::vector<Flat_id>::const_iterator I = m_used_nets.begin(); I != m_used_nets.end(); ++I)
+	{
+		m_net_flags[*I] = 0;
+	}
+	for (std::vector<Flat_id>::const_iterator I = m_cone_gates.begin(); I != m_cone_gates.end(); ++I)
+	{
+		m_gate_depths[*I] = 0;
+	}
+	m_used_nets.clear();
+	m_cone_gates.clear();
+
+	// Breadth-first from the extracted nets, so every gate is reached at its smallest depth.
+	std::vector<unsigned>& depths = m_gate_depths;
+	std::deque<Flat_id> pending;
+	for (std::vector<Flat_id>::const_iterator I = nets.begin(); I != nets.end(); ++I)
+	{
+		mark_net(*I, NET_USED | NET_EXTRACTED);
+		Flat_id driver = drivers[*I];
+		if (Flat_netlist::invalid_id != driver && 0 == depths[driver])
+		{
+			depths[driver] = 1;
+			m_cone_gates.push_back(driver);
+			pending.push_back(driver);
+		}
+	}
+	while (!pending.empty())
+	{
+		Flat_id gate = pending.front();
+		pending.pop_front();
+		mark_net(outputs[gate], NET_USED);
+		for (Flat_id i = input_offsets[gate]; i < input_offsets[gate + 1]; ++i)
+		{
+			Flat_id net = inputs[i];
+			mark_net(net, NET_USED);
+			Flat_id driver = drivers[net];
+			if (Flat_netlist::invalid_id == driver || 0 != depths[driver])
+			{
+				continue;
+			}
+			if (0 != max_depth && depths[gate] == max_depth)
+			{
+				mark_net(net, NET_CUT);
+				continue;
+			}
+			depths[driver] = depths[gate] + 1;
+			m_cone_gates.push_back(driver);
+			pending.push_back(driver);
+		}
+	}
+	std::sort(m_cone_gates.begin(), m_cone_gates.end());
+}
+
+/** \brief Adds flags to a net, records the net the first time it is flagged.
+ *	\param[in] net - The net.
+ *	\param[in] flags - The flags.
+ */
+void Cone_extractor::mark_net(Flat_id net, unsigned char flags)
+{
+	if (0 == m_net_flags[net])
+	{
+		m_used_nets.push_back(net);
+	}
+	m_net_flags[net] |= flags;
+}
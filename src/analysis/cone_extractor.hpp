@@ -0,0 +1,103 @@
+#ifndef CONE_EXTRACTOR_HPP
+#define CONE_EXTRACTOR_HPP
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "flat_netlist.hpp"
+
+class Netlist;
+
+/** \brief Class for extracting the fan-in cone of a set of nets into a standalone Netlist.
+ *	The cone is collected on the Flat Netlist with a breadth-first walk from the drivers of the nets. Hierarchy nodes
+ *	whose gates are all in the cone keep their master Module Description, shared with the source Netlist and not copied.
+ *	The other nodes on the way to the top get a copy of their module holding only the cone, named after the master with a
+ *	"_cone<n>" suffix; the copy of the top keeps the top name. Boundary ports are created automatically: the extracted
+ *	nets become outputs of the top, nets cut by a depth limit become inputs of the top, punched through the copied modules.
+ *	The walk only touches the cone: the net and gate marks are reset through the lists of the previous cone, and the gate
+ *	counts of the hierarchy nodes are computed by the first extraction, so an extraction costs the cone size plus the
+ *	number of hierarchy nodes.
+ */
+class Cone_extractor
+{
+public:
+
+	/** \brief Constructor with the Flat Netlist and the Netlist it was built from.
+	 *	\param[in] flat - The Flat Netlist. Must outlive the extractor.
+	 *	\param[in] netlist - The source Netlist, holding the master Module Descriptions. Must outlive the extractor.
+	 *	\param[in] thread_count - Number of threads used to connect the copied modules, 0 for the hardware thread count.
+	 */
+	Cone_extractor(const Flat_netlist& flat, const Netlist& netlist, unsigned thread_count = 0);
+
+	/** \brief Extracts the fan-in cone of the nets into a new Netlist. The copied modules are connected.
+	 *	\param[in] nets - Flat nets whose cone is extracted.
+	 *	\param[in] name - Name of the new Netlist.
+	 *	\param[in] max_depth - Maximal number of gates on a path from a cut net to an extracted net, 0 for the complete cone.
+	 *	\ret The new Netlist.
+	 */
+	boost::shared_ptr<Netlist> extract(const std::vector<Flat_id>& nets, const std::string& name, unsigned max_depth = 0);
+
+	/** \brief Returns the flat nets with the given hierarchical names. Throws if a name is not found.
+	 *	\param[in] names - Hierarchical net names, instance names separated by '/'.
+	 */
+	std::vector<Flat_id> find_nets(const std::vector<std::string>& names) const;
+
+	/// \brief Returns the gates of the last extracted cone, in increasing order.
+	const std::vector<Flat_id>& get_cone_gates() const;
+
+	/// \brief Returns the number of Module Descriptions copied by the last extraction, including the top.
+	size_t get_copied_module_count() const;
+
+	/// \brief Returns the number of master Module Descriptions shared by the last extraction.
+	size_t get_shared_module_count() const;
+
+private:
+
+	/** \brief Collects the cone gates and marks the used, cut and extracted nets.
+	 *	\param[in] nets - Flat nets whose cone is extracted.
+	 *	\param[in] max_depth - Maximal depth, 0 for the complete cone.
+	 */
+	void collect_cone(const std::vector<Flat_id>& nets, unsigned max_depth);
+
+	/** \brief Adds flags to a net, records the net the first time it is flagged.
+	 *	\param[in] net - The net.
+	 *	\param[in] flags - The flags.
+	 */
+	void mark_net(Flat_id net, unsigned char flags);
+
+private:
+
+	/// The Flat Netlist.
+	const Flat_netlist& m_flat;
+
+	/// The source Netlist.
+	const Netlist& m_netlist;
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Gates of the cone.
+	std::vector<Flat_id> m_cone_gates;
+
+	/// Flags of the nets: used by the cone, cut by the depth limit, extracted. Only the used nets are set.
+	std::vector<unsigned char> m_net_flags;
+
+	/// Nets with flags, in the order they were reached.
+	std::vector<Flat_id> m_used_nets;
+
+	/// Depths of the gates from the extracted nets, 0 outside the cone. Only the cone gates are set.
+	std::vector<unsigned> m_gate_depths;
+
+	/// Number of gates below each hierarchy node, including its own.
+	std::vector<size_t> m_gate_counts;
+
+	/// Number of copied modules.
+	size_t m_copied_module_count;
+
+	/// Number of shared modules.
+	size_t m_shared_module_count;
+
+};
+
+#endif // CONE_EXTRACTOR_HPP
@@ -0,0 +1,299 @@
+#include "constant_propagator.hpp"
+#include "parallel.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/netlist_transaction.hpp"
+
+#include <algorithm>
+#include <map>
+#include <boost/bind.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// \brief Returns the inverted value, unknown stays unknown.
+	LogicConstant invert(LogicConstant value)
+	{
+		if (CONSTANT_ZERO == value)
+		{
+			return CONSTANT_ONE;
+		}
+		return (CONSTANT_ONE == value) ? CONSTANT_ZERO : CONSTANT_NONE;
+	}
+
+	/// \brief Returns true if an output of the instance drives an input port of the module.
+	bool is_driving_input(const Module_description& module, const Module_instance& instance)
+	{
+		const std::vector<Instance_port>& pins = instance.get_ports();
+		for (std::vector<Instance_port>::const_iterator I = pins.begin(); I != pins.end(); ++I)
+		{
+			if (OUT != I->get_type())
+			{
+				continue;
+			}
+			std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator port = module.get_ports().find(I->get_net_name());
+			if (module.get_ports().end() != port && IN == port->second->get_type())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Module Description edited by the sweep, with the instances to remove.
+	struct Swept_module
+	{
+		/// The Module Description.
+		Module_description* module;
+
+		/// Names of the instances to remove and the values of their outputs.
+		std::vector<std::pair<const std::string*, LogicConstant> > instances;
+
+		/// Names of the output nets of the instances, empty for unconnected outputs.
+		std::vector<std::string> net_names;
+	};
+
+	/// Orders the swept instances by name, so the assignments do not depend on the memory layout.
+	struct Name_less
+	{
+		bool operator()(const std::pair<const std::string*, LogicConstant>& first, const std::pair<const std::string*, LogicConstant>& second) const
+		{
+			return *first.first < *second.first;
+		}
+	};
+
+	/// \brief Finds the output nets of the swept instances of a chunk of modules, without editing the modules.
+	void find_swept_nets(std::vector<Swept_module>* modules, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Module_description& module = *(*modules)[i].module;
+			std::vector<std::pair<const std::string*, LogicConstant> >& instances = (*modules)[i].instances;
+			std::vector<std::string>& net_names = (*modules)[i].net_names;
+			std::sort(instances.begin(), instances.end(), Name_less());
+			net_names.resize(instances.size());
+			for (size_t j = 0; j < instances.size(); ++j)
+			{
+				const std::vector<Instance_port>& pins = module.get_module_instances().find(*instances[j].first)->second->get_ports();
+				for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end(); ++J)
+				{
+					if (OUT == J->get_type())
+					{
+						net_names[j] = J->get_net_name();
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+
+/** \brief Constructor with the levelized netlist.
+ *	\param[in] levelizer - The Levelizer, levelize must already be called. Must outlive the propagator.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Constant_propagator::Constant_propagator(const Levelizer& levelizer, unsigned thread_count)
+	: m_levelizer( levelizer )
+	, m_thread_count( thread_count )
+	, m_constant_net_count( 0 )
+{
+}
+
+/// \brief Computes the values of all nets. Must be called before the getters.
+void Constant_propagator::propagate()
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	m_net_values = netlist.get_net_constants();
+	for (unsigned level = 0; level < m_levelizer.get_level_count(); ++level)
+	{
+		const std::vector<Flat_id>& level_offsets = m_levelizer.get_level_offsets();
+		Parallel::for_range(level_offsets[level + 1] - level_offsets[level],
+			boost::bind(&Constant_propagator::propagate_level, this, level, _1, _2), m_thread_count, 256);
+	}
+
+	m_constant_net_count = m_net_values.size() - std::count(m_net_values.begin(), m_net_values.end(), CONSTANT_NONE);
+	m_constant_gates.clear();
+	const std::vector<Flat_id>& outputs = netlist.get_gate_outputs();
+	for (size_t gate = 0; gate < outputs.size(); ++gate)
+	{
+		if (Flat_netlist::invalid_id != outputs[gate] && CONSTANT_NONE != m_net_values[outputs[gate]])
+		{
+			m_constant_gates.push_back(static_cast<Flat_id>(gate));
+		}
+	}
+}
+
+/// \brief Returns the constant values of the nets, CONSTANT_NONE for the nets that are not constant.
+const std::vector<LogicConstant>& Constant_propagator::get_net_values() const
+{
+	return m_net_values;
+}
+
+/// \brief Returns the gates driving a constant net, in increasing order.
+const std::vector<Flat_id>& Constant_propagator::get_constant_gates() const
+{
+	return m_constant_gates;
+}
+
+/// \brief Returns the number of nets with a constant value, including the literal constants.
+size_t Constant_propagator::get_constant_net_count() const
+{
+	return m_constant_net_count;
+}
+
+/** \brief Removes the primitive instances whose output is the same constant in every place they appear below the top module
+ *	and ties their output nets to the literal constant with an assignment. Instances driving input ports are kept.
+ *	The instances are looked up in parallel and removed in one transaction of the Netlist, whose commit reconnects the edited
+ *	modules. Logic feeding only removed instances is left floating.
+ *	The modules are specialized for the top module, the Flat Netlist and the Levelizer must not be used afterwards.
+ *	\param[in,out] netlist - The Netlist the Flat Netlist was built from.
+ *	\ret The number of removed instances.
+ */
+size_t Constant_propagator::sweep(Netlist& netlist) const
+{
+	const Flat_netlist& flat = m_levelizer.get_netlist();
+	const std::vector<PrimitiveType>& types = flat.get_gate_types();
+	const std::vector<Flat_id>& outputs = flat.get_gate_outputs();
+
+	// Every place of an instance must agree on the value, instances with an unknown value in any place are kept.
+	std::map<const Module_instance*, std::pair<LogicConstant, const Module_description*> > values;
+	for (size_t gate = 0; gate < types.size(); ++gate)
+	{
+		if (PRIMITIVE_NONE == types[gate] || Flat_netlist::invalid_id == outputs[gate])
+		{
+			continue;
+		}
+		LogicConstant value = m_net_values[outputs[gate]];
+		const Module_description* module = &flat.get_hierarchy_description(flat.get_gate_hierarchy(gate));
+		std::pair<std::map<const Module_instance*, std::pair<LogicConstant, const Module_description*> >::iterator, bool> inserted =
+			values.insert(std::make_pair(&flat.get_gate_instance(gate), std::make_pair(value, module)));
+		if (!inserted.second && inserted.first->second.first != value)
+		{
+			inserted.first->second.first = CONSTANT_NONE;
+		}
+	}
+
+	std::map<const Module_description*, size_t> module_indices;
+	std::vector<Swept_module> modules;
+	size_t removed_count = 0;
+	std::map<const Module_instance*, std::pair<LogicConstant, const Module_description*> >::const_iterator I;
+	for (I = values.begin(); I != values.end(); ++I)
+	{
+		const Module_description& module = *I->second.second;
+		if (CONSTANT_NONE == I->second.first || is_driving_input(module, *I->first))
+		{
+			continue;
+		}
+		std::pair<std::map<const Module_description*, size_t>::iterator, bool> inserted = module_indices.insert(std::make_pair(&module, modules.size()));
+		if (inserted.second)
+		{
+			modules.push_back(Swept_module());
+			modules.back().module = netlist.get_module(module.get_name()).get();
+		}
+		modules[inserted.first->second].instances.push_back(std::make_pair(&I->first->get_name(), I->second.first));
+		++removed_count;
+	}
+
+	// Edits are recorded and notified by the Netlist, which has a single writer: only the lookups run in parallel,
+	// the edits are applied in one transaction whose commit reconnects the edited modules.
+	Parallel::for_range(modules.size(), boost::bind(&find_swept_nets, &modules, _1, _2), m_thread_count, 1);
+	Netlist_transaction transaction(netlist);
+	for (std::vector<Swept_module>::const_iterator M = modules.begin(); M != modules.end(); ++M)
+	{
+		for (size_t j = 0; j < M->instances.size(); ++j)
+		{
+			// Copy the name, it is owned by the removed instance.
+			std::string instance_name = *M->instances[j].first;
+			M->module->remove_module_instance(instance_name);
+			const std::string& net_name = M->net_names[j];
+			if (!net_name.empty() && CONSTANT_NONE == Net::parse_constant(net_name))
+			{
+				M->module->add_assign(net_name, Net::get_constant_name(M->instances[j].second));
+			}
+		}
+	}
+	transaction.commit();
+	return removed_count;
+}
+
+/** \brief Evaluates a chunk of gates of one level.
+ *	\param[in] level - The level.
+ *	\param[in] begin - First gate of the chunk in the level.
+ *	\param[in] end - Gate after the last one of the chunk.
+ */
+void Constant_propagator::propagate_level(unsigned level, size_t begin, size_t end)
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<Flat_id>& outputs = netlist.get_gate_outputs();
+	const std::vector<Flat_id>& drivers = netlist.get_net_drivers();
+	const std::vector<Flat_id>& levelized = m_levelizer.get_levelized_gates();
+	Flat_id first = m_levelizer.get_level_offsets()[level];
+
+	for (size_t i = first + begin; i < first + end; ++i)
+	{
+		// Only the driver of a net writes it, literal constants keep their value.
+		Flat_id gate = levelized[i];
+		Flat_id output = outputs[gate];
+		if (Flat_netlist::invalid_id != output && gate == drivers[output] && CONSTANT_NONE == m_net_values[output])
+		{
+			m_net_values[output] = evaluate(gate);
+		}
+	}
+}
+
+/** \brief Returns the value of the gate output from its input values.
+ *	\param[in] gate - The gate.
+ */
+LogicConstant Constant_propagator::evaluate(Flat_id gate) const
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<Flat_id>& input_offsets = netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = netlist.get_gate_inputs();
+	const std::vector<Flat_id>& drivers = netlist.get_net_drivers();
+	const std::vector<unsigned>& levels = m_levelizer.get_gate_levels();
+
+	PrimitiveType type = netlist.get_gate_types()[gate];
+	if (PRIMITIVE_NONE == type || input_offsets[gate] == input_offsets[gate + 1])
+	{
+		return CONSTANT_NONE;
+	}
+
+	// Nets driven from the level of the gate are inside its loop and count as unknown.
+	size_t zero_count = 0;
+	size_t one_count = 0;
+	size_t unknown_count = 0;
+	for (Flat_id j = input_offsets[gate]; j < input_offsets[gate + 1]; ++j)
+	{
+		Flat_id driver = drivers[inputs[j]];
+		LogicConstant value = (Flat_netlist::invalid_id != driver && levels[driver] == levels[gate]) ? CONSTANT_NONE : m_net_values[inputs[j]];
+		zero_count += (CONSTANT_ZERO == value);
+		one_count += (CONSTANT_ONE == value);
+		unknown_count += (CONSTANT_NONE == value);
+	}
+
+	LogicConstant value = CONSTANT_NONE;
+	switch (type)
+	{
+	case PRIMITIVE_AND:
+	case PRIMITIVE_NAND:
+		value = (0 != zero_count) ? CONSTANT_ZERO : ((0 == unknown_count) ? CONSTANT_ONE : CONSTANT_NONE);
+		return (PRIMITIVE_NAND == type) ? invert(value) : value;
+	case PRIMITIVE_OR:
+	case PRIMITIVE_NOR:
+		value = (0 != one_count) ? CONSTANT_ONE : ((0 == unknown_count) ? CONSTANT_ZERO : CONSTANT_NONE);
+		return (PRIMITIVE_NOR == type) ? invert(value) : value;
+	case PRIMITIVE_XOR:
+	case PRIMITIVE_XNOR:
+		value = (0 != unknown_count) ? CONSTANT_NONE : ((one_count % 2) ? CONSTANT_ONE : CONSTANT_ZERO);
+		return (PRIMITIVE_XNOR == type) ? invert(value) : value;
+	case PRIMITIVE_NOT:
+		return (0 != unknown_count) ? CONSTANT_NONE : invert(m_net_values[inputs[input_offsets[gate]]]);
+	case PRIMITIVE_BUF:
+		return (0 != unknown_count) ? CONSTANT_NONE : m_net_values[inputs[input_offsets[gate]]];
+	default:
+		return CONSTANT_NONE;
+	}
+}
@@ -0,0 +1,296 @@
+#include "depth_analyzer.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <boost/bind.hpp>
+
+/// Helper types.
+namespace
+{
+	/// Marks missing parents of the path search.
+	const size_t no_parent = ~size_t(0);
+
+	/// Partial path of the backward search, from a net to an endpoint.
+	struct Path_entry
+	{
+		/// Depth of the net plus the delay to the endpoint, the largest depth of any full path through this entry.
+		unsigned bound;
+
+		/// Delay from the net to the endpoint.
+		unsigned suffix;
+
+		/// The net.
+		Flat_id net;
+
+		/// Entry of the next net towards the endpoint.
+		size_t parent;
+
+		/// Gate from the net to the parent net, invalid_id for the endpoint.
+		Flat_id gate;
+
+		/// True if the path is complete, i.e. the net is a start net.
+		bool is_complete;
+	};
+}
+
+/** \brief Constructor with the levelized netlist, all delays are 1.
+ *	\param[in] levelizer - The Levelizer, levelize must already be called. Must outlive the analyzer.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Depth_analyzer::Depth_analyzer(const Levelizer& levelizer, unsigned thread_count)
+	: m_levelizer( levelizer )
+	, m_thread_count( thread_count )
+	, m_delays( PRIMITIVE_BUF + 1, 1 )
+{
+	m_delays[PRIMITIVE_NONE] = 0;
+}
+
+/** \brief Sets the delay of a primitive type, used by the next analyze.
+ *	\param[in] type - The primitive type.
+ *	\param[in] delay - The delay of the gates of the type.
+ */
+void Depth_analyzer::set_delay(PrimitiveType type, unsigned delay)
+{
+	m_delays[type] = delay;
+}
+
+/// \brief Returns the delay of a primitive type.
+unsigned Depth_analyzer::get_delay(PrimitiveType type) const
+{
+	return m_delays[type];
+}
+
+/// \brief Computes the depths of all nets. Must be called before the getters.
+void Depth_analyzer::analyze()
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<PrimitiveType>& types = netlist.get_gate_types();
+	const std::vector<Flat_id>& input_offsets = netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = netlist.get_gate_inputs();
+	const std::vector<Flat_id>& level_offsets = m_levelizer.get_level_offsets();
+
+	m_net_depths.assign(netlist.get_net_count(), 0);
+	for (unsigned level = 0; level < m_levelizer.get_level_count(); ++level)
+	{
+		Parallel::for_range(level_offsets[level + 1] - level_offsets[level],
+			boost::bind(&Depth_analyzer::propagate_gates, this, level, _1, _2), m_thread_count);
+	}
+
+	// Endpoints: the top outputs, then the inputs of the undefined module instances.
+	m_endpoints = netlist.get_output_nets();
+	std::vector<char> is_endpoint(netlist.get_net_count(), 0);
+	std::vector<Flat_id>::const_iterator I;
+	for (I = m_endpoints.begin(); I != m_endpoints.end(); ++I)
+	{
+		is_endpoint[*I] = 1;
+	}
+	for (size_t gate = 0; gate < netlist.get_gate_count(); ++gate)
+	{
+		if (PRIMITIVE_NONE != types[gate])
+		{
+			continue;
+		}
+		for (Flat_id i = input_offsets[gate]; i < input_offsets[gate + 1]; ++i)
+		{
+			if (!is_endpoint[inputs[i]])
+			{
+				is_endpoint[inputs[i]] = 1;
+				m_endpoints.push_back(inputs[i]);
+			}
+		}
+	}
+}
+
+/// \brief Returns the depths of the nets, 0 for start nets.
+const std::vector<unsigned>& Depth_analyzer::get_net_depths() const
+{
+	return m_net_depths;
+}
+
+/// \brief Returns the endpoint nets, the top outputs come first.
+const std::vector<Flat_id>& Depth_analyzer::get_endpoints() const
+{
+	return m_endpoints;
+}
+
+/// \brief Returns the largest depth of the endpoints.
+unsigned Depth_analyzer::get_max_depth() const
+{
+	unsigned depth = 0;
+	std::vector<Flat_id>::const_iterator I;
+	for (I = m_endpoints.begin(); I != m_endpoints.end(); ++I)
+	{
+		depth = std::max(depth, m_net_depths[*I]);
+	}
+	return depth;
+}
+
+/** \brief Returns the deepest paths to the endpoints, deepest first.
+ *	Paths are enumerated best first from the endpoints backwards, bounded by the net depths, so only the returned paths are traced.
+ *	\param[in] count - Maximal number of paths.
+ */
+std::vector<Depth_path> Depth_analyzer::find_deepest_paths(size_t count) const
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<PrimitiveType>& types = netlist.get_gate_types();
+	const std::vector<Flat_id>& input_offsets = netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = netlist.get_gate_inputs();
+
+	// The queue holds the bounds and the inverted entry indices, so equal bounds pop in creation order.
+	std::vector<Path_entry> entries;
+	std::priority_queue<std::pair<unsigned, size_t> > queue;
+	for (size_t i = 0; i < m_endpoints.size(); ++i)
+	{
+		Path_entry entry = { m_net_depths[m_endpoints[i]], 0, m_endpoints[i], no_parent, Flat_netlist::invalid_id, false };
+		queue.push(std::make_pair(entry.bound, ~entries.size()));
+		entries.push_back(entry);
+	}
+
+	std::vector<Depth_path> paths;
+	while (paths.size() < count && !queue.empty())
+	{
+		size_t index = ~queue.top().second;
+		queue.pop();
+		Path_entry entry = entries[index];
+		if (entry.is_complete)
+		{
+			paths.push_back(Depth_path());
+			Depth_path& path = paths.back();
+			path.depth = entry.suffix;
+			for (size_t i = index; no_parent != i; i = entries[i].parent)
+			{
+				path.nets.push_back(entries[i].net);
+				if (Flat_netlist::invalid_id != entries[i].gate)
+				{
+					path.gates.push_back(entries[i].gate);
+				}
+			}
+			continue;
+		}
+
+		Flat_id gate = get_driving_gate(entry.net);
+		Path_entry next = entry;
+		next.parent = index;
+		if (Flat_netlist::invalid_id != gate)
+		{
+			next.suffix += m_delays[types[gate]];
+			next.gate = gate;
+			bool has_fanin = false;
+			for (Flat_id i = input_offsets[gate]; i < input_offsets[gate + 1]; ++i)
+			{
+				Flat_id net = inputs[i];
+				if (!is_followed(gate, net) || std::find(&inputs[input_offsets[gate]], &inputs[i], net) != &inputs[i])
+				{
+					continue;
+				}
+				has_fanin = true;
+				next.net = net;
+				next.bound = m_net_depths[net] + next.suffix;
+				queue.push(std::make_pair(next.bound, ~entries.size()));
+				entries.push_back(next);
+			}
+			if (has_fanin)
+			{
+				continue;
+			}
+		}
+
+		// Start nets and the outputs of gates without followed inputs complete the path.
+		next.net = entry.net;
+		next.parent = entry.parent;
+		next.gate = entry.gate;
+		next.is_complete = true;
+		next.bound = next.suffix;
+		queue.push(std::make_pair(next.bound, ~entries.size()));
+		entries.push_back(next);
+	}
+	return paths;
+}
+
+/// \brief Returns the number of endpoints of each depth.
+std::vector<size_t> Depth_analyzer::get_endpoint_histogram() const
+{
+	std::vector<size_t> histogram(get_max_depth() + 1, 0);
+	std::vector<Flat_id>::const_iterator I;
+	for (I = m_endpoints.begin(); I != m_endpoints.end(); ++I)
+	{
+		++histogram[m_net_depths[*I]];
+	}
+	return histogram;
+}
+
+/// \brief Returns the number of nets of each depth.
+std::vector<size_t> Depth_analyzer::get_net_histogram() const
+{
+	std::vector<size_t> histogram;
+	std::vector<unsigned>::const_iterator I;
+	for (I = m_net_depths.begin(); I != m_net_depths.end(); ++I)
+	{
+		if (histogram.size() <= *I)
+		{
+			histogram.resize(*I + 1, 0);
+		}
+		++histogram[*I];
+	}
+	return histogram;
+}
+
+/** \brief Propagates the depths through a chunk of the gates of one level.
+ *	\param[in] level - The level.
+ *	\param[in] begin - First gate of the chunk in the level.
+ *	\param[in] end - Gate after the last one of the chunk.
+ */
+void Depth_analyzer::propagate_gates(unsigned level, size_t begin, size_t end)
+{
+	const Flat_netlist& netlist = m_levelizer.get_netlist();
+	const std::vector<PrimitiveType>& types = netlist.get_gate_types();
+	const std::vector<Flat_id>& outputs = netlist.get_gate_outputs();
+	const std::vector<Flat_id>& input_offsets = netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = netlist.get_gate_inputs();
+	const std::vector<Flat_id>& levelized = m_levelizer.get_levelized_gates();
+	Flat_id first = m_levelizer.get_level_offsets()[level];
+
+	for (size_t i = first + begin; i < first + end; ++i)
+	{
+		Flat_id gate = levelized[i];
+		if (PRIMITIVE_NONE == types[gate] || Flat_netlist::invalid_id == outputs[gate])
+		{
+			continue;
+		}
+		unsigned depth = 0;
+		for (Flat_id j = input_offsets[gate]; j < input_offsets[gate + 1]; ++j)
+		{
+			if (is_followed(gate, inputs[j]))
+			{
+				depth = std::max(depth, m_net_depths[inputs[j]]);
+			}
+		}
+		m_net_depths[outputs[gate]] = depth + m_delays[types[gate]];
+	}
+}
+
+/** \brief Returns true if the gate input is followed: it is not driven by a gate of the same level.
+ *	\param[in] gate - The gate.
+ *	\param[in] net - The input net of the gate.
+ */
+bool Depth_analyzer::is_followed(Flat_id gate, Flat_id net) const
+{
+	Flat_id driver = get_driving_gate(net);
+	const std::vector<unsigned>& levels = m_levelizer.get_gate_levels();
+	return Flat_netlist::invalid_id == driver || levels[driver] != levels[gate];
+}
+
+/** \brief Returns the gate driving the net through a delay, invalid_id for start nets.
+ *	\param[in] net - The net.
+ */
+Flat_id Depth_analyzer::get_driving_gate(Flat_id net) const
+{
+	Flat_id driver = m_levelizer.get_netlist().get_net_drivers()[net];
+	if (Flat_netlist::invalid_id == driver || PRIMITIVE_NONE == m_levelizer.get_netlist().get_gate_types()[driver])
+	{
+		return Flat_netlist::invalid_id;
+	}
+	return driver;
+}
+
@@ -0,0 +1,611 @@
+#include "flat_netlist.hpp"
+
+#include <algorithm>
+#include <map>
+#include <stack>
+#include <boost/shared_ptr.hpp>
+
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+
+const Flat_id Flat_netlist::invalid_id = ~0u;
+
+/// Helper types.
+namespace
+{
+	/// Module Description waiting to be flattened, with the flat nets bound to its ports.
+	struct Flatten_context
+	{
+		/// Hierarchy node of the context.
+		Flat_id hierarchy;
+
+		/// Flat nets connected to the ports of the Module Description, by port name.
+		std::map<std::string, Flat_id> port_nets;
+	};
+
+	/// Local net of a hierarchy node.
+	struct Local_net
+	{
+		/// Hierarchy node.
+		Flat_id node;
+
+		/// Local name, held by the Module Description.
+		const std::string* name;
+
+		/// Flat net.
+		Flat_id net;
+	};
+
+	/// Orders local nets by node, then by name.
+	struct Local_net_less
+	{
+		bool operator()(const Local_net& first, const Local_net& second) const
+		{
+			return (first.node != second.node) ? (first.node < second.node) : (*first.name < *second.name);
+		}
+	};
+
+	/// Orders local nets of one node by name.
+	struct Local_name_less
+	{
+		bool operator()(const std::pair<const std::string*, Flat_id>& first, const std::string& second) const
+		{
+			return *first.first < second;
+		}
+	};
+}
+
+/** \brief Constructor, flattens the Netlist below the given module.
+ *	Nets of the modules must already be connected. Throws if the module does not exist, instantiates itself
+ *	or holds a leaf instance whose output pins drive more than one net.
+ *	\param[in] netlist - The Netlist to flatten.
+ *	\param[in] top_module_name - Name of the top Module Description.
+ */
+Flat_netlist::Flat_netlist(const Netlist& netlist, const std::string& top_module_name)
+	: m_top_module( 0 )
+{
+	const std::map< std::string, boost::shared_ptr<Module_description> >& modules = netlist.get_modules();
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator iter_found = modules.find(top_module_name);
+	if (iter_found == modules.end() || !iter_found->second)
+	{
+		throw std::string("Unable to find the top module with given name.");
+	}
+	m_top_module = iter_found->second.get();
+
+	std::vector<std::pair<Flat_id, Flat_id> > aliased_nets;
+	flatten(aliased_nets);
+	merge_aliased_nets(aliased_nets);
+	build_net_connectivity();
+}
+
+/// \brief Getter for the top Module Description.
+const Module_description& Flat_netlist::get_top_module() const
+{
+	return *m_top_module;
+}
+
+/// \brief Returns the number of gates.
+size_t Flat_netlist::get_gate_count() const
+{
+	return m_gate_types.size();
+}
+
+/// \brief Returns the number of nets.
+size_t Flat_netlist::get_net_count() const
+{
+	return m_net_names.size();
+}
+
+/// \brief Returns the primitive types of the gates, PRIMITIVE_NONE for instances of undefined modules.
+const std::vector<PrimitiveType>& Flat_netlist::get_gate_types() const
+{
+	return m_gate_types;
+}
+
+/// \brief Returns the offsets of the gate inputs, inputs of gate i are in [offsets[i], offsets[i + 1]).
+const std::vector<Flat_id>& Flat_netlist::get_gate_input_offsets() const
+{
+	return m_gate_input_offsets;
+}
+
+/// \brief Returns the input nets of all gates.
+const std::vector<Flat_id>& Flat_netlist::get_gate_inputs() const
+{
+	return m_gate_inputs;
+}
+
+/// \brief Returns the output nets of the gates, invalid_id for gates without output.
+const std::vector<Flat_id>& Flat_netlist::get_gate_outputs() const
+{
+	return m_gate_outputs;
+}
+
+/// \brief Returns the driving gates of the nets, invalid_id for input nets.
+const std::vector<Flat_id>& Flat_netlist::get_net_drivers() const
+{
+	return m_net_drivers;
+}
+
+/// \brief Returns the offsets of the net fanouts, fanout gates of net i are in [offsets[i], offsets[i + 1]).
+const std::vector<Flat_id>& Flat_netlist::get_net_fanout_offsets() const
+{
+	return m_net_fanout_offsets;
+}
+
+/// \brief Returns the fanout gates of all nets, one entry per connected gate input.
+const std::vector<Flat_id>& Flat_netlist::get_net_fanouts() const
+{
+	return m_net_fanouts;
+}
+
+/// \brief Returns the nets without a driving gate, the top input ports come first. Constant nets are not inputs.
+const std::vector<Flat_id>& Flat_netlist::get_input_nets() const
+{
+	return m_input_nets;
+}
+
+/// \brief Returns the literal constants the nets are tied to, CONSTANT_NONE for the other nets.
+const std::vector<LogicConstant>& Flat_netlist::get_net_constants() const
+{
+	return m_net_constants;
+}
+
+/// \brief Returns the nets of the top output ports.
+const std::vector<Flat_id>& Flat_netlist::get_output_nets() const
+{
+	return m_output_nets;
+}
+
+/** \brief Returns the leaf Module Instance of the gate.
+ *	\param[in] gate - Id of the gate.
+ */
+const Module_instance& Flat_netlist::get_gate_instance(Flat_id gate) const
+{
+	return *m_gate_instances[gate];
+}
+
+/** \brief Returns the hierarchy node containing the gate.
+ *	\param[in] gate - Id of the gate.
+ */
+Flat_id Flat_netlist::get_gate_hierarchy(Flat_id gate) const
+{
+	return m_gate_hierarchy[gate];
+}
+
+/** \brief Returns the hierarchical name of the gate, instance names separated by '/'.
+ *	\param[in] gate - Id of the gate.
+ */
+std::string Flat_netlist::get_gate_name(Flat_id gate) const
+{
+	std::string prefix = get_hierarchy_name(m_gate_hierarchy[gate]);
+	return prefix.empty() ? m_gate_instances[gate]->get_name() : prefix + "/" + m_gate_instances[gate]->get_name();
+}
+
+/** \brief Returns the hierarchical name of the net, named after the highest module it appears in.
+ *	\param[in] net - Id of the net.
+ */
+std::string Flat_netlist::get_net_name(Flat_id net) const
+{
+	std::string prefix = get_hierarchy_name(m_net_hierarchy[net]);
+	return prefix.empty() ? *m_net_names[net] : prefix + "/" + *m_net_names[net];
+}
+
+/** \brief Returns the highest hierarchy node the net appears in, the node it is named after.
+ *	\param[in] net - Id of the net.
+ */
+Flat_id Flat_netlist::get_net_hierarchy(Flat_id net) const
+{
+	return m_net_hierarchy[net];
+}
+
+/** \brief Returns the local name of the net in its highest hierarchy node.
+ *	\param[in] net - Id of the net.
+ */
+const std::string& Flat_netlist::get_net_local_name(Flat_id net) const
+{
+	return *m_net_names[net];
+}
+
+/** \brief Returns the flat net of a local net name in a hierarchy node, invalid_id if the node has no such net.
+ *	Instance pins use the canonical local names, port names must be resolved with get_canonical_net_name first.
+ *	\param[in] node - Id of the hierarchy node.
+ *	\param[in] name - Local net name.
+ */
+Flat_id Flat_netlist::get_local_net(Flat_id node, const std::string& name) const
+{
+	std::vector<std::pair<const std::string*, Flat_id> >::const_iterator begin = m_local_nets.begin() + m_local_net_offsets[node];
+	std::vector<std::pair<const std::string*, Flat_id> >::const_iterator end = m_local_nets.begin() + m_local_net_offsets[node + 1];
+	std::vector<std::pair<const std::string*, Flat_id> >::const_iterator found = std::lower_bound(begin, end, name, Local_name_less());
+	return (found != end && *found->first == name) ? found->second : invalid_id;
+}
+
+/** \brief Returns the id of the net by its hierarchical name, invalid_id if not found. Linear in the number of nets.
+ *	\param[in] name - Hierarchical name of the net.
+ */
+Flat_id Flat_netlist::find_net(const std::string& name) const
+{
+	size_t separator = name.rfind('/');
+	std::string local_name = (separator == std::string::npos) ? name : name.substr(separator + 1);
+	std::string prefix = (separator == std::string::npos) ? std::string() : name.substr(0, separator);
+
+	size_t count = m_net_names.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (*m_net_names[i] == local_name && get_hierarchy_name(m_net_hierarchy[i]) == prefix)
+		{
+			return static_cast<Flat_id>(i);
+		}
+	}
+	return invalid_id;
+}
+
+/// \brief Returns the number of hierarchy nodes. Node 0 is the top module.
+size_t Flat_netlist::get_hierarchy_count() const
+{
+	return m_hierarchy_parents.size();
+}
+
+/** \brief Returns the parent of the hierarchy node, invalid_id for the top.
+ *	\param[in] node - Id of the hierarchy node.
+ */
+Flat_id Flat_netlist::get_hierarchy_parent(Flat_id node) const
+{
+	return m_hierarchy_parents[node];
+}
+
+/** \brief Returns the Module Instance of the hierarchy node, NULL for the top.
+ *	\param[in] node - Id of the hierarchy node.
+ */
+const Module_instance* Flat_netlist::get_hierarchy_instance(Flat_id node) const
+{
+	return m_hierarchy_instances[node];
+}
+
+/** \brief Returns the Module Description of the hierarchy node.
+ *	\param[in] node - Id of the hierarchy node.
+ */
+const Module_description& Flat_netlist::get_hierarchy_description(Flat_id node) const
+{
+	return *m_hierarchy_descriptions[node];
+}
+
+/** \brief Returns the hierarchical name of the node, instance names separated by '/'. Empty for the top.
+ *	\param[in] node - Id of the hierarchy node.
+ */
+std::string Flat_netlist::get_hierarchy_name(Flat_id node) const
+{
+	std::string name;
+	for (; invalid_id != node && 0 != m_hierarchy_instances[node]; node = m_hierarchy_parents[node])
+	{
+		name = name.empty() ? m_hierarchy_instances[node]->get_name() : m_hierarchy_instances[node]->get_name() + "/" + name;
+	}
+	return name;
+}
+
+/** \brief Descends the hierarchy from the top module and creates all gates and nets.
+ *	\param[out] aliased_nets - Pairs of flat nets joined by aliased ports of a module, e.g. feed-throughs.
+ */
+void Flat_netlist::flatten(std::vector<std::pair<Flat_id, Flat_id> >& aliased_nets)
+{
+	m_hierarchy_parents.push_back(invalid_id);
+	m_hierarchy_instances.push_back(0);
+	m_hierarchy_descriptions.push_back(m_top_module);
+	m_gate_input_offsets.push_back(0);
+
+	std::vector<Local_net> all_local_nets;
+	std::stack<Flatten_context> pending;
+	pending.push(Flatten_context());
+	pending.top().hierarchy = 0;
+
+	bool is_top = true;
+	while (!pending.empty())
+	{
+		Flatten_context context = pending.top();
+		pending.pop();
+		const Module_description& description = *m_hierarchy_descriptions[context.hierarchy];
+
+		// Map local nets to the flat nets, creating new ones for the nets not bound from the parent.
+		std::map<std::string, Flat_id> local_nets;
+		const std::map<std::string, boost::shared_ptr<Net> >& nets = description.get_nets();
+		std::map<std::string, boost::shared_ptr<Net> >::const_iterator iter_nets;
+		for (iter_nets = nets.begin(); iter_nets != nets.end(); ++iter_nets)
+		{
+			std::map<std::string, Flat_id>::const_iterator bound = context.port_nets.find(iter_nets->first);
+			LogicConstant constant = iter_nets->second->get_constant();
+			Flat_id net = (bound != context.port_nets.end()) ? bound->second : create_net(context.hierarchy, &iter_nets->second->get_name(), constant);
+			if (CONSTANT_NONE != constant)
+			{
+				// A port tied to a constant inside the child ties the parent net bound to it.
+				m_net_constants[net] = constant;
+			}
+			local_nets.insert(std::make_pair(iter_nets->first, net));
+			Local_net local_net = { context.hierarchy, &iter_nets->second->get_name(), net };
+			all_local_nets.push_back(local_net);
+		}
+
+		if (is_top)
+		{
+			const std::map<std::string, boost::shared_ptr<Module_port> >& ports = description.get_ports();
+			std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator iter_ports;
+			for (iter_ports = ports.begin(); iter_ports != ports.end(); ++iter_ports)
+			{
+				const std::string& net_name = description.get_canonical_net_name(iter_ports->first);
+				std::map<std::string, Flat_id>::const_iterator local = local_nets.find(net_name);
+				if (local == local_nets.end())
+				{
+					local = local_nets.insert(std::make_pair(net_name, create_net(0, &net_name, CONSTANT_NONE))).first;
+					Local_net local_net = { 0, &net_name, local->second };
+					all_local_nets.push_back(local_net);
+				}
+				if (OUT == iter_ports->second->get_type())
+				{
+					m_output_nets.push_back(local->second);
+				}
+				else if (CONSTANT_NONE == m_net_constants[local->second])
+				{
+					m_input_nets.push_back(local->second);
+				}
+			}
+			is_top = false;
+		}
+
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = description.get_module_instances();
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator iter_instances;
+		for (iter_instances = instances.begin(); iter_instances != instances.end(); ++iter_instances)
+		{
+			const Module_instance& instance = *iter_instances->second;
+			const std::vector<Instance_port>& pins = instance.get_ports();
+
+			if (instance.has_description())
+			{
+				// Check that the module does not instantiate itself through the hierarchy.
+				for (Flat_id node = context.hierarchy; invalid_id != node; node = m_hierarchy_parents[node])
+				{
+					if (m_hierarchy_descriptions[node] == &instance.get_module_description())
+					{
+						throw std::string("Module instantiates itself: " + instance.get_description_name());
+					}
+				}
+
+				Flat_id child = static_cast<Flat_id>(m_hierarchy_parents.size());
+				m_hierarchy_parents.push_back(context.hierarchy);
+				m_hierarchy_instances.push_back(&instance);
+				m_hierarchy_descriptions.push_back(&instance.get_module_description());
+
+				// Ports aliased inside the child bind to one child net, the parent nets bound to them are joined.
+				const Module_description& child_description = instance.get_module_description();
+				pending.push(Flatten_context());
+				pending.top().hierarchy = child;
+				std::vector<Instance_port>::const_iterator I;
+				for (I = pins.begin(); I != pins.end(); ++I)
+				{
+					std::map<std::string, Flat_id>::const_iterator local = local_nets.find(I->get_net_name());
+					if (local != local_nets.end())
+					{
+						std::pair<std::map<std::string, Flat_id>::iterator, bool> bound = pending.top().port_nets.insert(std::make_pair(child_description.get_canonical_net_name(I->get_name()), local->second));
+						if (!bound.second && bound.first->second != local->second)
+						{
+							aliased_nets.push_back(std::make_pair(bound.first->second, local->second));
+						}
+					}
+				}
+				continue;
+			}
+
+			// A leaf instance becomes a gate.
+			Flat_id output = invalid_id;
+			std::vector<Instance_port>::const_iterator I;
+			for (I = pins.begin(); I != pins.end(); ++I)
+			{
+				std::map<std::string, Flat_id>::const_iterator local = local_nets.find(I->get_net_name());
+				if (local == local_nets.end())
+				{
+					continue;
+				}
+				if (OUT == I->get_type())
+				{
+					// Gates have a single output net, the pins driving it must all be bound to that net.
+					if (invalid_id != output && output != local->second)
+					{
+						throw std::string("Leaf instance drives several nets: " + instance.get_name());
+					}
+					output = local->second;
+				}
+				else
+				{
+					m_gate_inputs.push_back(local->second);
+				}
+			}
+			m_gate_input_offsets.push_back(static_cast<Flat_id>(m_gate_inputs.size()));
+			m_gate_outputs.push_back(output);
+			m_gate_types.push_back(instance.get_primitive_type());
+			m_gate_instances.push_back(&instance);
+			m_gate_hierarchy.push_back(context.hierarchy);
+		}
+	}
+
+	// Index the local nets by node and name.
+	std::sort(all_local_nets.begin(), all_local_nets.end(), Local_net_less());
+	m_local_net_offsets.assign(m_hierarchy_parents.size() + 1, 0);
+	m_local_nets.reserve(all_local_nets.size());
+	for (std::vector<Local_net>::const_iterator I = all_local_nets.begin(); I != all_local_nets.end(); ++I)
+	{
+		++m_local_net_offsets[I->node + 1];
+		m_local_nets.push_back(std::make_pair(I->name, I->net));
+	}
+	for (size_t node = 0; node + 1 < m_local_net_offsets.size(); ++node)
+	{
+		m_local_net_offsets[node + 1] += m_local_net_offsets[node];
+	}
+}
+
+/** \brief Creates a new net.
+ *	\param[in] hierarchy - Hierarchy node the net belongs to.
+ *	\param[in] name - Local name of the net in the node.
+ *	\param[in] constant - Literal constant the net is tied to.
+ */
+Flat_id Flat_netlist::create_net(Flat_id hierarchy, const std::string* name, LogicConstant constant)
+{
+	m_net_hierarchy.push_back(hierarchy);
+	m_net_names.push_back(name);
+	m_net_constants.push_back(constant);
+	return static_cast<Flat_id>(m_net_names.size() - 1);
+}
+
+/** \brief Merges the aliased flat nets with a union-find and renumbers the nets. The lowest id of a class names it.
+ *	\param[in] aliased_nets - Pairs of flat nets to merge.
+ */
+void Flat_netlist::merge_aliased_nets(const std::vector<std::pair<Flat_id, Flat_id> >& aliased_nets)
+{
+	if (aliased_nets.empty())
+	{
+		return;
+	}
+
+	// Union-find where the lower id is the root, so a class keeps the name from the highest module.
+	size_t net_count = m_net_names.size();
+	std::vector<Flat_id> parents(net_count);
+	for (size_t net = 0; net < net_count; ++net)
+	{
+		parents[net] = static_cast<Flat_id>(net);
+	}
+	std::vector<std::pair<Flat_id, Flat_id> >::const_iterator I;
+	for (I = aliased_nets.begin(); I != aliased_nets.end(); ++I)
+	{
+		Flat_id first = I->first;
+		Flat_id second = I->second;
+		while (parents[first] != first)
+		{
+			first = parents[first] = parents[parents[first]];
+		}
+		while (parents[second] != second)
+		{
+			second = parents[second] = parents[parents[second]];
+		}
+		if (first < second)
+		{
+			parents[second] = first;
+		}
+		else if (second < first)
+		{
+			parents[first] = second;
+		}
+	}
+
+	// A class is tied if any of its nets is tied.
+	for (size_t net = 0; net < net_count; ++net)
+	{
+		Flat_id root = static_cast<Flat_id>(net);
+		while (parents[root] != root)
+		{
+			root = parents[root];
+		}
+		if (CONSTANT_NONE == m_net_constants[root])
+		{
+			m_net_constants[root] = m_net_constants[net];
+		}
+	}
+
+	// Roots get the new ids in order, parents come first so one pass resolves every net.
+	std::vector<Flat_id> new_ids(net_count);
+	Flat_id root_count = 0;
+	for (size_t net = 0; net < net_count; ++net)
+	{
+		if (parents[net] == net)
+		{
+			new_ids[net] = root_count;
+			m_net_hierarchy[root_count] = m_net_hierarchy[net];
+			m_net_names[root_count] = m_net_names[net];
+			m_net_constants[root_count] = m_net_constants[net];
+			++root_count;
+		}
+		else
+		{
+			new_ids[net] = new_ids[parents[net]];
+		}
+	}
+	m_net_hierarchy.resize(root_count);
+	m_net_names.resize(root_count);
+	m_net_constants.resize(root_count);
+
+	for (std::vector<Flat_id>::iterator J = m_gate_inputs.begin(); J != m_gate_inputs.end(); ++J)
+	{
+		*J = new_ids[*J];
+	}
+	for (std::vector<Flat_id>::iterator J = m_gate_outputs.begin(); J != m_gate_outputs.end(); ++J)
+	{
+		*J = (invalid_id == *J) ? invalid_id : new_ids[*J];
+	}
+	for (std::vector<Flat_id>::iterator J = m_input_nets.begin(); J != m_input_nets.end(); ++J)
+	{
+		*J = new_ids[*J];
+	}
+	for (std::vector<Flat_id>::iterator J = m_output_nets.begin(); J != m_output_nets.end(); ++J)
+	{
+		*J = new_ids[*J];
+	}
+	std::vector<std::pair<const std::string*, Flat_id> >::iterator K;
+	for (K = m_local_nets.begin(); K != m_local_nets.end(); ++K)
+	{
+		K->second = new_ids[K->second];
+	}
+}
+
+/// \brief Fills the drivers and fanouts of the nets from the gate connectivity.
+void Flat_netlist::build_net_connectivity()
+{
+	size_t net_count = m_net_names.size();
+	size_t gate_count = m_gate_types.size();
+
+	// The first gate driving a net is its driver.
+	m_net_drivers.assign(net_count, invalid_id);
+	for (size_t gate = 0; gate < gate_count; ++gate)
+	{
+		Flat_id output = m_gate_outputs[gate];
+		if (invalid_id != output && invalid_id == m_net_drivers[output])
+		{
+			m_net_drivers[output] = static_cast<Flat_id>(gate);
+		}
+	}
+
+	// Count the fanouts, turn the counts into offsets and fill.
+	m_net_fanout_offsets.assign(net_count + 1, 0);
+	size_t input_count = m_gate_inputs.size();
+	for (size_t i = 0; i < input_count; ++i)
+	{
+		++m_net_fanout_offsets[m_gate_inputs[i] + 1];
+	}
+	for (size_t net = 0; net < net_count; ++net)
+	{
+		m_net_fanout_offsets[net + 1] += m_net_fanout_offsets[net];
+	}
+	m_net_fanouts.resize(input_count);
+	std::vector<Flat_id> positions(m_net_fanout_offsets.begin(), m_net_fanout_offsets.end() - 1);
+	for (size_t gate = 0; gate < gate_count; ++gate)
+	{
+		for (Flat_id i = m_gate_input_offsets[gate]; i < m_gate_input_offsets[gate + 1]; ++i)
+		{
+			m_net_fanouts[positions[m_gate_inputs[i]]++] = static_cast<Flat_id>(gate);
+		}
+	}
+
+	// Undriven internal nets that feed gates are inputs too, unless they are tied to a constant.
+	std::vector<bool> is_input(net_count, false);
+	std::vector<Flat_id>::const_iterator I;
+	for (I = m_input_nets.begin(); I != m_input_nets.end(); ++I)
+	{
+		is_input[*I] = true;
+	}
+	for (size_t net = 0; net < net_count; ++net)
+	{
+		if (!is_input[net] && invalid_id == m_net_drivers[net] && CONSTANT_NONE == m_net_constants[net] && m_net_fanout_offsets[net] != m_net_fanout_offsets[net + 1])
+		{
+			m_input_nets.push_back(static_cast<Flat_id>(net));
+		}
+	}
+}
+
@@ -0,0 +1,451 @@
+#include "hierarchy_query.hpp"
+#include "parallel.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+
+#include <algorithm>
+#include <map>
+#include <boost/bind.hpp>
+
+/// Helper types.
+namespace
+{
+	/// Frame of the explicit call stack of the module ordering.
+	struct Module_frame
+	{
+		/// The module.
+		const Module_description* module;
+
+		/// Next instance of the module to visit.
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator next;
+	};
+
+	/// Frame of the explicit call stack of the hierarchy expansion.
+	struct Occurrence_frame
+	{
+		/// The occurrence.
+		Hierarchy_handle handle;
+
+		/// Next member of its module to expand.
+		unsigned next;
+
+		/// Member after the last one of its module.
+		unsigned end;
+	};
+
+	/// Orders name pointers by the names.
+	struct Name_less
+	{
+		bool operator()(const std::string* first, const std::string* second) const
+		{
+			return *first < *second;
+		}
+	};
+
+	/// Compares name pointers by the names.
+	struct Name_equal
+	{
+		bool operator()(const std::string* first, const std::string* second) const
+		{
+			return *first == *second;
+		}
+	};
+
+	/// Prefix searched in the sorted name table.
+	struct Name_prefix
+	{
+		/// The prefix.
+		const std::string& text;
+	};
+
+	/// Compares the names with a prefix, the names starting with the prefix are equal to it.
+	struct Prefix_less
+	{
+		bool operator()(const std::string& name, const Name_prefix& prefix) const
+		{
+			return name.compare(0, prefix.text.size(), prefix.text) < 0;
+		}
+
+		bool operator()(const Name_prefix& prefix, const std::string& name) const
+		{
+			return name.compare(0, prefix.text.size(), prefix.text) > 0;
+		}
+	};
+}
+
+/// Handle returned for missing occurrences.
+const Hierarchy_handle Hierarchy_query::invalid_handle = static_cast<Hierarchy_handle>(-1);
+
+/** \brief Constructor, expands the hierarchy below the top module and interns the names.
+ *	Throws if the module does not exist or instantiates itself.
+ *	\param[in] netlist - The Netlist, instances must already point to their Module Descriptions. Must outlive the query.
+ *	\param[in] top_module_name - Name of the top Module Description.
+ *	\param[in] thread_count - Number of threads used by the searches, 0 for the hardware thread count.
+ */
+Hierarchy_query::Hierarchy_query(const Netlist& netlist, const std::string& top_module_name, unsigned thread_count)
+	: m_thread_count( thread_count )
+	, m_visited_count( 0 )
+{
+	std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator top = netlist.get_modules().find(top_module_name);
+	if (netlist.get_modules().end() == top)
+	{
+		throw std::string("Unable to find the top module: " + top_module_name);
+	}
+
+	// Order the modules depth first, modules on the stack have an invalid index until their submodules are done.
+	std::map<const Module_description*, unsigned> module_indices;
+	std::vector<Module_frame> stack;
+	Module_frame top_frame = { top->second.get(), top->second->get_module_instances().begin() };
+	stack.push_back(top_frame);
+	module_indices.insert(std::make_pair(top_frame.module, invalid_handle));
+	std::vector<const std::string*> names;
+	while (!stack.empty())
+	{
+		Module_frame& frame = stack.back();
+		if (frame.module->get_module_instances().end() == frame.next)
+		{
+			module_indices[frame.module] = static_cast<unsigned>(m_modules.size());
+			m_modules.push_back(frame.module);
+			names.push_back(&frame.module->get_name());
+			stack.pop_back();
+			continue;
+		}
+		const Module_instance& instance = *(frame.next++)->second;
+		names.push_back(&instance.get_name());
+		names.push_back(&instance.get_description_name());
+		if (!instance.has_description())
+		{
+			continue;
+		}
+		const Module_description& master = instance.get_module_description();
+		std::pair<std::map<const Module_description*, unsigned>::iterator, bool> inserted = module_indices.insert(std::make_pair(&master, invalid_handle));
+		if (inserted.second)
+		{
+			Module_frame master_frame = { &master, master.get_module_instances().begin() };
+			stack.push_back(master_frame);
+		}
+		else if (invalid_handle == inserted.first->second)
+		{
+			throw std::string("Module instantiates itself: " + master.get_name());
+		}
+	}
+
+	// Intern the names in sorted order, so the names with a common prefix have consecutive ids.
+	std::sort(names.begin(), names.end(), Name_less());
+	names.erase(std::unique(names.begin(), names.end(), Name_equal()), names.end());
+	m_names.reserve(names.size());
+	for (std::vector<const std::string*>::const_iterator I = names.begin(); I != names.end(); ++I)
+	{
+		m_names.push_back(**I);
+	}
+
+	for (std::vector<const Module_description*>::const_iterator I = m_modules.begin(); I != m_modules.end(); ++I)
+	{
+		m_member_offsets.push_back(static_cast<unsigned>(m_members.size()));
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = (*I)->get_module_instances();
+		for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J = instances.begin(); J != instances.end(); ++J)
+		{
+			const Module_instance& instance = *J->second;
+			Member member = { get_name_id(instance.get_name()), get_name_id(instance.get_description_name()), invalid_handle, &instance };
+			if (instance.has_description())
+			{
+				member.module = module_indices[&instance.get_module_description()];
+			}
+			m_members.push_back(member);
+		}
+	}
+	m_member_offsets.push_back(static_cast<unsigned>(m_members.size()));
+	unsigned top_name = get_name_id(top_module_name);
+	Member top_member = { top_name, top_name, static_cast<unsigned>(m_modules.size() - 1), 0 };
+	m_members.push_back(top_member);
+
+	// Expand the occurrences in preorder, the subtree end is known when the frame is popped.
+	m_occurrence_members.push_back(static_cast<unsigned>(m_members.size() - 1));
+	m_parents.push_back(invalid_handle);
+	m_levels.push_back(0);
+	m_subtree_ends.push_back(invalid_handle);
+	std::vector<Occurrence_frame> occurrences;
+	Occurrence_frame occurrence = { 0, m_member_offsets[top_member.module], m_member_offsets[top_member.module + 1] };
+	occurrences.push_back(occurrence);
+	while (!occurrences.empty())
+	{
+		Occurrence_frame& frame = occurrences.back();
+		if (frame.next == frame.end)
+		{
+			m_subtree_ends[frame.handle] = static_cast<Hierarchy_handle>(m_parents.size());
+			occurrences.pop_back();
+			continue;
+		}
+		if (invalid_handle == m_parents.size())
+		{
+			throw std::string("Too many instances below the top module: " + top_module_name);
+		}
+		Hierarchy_handle handle = static_cast<Hierarchy_handle>(m_parents.size());
+		const Member& member = m_members[frame.next];
+		m_occurrence_members.push_back(frame.next++);
+		m_parents.push_back(frame.handle);
+		m_levels.push_back(m_levels[frame.handle] + 1);
+		m_subtree_ends.push_back(handle + 1);
+		if (invalid_handle != member.module)
+		{
+			Occurrence_frame child = { handle, m_member_offsets[member.module], m_member_offsets[member.module + 1] };
+			occurrences.push_back(child);
+		}
+	}
+}
+
+/** \brief Finds the instances below the scopes whose name and master match the patterns.
+ *	\param[in] scopes - Occurrences to search below. Scopes inside other scopes are searched once.
+ *	\param[in] name - Pattern of the instance names.
+ *	\param[in] master - Pattern of the master names (module, primitive or undefined module names), NULL for any master.
+ *	\param[in] min_level - Minimal level below the scope, 1 for the instances of the scope module, 0 to include the scope.
+ *	\param[in] max_level - Maximal level below the scope.
+ *	\ret The matching occurrences, in preorder.
+ */
+std::vector<Hierarchy_handle> Hierarchy_query::find(const std::vector<Hierarchy_handle>& scopes, const Name_pattern& name,
+	const Name_pattern* master, unsigned min_level, unsigned max_level)
+{
+	// Patterns are matched once per distinct name.
+	m_name_matches.assign(m_names.size(), 0);
+	match_names(name, m_name_matches);
+	m_master_matches.assign(m_names.size(), 0 == master);
+	if (0 != master)
+	{
+		match_names(*master, m_master_matches);
+	}
+	m_module_matches.assign(m_modules.size(), 0);
+	for (size_t module = 0; module < m_modules.size(); ++module)
+	{
+		for (unsigned i = m_member_offsets[module]; i < m_member_offsets[module + 1] && !m_module_matches[module]; ++i)
+		{
+			const Member& member = m_members[i];
+			m_module_matches[module] = (m_name_matches[member.name] && m_master_matches[member.master])
+				|| (invalid_handle != member.module && m_module_matches[member.module]);
+		}
+	}
+
+	std::vector<Hierarchy_handle> sorted_scopes(scopes);
+	std::sort(sorted_scopes.begin(), sorted_scopes.end());
+	size_t total = 0;
+	Hierarchy_handle covered_end = 0;
+	std::vector<Hierarchy_handle>::iterator last = sorted_scopes.begin();
+	for (std::vector<Hierarchy_handle>::const_iterator I = sorted_scopes.begin(); I != sorted_scopes.end(); ++I)
+	{
+		if (*I >= m_parents.size())
+		{
+			throw std::string("Invalid hierarchy handle");
+		}
+		if (*I >= covered_end)
+		{
+			*last++ = *I;
+			covered_end = m_subtree_ends[*I];
+			total += covered_end - *I;
+		}
+	}
+	sorted_scopes.erase(last, sorted_scopes.end());
+
+	// Subtrees above the grain are split into their root and the subtrees of the children.
+	unsigned thread_count = (0 == m_thread_count) ? Parallel::get_thread_count() : m_thread_count;
+	size_t grain = std::max<size_t>(total / (thread_count * 16), 1024);
+	std::vector<Search_task> tasks;
+	for (std::vector<Hierarchy_handle>::const_iterator I = sorted_scopes.begin(); I != sorted_scopes.end(); ++I)
+	{
+		for (Hierarchy_handle handle = *I; handle < m_subtree_ends[*I]; )
+		{
+			Search_task task = { handle, m_subtree_ends[handle], m_levels[*I] };
+			if (m_subtree_ends[handle] - handle > grain && !is_pruned(handle, m_levels[handle] - m_levels[*I], max_level))
+			{
+				task.last = handle + 1;
+			}
+			tasks.push_back(task);
+			handle = task.last;
+		}
+	}
+
+	std::vector<std::vector<Hierarchy_handle> > results(tasks.size());
+	std::vector<size_t> visited_counts(tasks.size(), 0);
+	Parallel::for_range(tasks.size(), boost::bind(&Hierarchy_query::search, this, &tasks, &results, &visited_counts, min_level, max_level, _1, _2), m_thread_count, 1);
+
+	std::vector<Hierarchy_handle> found;
+	m_visited_count = 0;
+	for (size_t i = 0; i < tasks.size(); ++i)
+	{
+		found.insert(found.end(), results[i].begin(), results[i].end());
+		m_visited_count += visited_counts[i];
+	}
+	return found;
+}
+
+/** \brief Returns the occurrence of an instance path, invalid_handle if not found.
+ *	\param[in] path - Instance names separated by '/', empty for the top module.
+ */
+Hierarchy_handle Hierarchy_query::find_path(const std::string& path) const
+{
+	Hierarchy_handle handle = 0;
+	size_t begin = 0;
+	while (begin < path.size())
+	{
+		size_t end = path.find('/', begin);
+		if (std::string::npos == end)
+		{
+			end = path.size();
+		}
+		Hierarchy_handle child = handle + 1;
+		while (child < m_subtree_ends[handle] && 0 != path.compare(begin, end - begin, get_name(child)))
+		{
+			child = m_subtree_ends[child];
+		}
+		if (child == m_subtree_ends[handle])
+		{
+			return invalid_handle;
+		}
+		handle = child;
+		begin = end + 1;
+	}
+	return handle;
+}
+
+/// \brief Returns the number of occurrences, including the top module.
+size_t Hierarchy_query::get_handle_count() const
+{
+	return m_parents.size();
+}
+
+/** \brief Returns the parent of the occurrence, invalid_handle for the top.
+ *	\param[in] handle - The occurrence.
+ */
+Hierarchy_handle Hierarchy_query::get_parent(Hierarchy_handle handle) const
+{
+	return m_parents[handle];
+}
+
+/** \brief Returns the level of the occurrence, 0 for the top.
+ *	\param[in] handle - The occurrence.
+ */
+unsigned Hierarchy_query::get_level(Hierarchy_handle handle) const
+{
+	return m_levels[handle];
+}
+
+/** \brief Returns the handle after the last occurrence of the subtree of the occurrence.
+ *	\param[in] handle - The occurrence.
+ */
+Hierarchy_handle Hierarchy_query::get_subtree_end(Hierarchy_handle handle) const
+{
+	return m_subtree_ends[handle];
+}
+
+/** \brief Returns the Module Instance of the occurrence, NULL for the top.
+ *	\param[in] handle - The occurrence.
+ */
+const Module_instance* Hierarchy_query::get_instance(Hierarchy_handle handle) const
+{
+	return m_members[m_occurrence_members[handle]].instance;
+}
+
+/** \brief Returns the instance name of the occurrence, the top module name for the top.
+ *	\param[in] handle - The occurrence.
+ */
+const std::string& Hierarchy_query::get_name(Hierarchy_handle handle) const
+{
+	return m_names[m_members[m_occurrence_members[handle]].name];
+}
+
+/** \brief Returns the master name of the occurrence.
+ *	\param[in] handle - The occurrence.
+ */
+const std::string& Hierarchy_query::get_master_name(Hierarchy_handle handle) const
+{
+	return m_names[m_members[m_occurrence_members[handle]].master];
+}
+
+/** \brief Returns the instance path of the occurrence, instance names separated by '/'. Empty for the top.
+ *	\param[in] handle - The occurrence.
+ */
+std::string Hierarchy_query::get_path(Hierarchy_handle handle) const
+{
+	std::string path;
+	for (; 0 != handle; handle = m_parents[handle])
+	{
+		path = path.empty() ? get_name(handle) : get_name(handle) + "/" + path;
+	}
+	return path;
+}
+
+/// \brief Returns the number of distinct instance and master names.
+size_t Hierarchy_query::get_name_count() const
+{
+	return m_names.size();
+}
+
+/// \brief Returns the number of occurrences visited by the last search.
+size_t Hierarchy_query::get_visited_count() const
+{
+	return m_visited_count;
+}
+
+/** \brief Returns the id of an interned name.
+ *	\param[in] name - The name, must be in the name table.
+ */
+unsigned Hierarchy_query::get_name_id(const std::string& name) const
+{
+	return static_cast<unsigned>(std::lower_bound(m_names.begin(), m_names.end(), name) - m_names.begin());
+}
+
+/** \brief Matches the pattern against the names of the table starting with its prefix.
+ *	\param[in] pattern - The pattern.
+ *	\param[out] matches - Flags of the names, indexed by name id.
+ */
+void Hierarchy_query::match_names(const Name_pattern& pattern, std::vector<char>& matches) const
+{
+	Name_prefix prefix = { pattern.get_prefix() };
+	std::vector<std::string>::const_iterator first = std::lower_bound(m_names.begin(), m_names.end(), prefix, Prefix_less());
+	std::vector<std::string>::const_iterator last = std::upper_bound(first, m_names.end(), prefix, Prefix_less());
+	for (std::vector<std::string>::const_iterator I = first; I != last; ++I)
+	{
+		matches[I - m_names.begin()] = pattern.match(*I);
+	}
+}
+
+/** \brief Searches a chunk of tasks.
+ *	\param[in] tasks - All tasks.
+ *	\param[out] results - Matching occurrences of the tasks.
+ *	\param[out] visited_counts - Numbers of occurrences visited by the tasks.
+ *	\param[in] min_level - Minimal level below the scope.
+ *	\param[in] max_level - Maximal level below the scope.
+ *	\param[in] begin - First task of the chunk.
+ *	\param[in] end - Task after the last one of the chunk.
+ */
+void Hierarchy_query::search(const std::vector<Search_task>* tasks, std::vector<std::vector<Hierarchy_handle> >* results,
+	std::vector<size_t>* visited_counts, unsigned min_level, unsigned max_level, size_t begin, size_t end) const
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		const Search_task& task = (*tasks)[i];
+		std::vector<Hierarchy_handle>& found = (*results)[i];
+		size_t visited_count = 0;
+		for (Hierarchy_handle handle = task.first; handle < task.last; ++visited_count)
+		{
+			unsigned level = m_levels[handle] - task.scope_level;
+			const Member& member = m_members[m_occurrence_members[handle]];
+			if (level >= min_level && m_name_matches[member.name] && m_master_matches[member.master])
+			{
+				found.push_back(handle);
+			}
+			handle = is_pruned(handle, level, max_level) ? m_subtree_ends[handle] : handle + 1;
+		}
+		(*visited_counts)[i] = visited_count;
+	}
+}
+
+/** \brief Returns true if the occurrences below the occurrence are skipped by the search.
+ *	\param[in] handle - The occurrence.
+ *	\param[in] level - Level of the occurrence below the scope.
+ *	\param[in] max_level - Maximal level below the scope.
+ */
+bool Hierarchy_query::is_pruned(Hierarchy_handle handle, unsigned level, unsigned max_level) const
+{
+	unsigned module = m_members[m_occurrence_members[handle]].module;
+	return level >= max_level || invalid_handle == module || !m_module_matches[module];
+}
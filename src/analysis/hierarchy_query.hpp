@@ -0,0 +1,204 @@
+#ifndef HIERARCHY_QUERY_HPP
+#define HIERARCHY_QUERY_HPP
+
+#include <climits>
+#include <string>
+#include <vector>
+
+#include "name_pattern.hpp"
+
+class Netlist;
+class Module_description;
+class Module_instance;
+
+/// Type of the handles of the instance occurrences in the hierarchy, the top module is handle 0.
+typedef unsigned int Hierarchy_handle;
+
+/** \brief Class for finding the instances of a hierarchy by name, master and level.
+ *	The hierarchy below the top module is expanded once into a preorder table of instance occurrences, so the subtree
+ *	of an occurrence is the range of handles up to its subtree end. Instance and master names are interned in a sorted
+ *	name table: the names starting with a literal prefix are one range of ids (the prefix index), and a pattern is
+ *	matched once per distinct name in the range of its prefix instead of once per occurrence.
+ *	For every query each module gets a flag telling if anything below it can match, the subtrees of the other modules
+ *	and the levels below the maximal level are skipped. Large subtrees are searched in parallel.
+ */
+class Hierarchy_query
+{
+public:
+
+	/// Handle returned for missing occurrences.
+	static const Hierarchy_handle invalid_handle;
+
+	/** \brief Constructor, expands the hierarchy below the top module and interns the names.
+	 *	Throws if the module does not exist or instantiates itself.
+	 *	\param[in] netlist - The Netlist, instances must already point to their Module Descriptions. Must outlive the query.
+	 *	\param[in] top_module_name - Name of the top Module Description.
+	 *	\param[in] thread_count - Number of threads used by the searches, 0 for the hardware thread count.
+	 */
+	Hierarchy_query(const Netlist& netlist, const std::string& top_module_name, unsigned thread_count = 0);
+
+	/** \brief Finds the instances below the scopes whose name and master match the patterns.
+	 *	\param[in] scopes - Occurrences to search below. Scopes inside other scopes are searched once.
+	 *	\param[in] name - Pattern of the instance names.
+	 *	\param[in] master - Pattern of the master names (module, primitive or undefined module names), NULL for any master.
+	 *	\param[in] min_level - Minimal level below the scope, 1 for the instances of the scope module, 0 to include the scope.
+	 *	\param[in] max_level - Maximal level below the scope.
+	 *	\ret The matching occurrences, in preorder.
+	 */
+	std::vector<Hierarchy_handle> find(const std::vector<Hierarchy_handle>& scopes, const Name_pattern& name,
+		const Name_pattern* master = 0, unsigned min_level = 1, unsigned max_level = UINT_MAX);
+
+	/** \brief Returns the occurrence of an instance path, invalid_handle if not found.
+	 *	\param[in] path - Instance names separated by '/', empty for the top module.
+	 */
+	Hierarchy_handle find_path(const std::string& path) const;
+
+	/// \brief Returns the number of occurrences, including the top module.
+	size_t get_handle_count() const;
+
+	/** \brief Returns the parent of the occurrence, invalid_handle for the top.
+	 *	\param[in] handle - The occurrence.
+	 */
+	Hierarchy_handle get_parent(Hierarchy_handle handle) const;
+
+	/** \brief Returns the level of the occurrence, 0 for the top.
+	 *	\param[in] handle - The occurrence.
+	 */
+	unsigned get_level(Hierarchy_handle handle) const;
+
+	/** \brief Returns the handle after the last occurrence of the subtree of the occurrence.
+	 *	\param[in] handle - The occurrence.
+	 */
+	Hierarchy_handle get_subtree_end(Hierarchy_handle handle) const;
+
+	/** \brief Returns the Module Instance of the occurrence, NULL for the top.
+	 *	\param[in] handle - The occurrence.
+	 */
+	const Module_instance* get_instance(Hierarchy_handle handle) const;
+
+	/** \brief Returns the instance name of the occurrence, the top module name for the top.
+	 *	\param[in] handle - The occurrence.
+	 */
+	const std::string& get_name(Hierarchy_handle handle) const;
+
+	/** \brief Returns the master name of the occurrence.
+	 *	\param[in] handle - The occurrence.
+	 */
+	const std::string& get_master_name(Hierarchy_handle handle) const;
+
+	/** \brief Returns the instance path of the occurrence, instance names separated by '/'. Empty for the top.
+	 *	\param[in] handle - The occurrence.
+	 */
+	std::string get_path(Hierarchy_handle handle) const;
+
+	/// \brief Returns the number of distinct instance and master names.
+	size_t get_name_count() const;
+
+	/// \brief Returns the number of occurrences visited by the last search.
+	size_t get_visited_count() const;
+
+private:
+
+	/// Instance of a module, or the top module itself.
+	struct Member
+	{
+		/// Id of the instance name.
+		unsigned name;
+
+		/// Id of the master name.
+		unsigned master;
+
+		/// Index of the master module, invalid_handle for built-in and undefined modules.
+		unsigned module;
+
+		/// The Module Instance, NULL for the top.
+		const Module_instance* instance;
+	};
+
+	/// Range of occurrences searched by one task.
+	struct Search_task
+	{
+		/// First occurrence.
+		Hierarchy_handle first;
+
+		/// Occurrence after the last one.
+		Hierarchy_handle last;
+
+		/// Level of the scope of the task.
+		unsigned scope_level;
+	};
+
+	/** \brief Returns the id of an interned name.
+	 *	\param[in] name - The name, must be in the name table.
+	 */
+	unsigned get_name_id(const std::string& name) const;
+
+	/** \brief Matches the pattern against the names of the table starting with its prefix.
+	 *	\param[in] pattern - The pattern.
+	 *	\param[out] matches - Flags of the names, indexed by name id.
+	 */
+	void match_names(const Name_pattern& pattern, std::vector<char>& matches) const;
+
+	/** \brief Searches a chunk of tasks.
+	 *	\param[in] tasks - All tasks.
+	 *	\param[out] results - Matching occurrences of the tasks.
+	 *	\param[out] visited_counts - Numbers of occurrences visited by the tasks.
+	 *	\param[in] min_level - Minimal level below the scope.
+	 *	\param[in] max_level - Maximal level below the scope.
+	 *	\param[in] begin - First task of the chunk.
+	 *	\param[in] end - Task after the last one of the chunk.
+	 */
+	void search(const std::vector<Search_task>* tasks, std::vector<std::vector<Hierarchy_handle> >* results,
+		std::vector<size_t>* visited_counts, unsigned min_level, unsigned max_level, size_t begin, size_t end) const;
+
+	/** \brief Returns true if the occurrences below the occurrence are skipped by the search.
+	 *	\param[in] handle - The occurrence.
+	 *	\param[in] level - Level of the occurrence below the scope.
+	 *	\param[in] max_level - Maximal level below the scope.
+	 */
+	bool is_pruned(Hierarchy_handle handle, unsigned level, unsigned max_level) const;
+
+private:
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Interned names, sorted.
+	std::vector<std::string> m_names;
+
+	/// Modules of the hierarchy, submodules before the modules instantiating them.
+	std::vector<const Module_description*> m_modules;
+
+	/// Offsets of the members of the modules, members of module i are in [offsets[i], offsets[i + 1]).
+	std::vector<unsigned> m_member_offsets;
+
+	/// Members of all modules in instance name order, the top is the last member.
+	std::vector<Member> m_members;
+
+	/// Members of the occurrences.
+	std::vector<unsigned> m_occurrence_members;
+
+	/// Parents of the occurrences.
+	std::vector<Hierarchy_handle> m_parents;
+
+	/// Levels of the occurrences.
+	std::vector<unsigned> m_levels;
+
+	/// Subtree ends of the occurrences.
+	std::vector<Hierarchy_handle> m_subtree_ends;
+
+	/// Flags of the names matching the name pattern of the current search.
+	std::vector<char> m_name_matches;
+
+	/// Flags of the names matching the master pattern of the current search.
+	std::vector<char> m_master_matches;
+
+	/// Flags of the modules with a matching member at any level below them, for the current search.
+	std::vector<char> m_module_matches;
+
+	/// Number of occurrences visited by the last search.
+	size_t m_visited_count;
+
+};
+
+#endif // HIERARCHY_QUERY_HPP
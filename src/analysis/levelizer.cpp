@@ -0,0 +1,393 @@
+#include "levelizer.hpp"
+#include "parallel.hpp"
+
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+
+/// Helper types.
+namespace
+{
+	/// Marks gates not yet visited by the component search.
+	const Flat_id not_visited = ~0u;
+
+	/// Frame of the explicit call stack of the component search.
+	struct Search_frame
+	{
+		/// The visited gate.
+		Flat_id gate;
+
+		/// Position of the next fanout to visit.
+		Flat_id next_fanout;
+	};
+
+	/// Counts the edges entering every component from other components, for a chunk of gates.
+	struct Count_predecessors
+	{
+		const Flat_netlist* netlist;
+		const std::vector<Flat_id>* gate_components;
+		boost::atomic<unsigned>* predecessors;
+
+		void operator()(size_t begin, size_t end, unsigned) const
+		{
+			const std::vector<Flat_id>& outputs = netlist->get_gate_outputs();
+			const std::vector<Flat_id>& fanout_offsets = netlist->get_net_fanout_offsets();
+			const std::vector<Flat_id>& fanouts = netlist->get_net_fanouts();
+			for (size_t gate = begin; gate < end; ++gate)
+			{
+				Flat_id output = outputs[gate];
+				if (Flat_netlist::invalid_id == output)
+				{
+					continue;
+				}
+				for (Flat_id i = fanout_offsets[output]; i < fanout_offsets[output + 1]; ++i)
+				{
+					Flat_id component = (*gate_components)[fanouts[i]];
+					if (component != (*gate_components)[gate])
+					{
+						predecessors[component].fetch_add(1, boost::memory_order_relaxed);
+					}
+				}
+			}
+		}
+	};
+
+	/// Levelizes a chunk of the current wavefront and collects the components of the next one.
+	struct Advance_wavefront
+	{
+		const Flat_netlist* netlist;
+		const std::vector<Flat_id>* gate_components;
+		const std::vector<Flat_id>* component_offsets;
+		const std::vector<Flat_id>* component_gates;
+		const std::vector<Flat_id>* wavefront;
+		boost::atomic<unsigned>* predecessors;
+		std::vector<unsigned>* component_levels;
+		std::vector<std::vector<Flat_id> >* next_wavefronts;
+		unsigned level;
+
+		void operator()(size_t begin, size_t end, unsigned thread) const
+		{
+			const std::vector<Flat_id>& outputs = netlist->get_gate_outputs();
+			const std::vector<Flat_id>& fanout_offsets = netlist->get_net_fanout_offsets();
+			const std::vector<Flat_id>& fanouts = netlist->get_net_fanouts();
+			std::vector<Flat_id>& next = (*next_wavefronts)[thread];
+			for (size_t i = begin; i < end; ++i)
+			{
+				Flat_id component = (*wavefront)[i];
+				(*component_levels)[component] = level;
+				for (Flat_id j = (*component_offsets)[component]; j < (*component_offsets)[component + 1]; ++j)
+				{
+					Flat_id output = outputs[(*component_gates)[j]];
+					if (Flat_netlist::invalid_id == output)
+					{
+						continue;
+					}
+					for (Flat_id k = fanout_offsets[output]; k < fanout_offsets[output + 1]; ++k)
+					{
+						Flat_id successor = (*gate_components)[fanouts[k]];
+						if (successor != component && 1 == predecessors[successor].fetch_sub(1, boost::memory_order_acq_rel))
+						{
+							next.push_back(successor);
+						}
+					}
+				}
+			}
+		}
+	};
+
+	/// Copies the component levels to the gates of a chunk.
+	struct Assign_gate_levels
+	{
+		const std::vector<Flat_id>* gate_components;
+		const std::vector<unsigned>* component_levels;
+		std::vector<unsigned>* gate_levels;
+
+		void operator()(size_t begin, size_t end, unsigned) const
+		{
+			for (size_t gate = begin; gate < end; ++gate)
+			{
+				(*gate_levels)[gate] = (*component_levels)[(*gate_components)[gate]];
+			}
+		}
+	};
+}
+
+/** \brief Constructor with the netlist to levelize.
+ *	\param[in] netlist - The Flat Netlist, must outlive the Levelizer.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Levelizer::Levelizer(const Flat_netlist& netlist, unsigned thread_count)
+	: m_netlist( netlist )
+	, m_thread_count( (0 == thread_count) ? Parallel::get_thread_count() : thread_count )
+{
+
+}
+
+/// \brief Finds the loops and assigns the levels. Must be called before the getters.
+void Levelizer::levelize()
+{
+	find_components();
+	collect_components();
+	compute_levels();
+}
+
+/// \brief Getter for the levelized Flat Netlist.
+const Flat_netlist& Levelizer::get_netlist() const
+{
+	return m_netlist;
+}
+
+/// \brief Returns the levels of the gates.
+const std::vector<unsigned>& Levelizer::get_gate_levels() const
+{
+	return m_gate_levels;
+}
+
+/// \brief Returns the number of levels.
+unsigned Levelizer::get_level_count() const
+{
+	return m_level_offsets.empty() ? 0 : static_cast<unsigned>(m_level_offsets.size() - 1);
+}
+
+/// \brief Returns all gates ordered by level.
+const std::vector<Flat_id>& Levelizer::get_levelized_gates() const
+{
+	return m_levelized_gates;
+}
+
+/// \brief Returns the offsets of the levels in the levelized gates, gates of level l are in [offsets[l], offsets[l + 1]).
+const std::vector<Flat_id>& Levelizer::get_level_offsets() const
+{
+	return m_level_offsets;
+}
+
+/// \brief Returns the strongly connected component of each gate. Components are numbered in reverse topological order.
+const std::vector<Flat_id>& Levelizer::get_gate_components() const
+{
+	return m_gate_components;
+}
+
+/// \brief Returns the number of strongly connected components.
+size_t Levelizer::get_component_count() const
+{
+	return m_component_offsets.empty() ? 0 : m_component_offsets.size() - 1;
+}
+
+/// \brief Returns true if the netlist has combinational loops.
+bool Levelizer::has_loops() const
+{
+	return 0 != get_loop_count();
+}
+
+/// \brief Returns the number of combinational loops, i.e. components with more than one gate or a gate feeding itself.
+size_t Levelizer::get_loop_count() const
+{
+	return m_loop_offsets.empty() ? 0 : m_loop_offsets.size() - 1;
+}
+
+/// \brief Returns the offsets of the loops in the loop gates, gates of loop i are in [offsets[i], offsets[i + 1]).
+const std::vector<Flat_id>& Levelizer::get_loop_offsets() const
+{
+	return m_loop_offsets;
+}
+
+/// \brief Returns the gates of all loops, grouped by loop.
+const std::vector<Flat_id>& Levelizer::get_loop_gates() const
+{
+	return m_loop_gates;
+}
+
+/// \brief Finds the strongly connected components of the gate graph without recursion.
+void Levelizer::find_components()
+{
+	const std::vector<Flat_id>& outputs = m_netlist.get_gate_outputs();
+	const std::vector<Flat_id>& fanout_offsets = m_netlist.get_net_fanout_offsets();
+	const std::vector<Flat_id>& fanouts = m_netlist.get_net_fanouts();
+	size_t gate_count = m_netlist.get_gate_count();
+
+	std::vector<Flat_id> index(gate_count, not_visited);
+	std::vector<Flat_id> lowlink(gate_count, 0);
+	std::vector<bool> on_stack(gate_count, false);
+	std::vector<Flat_id> component_stack;
+	std::vector<Search_frame> call_stack;
+	m_gate_components.assign(gate_count, not_visited);
+
+	Flat_id next_index = 0;
+	Flat_id next_component = 0;
+	for (size_t root = 0; root < gate_count; ++root)
+	{
+		if (not_visited != index[root])
+		{
+			continue;
+		}
+
+		Search_frame frame = { static_cast<Flat_id>(root), 0 };
+		Flat_id output = outputs[root];
+		frame.next_fanout = (Flat_netlist::invalid_id == output) ? 0 : fanout_offsets[output];
+		call_stack.push_back(frame);
+		index[root] = lowlink[root] = next_index++;
+		component_stack.push_back(static_cast<Flat_id>(root));
+		on_stack[root] = true;
+
+		while (!call_stack.empty())
+		{
+			Search_frame& top = call_stack.back();
+			Flat_id gate = top.gate;
+			output = outputs[gate];
+			Flat_id fanout_end = (Flat_netlist::invalid_id == output) ? 0 : fanout_offsets[output + 1];
+
+			if (top.next_fanout < fanout_end)
+			{
+				Flat_id successor = fanouts[top.next_fanout++];
+				if (not_visited == index[successor])
+				{
+					index[successor] = lowlink[successor] = next_index++;
+					component_stack.push_back(successor);
+					on_stack[successor] = true;
+					Search_frame child = { successor, 0 };
+					Flat_id successor_output = outputs[successor];
+					child.next_fanout = (Flat_netlist::invalid_id == successor_output) ? 0 : fanout_offsets[successor_output];
+					call_stack.push_back(child);
+				}
+				else if (on_stack[successor] && index[successor] < lowlink[gate])
+				{
+					lowlink[gate] = index[successor];
+				}
+				continue;
+			}
+
+			// All fanouts visited, pop the component if the gate is its root.
+			call_stack.pop_back();
+			if (lowlink[gate] == index[gate])
+			{
+				Flat_id member;
+				do
+				{
+					member = component_stack.back();
+					component_stack.pop_back();
+					on_stack[member] = false;
+					m_gate_components[member] = next_component;
+				}
+				while (member != gate);
+				++next_component;
+			}
+			if (!call_stack.empty() && lowlink[gate] < lowlink[call_stack.back().gate])
+			{
+				lowlink[call_stack.back().gate] = lowlink[gate];
+			}
+		}
+	}
+	m_component_offsets.assign(next_component + 1, 0);
+}
+
+/// \brief Groups the gates by component and collects the loops.
+void Levelizer::collect_components()
+{
+	const std::vector<Flat_id>& outputs = m_netlist.get_gate_outputs();
+	const std::vector<Flat_id>& input_offsets = m_netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = m_netlist.get_gate_inputs();
+	size_t gate_count = m_netlist.get_gate_count();
+	size_t component_count = get_component_count();
+
+	for (size_t gate = 0; gate < gate_count; ++gate)
+	{
+		++m_component_offsets[m_gate_components[gate] + 1];
+	}
+	for (size_t component = 0; component < component_count; ++component)
+	{
+		m_component_offsets[component + 1] += m_component_offsets[component];
+	}
+	m_component_gates.resize(gate_count);
+	std::vector<Flat_id> positions(m_component_offsets.begin(), m_component_offsets.end() - 1);
+	for (size_t gate = 0; gate < gate_count; ++gate)
+	{
+		m_component_gates[positions[m_gate_components[gate]]++] = static_cast<Flat_id>(gate);
+	}
+
+	// A component is a loop if it has several gates, or its only gate reads its own output.
+	m_loop_offsets.assign(1, 0);
+	m_loop_gates.clear();
+	for (size_t component = 0; component < component_count; ++component)
+	{
+		Flat_id first = m_component_offsets[component];
+		Flat_id last = m_component_offsets[component + 1];
+		bool is_loop = (last - first > 1);
+		if (!is_loop)
+		{
+			Flat_id gate = m_component_gates[first];
+			for (Flat_id i = input_offsets[gate]; i < input_offsets[gate + 1] && !is_loop; ++i)
+			{
+				is_loop = (inputs[i] == outputs[gate]);
+			}
+		}
+		if (is_loop)
+		{
+			m_loop_gates.insert(m_loop_gates.end(), m_component_gates.begin() + first, m_component_gates.begin() + last);
+			m_loop_offsets.push_back(static_cast<Flat_id>(m_loop_gates.size()));
+		}
+	}
+}
+
+/// \brief Assigns the component levels in parallel wavefronts and orders the gates by level.
+void Levelizer::compute_levels()
+{
+	size_t gate_count = m_netlist.get_gate_count();
+	size_t component_count = get_component_count();
+
+	boost::scoped_array<boost::atomic<unsigned> > predecessors(new boost::atomic<unsigned>[component_count]);
+	for (size_t component = 0; component < component_count; ++component)
+	{
+		predecessors[component].store(0, boost::memory_order_relaxed);
+	}
+	Count_predecessors count = { &m_netlist, &m_gate_components, predecessors.get() };
+	Parallel::for_range(gate_count, count, m_thread_count);
+
+	std::vector<Flat_id> wavefront;
+	for (size_t component = 0; component < component_count; ++component)
+	{
+		if (0 == predecessors[component].load(boost::memory_order_relaxed))
+		{
+			wavefront.push_back(static_cast<Flat_id>(component));
+		}
+	}
+
+	// Every wavefront holds the components whose predecessors are all in the previous ones.
+	std::vector<unsigned> component_levels(component_count, 0);
+	std::vector<std::vector<Flat_id> > next_wavefronts(m_thread_count);
+	unsigned level_count = 0;
+	while (!wavefront.empty())
+	{
+		Advance_wavefront advance = { &m_netlist, &m_gate_components, &m_component_offsets, &m_component_gates,
+			&wavefront, predecessors.get(), &component_levels, &next_wavefronts, level_count };
+		Parallel::for_range(wavefront.size(), advance, m_thread_count);
+		++level_count;
+
+		wavefront.clear();
+		for (unsigned thread = 0; thread < m_thread_count; ++thread)
+		{
+			wavefront.insert(wavefront.end(), next_wavefronts[thread].begin(), next_wavefronts[thread].end());
+			next_wavefronts[thread].clear();
+		}
+	}
+
+	m_gate_levels.resize(gate_count);
+	Assign_gate_levels assign = { &m_gate_components, &component_levels, &m_gate_levels };
+	Parallel::for_range(gate_count, assign, m_thread_count);
+
+	// Counting sort of the gates by level.
+	m_level_offsets.assign(level_count + 1, 0);
+	for (size_t gate = 0; gate < gate_count; ++gate)
+	{
+		++m_level_offsets[m_gate_levels[gate] + 1];
+	}
+	for (unsigned level = 0; level < level_count; ++level)
+	{
+		m_level_offsets[level + 1] += m_level_offsets[level];
+	}
+	m_levelized_gates.resize(gate_count);
+	std::vector<Flat_id> positions(m_level_offsets.begin(), m_level_offsets.end() - 1);
+	for (size_t gate = 0; gate < gate_count; ++gate)
+	{
+		m_levelized_gates[positions[m_gate_levels[gate]]++] = static_cast<Flat_id>(gate);
+	}
+}
+
@@ -0,0 +1,464 @@
+#include "lint_engine.hpp"
+#include "work_stealing_pool.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// Drivers and loads of a net of a module.
+	struct Net_connections
+	{
+		/// Driving ports and pins as (instance name, pin name), the instance name is NULL for ports.
+		std::vector<std::pair<const std::string*, const std::string*> > drivers;
+
+		/// Number of loads.
+		size_t load_count;
+
+		/// True if a pin of unknown direction (undefined module or inout) is connected.
+		bool has_unknown;
+	};
+
+	/// \brief Returns true if the instance is neither a built-in primitive nor an instance of a known module.
+	bool is_undefined(const Module_instance& instance)
+	{
+		return !instance.has_description() && PRIMITIVE_NONE == instance.get_primitive_type();
+	}
+
+	/** \brief Collects the drivers and loads of all nets of the module from its ports and instance pins.
+	 *	\param[in] module - The Module Description.
+	 *	\param[out] connections - Connections by net name.
+	 */
+	void collect_connections(const Module_description& module, std::map<std::string, Net_connections>& connections)
+	{
+		Net_connections empty = { std::vector<std::pair<const std::string*, const std::string*> >(), 0, false };
+		const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+		for (std::map<std::string, boost::shared_ptr<Net> >::const_iterator I = nets.begin(); I != nets.end(); ++I)
+		{
+			Net_connections& net = connections.insert(connections.end(), std::make_pair(I->first, empty))->second;
+			if (I->second->is_constant())
+			{
+				// Literal constants are driven by their tie.
+				net.drivers.push_back(std::make_pair(static_cast<const std::string*>(0), &I->first));
+			}
+		}
+
+		// Input ports drive their nets from outside, output ports load them.
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = module.get_ports();
+		for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I = ports.begin(); I != ports.end(); ++I)
+		{
+			Net_connections& net = connections.insert(std::make_pair(module.get_canonical_net_name(I->first), empty)).first->second;
+			if (IN == I->second->get_type())
+			{
+				net.drivers.push_back(std::make_pair(static_cast<const std::string*>(0), &I->first));
+			}
+			else if (OUT == I->second->get_type())
+			{
+				++net.load_count;
+			}
+			else
+			{
+				net.has_unknown = true;
+			}
+		}
+
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+		for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+		{
+			bool is_unknown = is_undefined(*I->second);
+			const std::vector<Instance_port>& pins = I->second->get_ports();
+			for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end(); ++J)
+			{
+				if (J->get_net_name().empty())
+				{
+					continue;
+				}
+				Net_connections& net = connections.insert(std::make_pair(J->get_net_name(), empty)).first->second;
+				if (is_unknown || INOUT == J->get_type())
+				{
+					net.has_unknown = true;
+				}
+				else if (OUT == J->get_type())
+				{
+					net.drivers.push_back(std::make_pair(&I->first, &J->get_name()));
+				}
+				else
+				{
+					++net.load_count;
+				}
+			}
+		}
+	}
+
+	/// \brief Appends a violation.
+	void report(std::vector<Lint_violation>& violations, const std::string& rule, const Module_description& module, const std::string& object, const std::string& message)
+	{
+		Lint_violation violation = { rule, module.get_name(), object, message };
+		violations.push_back(violation);
+	}
+
+	/// Reports nets with more than one driver.
+	class Multiple_drivers_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "multiple-drivers";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			std::map<std::string, Net_connections> connections;
+			collect_connections(module, connections);
+			for (std::map<std::string, Net_connections>::const_iterator I = connections.begin(); I != connections.end(); ++I)
+			{
+				if (I->second.drivers.size() > 1)
+				{
+					std::ostringstream message;
+					message << "net has " << I->second.drivers.size() << " drivers:";
+					for (size_t i = 0; i < I->second.drivers.size(); ++i)
+					{
+						message << " ";
+						if (0 != I->second.drivers[i].first)
+						{
+							message << *I->second.drivers[i].first << "/";
+						}
+						message << *I->second.drivers[i].second;
+					}
+					report(violations, get_name(), module, I->first, message.str());
+				}
+			}
+		}
+	};
+
+	/// Reports nets with loads but without a driver.
+	class Undriven_net_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "undriven-net";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			std::map<std::string, Net_connections> connections;
+			collect_connections(module, connections);
+			for (std::map<std::string, Net_connections>::const_iterator I = connections.begin(); I != connections.end(); ++I)
+			{
+				if (I->second.drivers.empty() && 0 != I->second.load_count && !I->second.has_unknown)
+				{
+					report(violations, get_name(), module, I->first, "net has loads but no driver");
+				}
+			}
+		}
+	};
+
+	/// Reports nets without loads. Unused literal constants are not reported.
+	class Floating_net_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "floating-net";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			std::map<std::string, Net_connections> connections;
+			collect_connections(module, connections);
+			for (std::map<std::string, Net_connections>::const_iterator I = connections.begin(); I != connections.end(); ++I)
+			{
+				if (0 == I->second.load_count && !I->second.has_unknown && CONSTANT_NONE == Net::parse_constant(I->first))
+				{
+					report(violations, get_name(), module, I->first, I->second.drivers.empty() ? "net is not connected" : "net has no loads");
+				}
+			}
+		}
+	};
+
+	/// Reports instance inputs without a net, including master input ports missing on the instance.
+	class Unconnected_input_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "unconnected-input";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+			for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+			{
+				const Module_instance& instance = *I->second;
+				if (is_undefined(instance))
+				{
+					continue;
+				}
+				const std::vector<Instance_port>& pins = instance.get_ports();
+				for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end(); ++J)
+				{
+					if (OUT != J->get_type() && J->get_net_name().empty())
+					{
+						report(violations, get_name(), module, I->first + "/" + J->get_name(), "input pin is not connected");
+					}
+				}
+				if (!instance.has_description())
+				{
+					continue;
+				}
+				const std::map<std::string, boost::shared_ptr<Module_port> >& ports = instance.get_module_description().get_ports();
+				for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator K = ports.begin(); K != ports.end(); ++K)
+				{
+					if (OUT == K->second->get_type())
+					{
+						continue;
+					}
+					bool is_found = false;
+					for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end() && !is_found; ++J)
+					{
+						is_found = (K->first == J->get_name());
+					}
+					if (!is_found)
+					{
+						report(violations, get_name(), module, I->first + "/" + K->first, "input pin is missing");
+					}
+				}
+			}
+		}
+	};
+
+	/// Reports instances whose pins do not match the ports of their master.
+	class Pin_count_mismatch_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "pin-count-mismatch";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+			for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+			{
+				const Module_instance& instance = *I->second;
+				if (!instance.has_description())
+				{
+					continue;
+				}
+				const std::vector<Instance_port>& pins = instance.get_ports();
+				const std::map<std::string, boost::shared_ptr<Module_port> >& ports = instance.get_module_description().get_ports();
+				if (pins.size() != ports.size())
+				{
+					std::ostringstream message;
+					message << "instance has " << pins.size() << " pins, master " << instance.get_description_name() << " has " << ports.size() << " ports";
+					report(violations, get_name(), module, I->first, message.str());
+				}
+				for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end(); ++J)
+				{
+					if (ports.end() == ports.find(J->get_name()))
+					{
+						report(violations, get_name(), module, I->first + "/" + J->get_name(), "pin is not a port of master " + instance.get_description_name());
+					}
+				}
+			}
+		}
+	};
+
+	/// Reports instances of modules that are neither primitives nor in the Netlist.
+	class Undefined_module_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "undefined-module";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+			for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+			{
+				if (is_undefined(*I->second))
+				{
+					report(violations, get_name(), module, I->first, "master " + I->second->get_description_name() + " is not defined");
+				}
+			}
+		}
+	};
+
+	/// Reports nets that were used without being declared.
+	class Implicit_net_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "implicit-net";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+			for (std::map<std::string, boost::shared_ptr<Net> >::const_iterator I = nets.begin(); I != nets.end(); ++I)
+			{
+				if (I->second->is_implicit())
+				{
+					report(violations, get_name(), module, I->first, "net is not declared");
+				}
+			}
+		}
+	};
+}
+
+/// \brief Destructor.
+Lint_rule::~Lint_rule()
+{
+}
+
+/** \brief Constructor with the built-in rules.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Lint_engine::Lint_engine(unsigned thread_count)
+	: m_thread_count( thread_count )
+{
+	m_rules.push_back(boost::shared_ptr<Lint_rule>(new Multiple_drivers_rule()));
+	m_rules.push_back(boost::shared_ptr<Lint_rule>(new Undriven_net_rule()));
+	m_rules.push_back(boost::shared_ptr<Lint_rule>(new Floating_net_rule()));
+	m_rules.push_back(boost::shared_ptr<Lint_rule>(new Unconnected_input_rule()));
+	m_rules.push_back(boost::shared_ptr<Lint_rule>(new Pin_count_mismatch_rule()));
+	m_rules.push_back(boost::shared_ptr<Lint_rule>(new Undefined_module_rule()));
+	m_rules.push_back(boost::shared_ptr<Lint_rule>(new Implicit_net_rule()));
+}
+
+/** \brief Adds a rule. Throws if a rule with the same name exists.
+ *	\param[in] rule - The rule.
+ */
+void Lint_engine::add_rule(const boost::shared_ptr<Lint_rule>& rule)
+{
+	std::string name = rule->get_name();
+	for (std::vector<boost::shared_ptr<Lint_rule> >::const_iterator I = m_rules.begin(); I != m_rules.end(); ++I)
+	{
+		if (name == (*I)->get_name())
+		{
+			throw std::string("Lint rule already exists: " + name);
+		}
+	}
+	m_rules.push_back(rule);
+}
+
+/** \brief Removes the rule with the given name.
+ *	\param[in] name - Name of the rule.
+ *	\ret True if the rule existed.
+ */
+bool Lint_engine::remove_rule(const std::string& name)
+{
+	for (std::vector<boost::shared_ptr<Lint_rule> >::iterator I = m_rules.begin(); I != m_rules.end(); ++I)
+	{
+		if (name == (*I)->get_name())
+		{
+			m_rules.erase(I);
+			return true;
+		}
+	}
+	return false;
+}
+
+/// \brief Returns the names of the rules in the order they run.
+std::vector<std::string> Lint_engine::get_rule_names() const
+{
+	std::vector<std::string> names;
+	for (std::vector<boost::shared_ptr<Lint_rule> >::const_iterator I = m_rules.begin(); I != m_rules.end(); ++I)
+	{
+		names.push_back((*I)->get_name());
+	}
+	return names;
+}
+
+/** \brief Runs all rules on all Module Descriptions. Rethrows the first string thrown by a rule.
+ *	\param[in] netlist - The Netlist, nets must already be connected.
+ *	\ret The violations ordered by module name, then by rule.
+ */
+std::vector<Lint_violation> Lint_engine::run(const Netlist& netlist) const
+{
+	Work_stealing_pool pool(m_thread_count);
+	std::vector<std::vector<Lint_violation> > buffers(pool.get_thread_count());
+	std::vector<std::vector<size_t> > module_indices(pool.get_thread_count());
+	const std::map< std::string, boost::shared_ptr<Module_description> >& modules = netlist.get_modules();
+	size_t index = 0;
+	for (std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator I = modules.begin(); I != modules.end(); ++I, ++index)
+	{
+		if (0 != I->second)
+		{
+			pool.submit(boost::bind(&Lint_engine::check_module, this, I->second.get(), index, &buffers, &module_indices, _1));
+		}
+	}
+	pool.wait();
+
+	// A module is checked by one worker, so ordering by module keeps the order of its violations.
+	typedef boost::tuple<size_t, unsigned, size_t> Position;
+	std::vector<Position> positions;
+	for (unsigned worker = 0; worker < buffers.size(); ++worker)
+	{
+		for (size_t i = 0; i < buffers[worker].size(); ++i)
+		{
+			positions.push_back(Position(module_indices[worker][i], worker, i));
+		}
+	}
+	std::sort(positions.begin(), positions.end());
+	std::vector<Lint_violation> violations;
+	violations.reserve(positions.size());
+	for (std::vector<Position>::const_iterator I = positions.begin(); I != positions.end(); ++I)
+	{
+		violations.push_back(buffers[I->get<1>()][I->get<2>()]);
+	}
+	return violations;
+}
+
+/** \brief Writes the violations, one tab-separated line per violation.
+ *	\param[in] violations - The violations.
+ *	\param[in,out] stream - Output stream.
+ */
+void Lint_engine::write(const std::vector<Lint_violation>& violations, std::ostream& stream)
+{
+	for (std::vector<Lint_violation>::const_iterator I = violations.begin(); I != violations.end(); ++I)
+	{
+		stream << I->rule << '\t' << I->module << '\t' << I->object << '\t' << I->message << '\n';
+	}
+}
+
+/** \brief Checks one module with all rules.
+ *	\param[in] module - The Module Description.
+ *	\param[in] index - Index of the module in the Netlist order.
+ *	\param[in,out] buffers - Violations of the workers.
+ *	\param[in,out] module_indices - Module indices of the buffered violations.
+ *	\param[in] worker - Index of the worker.
+ */
+void Lint_engine::check_module(const Module_description* module, size_t index, std::vector<std::vector<Lint_violation> >* buffers, std::vector<std::vector<size_t> >* module_indices, unsigned worker) const
+{
+	std::vector<Lint_violation>& buffer = (*buffers)[worker];
+	for (std::vector<boost::shared_ptr<Lint_rule> >::const_iterator I = m_rules.begin(); I != m_rules.end(); ++I)
+	{
+		(*I)->check(*module, buffer);
+	}
+	(*module_indices)[worker].resize(buffer.size(), index);
+}
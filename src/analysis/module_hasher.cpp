@@ -0,0 +1,691 @@
+#include "module_hasher.hpp"
+#include "module_scheduler.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// Seeds separating the kinds of hashed items.
+	const Module_hasher::Hash internal_net_seed = 0x6a09e667f3bcc908ull;
+	const Module_hasher::Hash constant_net_seed = 0x510e527fade682d1ull;
+	const Module_hasher::Hash unconnected_seed = 0xbb67ae8584caa73bull;
+	const Module_hasher::Hash primitive_seed = 0x3c6ef372fe94f82bull;
+	const Module_hasher::Hash undefined_seed = 0xa54ff53a5f1d36f1ull;
+
+	/// Marks unconnected instance pins, unmapped nets and instances without a hashed master.
+	const size_t unconnected = ~size_t(0);
+
+	/// \brief Scrambles the bits of a hash.
+	Module_hasher::Hash mix(Module_hasher::Hash hash)
+	{
+		hash ^= hash >> 30;
+		hash *= 0xbf58476d1ce4e5b9ull;
+		hash ^= hash >> 27;
+		hash *= 0x94d049bb133111ebull;
+		return hash ^ (hash >> 31);
+	}
+
+	/// \brief Combines two hashes, the order matters.
+	Module_hasher::Hash combine(Module_hasher::Hash first, Module_hasher::Hash second)
+	{
+		return mix(first ^ (second + 0x9e3779b97f4a7c15ull + (first << 6) + (first >> 2)));
+	}
+
+	/// \brief Returns the hash of a string.
+	Module_hasher::Hash hash_string(const std::string& text)
+	{
+		Module_hasher::Hash hash = 0xcbf29ce484222325ull;
+		for (std::string::const_iterator I = text.begin(); I != text.end(); ++I)
+		{
+			hash = (hash ^ static_cast<unsigned char>(*I)) * 0x100000001b3ull;
+		}
+		return mix(hash);
+	}
+
+	/// \brief Returns the number of distinct labels.
+	size_t count_classes(const std::vector<Module_hasher::Hash>& labels)
+	{
+		std::vector<Module_hasher::Hash> sorted(labels);
+		std::sort(sorted.begin(), sorted.end());
+		return std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+	}
+}
+
+/// Nets, instances and labels of a module, as hashed.
+struct Module_hasher::Module_graph
+{
+	/// A pin of an instance with its name, hashed name and the index of its net.
+	struct Pin
+	{
+		const std::string* name;
+		Hash name_hash;
+		size_t net;
+
+		/// \brief Orders the pins of an instance by name.
+		bool operator<(const Pin& other) const
+		{
+			return *name < *other.name;
+		}
+	};
+
+	/// Names and types of the ports, ordered by name.
+	std::vector<std::pair<std::string, int> > ports;
+
+	/// Hashes of the port names and types.
+	std::vector<Hash> port_labels;
+
+	/// Index of the net of each port.
+	std::vector<size_t> port_nets;
+
+	/// Labels of the nets.
+	std::vector<Hash> net_labels;
+
+	/// Constant values of the nets.
+	std::vector<LogicConstant> net_constants;
+
+	/// Instances and their hashed masters.
+	std::vector<const Module_instance*> instances;
+	std::vector<Hash> masters;
+
+	/// Index of the master of each instance in the hashed modules, unconnected for primitives and unhashed masters.
+	std::vector<size_t> master_indices;
+
+	/// Pins of each instance, from pin_offsets[i] to pin_offsets[i + 1], ordered by name.
+	std::vector<size_t> pin_offsets;
+	std::vector<Pin> pins;
+
+	/// Labels of the instances.
+	std::vector<Hash> instance_labels;
+
+	/// Indices of the nets by name.
+	std::map<std::string, size_t> net_indices;
+
+	/** \brief Returns the index of the named net, adds it if it is new. Constant nets are labelled by their value.
+	 *	\param[in] name - Canonical name of the net.
+	 *	\param[in] label - Initial label of a non constant net.
+	 */
+	size_t get_net_index(const std::string& name, Hash label)
+	{
+		std::map<std::string, size_t>::iterator found = net_indices.find(name);
+		if (net_indices.end() != found)
+		{
+			return found->second;
+		}
+		LogicConstant constant = Net::parse_constant(name);
+		net_indices.insert(std::make_pair(name, net_labels.size()));
+		net_labels.push_back((CONSTANT_NONE == constant) ? label : combine(constant_net_seed, constant));
+		net_constants.push_back(constant);
+		return net_labels.size() - 1;
+	}
+};
+
+/** \brief Constructor, hashes all Module Descriptions of the Netlist. Throws if a module instantiates itself.
+ *	\param[in] netlist - The Netlist, instances must already point to their Module Descriptions.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Module_hasher::Module_hasher(const Netlist& netlist, unsigned thread_count)
+	: m_thread_count( thread_count )
+{
+	Module_scheduler scheduler(netlist);
+	m_modules = scheduler.get_modules();
+	for (size_t i = 0; i < m_modules.size(); ++i)
+	{
+		m_indices.insert(std::make_pair(m_modules[i], i));
+	}
+	m_module_hashes.assign(m_modules.size(), 0);
+	scheduler.run(boost::bind(&Module_hasher::hash_scheduled_module, this, _1), Module_scheduler::BOTTOM_UP, m_thread_count);
+
+	for (size_t i = 0; i < m_modules.size(); ++i)
+	{
+		m_hashes[m_modules[i]->get_name()] = m_module_hashes[i];
+	}
+}
+
+/// \brief Returns the hashes of the Module Descriptions by name.
+const std::map<std::string, Module_hasher::Hash>& Module_hasher::get_hashes() const
+{
+	return m_hashes;
+}
+
+/** \brief Returns the hash of the Module Description. Throws if the module is not in the hashed Netlist.
+ *	\param[in] name - Name of the Module Description.
+ */
+Module_hasher::Hash Module_hasher::get_hash(const std::string& name) const
+{
+	std::map<std::string, Hash>::const_iterator found = m_hashes.find(name);
+	if (m_hashes.end() == found)
+	{
+		throw std::string("Module is not hashed: " + name);
+	}
+	return found->second;
+}
+
+/// \brief Returns the groups of structurally identical Module Descriptions, the names in each group are sorted.
+std::vector<std::vector<std::string> > Module_hasher::find_identical_modules() const
+{
+	std::map<Hash, std::vector<std::string> > candidates;
+	std::map<std::string, Hash>::const_iterator I;
+	for (I = m_hashes.begin(); I != m_hashes.end(); ++I)
+	{
+		candidates[I->second].push_back(I->first);
+	}
+
+	// Modules with equal hashes are split into the classes that match exactly.
+	std::vector<std::vector<std::string> > identical;
+	Match_cache cache;
+	std::map<Hash, std::vector<std::string> >::const_iterator J;
+	for (J = candidates.begin(); J != candidates.end(); ++J)
+	{
+		std::vector<std::vector<std::string> > classes;
+		std::vector<std::string>::const_iterator K;
+		for (K = J->second.begin(); K != J->second.end(); ++K)
+		{
+			size_t index = get_index(*K);
+			std::vector<std::vector<std::string> >::iterator L = classes.begin();
+			while (classes.end() != L && !match_modules(*this, get_index(L->front()), *this, index, cache))
+			{
+				++L;
+			}
+			if (classes.end() == L)
+			{
+				classes.push_back(std::vector<std::string>(1, *K));
+			}
+			else
+			{
+				L->push_back(*K);
+			}
+		}
+		for (std::vector<std::vector<std::string> >::const_iterator L = classes.begin(); L != classes.end(); ++L)
+		{
+			if (L->size() > 1)
+			{
+				identical.push_back(*L);
+			}
+		}
+	}
+	return identical;
+}
+
+/** \brief Returns the sorted names of the modules that differ between two hashed Netlists:
+ *	modules that exist only in one of them or whose hashes differ.
+ *	\param[in] first - Hashes of the first Netlist.
+ *	\param[in] second - Hashes of the second Netlist.
+ */
+std::vector<std::string> Module_hasher::find_changed_modules(const Module_hasher& first, const Module_hasher& second)
+{
+	std::vector<std::string> changed;
+	std::map<std::string, Hash>::const_iterator I = first.m_hashes.begin();
+	std::map<std::string, Hash>::const_iterator J = second.m_hashes.begin();
+	while (first.m_hashes.end() != I || second.m_hashes.end() != J)
+	{
+		if (second.m_hashes.end() == J || (first.m_hashes.end() != I && I->first < J->first))
+		{
+			changed.push_back((I++)->first);
+		}
+		else if (first.m_hashes.end() == I || J->first < I->first)
+		{
+			changed.push_back((J++)->first);
+		}
+		else
+		{
+			if (I->second != J->second || !is_same_structure(first, I->first, second, J->first))
+			{
+				changed.push_back(I->first);
+			}
+			++I;
+			++J;
+		}
+	}
+	return changed;
+}
+
+/** \brief Returns true if two hashed Module Descriptions have the same structure: equal ports, and a one-to-one mapping
+ *	of their instances and nets that keeps the masters, the pins and the connectivity. The masters are compared recursively.
+ *	\param[in] first - Hashes of the Netlist of the first module.
+ *	\param[in] first_name - Name of the first module.
+ *	\param[in] second - Hashes of the Netlist of the second module.
+ *	\param[in] second_name - Name of the second module.
+ */
+bool Module_hasher::is_same_structure(const Module_hasher& first, const std::string& first_name, const Module_hasher& second, const std::string& second_name)
+{
+	Match_cache cache;
+	return match_modules(first, first.get_index(first_name), second, second.get_index(second_name), cache);
+}
+
+/** \brief Replaces structurally identical Module Descriptions by the first one of their group and removes the others.
+ *	\param[in,out] netlist - The Netlist.
+ *	\param[in] thread_count - Number of threads to use for hashing, 0 for the hardware thread count.
+ *	\ret The number of removed Module Descriptions.
+ */
+size_t Module_hasher::merge_identical_modules(Netlist& netlist, unsigned thread_count)
+{
+	std::vector<std::vector<std::string> > groups = Module_hasher(netlist, thread_count).find_identical_modules();
+	std::map<std::string, boost::shared_ptr<Module_description> > replacements;
+	std::vector<std::vector<std::string> >::const_iterator I;
+	for (I = groups.begin(); I != groups.end(); ++I)
+	{
+		boost::shared_ptr<Module_description> kept = netlist.get_module(I->front());
+		for (size_t i = 1; i < I->size(); ++i)
+		{
+			replacements[(*I)[i]] = kept;
+		}
+	}
+	if (replacements.empty())
+	{
+		return 0;
+	}
+
+	const std::map< std::string, boost::shared_ptr<Module_description> >& modules = netlist.get_modules();
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator J;
+	for (J = modules.begin(); J != modules.end(); ++J)
+	{
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = J->second->get_module_instances();
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator K;
+		for (K = instances.begin(); K != instances.end(); ++K)
+		{
+			std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator found = replacements.find(K->second->get_description_name());
+			if (K->second->has_description() && replacements.end() != found)
+			{
+				K->second->set_module_description(*found->second);
+			}
+		}
+	}
+
+	std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator L;
+	for (L = replacements.begin(); L != replacements.end(); ++L)
+	{
+		netlist.remove_module(L->first);
+	}
+	return replacements.size();
+}
+
+/** \brief Hashes one module, run by the Module Scheduler after its submodules.
+ *	\param[in] index - Index of the module.
+ */
+void Module_hasher::hash_scheduled_module(size_t index)
+{
+	m_module_hashes[index] = hash_module(index);
+}
+
+/** \brief Computes the hash of one module, the hashes of its masters must be known.
+ *	\param[in] index - Index of the module.
+ */
+Module_hasher::Hash Module_hasher::hash_module(size_t index) const
+{
+	Module_graph graph;
+	build_graph(index, graph);
+
+	Hash port_sum = 0;
+	for (size_t i = 0; i < graph.port_labels.size(); ++i)
+	{
+		port_sum += mix(combine(graph.port_labels[i], graph.net_labels[graph.port_nets[i]]));
+	}
+	Hash instance_sum = 0;
+	for (size_t i = 0; i < graph.instance_labels.size(); ++i)
+	{
+		instance_sum += mix(graph.instance_labels[i]);
+	}
+	Hash net_sum = 0;
+	for (size_t i = 0; i < graph.net_labels.size(); ++i)
+	{
+		net_sum += mix(graph.net_labels[i]);
+	}
+	return combine(combine(port_sum, instance_sum), net_sum);
+}
+
+/** \brief Builds the graph of one module and refines its labels, the hashes of its masters must be known.
+ *	\param[in] index - Index of the module.
+ *	\param[out] graph - The graph.
+ */
+void Module_hasher::build_graph(size_t index, Module_graph& graph) const
+{
+	const Module_description& module = *m_modules[index];
+
+	// Port nets start from their port name and type, constant nets from their value, all other nets start equal.
+	const std::map<std::string, boost::shared_ptr<Module_port> >& ports = module.get_ports();
+	std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I;
+	for (I = ports.begin(); I != ports.end(); ++I)
+	{
+		Hash name = combine(hash_string(I->first), I->second->get_type());
+		graph.ports.push_back(std::make_pair(I->first, static_cast<int>(I->second->get_type())));
+		graph.port_labels.push_back(name);
+		graph.port_nets.push_back(graph.get_net_index(module.get_canonical_net_name(I->first), name));
+	}
+	const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+	std::map<std::string, boost::shared_ptr<Net> >::const_iterator J;
+	for (J = nets.begin(); J != nets.end(); ++J)
+	{
+		graph.get_net_index(module.get_canonical_net_name(J->first), internal_net_seed);
+	}
+
+	// Masters and pins of the instances.
+	graph.pin_offsets.push_back(0);
+	const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator K;
+	for (K = instances.begin(); K != instances.end(); ++K)
+	{
+		const Module_instance& instance = *K->second;
+		Hash master = combine(undefined_seed, hash_string(instance.get_description_name()));
+		size_t master_index = unconnected;
+		if (PRIMITIVE_NONE != instance.get_primitive_type())
+		{
+			master = combine(primitive_seed, instance.get_primitive_type());
+		}
+		else if (instance.has_description())
+		{
+			std::map<const Module_description*, size_t>::const_iterator found = m_indices.find(&instance.get_module_description());
+			if (m_indices.end() != found)
+			{
+				master = m_module_hashes[found->second];
+				master_index = found->second;
+			}
+		}
+		graph.instances.push_back(&instance);
+		graph.masters.push_back(master);
+		graph.master_indices.push_back(master_index);
+
+		const std::vector<Instance_port>& instance_pins = instance.get_ports();
+		std::vector<Instance_port>::const_iterator L;
+		for (L = instance_pins.begin(); L != instance_pins.end(); ++L)
+		{
+			Module_graph::Pin pin = { &L->get_name(), hash_string(L->get_name()), unconnected };
+			if (!L->get_net_name().empty())
+			{
+				pin.net = graph.get_net_index(module.get_canonical_net_name(L->get_net_name()), internal_net_seed);
+			}
+			graph.pins.push_back(pin);
+		}
+		std::sort(graph.pins.begin() + graph.pin_offsets.back(), graph.pins.end());
+		graph.pin_offsets.push_back(graph.pins.size());
+	}
+
+	// Refine the labels from the neighbourhoods until the number of label classes stops growing,
+	// sums of mixed terms do not depend on the order. The bound only guards against hash collisions.
+	std::vector<Hash>& labels = graph.net_labels;
+	std::vector<Hash>& instance_labels = graph.instance_labels;
+	const std::vector<Module_graph::Pin>& pins = graph.pins;
+	const std::vector<size_t>& pin_offsets = graph.pin_offsets;
+	instance_labels.assign(graph.masters.size(), 0);
+	std::vector<Hash> net_sums(labels.size());
+	size_t class_count = count_classes(labels);
+	for (size_t round = 0; round <= labels.size() + instance_labels.size(); ++round)
+	{
+		std::fill(net_sums.begin(), net_sums.end(), 0);
+		for (size_t instance = 0; instance < instance_labels.size(); ++instance)
+		{
+			Hash sum = 0;
+			for (size_t i = pin_offsets[instance]; i < pin_offsets[instance + 1]; ++i)
+			{
+				sum += mix(combine(pins[i].name_hash, (unconnected == pins[i].net) ? unconnected_seed : labels[pins[i].net]));
+			}
+			instance_labels[instance] = combine(graph.masters[instance], sum);
+		}
+		for (size_t instance = 0; instance < instance_labels.size(); ++instance)
+		{
+			for (size_t i = pin_offsets[instance]; i < pin_offsets[instance + 1]; ++i)
+			{
+				if (unconnected != pins[i].net)
+				{
+					net_sums[pins[i].net] += mix(combine(instance_labels[instance], pins[i].name_hash));
+				}
+			}
+		}
+		for (size_t net = 0; net < labels.size(); ++net)
+		{
+			labels[net] = combine(labels[net], net_sums[net]);
+		}
+
+		size_t refined_count = count_classes(labels) + count_classes(instance_labels);
+		if (0 != round && refined_count == class_count)
+		{
+			break;
+		}
+		class_count = refined_count;
+	}
+}
+
+/** \brief Returns the index of a module, throws if it is not hashed.
+ *	\param[in] name - Name of the Module Description.
+ */
+size_t Module_hasher::get_index(const std::string& name) const
+{
+	for (size_t i = 0; i < m_modules.size(); ++i)
+	{
+		if (m_modules[i]->get_name() == name)
+		{
+			return i;
+		}
+	}
+	throw std::string("Module is not hashed: " + name);
+}
+
+/** \brief Returns true if two hashed modules have the same structure, see is_same_structure.
+ *	Instances are mapped by backtracking over the instances with equal labels, in the order they are reached from the ports.
+ *	\param[in] first - Hashes of the Netlist of the first module.
+ *	\param[in] first_index - Index of the first module.
+ *	\param[in] second - Hashes of the Netlist of the second module.
+ *	\param[in] second_index - Index of the second module.
+ *	\param[in,out] cache - Results of the comparisons already made.
+ */
+bool Module_hasher::match_modules(const Module_hasher& first, size_t first_index, const Module_hasher& second, size_t second_index, Match_cache& cache)
+{
+	std::pair<size_t, size_t> key(first_index, second_index);
+	Match_cache::const_iterator cached = cache.find(key);
+	if (cache.end() != cached)
+	{
+		return cached->second;
+	}
+	bool& is_match = cache[key];
+	is_match = false;
+	if (first.m_module_hashes[first_index] != second.m_module_hashes[second_index])
+	{
+		return false;
+	}
+
+	Module_graph a;
+	first.build_graph(first_index, a);
+	Module_graph b;
+	second.build_graph(second_index, b);
+	if (a.ports != b.ports || a.instances.size() != b.instances.size() || a.net_labels.size() != b.net_labels.size())
+	{
+		return false;
+	}
+	std::vector<std::pair<Hash, int> > a_nets;
+	std::vector<std::pair<Hash, int> > b_nets;
+	for (size_t i = 0; i < a.net_labels.size(); ++i)
+	{
+		a_nets.push_back(std::make_pair(a.net_labels[i], static_cast<int>(a.net_constants[i])));
+		b_nets.push_back(std::make_pair(b.net_labels[i], static_cast<int>(b.net_constants[i])));
+	}
+	std::sort(a_nets.begin(), a_nets.end());
+	std::sort(b_nets.begin(), b_nets.end());
+	if (a_nets != b_nets)
+	{
+		return false;
+	}
+
+	// Port nets are mapped by the port names.
+	std::vector<size_t> a_to_b(a.net_labels.size(), unconnected);
+	std::vector<size_t> b_to_a(b.net_labels.size(), unconnected);
+	for (size_t i = 0; i < a.port_nets.size(); ++i)
+	{
+		size_t a_net = a.port_nets[i];
+		size_t b_net = b.port_nets[i];
+		if (a.net_labels[a_net] != b.net_labels[b_net] || (unconnected != a_to_b[a_net] && b_net != a_to_b[a_net])
+			|| (unconnected != b_to_a[b_net] && a_net != b_to_a[b_net]))
+		{
+			return false;
+		}
+		a_to_b[a_net] = b_net;
+		b_to_a[b_net] = a_net;
+	}
+
+	// Instances of the first module in the order they are reached from the ports, so mapped nets constrain the next choices.
+	std::vector<std::vector<size_t> > net_instances(a.net_labels.size());
+	for (size_t instance = 0; instance < a.instances.size(); ++instance)
+	{
+		for (size_t i = a.pin_offsets[instance]; i < a.pin_offsets[instance + 1]; ++i)
+		{
+			if (unconnected != a.pins[i].net)
+			{
+				net_instances[a.pins[i].net].push_back(instance);
+			}
+		}
+	}
+	std::vector<size_t> order;
+	std::vector<bool> is_ordered(a.instances.size(), false);
+	std::vector<bool> is_net_visited(a.net_labels.size(), false);
+	std::vector<size_t> queue(a.port_nets);
+	for (size_t start = 0; order.size() < a.instances.size(); )
+	{
+		for (size_t next = 0; next < queue.size(); ++next)
+		{
+			size_t net = queue[next];
+			if (is_net_visited[net])
+			{
+				continue;
+			}
+			is_net_visited[net] = true;
+			for (std::vector<size_t>::const_iterator I = net_instances[net].begin(); I != net_instances[net].end(); ++I)
+			{
+				if (!is_ordered[*I])
+				{
+					is_ordered[*I] = true;
+					order.push_back(*I);
+					for (size_t i = a.pin_offsets[*I]; i < a.pin_offsets[*I + 1]; ++i)
+					{
+						if (unconnected != a.pins[i].net)
+						{
+							queue.push_back(a.pins[i].net);
+						}
+					}
+				}
+			}
+		}
+		queue.clear();
+		while (start < a.instances.size() && is_ordered[start])
+		{
+			++start;
+		}
+		if (start < a.instances.size())
+		{
+			is_ordered[start] = true;
+			order.push_back(start);
+			for (size_t i = a.pin_offsets[start]; i < a.pin_offsets[start + 1]; ++i)
+			{
+				if (unconnected != a.pins[i].net)
+				{
+					queue.push_back(a.pins[i].net);
+				}
+			}
+		}
+	}
+
+	std::map<Hash, std::vector<size_t> > candidates;
+	for (size_t instance = 0; instance < b.instances.size(); ++instance)
+	{
+		candidates[b.instance_labels[instance]].push_back(instance);
+	}
+
+	// Depth-first search over the instance mappings, the trail records the mapped nets to undo them on backtracking.
+	static const std::vector<size_t> no_candidates;
+	std::vector<size_t> choices(order.size() + 1, 0);
+	std::vector<size_t> chosen(order.size(), unconnected);
+	std::vector<size_t> trail_marks(order.size(), 0);
+	std::vector<size_t> trail;
+	std::vector<bool> is_used(b.instances.size(), false);
+	size_t depth = 0;
+	while (depth < order.size())
+	{
+		size_t a_instance = order[depth];
+		std::map<Hash, std::vector<size_t> >::const_iterator found = candidates.find(a.instance_labels[a_instance]);
+		const std::vector<size_t>& options = (candidates.end() == found) ? no_candidates : found->second;
+		bool is_placed = false;
+		while (!is_placed && choices[depth] < options.size())
+		{
+			size_t b_instance = options[choices[depth]++];
+			if (is_used[b_instance] || a.pin_offsets[a_instance + 1] - a.pin_offsets[a_instance] != b.pin_offsets[b_instance + 1] - b.pin_offsets[b_instance])
+			{
+				continue;
+			}
+			const Module_instance& a_master = *a.instances[a_instance];
+			const Module_instance& b_master = *b.instances[b_instance];
+			if (a_master.get_primitive_type() != b_master.get_primitive_type()
+				|| (unconnected == a.master_indices[a_instance]) != (unconnected == b.master_indices[b_instance])
+				|| (unconnected == a.master_indices[a_instance] && PRIMITIVE_NONE == a_master.get_primitive_type()
+					&& a_master.get_description_name() != b_master.get_description_name())
+				|| (unconnected != a.master_indices[a_instance]
+					&& !match_modules(first, a.master_indices[a_instance], second, b.master_indices[b_instance], cache)))
+			{
+				continue;
+			}
+
+			trail_marks[depth] = trail.size();
+			is_placed = true;
+			for (size_t i = a.pin_offsets[a_instance], j = b.pin_offsets[b_instance]; is_placed && i < a.pin_offsets[a_instance + 1]; ++i, ++j)
+			{
+				size_t a_net = a.pins[i].net;
+				size_t b_net = b.pins[j].net;
+				if (*a.pins[i].name != *b.pins[j].name || (unconnected == a_net) != (unconnected == b_net))
+				{
+					is_placed = false;
+				}
+				else if (unconnected == a_net || (unconnected != a_to_b[a_net] && b_net == a_to_b[a_net]))
+				{
+					continue;
+				}
+				else if (unconnected == a_to_b[a_net] && unconnected == b_to_a[b_net]
+					&& a.net_labels[a_net] == b.net_labels[b_net] && a.net_constants[a_net] == b.net_constants[b_net])
+				{
+					a_to_b[a_net] = b_net;
+					b_to_a[b_net] = a_net;
+					trail.push_back(a_net);
+				}
+				else
+				{
+					is_placed = false;
+				}
+			}
+			if (is_placed)
+			{
+				is_used[b_instance] = true;
+				chosen[depth] = b_instance;
+			}
+			else
+			{
+				for (; trail.size() > trail_marks[depth]; trail.pop_back())
+				{
+					b_to_a[a_to_b[trail.back()]] = unconnected;
+					a_to_b[trail.back()] = unconnected;
+				}
+			}
+		}
+
+		if (is_placed)
+		{
+			choices[++depth] = 0;
+			continue;
+		}
+		if (0 == depth)
+		{
+			return false;
+		}
+		--depth;
+		is_used[chosen[depth]] = false;
+		for (; trail.size() > trail_marks[depth]; trail.pop_back())
+		{
+			b_to_a[a_to_b[trail.back()]] = unconnected;
+			a_to_b[trail.back()] = unconnected;
+		}
+	}
+	is_match = true;
+	return true;
+}
@@ -0,0 +1,124 @@
+#ifndef MODULE_HASHER_HPP
+#define MODULE_HASHER_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+class Netlist;
+class Module_description;
+
+/** \brief Class for computing canonical structural (Merkle) hashes of the Module Descriptions of a Netlist.
+ *	The hash of a module depends on its port names and types, the hashes of the masters of its instances,
+ *	the pin names and the connectivity, but not on the names of the module, its nets and its instances.
+ *	Constant nets are labelled by their value. Nets and instances are labelled by neighbourhood refinement
+ *	until the partition into label classes is stable, so the labels do not depend on the declaration order.
+ *	Modules are hashed bottom-up in parallel by the Module Scheduler.
+ *	Equal hashes only select candidates: identical and unchanged modules are confirmed by an exact structural match.
+ */
+class Module_hasher
+{
+public:
+
+	/// Type of the hashes.
+	typedef boost::uint64_t Hash;
+
+	/** \brief Constructor, hashes all Module Descriptions of the Netlist. Throws if a module instantiates itself.
+	 *	\param[in] netlist - The Netlist, instances must already point to their Module Descriptions.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Module_hasher(const Netlist& netlist, unsigned thread_count = 0);
+
+	/// \brief Returns the hashes of the Module Descriptions by name.
+	const std::map<std::string, Hash>& get_hashes() const;
+
+	/** \brief Returns the hash of the Module Description. Throws if the module is not in the hashed Netlist.
+	 *	\param[in] name - Name of the Module Description.
+	 */
+	Hash get_hash(const std::string& name) const;
+
+	/// \brief Returns the groups of structurally identical Module Descriptions, the names in each group are sorted.
+	std::vector<std::vector<std::string> > find_identical_modules() const;
+
+	/** \brief Returns the sorted names of the modules that differ between two hashed Netlists:
+	 *	modules that exist only in one of them or that do not match structurally.
+	 *	\param[in] first - Hashes of the first Netlist.
+	 *	\param[in] second - Hashes of the second Netlist.
+	 */
+	static std::vector<std::string> find_changed_modules(const Module_hasher& first, const Module_hasher& second);
+
+	/** \brief Replaces structurally identical Module Descriptions by the first one of their group and removes the others.
+	 *	\param[in,out] netlist - The Netlist.
+	 *	\param[in] thread_count - Number of threads to use for hashing, 0 for the hardware thread count.
+	 *	\ret The number of removed Module Descriptions.
+	 */
+	static size_t merge_identical_modules(Netlist& netlist, unsigned thread_count = 0);
+
+	/** \brief Returns true if two hashed Module Descriptions have the same structure: equal ports, and a one-to-one mapping
+	 *	of their instances and nets that keeps the masters, the pins and the connectivity. The masters are compared recursively.
+	 *	\param[in] first - Hashes of the Netlist of the first module.
+	 *	\param[in] first_name - Name of the first module.
+	 *	\param[in] second - Hashes of the Netlist of the second module.
+	 *	\param[in] second_name - Name of the second module.
+	 */
+	static bool is_same_structure(const Module_hasher& first, const std::string& first_name, const Module_hasher& second, const std::string& second_name);
+
+private:
+
+	/// Nets, instances and labels of a module, as hashed.
+	struct Module_graph;
+
+	/// Results of the structural comparisons of pairs of modules, by module indices.
+	typedef std::map<std::pair<size_t, size_t>, bool> Match_cache;
+
+	/** \brief Hashes one module, run by the Module Scheduler after its submodules.
+	 *	\param[in] index - Index of the module.
+	 */
+	void hash_scheduled_module(size_t index);
+
+	/** \brief Computes the hash of one module, the hashes of its masters must be known.
+	 *	\param[in] index - Index of the module.
+	 */
+	Hash hash_module(size_t index) const;
+
+	/** \brief Builds the graph of one module and refines its labels, the hashes of its masters must be known.
+	 *	\param[in] index - Index of the module.
+	 *	\param[out] graph - The graph.
+	 */
+	void build_graph(size_t index, Module_graph& graph) const;
+
+	/** \brief Returns the index of a module, throws if it is not hashed.
+	 *	\param[in] name - Name of the Module Description.
+	 */
+	size_t get_index(const std::string& name) const;
+
+	/** \brief Returns true if two hashed modules have the same structure, see is_same_structure.
+	 *	\param[in] first - Hashes of the Netlist of the first module.
+	 *	\param[in] first_index - Index of the first module.
+	 *	\param[in] second - Hashes of the Netlist of the second module.
+	 *	\param[in] second_index - Index of the second module.
+	 *	\param[in,out] cache - Results of the comparisons already made.
+	 */
+	static bool match_modules(const Module_hasher& first, size_t first_index, const Module_hasher& second, size_t second_index, Match_cache& cache);
+
+private:
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// The Module Descriptions.
+	std::vector<const Module_description*> m_modules;
+
+	/// Indices of the Module Descriptions.
+	std::map<const Module_description*, size_t> m_indices;
+
+	/// Hashes of the modules by index.
+	std::vector<Hash> m_module_hashes;
+
+	/// Hashes of the modules by name.
+	std::map<std::string, Hash> m_hashes;
+
+};
+
+#endif // MODULE_HASHER_HPP
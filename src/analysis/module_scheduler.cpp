@@ -0,0 +1,254 @@
+#include "module_scheduler.hpp"
+#include "work_stealing_pool.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+
+#include <algorithm>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_array.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// State shared by the tasks of one run.
+	struct Schedule
+	{
+		/// The user task.
+		const Module_scheduler::Task* task;
+
+		/// Offsets of the modules depending on each module.
+		const std::vector<size_t>* dependent_offsets;
+
+		/// Modules depending on each module.
+		const std::vector<size_t>* dependents;
+
+		/// Number of unfinished dependencies of each module.
+		boost::atomic<size_t>* pending;
+
+		/// The pool running the modules.
+		Work_stealing_pool* pool;
+	};
+
+	/** \brief Runs the task on a module, then submits the dependents it made ready.
+	 *	\param[in] schedule - The run state.
+	 *	\param[in] module - Index of the module.
+	 *	\param[in] worker - Index of the worker.
+	 */
+	void run_module(const Schedule* schedule, size_t module, unsigned worker)
+	{
+		(*schedule->task)(module, worker);
+		for (size_t i = (*schedule->dependent_offsets)[module]; i < (*schedule->dependent_offsets)[module + 1]; ++i)
+		{
+			size_t dependent = (*schedule->dependents)[i];
+			if (1 == schedule->pending[dependent].fetch_sub(1, boost::memory_order_acq_rel))
+			{
+				schedule->pool->submit(boost::bind(&run_module, schedule, dependent, _1));
+			}
+		}
+	}
+}
+
+/** \brief Constructor, builds the dependency graph. Throws if a module instantiates itself.
+ *	\param[in] netlist - The Netlist, instances must already point to their Module Descriptions. Must outlive the scheduler.
+ */
+Module_scheduler::Module_scheduler(const Netlist& netlist)
+{
+	const std::map< std::string, boost::shared_ptr<Module_description> >& modules = netlist.get_modules();
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator I;
+	for (I = modules.begin(); I != modules.end(); ++I)
+	{
+		if (0 != I->second)
+		{
+			m_indices.insert(std::make_pair(I->second.get(), m_modules.size()));
+			m_modules.push_back(I->second.get());
+		}
+	}
+
+	// Distinct submodules of every module, instances of modules outside the Netlist are ignored.
+	m_child_offsets.assign(1, 0);
+	for (size_t i = 0; i < m_modules.size(); ++i)
+	{
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = m_modules[i]->get_module_instances();
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J;
+		for (J = instances.begin(); J != instances.end(); ++J)
+		{
+			if (J->second->has_description())
+			{
+				std::map<const Module_description*, size_t>::const_iterator found = m_indices.find(&J->second->get_module_description());
+				if (m_indices.end() != found)
+				{
+					m_children.push_back(found->second);
+				}
+			}
+		}
+		std::vector<size_t>::iterator first = m_children.begin() + m_child_offsets.back();
+		std::sort(first, m_children.end());
+		m_children.erase(std::unique(first, m_children.end()), m_children.end());
+		m_child_offsets.push_back(m_children.size());
+	}
+	order_modules();
+}
+
+/// \brief Returns the number of modules.
+size_t Module_scheduler::get_module_count() const
+{
+	return m_modules.size();
+}
+
+/// \brief Returns the Module Descriptions, in the order of the Netlist.
+const std::vector<const Module_description*>& Module_scheduler::get_modules() const
+{
+	return m_modules;
+}
+
+/** \brief Returns the index of the Module Description. Throws if the module is not in the Netlist.
+ *	\param[in] module - The Module Description.
+ */
+size_t Module_scheduler::get_index(const Module_description& module) const
+{
+	std::map<const Module_description*, size_t>::const_iterator found = m_indices.find(&module);
+	if (m_indices.end() == found)
+	{
+		throw std::string("Module is not scheduled: " + module.get_name());
+	}
+	return found->second;
+}
+
+/// \brief Returns the offsets of the submodules, distinct submodules of module i are in [offsets[i], offsets[i + 1]).
+const std::vector<size_t>& Module_scheduler::get_child_offsets() const
+{
+	return m_child_offsets;
+}
+
+/// \brief Returns the distinct submodules of all modules.
+const std::vector<size_t>& Module_scheduler::get_children() const
+{
+	return m_children;
+}
+
+/// \brief Returns the offsets of the parents, distinct modules instantiating module i are in [offsets[i], offsets[i + 1]).
+const std::vector<size_t>& Module_scheduler::get_parent_offsets() const
+{
+	return m_parent_offsets;
+}
+
+/// \brief Returns the distinct modules instantiating each module.
+const std::vector<size_t>& Module_scheduler::get_parents() const
+{
+	return m_parents;
+}
+
+/// \brief Returns the depths of the modules, 0 for modules without submodules.
+const std::vector<unsigned>& Module_scheduler::get_depths() const
+{
+	return m_depths;
+}
+
+/** \brief Runs the task once on every module, a module only after the modules it depends on.
+ *	Rethrows the first string thrown by a task, the modules depending on a failed module are not run.
+ *	\param[in] task - The task, called from the worker threads.
+ *	\param[in] direction - Order of the modules.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+void Module_scheduler::run(const Task& task, Direction direction, unsigned thread_count) const
+{
+	// Bottom-up a module waits for its children and releases its parents, top-down the other way round.
+	const std::vector<size_t>& dependency_offsets = (BOTTOM_UP == direction) ? m_child_offsets : m_parent_offsets;
+	size_t module_count = m_modules.size();
+	boost::scoped_array<boost::atomic<size_t> > pending(new boost::atomic<size_t>[module_count]);
+	for (size_t i = 0; i < module_count; ++i)
+	{
+		pending[i].store(dependency_offsets[i + 1] - dependency_offsets[i], boost::memory_order_relaxed);
+	}
+
+	Work_stealing_pool pool(thread_count);
+	Schedule schedule = { &task, (BOTTOM_UP == direction) ? &m_parent_offsets : &m_child_offsets, (BOTTOM_UP == direction) ? &m_parents : &m_children, pending.get(), &pool };
+	for (size_t i = 0; i < module_count; ++i)
+	{
+		if (dependency_offsets[i + 1] == dependency_offsets[i])
+		{
+			pool.submit(boost::bind(&run_module, &schedule, i, _1));
+		}
+	}
+	pool.wait();
+}
+
+/// \brief Fills the parents from the children and computes the depths. Throws if a module instantiates itself.
+void Module_scheduler::order_modules()
+{
+	size_t module_count = m_modules.size();
+	m_parent_offsets.assign(module_count + 1, 0);
+	for (std::vector<size_t>::const_iterator I = m_children.begin(); I != m_children.end(); ++I)
+	{
+		++m_parent_offsets[*I + 1];
+	}
+	for (size_t i = 0; i < module_count; ++i)
+	{
+		m_parent_offsets[i + 1] += m_parent_offsets[i];
+	}
+	m_parents.resize(m_children.size());
+	std::vector<size_t> positions(m_parent_offsets.begin(), m_parent_offsets.end() - 1);
+	for (size_t module = 0; module < module_count; ++module)
+	{
+		for (size_t i = m_child_offsets[module]; i < m_child_offsets[module + 1]; ++i)
+		{
+			m_parents[positions[m_children[i]]++] = module;
+		}
+	}
+
+	// Kahn's algorithm from the leaves, the depth of a module is known once all its children are done.
+	std::vector<size_t> pending(module_count);
+	std::vector<size_t> ready;
+	m_depths.assign(module_count, 0);
+	for (size_t module = 0; module < module_count; ++module)
+	{
+		pending[module] = m_child_offsets[module + 1] - m_child_offsets[module];
+		if (0 == pending[module])
+		{
+			ready.push_back(module);
+		}
+	}
+	size_t done_count = 0;
+	while (!ready.empty())
+	{
+		size_t module = ready.back();
+		ready.pop_back();
+		++done_count;
+		for (size_t i = m_parent_offsets[module]; i < m_parent_offsets[module + 1]; ++i)
+		{
+			size_t parent = m_parents[i];
+			m_depths[parent] = std::max(m_depths[parent], m_depths[module] + 1);
+			if (0 == --pending[parent])
+			{
+				ready.push_back(parent);
+			}
+		}
+	}
+	if (done_count == module_count)
+	{
+		return;
+	}
+
+	// Walk down the unfinished modules until one repeats, it lies on a cycle.
+	size_t module = 0;
+	while (0 == pending[module])
+	{
+		++module;
+	}
+	std::vector<char> is_visited(module_count, 0);
+	while (!is_visited[module])
+	{
+		is_visited[module] = 1;
+		for (size_t i = m_child_offsets[module]; i < m_child_offsets[module + 1]; ++i)
+		{
+			if (0 != pending[m_children[i]])
+			{
+				module = m_children[i];
+				break;
+			}
+		}
+	}
+	throw std::string("Module instantiates itself: " + m_modules[module]->get_name());
+}
@@ -0,0 +1,101 @@
+#ifndef MODULE_SCHEDULER_HPP
+#define MODULE_SCHEDULER_HPP
+
+#include <map>
+#include <vector>
+#include <boost/function.hpp>
+
+class Netlist;
+class Module_description;
+
+/** \brief Class for running a task on every Module Description of a Netlist in hierarchy order.
+ *	The dependency graph of the modules is built from the instance to description edges. A module is
+ *	run as soon as the modules it depends on are finished: its submodules when running bottom-up,
+ *	the modules instantiating it when running top-down. Ready modules are run on a Work Stealing Pool,
+ *	a finished module puts its newly ready dependents on the deque of its own worker and idle workers
+ *	steal them, so both wide and deep hierarchies keep all workers busy.
+ */
+class Module_scheduler
+{
+public:
+
+	/// Order of the modules.
+	enum Direction
+	{
+		BOTTOM_UP,	///< Submodules before the modules instantiating them.
+		TOP_DOWN	///< Modules instantiating a module before the module.
+	};
+
+	/// Task run per module. The arguments are the index of the module in get_modules() and the index of the worker.
+	typedef boost::function<void (size_t, unsigned)> Task;
+
+	/** \brief Constructor, builds the dependency graph. Throws if a module instantiates itself.
+	 *	\param[in] netlist - The Netlist, instances must already point to their Module Descriptions. Must outlive the scheduler.
+	 */
+	Module_scheduler(const Netlist& netlist);
+
+	/// \brief Returns the number of modules.
+	size_t get_module_count() const;
+
+	/// \brief Returns the Module Descriptions, in the order of the Netlist.
+	const std::vector<const Module_description*>& get_modules() const;
+
+	/** \brief Returns the index of the Module Description. Throws if the module is not in the Netlist.
+	 *	\param[in] module - The Module Description.
+	 */
+	size_t get_index(const Module_description& module) const;
+
+	/// \brief Returns the offsets of the submodules, distinct submodules of module i are in [offsets[i], offsets[i + 1]).
+	const std::vector<size_t>& get_child_offsets() const;
+
+	/// \brief Returns the distinct submodules of all modules.
+	const std::vector<size_t>& get_children() const;
+
+	/// \brief Returns the offsets of the parents, distinct modules instantiating module i are in [offsets[i], offsets[i + 1]).
+	const std::vector<size_t>& get_parent_offsets() const;
+
+	/// \brief Returns the distinct modules instantiating each module.
+	const std::vector<size_t>& get_parents() const;
+
+	/// \brief Returns the depths of the modules, 0 for modules without submodules.
+	const std::vector<unsigned>& get_depths() const;
+
+	/** \brief Runs the task once on every module, a module only after the modules it depends on.
+	 *	Rethrows the first string thrown by a task, the modules depending on a failed module are not run.
+	 *	\param[in] task - The task, called from the worker threads.
+	 *	\param[in] direction - Order of the modules.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	void run(const Task& task, Direction direction, unsigned thread_count = 0) const;
+
+private:
+
+	/// \brief Fills the parents from the children and computes the depths. Throws if a module instantiates itself.
+	void order_modules();
+
+private:
+
+	/// The Module Descriptions.
+	std::vector<const Module_description*> m_modules;
+
+	/// Indices of the Module Descriptions.
+	std::map<const Module_description*, size_t> m_indices;
+
+	/// Offsets of the submodules.
+	std::vector<size_t> m_child_offsets;
+
+	/// Distinct submodules of the modules.
+	std::vector<size_t> m_children;
+
+	/// Offsets of the parents.
+	std::vector<size_t> m_parent_offsets;
+
+	/// Distinct parents of the modules.
+	std::vector<size_t> m_parents;
+
+	/// Depths of the modules.
+	std::vector<unsigned> m_depths;
+
+};
+
+#endif // MODULE_SCHEDULER_HPP
@@ -0,0 +1,373 @@
+#include "module_summary.hpp"
+#include "module_scheduler.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <set>
+#include <boost/bind.hpp>
+
+/// Maximal depth of paths crossing a combinational loop.
+const unsigned Module_summary::unbounded_depth = ~0u;
+
+/// Helper functions.
+namespace
+{
+	/// Marks unreached nets and nets outside the topological order.
+	const size_t no_position = ~size_t(0);
+
+	/// A combinational connection between two local nets of a module.
+	struct Local_edge
+	{
+		size_t from;
+		size_t to;
+		unsigned min_depth;
+		unsigned max_depth;
+
+		bool operator<(const Local_edge& other) const
+		{
+			return from < other.from;
+		}
+	};
+
+	/// \brief Adds two depths, unbounded depths stay unbounded.
+	unsigned add_depths(unsigned first, unsigned second)
+	{
+		return (Module_summary::unbounded_depth == first || Module_summary::unbounded_depth == second) ? Module_summary::unbounded_depth : first + second;
+	}
+
+	/// \brief Returns the index of the named local net, adds it if it is new.
+	size_t get_net_index(std::map<std::string, size_t>& indices, const std::string& name)
+	{
+		return indices.insert(std::make_pair(name, indices.size())).first->second;
+	}
+
+	/** \brief Computes the summary of a module from its primitives and the summaries of its submodules.
+	 *	\param[in] module - The Module Description.
+	 *	\param[in] submodules - Summaries of the masters of the instances in instance order, NULL for leaf instances.
+	 */
+	Module_summary summarize(const Module_description& module, const std::vector<const Module_summary*>& submodules)
+	{
+		Module_summary summary;
+		summary.has_loops = false;
+
+		// Nets of the ports by port index, aliased ports share their net.
+		std::map<std::string, size_t> net_indices;
+		std::vector<size_t> port_nets;
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = module.get_ports();
+		std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I;
+		for (I = ports.begin(); I != ports.end(); ++I)
+		{
+			port_nets.push_back(get_net_index(net_indices, module.get_canonical_net_name(I->first)));
+		}
+
+		// Primitives connect each input to their output, submodules connect the pins of their summary paths.
+		std::vector<Local_edge> edges;
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J;
+		size_t instance_index = 0;
+		for (J = instances.begin(); J != instances.end(); ++J, ++instance_index)
+		{
+			const Module_instance& instance = *J->second;
+			const std::vector<Instance_port>& pins = instance.get_ports();
+			const Module_summary* submodule = submodules[instance_index];
+			if (0 != submodule)
+			{
+				summary.has_loops |= submodule->has_loops;
+				std::map<std::string, size_t> pin_nets;
+				std::vector<Instance_port>::const_iterator K;
+				for (K = pins.begin(); K != pins.end(); ++K)
+				{
+					if (!K->get_net_name().empty())
+					{
+						pin_nets.insert(std::make_pair(K->get_name(), get_net_index(net_indices, K->get_net_name())));
+					}
+				}
+				std::vector<Port_path>::const_iterator L;
+				for (L = submodule->paths.begin(); L != submodule->paths.end(); ++L)
+				{
+					std::map<std::string, size_t>::const_iterator from = pin_nets.find(L->input);
+					std::map<std::string, size_t>::const_iterator to = pin_nets.find(L->output);
+					if (pin_nets.end() != from && pin_nets.end() != to)
+					{
+						Local_edge edge = { from->second, to->second, L->min_depth, L->max_depth };
+						edges.push_back(edge);
+					}
+				}
+			}
+			else if (PRIMITIVE_NONE != instance.get_primitive_type())
+			{
+				// The first connected output pin is the gate output, like in the Flat Netlist.
+				size_t output = no_position;
+				std::vector<size_t> inputs;
+				std::vector<Instance_port>::const_iterator K;
+				for (K = pins.begin(); K != pins.end(); ++K)
+				{
+					if (K->get_net_name().empty())
+					{
+						continue;
+					}
+					size_t net = get_net_index(net_indices, K->get_net_name());
+					if (OUT == K->get_type() && no_position == output)
+					{
+						output = net;
+					}
+					else
+					{
+						inputs.push_back(net);
+					}
+				}
+				for (size_t i = 0; i < inputs.size() && no_position != output; ++i)
+				{
+					Local_edge edge = { inputs[i], output, 1, 1 };
+					edges.push_back(edge);
+				}
+			}
+		}
+
+		// Edges grouped by source net.
+		size_t net_count = net_indices.size();
+		std::stable_sort(edges.begin(), edges.end());
+		std::vector<size_t> edge_offsets(net_count + 1, 0);
+		std::vector<size_t> in_degrees(net_count, 0);
+		for (std::vector<Local_edge>::const_iterator E = edges.begin(); E != edges.end(); ++E)
+		{
+			++edge_offsets[E->from + 1];
+			++in_degrees[E->to];
+		}
+		for (size_t net = 0; net < net_count; ++net)
+		{
+			edge_offsets[net + 1] += edge_offsets[net];
+		}
+
+		// Topological order of the nets, nets on or behind a loop stay out of it.
+		std::vector<size_t> order;
+		std::vector<size_t> positions(net_count, no_position);
+		for (size_t net = 0; net < net_count; ++net)
+		{
+			if (0 == in_degrees[net])
+			{
+				order.push_back(net);
+			}
+		}
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			positions[order[i]] = i;
+			for (size_t e = edge_offsets[order[i]]; e < edge_offsets[order[i] + 1]; ++e)
+			{
+				if (0 == --in_degrees[edges[e].to])
+				{
+					order.push_back(edges[e].to);
+				}
+			}
+		}
+		summary.has_loops |= (order.size() < net_count);
+
+		// Shortest paths from every input port by Dijkstra, longest paths along the topological order.
+		typedef std::pair<unsigned, size_t> Queued_net;
+		std::vector<unsigned> min_depths(net_count);
+		std::vector<unsigned> max_depths(net_count);
+		std::vector<char> is_reached(net_count);
+		size_t input = 0;
+		for (I = ports.begin(); I != ports.end(); ++I, ++input)
+		{
+			if (OUT == I->second->get_type())
+			{
+				continue;
+			}
+			std::fill(min_depths.begin(), min_depths.end(), Module_summary::unbounded_depth);
+			std::fill(is_reached.begin(), is_reached.end(), 0);
+			std::priority_queue<Queued_net, std::vector<Queued_net>, std::greater<Queued_net> > queue;
+			min_depths[port_nets[input]] = 0;
+			queue.push(Queued_net(0, port_nets[input]));
+			while (!queue.empty())
+			{
+				Queued_net top = queue.top();
+				queue.pop();
+				if (top.first != min_depths[top.second])
+				{
+					continue;
+				}
+				is_reached[top.second] = 1;
+				for (size_t e = edge_offsets[top.second]; e < edge_offsets[top.second + 1]; ++e)
+				{
+					unsigned depth = top.first + edges[e].min_depth;
+					if (depth < min_depths[edges[e].to])
+					{
+						min_depths[edges[e].to] = depth;
+						queue.push(Queued_net(depth, edges[e].to));
+					}
+				}
+			}
+
+			std::fill(max_depths.begin(), max_depths.end(), 0);
+			for (size_t i = positions[port_nets[input]]; i < order.size(); ++i)
+			{
+				size_t net = order[i];
+				if (!is_reached[net])
+				{
+					continue;
+				}
+				for (size_t e = edge_offsets[net]; e < edge_offsets[net + 1]; ++e)
+				{
+					max_depths[edges[e].to] = std::max(max_depths[edges[e].to], add_depths(max_depths[net], edges[e].max_depth));
+				}
+			}
+
+			size_t output = 0;
+			std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator O;
+			for (O = ports.begin(); O != ports.end(); ++O, ++output)
+			{
+				size_t net = port_nets[output];
+				if (IN == O->second->get_type() || output == input || !is_reached[net])
+				{
+					continue;
+				}
+				Port_path path = { I->first, O->first, min_depths[net], (no_position == positions[net]) ? Module_summary::unbounded_depth : max_depths[net] };
+				summary.paths.push_back(path);
+			}
+		}
+		return summary;
+	}
+}
+
+/** \brief Constructor.
+ *	\param[in] thread_count - Number of threads used by update(), 0 for the hardware thread count.
+ */
+Module_summary_cache::Module_summary_cache(unsigned thread_count)
+	: m_thread_count( thread_count ),
+	m_next_stamp( 1 ),
+	m_computed_count( 0 )
+{
+}
+
+/** \brief Returns the summary of the module, recomputing the stale summaries of the module and its submodules.
+ *	The reference stays valid until the summary is recomputed or dropped.
+ *	\param[in] module - The Module Description, instances must already point to their Module Descriptions.
+ */
+const Module_summary& Module_summary_cache::get_summary(const Module_description& module)
+{
+	// Depth first search without recursion, submodules are refreshed before the modules instantiating them.
+	typedef std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator Instance_iterator;
+	std::set<const Module_description*> done;
+	std::set<const Module_description*> in_progress;
+	std::vector<std::pair<const Module_description*, Instance_iterator> > stack;
+	in_progress.insert(&module);
+	stack.push_back(std::make_pair(&module, module.get_module_instances().begin()));
+	while (!stack.empty())
+	{
+		const Module_description* current = stack.back().first;
+		Instance_iterator& next = stack.back().second;
+		if (current->get_module_instances().end() != next)
+		{
+			const Module_instance& instance = *(next++)->second;
+			if (instance.has_description())
+			{
+				const Module_description* child = &instance.get_module_description();
+				if (in_progress.count(child))
+				{
+					throw std::string("Module instantiates itself: " + child->get_name());
+				}
+				if (!done.count(child))
+				{
+					in_progress.insert(child);
+					stack.push_back(std::make_pair(child, child->get_module_instances().begin()));
+				}
+			}
+			continue;
+		}
+		refresh(*current, m_entries[current]);
+		in_progress.erase(current);
+		done.insert(current);
+		stack.pop_back();
+	}
+	return m_entries[&module].summary;
+}
+
+/** \brief Recomputes the stale summaries of all modules of the Netlist bottom-up in parallel.
+ *	Throws if a module instantiates itself or a module outside the Netlist.
+ *	\param[in] netlist - The Netlist.
+ */
+void Module_summary_cache::update(const Netlist& netlist)
+{
+	// The entries are created up front, the workers only write the entries of their own modules.
+	Module_scheduler scheduler(netlist);
+	const std::vector<const Module_description*>& modules = scheduler.get_modules();
+	for (std::vector<const Module_description*>::const_iterator I = modules.begin(); I != modules.end(); ++I)
+	{
+		m_entries[*I];
+	}
+	scheduler.run(boost::bind(&Module_summary_cache::refresh_scheduled_module, this, &modules, _1), Module_scheduler::BOTTOM_UP, m_thread_count);
+}
+
+/** \brief Drops the summary of the module, to be called before the module is destroyed.
+ *	\param[in] module - The Module Description.
+ */
+void Module_summary_cache::invalidate(const Module_description& module)
+{
+	m_entries.erase(&module);
+}
+
+/// \brief Drops all summaries.
+void Module_summary_cache::clear()
+{
+	m_entries.clear();
+}
+
+/// \brief Returns the number of summaries computed since the construction.
+size_t Module_summary_cache::get_computed_count() const
+{
+	return m_computed_count.load();
+}
+
+/** \brief Recomputes the summary of the module if it is stale, the summaries of its submodules must be up to date.
+ *	\param[in] module - The Module Description.
+ *	\param[in,out] entry - Cache entry of the module.
+ */
+void Module_summary_cache::refresh(const Module_description& module, Entry& entry)
+{
+	// A summary is stale if its module changed or a submodule got a newer summary.
+	std::vector<const Module_summary*> submodules;
+	unsigned long newest_stamp = 0;
+	const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I;
+	for (I = instances.begin(); I != instances.end(); ++I)
+	{
+		if (!I->second->has_description())
+		{
+			submodules.push_back(0);
+			continue;
+		}
+		std::map<const Module_description*, Entry>::const_iterator found = m_entries.find(&I->second->get_module_description());
+		if (m_entries.end() == found || 0 == found->second.stamp)
+		{
+			throw std::string("Submodule is not summarized: " + I->second->get_description_name());
+		}
+		submodules.push_back(&found->second.summary);
+		newest_stamp = std::max(newest_stamp, found->second.stamp);
+	}
+	if (0 != entry.stamp && module.get_revision() == entry.revision && newest_stamp < entry.stamp)
+	{
+		return;
+	}
+
+	entry.summary = summarize(module, submodules);
+	entry.revision = module.get_revision();
+	entry.stamp = m_next_stamp.fetch_add(1);
+	++m_computed_count;
+}
+
+/** \brief Refreshes one module, run by the Module Scheduler after its submodules.
+ *	\param[in] modules - The scheduled Module Descriptions.
+ *	\param[in] index - Index of the module.
+ */
+void Module_summary_cache::refresh_scheduled_module(const std::vector<const Module_description*>* modules, size_t index)
+{
+	// The entry exists, so the lookup does not modify the map.
+	refresh(*(*modules)[index], m_entries.find((*modules)[index])->second);
+}
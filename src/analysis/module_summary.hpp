@@ -0,0 +1,123 @@
+#ifndef MODULE_SUMMARY_HPP
+#define MODULE_SUMMARY_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+
+class Netlist;
+class Module_description;
+
+/// A combinational path from an input port to an output port of a module.
+struct Port_path
+{
+	/// Name of the input (or inout) port.
+	std::string input;
+
+	/// Name of the output (or inout) port.
+	std::string output;
+
+	/// Smallest number of primitive gates on a path between the ports.
+	unsigned min_depth;
+
+	/// Largest number of primitive gates on a path between the ports, Module_summary::unbounded_depth if the path crosses a loop.
+	unsigned max_depth;
+};
+
+/// Abstract port to port connectivity of a Module Description.
+struct Module_summary
+{
+	/// Maximal depth of paths crossing a combinational loop.
+	static const unsigned unbounded_depth;
+
+	/// The paths, ordered by input then output port name.
+	std::vector<Port_path> paths;
+
+	/// True if the module or one of its submodules has a combinational loop.
+	bool has_loops;
+};
+
+/** \brief Class for computing and caching the port to port summaries of Module Descriptions.
+ *	The summary of a module is computed from its primitive instances and the summaries of its
+ *	submodules, which are treated as black boxes, so every master is traversed once. Primitive gates
+ *	have unit depth, instances of undefined modules cut the paths like the sequential boundaries
+ *	of the Depth Analyzer. A cached summary is recomputed when the revision of its module changes
+ *	or one of its submodules gets a newer summary.
+ */
+class Module_summary_cache
+{
+public:
+
+	/** \brief Constructor.
+	 *	\param[in] thread_count - Number of threads used by update(), 0 for the hardware thread count.
+	 */
+	Module_summary_cache(unsigned thread_count = 0);
+
+	/** \brief Returns the summary of the module, recomputing the stale summaries of the module and its submodules.
+	 *	The reference stays valid until the summary is recomputed or dropped.
+	 *	\param[in] module - The Module Description, instances must already point to their Module Descriptions.
+	 */
+	const Module_summary& get_summary(const Module_description& module);
+
+	/** \brief Recomputes the stale summaries of all modules of the Netlist bottom-up in parallel.
+	 *	Throws if a module instantiates itself or a module outside the Netlist.
+	 *	\param[in] netlist - The Netlist.
+	 */
+	void update(const Netlist& netlist);
+
+	/** \brief Drops the summary of the module, to be called before the module is destroyed.
+	 *	\param[in] module - The Module Description.
+	 */
+	void invalidate(const Module_description& module);
+
+	/// \brief Drops all summaries.
+	void clear();
+
+	/// \brief Returns the number of summaries computed since the construction.
+	size_t get_computed_count() const;
+
+private:
+
+	/// Cached summary of one module.
+	struct Entry
+	{
+		/// The summary.
+		Module_summary summary;
+
+		/// Revision of the module when the summary was computed.
+		unsigned long revision;
+
+		/// Order of the computation, larger for newer summaries, 0 if not computed.
+		unsigned long stamp;
+	};
+
+	/** \brief Recomputes the summary of the module if it is stale, the summaries of its submodules must be up to date.
+	 *	\param[in] module - The Module Description.
+	 *	\param[in,out] entry - Cache entry of the module.
+	 */
+	void refresh(const Module_description& module, Entry& entry);
+
+	/** \brief Refreshes one module, run by the Module Scheduler after its submodules.
+	 *	\param[in] modules - The scheduled Module Descriptions.
+	 *	\param[in] index - Index of the module.
+	 */
+	void refresh_scheduled_module(const std::vector<const Module_description*>* modules, size_t index);
+
+private:
+
+	/// Number of threads used by update().
+	unsigned m_thread_count;
+
+	/// Cached summaries by module.
+	std::map<const Module_description*, Entry> m_entries;
+
+	/// Stamp of the next computed summary.
+	boost::atomic<unsigned long> m_next_stamp;
+
+	/// Number of computed summaries.
+	boost::atomic<size_t> m_computed_count;
+
+};
+
+#endif // MODULE_SUMMARY_HPP
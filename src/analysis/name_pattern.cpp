@@ -0,0 +1,263 @@
+#include "name_pattern.hpp"
+
+#include <boost/regex.hpp>
+
+/// Helper functions.
+namespace
+{
+	/** \brief Returns the position of the bracket closing a bracket expression of a regular expression.
+	 *	\param[in] pattern - The regular expression.
+	 *	\param[in] begin - Position of the opening bracket.
+	 *	\ret The position of the closing bracket, the pattern size if the expression is not closed.
+	 */
+	size_t skip_bracket_expression(const std::string& pattern, size_t begin)
+	{
+		size_t i = begin + 1;
+		if (i < pattern.size() && '^' == pattern[i])
+		{
+			++i;
+		}
+		if (i < pattern.size() && ']' == pattern[i])
+		{
+			++i;
+		}
+		while (i < pattern.size() && ']' != pattern[i])
+		{
+			if ('\\' == pattern[i])
+			{
+				i += 2;
+				continue;
+			}
+			if ('[' == pattern[i] && i + 1 < pattern.size() && std::string::npos != std::string(":.=").find(pattern[i + 1]))
+			{
+				// Class names, collating elements and equivalence classes end with the same character and a bracket.
+				size_t end = pattern.find(std::string(1, pattern[i + 1]) + "]", i + 2);
+				i = (std::string::npos == end) ? pattern.size() : end + 2;
+				continue;
+			}
+			++i;
+		}
+		return (i < pattern.size()) ? i : pattern.size();
+	}
+}
+
+/** \brief Constructor, compiles the pattern. Throws if the pattern is not valid.
+ *	\param[in] pattern - The glob pattern or regular expression.
+ *	\param[in] is_regex - True if the pattern is a regular expression.
+ */
+Name_pattern::Name_pattern(const std::string& pattern, bool is_regex)
+	: m_pattern( pattern )
+	, m_is_literal( false )
+{
+	if (is_regex)
+	{
+		compile_regex(pattern);
+	}
+	else
+	{
+		compile_glob(pattern);
+	}
+}
+
+/** \brief Returns true if the whole name matches the pattern.
+ *	\param[in] name - The name.
+ */
+bool Name_pattern::match(const std::string& name) const
+{
+	if (0 != name.compare(0, m_prefix.size(), m_prefix))
+	{
+		return false;
+	}
+	if (m_is_literal)
+	{
+		return name.size() == m_prefix.size();
+	}
+	if (m_regex)
+	{
+		return boost::regex_match(name, *m_regex);
+	}
+
+	// Backtrack to the last star only, every star can absorb what the previous ones did.
+	size_t token = 0;
+	size_t position = m_prefix.size();
+	size_t star_token = std::string::npos;
+	size_t star_position = 0;
+	while (position < name.size())
+	{
+		if (token < m_tokens.size() && TOKEN_STAR == m_tokens[token].kind)
+		{
+			star_token = token++;
+			star_position = position;
+			continue;
+		}
+		if (token < m_tokens.size())
+		{
+			const Token& current = m_tokens[token];
+			unsigned char character = static_cast<unsigned char>(name[position]);
+			if (TOKEN_ANY == current.kind
+				|| (TOKEN_CHARACTER == current.kind && current.value == character)
+				|| (TOKEN_SET == current.kind && m_sets[current.value].test(character)))
+			{
+				++token;
+				++position;
+				continue;
+			}
+		}
+		if (std::string::npos == star_token)
+		{
+			return false;
+		}
+		token = star_token + 1;
+		position = ++star_position;
+	}
+	while (token < m_tokens.size() && TOKEN_STAR == m_tokens[token].kind)
+	{
+		++token;
+	}
+	return token == m_tokens.size();
+}
+
+/// \brief Returns the literal prefix of all names matching the pattern.
+const std::string& Name_pattern::get_prefix() const
+{
+	return m_prefix;
+}
+
+/// \brief Returns true if the pattern matches only its prefix.
+bool Name_pattern::is_literal() const
+{
+	return m_is_literal;
+}
+
+/// \brief Getter for the source pattern.
+const std::string& Name_pattern::get_pattern() const
+{
+	return m_pattern;
+}
+
+/** \brief Compiles a glob pattern into tokens.
+ *	\param[in] pattern - The glob pattern.
+ */
+void Name_pattern::compile_glob(const std::string& pattern)
+{
+	for (size_t i = 0; i < pattern.size(); ++i)
+	{
+		Token token = { TOKEN_CHARACTER, static_cast<unsigned char>(pattern[i]) };
+		if ('*' == pattern[i])
+		{
+			// Consecutive stars are one star.
+			if (!m_tokens.empty() && TOKEN_STAR == m_tokens.back().kind)
+			{
+				continue;
+			}
+			token.kind = TOKEN_STAR;
+		}
+		else if ('?' == pattern[i])
+		{
+			token.kind = TOKEN_ANY;
+		}
+		else if ('\\' == pattern[i] && i + 1 < pattern.size())
+		{
+			token.value = static_cast<unsigned char>(pattern[++i]);
+		}
+		else if ('[' == pattern[i])
+		{
+			// A ']' right after the bracket or the negation belongs to the set, an unclosed bracket is a literal.
+			size_t first = i + 1;
+			bool is_negated = first < pattern.size() && ('!' == pattern[first] || '^' == pattern[first]);
+			first += is_negated;
+			size_t last = pattern.find(']', first + 1);
+			if (first < pattern.size() && std::string::npos != last)
+			{
+				std::bitset<256> set;
+				for (size_t j = first; j < last; ++j)
+				{
+					unsigned char low = static_cast<unsigned char>(pattern[j]);
+					if ('\\' == pattern[j] && j + 1 < last)
+					{
+						low = static_cast<unsigned char>(pattern[++j]);
+					}
+					unsigned char high = low;
+					if (j + 2 < last && '-' == pattern[j + 1])
+					{
+						high = static_cast<unsigned char>(pattern[j + 2]);
+						j += 2;
+					}
+					for (unsigned character = low; character <= high; ++character)
+					{
+						set.set(character);
+					}
+				}
+				if (is_negated)
+				{
+					set.flip();
+				}
+				token.kind = TOKEN_SET;
+				token.value = static_cast<unsigned>(m_sets.size());
+				m_sets.push_back(set);
+				i = last;
+			}
+		}
+		m_tokens.push_back(token);
+	}
+
+	size_t literal_count = 0;
+	while (literal_count < m_tokens.size() && TOKEN_CHARACTER == m_tokens[literal_count].kind)
+	{
+		m_prefix += static_cast<char>(m_tokens[literal_count++].value);
+	}
+	m_is_literal = (literal_count == m_tokens.size());
+	m_tokens.erase(m_tokens.begin(), m_tokens.begin() + literal_count);
+}
+
+/** \brief Compiles a regular expression and extracts its literal prefix.
+ *	\param[in] pattern - The regular expression.
+ */
+void Name_pattern::compile_regex(const std::string& pattern)
+{
+	try
+	{
+		m_regex.reset(new boost::regex(pattern, boost::regex::perl));
+	}
+	catch (const boost::regex_error& error)
+	{
+		throw std::string("Invalid regular expression: " + pattern + ", " + error.what());
+	}
+
+	// Top level alternatives have no common prefix, a quantified character is not part of it.
+	// Escaped characters and bracket expressions are skipped, their parentheses and bars are literals.
+	int depth = 0;
+	for (size_t i = 0; i < pattern.size(); ++i)
+	{
+		if ('\\' == pattern[i])
+		{
+			++i;
+		}
+		else if ('[' == pattern[i])
+		{
+			i = skip_bracket_expression(pattern, i);
+		}
+		else if ('(' == pattern[i] || ')' == pattern[i])
+		{
+			depth += ('(' == pattern[i]) ? 1 : -1;
+		}
+		else if ('|' == pattern[i] && 0 == depth)
+		{
+			return;
+		}
+	}
+	const std::string special = "\\^$.[](){}*+?";
+	size_t end = pattern.find_first_of(special);
+	if (std::string::npos == end)
+	{
+		end = pattern.size();
+	}
+	else if (0 < end && std::string::npos != std::string("*?{").find(pattern[end]))
+	{
+		--end;
+	}
+
+	// The prefix only filters the names, the expression still matches the whole name.
+	m_prefix = pattern.substr(0, end);
+	m_is_literal = (end == pattern.size());
+}
@@ -0,0 +1,93 @@
+#ifndef NAME_PATTERN_HPP
+#define NAME_PATTERN_HPP
+
+#include <bitset>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/regex_fwd.hpp>
+
+/** \brief Class for a name pattern compiled once and matched against many names.
+ *	Glob patterns are compiled into a sequence of tokens: '*' matches any string, '?' any character, "[...]" a set of
+ *	characters with ranges ("[a-z]"), "[!...]" the characters not in the set, '\' escapes the next character.
+ *	Regular expressions use the Perl syntax and must match the whole name.
+ *	The literal prefix shared by all matching names is kept, so callers can skip names not starting with it.
+ */
+class Name_pattern
+{
+public:
+
+	/** \brief Constructor, compiles the pattern. Throws if the pattern is not valid.
+	 *	\param[in] pattern - The glob pattern or regular expression.
+	 *	\param[in] is_regex - True if the pattern is a regular expression.
+	 */
+	Name_pattern(const std::string& pattern, bool is_regex = false);
+
+	/** \brief Returns true if the whole name matches the pattern.
+	 *	\param[in] name - The name.
+	 */
+	bool match(const std::string& name) const;
+
+	/// \brief Returns the literal prefix of all names matching the pattern.
+	const std::string& get_prefix() const;
+
+	/// \brief Returns true if the pattern matches only its prefix.
+	bool is_literal() const;
+
+	/// \brief Getter for the source pattern.
+	const std::string& get_pattern() const;
+
+private:
+
+	/// Kinds of the glob tokens.
+	enum Token_kind
+	{
+		TOKEN_CHARACTER,
+		TOKEN_ANY,
+		TOKEN_STAR,
+		TOKEN_SET
+	};
+
+	/// Token of a compiled glob pattern.
+	struct Token
+	{
+		/// Kind of the token.
+		Token_kind kind;
+
+		/// Character of a character token, index of the set of a set token.
+		unsigned value;
+	};
+
+	/** \brief Compiles a glob pattern into tokens.
+	 *	\param[in] pattern - The glob pattern.
+	 */
+	void compile_glob(const std::string& pattern);
+
+	/** \brief Compiles a regular expression and extracts its literal prefix.
+	 *	\param[in] pattern - The regular expression.
+	 */
+	void compile_regex(const std::string& pattern);
+
+private:
+
+	/// The source pattern.
+	std::string m_pattern;
+
+	/// Literal prefix of the matching names.
+	std::string m_prefix;
+
+	/// True if the pattern matches only its prefix.
+	bool m_is_literal;
+
+	/// Tokens of a glob pattern.
+	std::vector<Token> m_tokens;
+
+	/// Character sets of the set tokens.
+	std::vector<std::bitset<256> > m_sets;
+
+	/// Compiled regular expression, NULL for a glob pattern.
+	boost::shared_ptr<boost::regex> m_regex;
+
+};
+
+#endif // NAME_PATTERN_HPP
@@ -0,0 +1,288 @@
+#include "netlist_diff.hpp"
+#include "work_stealing_pool.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <boost/bind.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// \brief Returns the name of the port type.
+	std::string get_type_name(PortType type)
+	{
+		switch (type)
+		{
+			case IN: return "input";
+			case OUT: return "output";
+			case INOUT: return "inout";
+		}
+		return "";
+	}
+
+	/// \brief Appends a change to the list.
+	void add_change(std::vector<Netlist_change>& changes, Netlist_change::Kind kind, Netlist_change::Object object,
+		const std::string& module, const std::string& name, const std::string& old_value, const std::string& new_value)
+	{
+		changes.push_back(Netlist_change());
+		Netlist_change& change = changes.back();
+		change.kind = kind;
+		change.object = object;
+		change.module = module;
+		change.name = name;
+		change.old_value = old_value;
+		change.new_value = new_value;
+	}
+
+	/// Value of a named object compared by the merge join, with its name.
+	struct Named_value
+	{
+		const std::string* name;
+		std::string value;
+
+		bool operator<(const Named_value& other) const
+		{
+			return *name < *other.name;
+		}
+	};
+
+	/** \brief Merge joins two name sorted lists and reports the added, removed and changed values.
+	 *	\param[in] first - Values in the first Netlist.
+	 *	\param[in] second - Values in the second Netlist.
+	 *	\param[in] object - Kind of the objects.
+	 *	\param[in] module - Name of the module.
+	 *	\param[in] prefix - Prefix of the object names.
+	 *	\param[out] changes - The change list.
+	 */
+	void diff_values(const std::vector<Named_value>& first, const std::vector<Named_value>& second, Netlist_change::Object object,
+		const std::string& module, const std::string& prefix, std::vector<Netlist_change>& changes)
+	{
+		std::vector<Named_value>::const_iterator I = first.begin();
+		std::vector<Named_value>::const_iterator J = second.begin();
+		while (first.end() != I || second.end() != J)
+		{
+			if (second.end() == J || (first.end() != I && *I < *J))
+			{
+				add_change(changes, Netlist_change::REMOVED, object, module, prefix + *I->name, I->value, "");
+				++I;
+			}
+			else if (first.end() == I || *J < *I)
+			{
+				add_change(changes, Netlist_change::ADDED, object, module, prefix + *J->name, "", J->value);
+				++J;
+			}
+			else
+			{
+				if (I->value != J->value)
+				{
+					add_change(changes, Netlist_change::CHANGED, object, module, prefix + *I->name, I->value, J->value);
+				}
+				++I;
+				++J;
+			}
+		}
+	}
+
+	/// \brief Collects the port names and types of a module, in name order.
+	void get_port_values(const Module_description& module, std::vector<Named_value>& values)
+	{
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = module.get_ports();
+		std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I;
+		for (I = ports.begin(); I != ports.end(); ++I)
+		{
+			Named_value value = { &I->first, get_type_name(I->second->get_type()) };
+			values.push_back(value);
+		}
+	}
+
+	/// \brief Collects the net names of a module, in name order.
+	void get_net_values(const Module_description& module, std::vector<Named_value>& values)
+	{
+		const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+		std::map<std::string, boost::shared_ptr<Net> >::const_iterator I;
+		for (I = nets.begin(); I != nets.end(); ++I)
+		{
+			Named_value value = { &I->first, "" };
+			values.push_back(value);
+		}
+	}
+
+	/// \brief Collects the pin names and the canonical names of their nets in the module, in pin name order.
+	void get_pin_values(const Module_description& module, const Module_instance& instance, std::vector<Named_value>& values)
+	{
+		const std::vector<Instance_port>& pins = instance.get_ports();
+		std::vector<Instance_port>::const_iterator I;
+		for (I = pins.begin(); I != pins.end(); ++I)
+		{
+			Named_value value = { &I->get_name(), module.get_canonical_net_name(I->get_written_net_name()) };
+			values.push_back(value);
+		}
+		std::sort(values.begin(), values.end());
+	}
+}
+
+/** \brief Constructor, compares the Netlists.
+ *	\param[in] first - The old Netlist.
+ *	\param[in] second - The new Netlist.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Netlist_diff::Netlist_diff(const Netlist& first, const Netlist& second, unsigned thread_count)
+{
+	// Match the modules by name, modules found only in one Netlist get an empty partner.
+	const std::map< std::string, boost::shared_ptr<Module_description> >& first_modules = first.get_modules();
+	const std::map< std::string, boost::shared_ptr<Module_description> >& second_modules = second.get_modules();
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator I = first_modules.begin();
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator J = second_modules.begin();
+	while (first_modules.end() != I || second_modules.end() != J)
+	{
+		if (second_modules.end() == J || (first_modules.end() != I && I->first < J->first))
+		{
+			m_common_modules.push_back(std::make_pair(I->second.get(), static_cast<const Module_description*>(0)));
+			++I;
+		}
+		else if (first_modules.end() == I || J->first < I->first)
+		{
+			m_common_modules.push_back(std::make_pair(static_cast<const Module_description*>(0), J->second.get()));
+			++J;
+		}
+		else
+		{
+			m_common_modules.push_back(std::make_pair(I->second.get(), J->second.get()));
+			++I;
+			++J;
+		}
+	}
+
+	// A module shared by both Netlists, as the unchanged modules of two published versions, is not compared.
+	m_module_changes.resize(m_common_modules.size());
+	Work_stealing_pool pool(thread_count);
+	for (size_t i = 0; i < m_common_modules.size(); ++i)
+	{
+		if (m_common_modules[i].first == m_common_modules[i].second)
+		{
+			continue;
+		}
+		pool.submit(boost::bind(&Netlist_diff::compare_modules, this, i));
+	}
+	pool.wait();
+
+	size_t change_count = 0;
+	for (size_t i = 0; i < m_module_changes.size(); ++i)
+	{
+		change_count += m_module_changes[i].size();
+	}
+	m_changes.reserve(change_count);
+	for (size_t i = 0; i < m_module_changes.size(); ++i)
+	{
+		m_changes.insert(m_changes.end(), m_module_changes[i].begin(), m_module_changes[i].end());
+		std::vector<Netlist_change>().swap(m_module_changes[i]);
+	}
+}
+
+/// \brief Returns the changes, ordered by module name.
+const std::vector<Netlist_change>& Netlist_diff::get_changes() const
+{
+	return m_changes;
+}
+
+/// \brief Returns true if the Netlists are equal.
+bool Netlist_diff::is_empty() const
+{
+	return m_changes.empty();
+}
+
+/** \brief Writes the changes one per line as tab separated fields: kind, object, module, name, old value, new value.
+ *	\param[in] stream - Stream to write to.
+ */
+void Netlist_diff::write(std::ostream& stream) const
+{
+	std::vector<Netlist_change>::const_iterator I;
+	for (I = m_changes.begin(); I != m_changes.end(); ++I)
+	{
+		stream << get_kind_name(I->kind) << "\t" << get_object_name(I->object) << "\t" << I->module << "\t"
+			<< I->name << "\t" << I->old_value << "\t" << I->new_value << "\n";
+	}
+}
+
+/// \brief Returns the name of the change kind.
+const char* Netlist_diff::get_kind_name(Netlist_change::Kind kind)
+{
+	static const char* names[] = { "added", "removed", "changed" };
+	return names[kind];
+}
+
+/// \brief Returns the name of the object kind.
+const char* Netlist_diff::get_object_name(Netlist_change::Object object)
+{
+	static const char* names[] = { "module", "port", "net", "instance", "pin" };
+	return names[object];
+}
+
+/** \brief Compares a module present in both Netlists.
+ *	\param[in] index - Index of the module pair.
+ */
+void Netlist_diff::compare_modules(size_t index)
+{
+	const Module_description* first = m_common_modules[index].first;
+	const Module_description* second = m_common_modules[index].second;
+	std::vector<Netlist_change>& changes = m_module_changes[index];
+	if (0 == first || 0 == second)
+	{
+		add_change(changes, (0 == first) ? Netlist_change::ADDED : Netlist_change::REMOVED, Netlist_change::MODULE,
+			(0 == first) ? second->get_name() : first->get_name(), "", "", "");
+		return;
+	}
+	const std::string& module = first->get_name();
+
+	std::vector<Named_value> first_values, second_values;
+	get_port_values(*first, first_values);
+	get_port_values(*second, second_values);
+	diff_values(first_values, second_values, Netlist_change::PORT, module, "", changes);
+
+	first_values.clear();
+	second_values.clear();
+	get_net_values(*first, first_values);
+	get_net_values(*second, second_values);
+	diff_values(first_values, second_values, Netlist_change::NET, module, "", changes);
+
+	// Instances are matched by name, pins are compared for instances found in both modules.
+	const std::map<std::string, boost::shared_ptr<Module_instance> >& first_instances = first->get_module_instances();
+	const std::map<std::string, boost::shared_ptr<Module_instance> >& second_instances = second->get_module_instances();
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = first_instances.begin();
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J = second_instances.begin();
+	while (first_instances.end() != I || second_instances.end() != J)
+	{
+		if (second_instances.end() == J || (first_instances.end() != I && I->first < J->first))
+		{
+			add_change(changes, Netlist_change::REMOVED, Netlist_change::INSTANCE, module, I->first, I->second->get_description_name(), "");
+			++I;
+		}
+		else if (first_instances.end() == I || J->first < I->first)
+		{
+			add_change(changes, Netlist_change::ADDED, Netlist_change::INSTANCE, module, J->first, "", J->second->get_description_name());
+			++J;
+		}
+		else
+		{
+			if (I->second->get_description_name() != J->second->get_description_name())
+			{
+				add_change(changes, Netlist_change::CHANGED, Netlist_change::INSTANCE, module, I->first,
+					I->second->get_description_name(), J->second->get_description_name());
+			}
+			first_values.clear();
+			second_values.clear();
+			get_pin_values(*first, *I->second, first_values);
+			get_pin_values(*second, *J->second, second_values);
+			diff_values(first_values, second_values, Netlist_change::PIN, module, I->first + "/", changes);
+			++I;
+			++J;
+		}
+	}
+}
+
@@ -0,0 +1,107 @@
+#ifndef NETLIST_DIFF_HPP
+#define NETLIST_DIFF_HPP
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class Netlist;
+class Module_description;
+
+/// A single difference between two Netlists.
+struct Netlist_change
+{
+	/// Kind of the change.
+	enum Kind
+	{
+		ADDED = 0,
+		REMOVED = 1,
+		CHANGED = 2
+	};
+
+	/// Kind of the changed object.
+	enum Object
+	{
+		MODULE = 0,
+		PORT = 1,
+		NET = 2,
+		INSTANCE = 3,
+		PIN = 4
+	};
+
+	/// Kind of the change.
+	Kind kind;
+
+	/// Kind of the changed object.
+	Object object;
+
+	/// Name of the Module Description containing the object, the module itself for module changes.
+	std::string module;
+
+	/// Name of the object in the module, "instance/pin" for pins, empty for modules.
+	std::string name;
+
+	/// Value in the first Netlist: port type, instance master or pin net. Empty for added objects.
+	std::string old_value;
+
+	/// Value in the second Netlist. Empty for removed objects.
+	std::string new_value;
+};
+
+/** \brief Class for comparing two Netlists.
+ *	Modules, ports, nets, instances and pins are matched by name with merge joins of the sorted name maps.
+ *	Modules present in both Netlists are compared in parallel on a Work Stealing Pool, every module into its
+ *	own change list, and the lists are concatenated in module name order so the result is deterministic.
+ *	Modules shared by both Netlists are skipped, so diffing two published versions walks only the copied modules.
+ *	Pins are compared by the canonical names of their nets, a pin moved to an alias of its net is not a change.
+ *	The contents of added or removed modules are not listed.
+ */
+class Netlist_diff
+{
+public:
+
+	/** \brief Constructor, compares the Netlists.
+	 *	\param[in] first - The old Netlist.
+	 *	\param[in] second - The new Netlist.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Netlist_diff(const Netlist& first, const Netlist& second, unsigned thread_count = 0);
+
+	/// \brief Returns the changes, ordered by module name.
+	const std::vector<Netlist_change>& get_changes() const;
+
+	/// \brief Returns true if the Netlists are equal.
+	bool is_empty() const;
+
+	/** \brief Writes the changes one per line as tab separated fields: kind, object, module, name, old value, new value.
+	 *	\param[in] stream - Stream to write to.
+	 */
+	void write(std::ostream& stream) const;
+
+	/// \brief Returns the name of the change kind.
+	static const char* get_kind_name(Netlist_change::Kind kind);
+
+	/// \brief Returns the name of the object kind.
+	static const char* get_object_name(Netlist_change::Object object);
+
+private:
+
+	/** \brief Compares a module present in both Netlists.
+	 *	\param[in] index - Index of the module pair.
+	 */
+	void compare_modules(size_t index);
+
+private:
+
+	/// Modules present in both Netlists.
+	std::vector<std::pair<const Module_description*, const Module_description*> > m_common_modules;
+
+	/// Changes of every module pair.
+	std::vector<std::vector<Netlist_change> > m_module_changes;
+
+	/// All changes.
+	std::vector<Netlist_change> m_changes;
+
+};
+
+#endif // NETLIST_DIFF_HPP
@@ -0,0 +1,57 @@
+#include "parallel.hpp"
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+/// \brief Returns the number of hardware threads, at least 1.
+unsigned Parallel::get_thread_count()
+{
+	unsigned count = boost::thread::hardware_concurrency();
+	return (0 == count) ? 1 : count;
+}
+
+/** \brief Splits the range [0, size) into contiguous chunks and runs the function on them in parallel.
+ *	Ranges smaller than the grain run on the calling thread. Each thread gets a single chunk, thread indices are in [0, thread_count).
+ *	\param[in] size - Size of the range.
+ *	\param[in] function - Function to call for every chunk.
+ *	\param[in] thread_count - Maximal number of threads to use, 0 for the hardware thread count.
+ *	\param[in] grain - Minimal number of elements processed by a thread.
+ */
+void Parallel::for_range(size_t size, const Range_function& function, unsigned thread_count, size_t grain)
+{
+	if (0 == size)
+	{
+		return;
+	}
+	if (0 == thread_count)
+	{
+		thread_count = get_thread_count();
+	}
+	if (0 == grain)
+	{
+		grain = 1;
+	}
+
+	size_t chunks = (size + grain - 1) / grain;
+	if (chunks < thread_count)
+	{
+		thread_count = static_cast<unsigned>(chunks);
+	}
+	if (thread_count <= 1)
+	{
+		function(0, size, 0);
+		return;
+	}
+
+	// The calling thread processes the last chunk itself.
+	size_t chunk_size = (size + thread_count - 1) / thread_count;
+	thread_count = static_cast<unsigned>((size + chunk_size - 1) / chunk_size);
+	boost::thread_group threads;
+	for (unsigned i = 0; i + 1 < thread_count; ++i)
+	{
+		threads.create_thread(boost::bind(function, i * chunk_size, (i + 1) * chunk_size, i));
+	}
+	function((thread_count - 1) * chunk_size, size, thread_count - 1);
+	threads.join_all();
+}
+
@@ -0,0 +1,793 @@
+#include "partitioner.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <queue>
+#include <boost/bind.hpp>
+
+/// Helper types and functions of the multilevel bisection.
+namespace
+{
+	/// Marks unmatched or unmapped vertices.
+	const Flat_id no_vertex = ~0u;
+
+	/// Coarsening stops below this number of vertices.
+	const size_t coarsest_vertex_count = 160;
+
+	/// Nets with more pins are ignored by the match ratings and the greedy growing, e.g. clocks and resets.
+	const size_t max_rated_net_size = 64;
+
+	/// Nets with more pins do not update the gains of their pins during refinement.
+	const size_t max_updated_net_size = 1024;
+
+	/// Number of greedy growing tries for the initial bisection.
+	const int initial_tries = 8;
+
+	/// Maximal number of refinement passes per level.
+	const int refinement_passes = 4;
+
+	/// Hypergraph with weighted vertices, nets kept as pin lists and vertices as net lists.
+	struct Hypergraph
+	{
+		/// Weights of the vertices.
+		std::vector<unsigned> vertex_weights;
+
+		/// Weights of the nets, the number of fine nets merged into each net.
+		std::vector<unsigned> net_weights;
+
+		/// Offsets of the net pins, pins of net i are in [offsets[i], offsets[i + 1]).
+		std::vector<Flat_id> net_offsets;
+
+		/// Pins of all nets.
+		std::vector<Flat_id> net_pins;
+
+		/// Offsets of the vertex nets.
+		std::vector<Flat_id> vertex_offsets;
+
+		/// Nets of all vertices.
+		std::vector<Flat_id> vertex_nets;
+
+		Hypergraph()
+			: net_offsets( 1, 0 )
+		{
+		}
+
+		size_t get_vertex_count() const
+		{
+			return vertex_weights.size();
+		}
+
+		size_t get_net_count() const
+		{
+			return net_offsets.size() - 1;
+		}
+
+		boost::uint64_t get_total_weight() const
+		{
+			boost::uint64_t total = 0;
+			for (size_t i = 0; i < vertex_weights.size(); ++i)
+			{
+				total += vertex_weights[i];
+			}
+			return total;
+		}
+
+		/// Adds a net, duplicate pins are removed and nets with less than two pins are dropped.
+		void add_net(std::vector<Flat_id>& pins, unsigned weight)
+		{
+			std::sort(pins.begin(), pins.end());
+			pins.erase(std::unique(pins.begin(), pins.end()), pins.end());
+			if (pins.size() >= 2)
+			{
+				net_weights.push_back(weight);
+				net_pins.insert(net_pins.end(), pins.begin(), pins.end());
+				net_offsets.push_back(static_cast<Flat_id>(net_pins.size()));
+			}
+		}
+
+		/// Fills the nets of the vertices from the pins of the nets.
+		void build_incidence()
+		{
+			vertex_offsets.assign(get_vertex_count() + 1, 0);
+			for (size_t i = 0; i < net_pins.size(); ++i)
+			{
+				++vertex_offsets[net_pins[i] + 1];
+			}
+			for (size_t vertex = 0; vertex < get_vertex_count(); ++vertex)
+			{
+				vertex_offsets[vertex + 1] += vertex_offsets[vertex];
+			}
+			vertex_nets.resize(net_pins.size());
+			std::vector<Flat_id> positions(vertex_offsets.begin(), vertex_offsets.end() - 1);
+			for (size_t net = 0; net < get_net_count(); ++net)
+			{
+				for (Flat_id i = net_offsets[net]; i < net_offsets[net + 1]; ++i)
+				{
+					vertex_nets[positions[net_pins[i]]++] = static_cast<Flat_id>(net);
+				}
+			}
+		}
+	};
+
+	/// \brief Returns the next number of a xorshift generator.
+	boost::uint64_t next_random(boost::uint64_t& state)
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 2685821657736338717ull;
+	}
+
+	/// Chooses for every vertex of a chunk the neighbour sharing the most small nets.
+	struct Rate_vertices
+	{
+		const Hypergraph* graph;
+		unsigned max_weight;
+		std::vector<Flat_id>* proposals;
+		std::vector<std::vector<double> >* scores;
+
+		void operator()(size_t begin, size_t end, unsigned thread) const
+		{
+			std::vector<double>& score = (*scores)[thread];
+			score.assign(graph->get_vertex_count(), 0);
+			std::vector<Flat_id> touched;
+			for (size_t vertex = begin; vertex < end; ++vertex)
+			{
+				touched.clear();
+				for (Flat_id i = graph->vertex_offsets[vertex]; i < graph->vertex_offsets[vertex + 1]; ++i)
+				{
+					Flat_id net = graph->vertex_nets[i];
+					size_t size = graph->net_offsets[net + 1] - graph->net_offsets[net];
+					if (size > max_rated_net_size)
+					{
+						continue;
+					}
+					for (Flat_id j = graph->net_offsets[net]; j < graph->net_offsets[net + 1]; ++j)
+					{
+						Flat_id other = graph->net_pins[j];
+						if (other != vertex)
+						{
+							if (0 == score[other])
+							{
+								touched.push_back(other);
+							}
+							score[other] += double(graph->net_weights[net]) / (size - 1);
+						}
+					}
+				}
+
+				Flat_id best = no_vertex;
+				std::vector<Flat_id>::const_iterator I;
+				for (I = touched.begin(); I != touched.end(); ++I)
+				{
+					if (graph->vertex_weights[vertex] + graph->vertex_weights[*I] <= max_weight
+						&& (no_vertex == best || score[*I] > score[best] || (score[*I] == score[best] && *I < best)))
+					{
+						best = *I;
+					}
+				}
+				for (I = touched.begin(); I != touched.end(); ++I)
+				{
+					score[*I] = 0;
+				}
+				(*proposals)[vertex] = best;
+			}
+		}
+	};
+
+	/// Orders nets by pin hash, then by index.
+	struct Hash_less
+	{
+		const std::vector<boost::uint64_t>* hashes;
+
+		bool operator()(Flat_id first, Flat_id second) const
+		{
+			return (*hashes)[first] < (*hashes)[second] || ((*hashes)[first] == (*hashes)[second] && first < second);
+		}
+	};
+
+	/** \brief Merges nets with the same pins into one net with the summed weight.
+	 *	\param[in,out] graph - The hypergraph, the incidence is not built yet.
+	 */
+	void merge_parallel_nets(Hypergraph& graph)
+	{
+		size_t net_count = graph.get_net_count();
+		std::vector<boost::uint64_t> hashes(net_count);
+		std::vector<Flat_id> order(net_count);
+		for (size_t net = 0; net < net_count; ++net)
+		{
+			boost::uint64_t hash = graph.net_offsets[net + 1] - graph.net_offsets[net];
+			for (Flat_id i = graph.net_offsets[net]; i < graph.net_offsets[net + 1]; ++i)
+			{
+				hash = (hash ^ graph.net_pins[i]) * 0x100000001b3ull;
+			}
+			hashes[net] = hash;
+			order[net] = static_cast<Flat_id>(net);
+		}
+		Hash_less hash_less = { &hashes };
+		std::sort(order.begin(), order.end(), hash_less);
+
+		// Every net is compared with the kept nets of its hash group.
+		std::vector<char> is_kept(net_count, 1);
+		for (size_t begin = 0, end = 0; begin < net_count; begin = end)
+		{
+			for (end = begin + 1; end < net_count && hashes[order[end]] == hashes[order[begin]]; ++end)
+			{
+			}
+			for (size_t i = begin + 1; i < end; ++i)
+			{
+				Flat_id net = order[i];
+				for (size_t j = begin; j < i; ++j)
+				{
+					Flat_id kept = order[j];
+					if (is_kept[kept] && std::equal(&graph.net_pins[graph.net_offsets[net]], &graph.net_pins[0] + graph.net_offsets[net + 1], &graph.net_pins[graph.net_offsets[kept]])
+						&& graph.net_offsets[net + 1] - graph.net_offsets[net] == graph.net_offsets[kept + 1] - graph.net_offsets[kept])
+					{
+						graph.net_weights[kept] += graph.net_weights[net];
+						is_kept[net] = 0;
+						break;
+					}
+				}
+			}
+		}
+
+		Hypergraph merged;
+		merged.vertex_weights.swap(graph.vertex_weights);
+		std::vector<Flat_id> pins;
+		for (size_t net = 0; net < net_count; ++net)
+		{
+			if (is_kept[net])
+			{
+				pins.assign(graph.net_pins.begin() + graph.net_offsets[net], graph.net_pins.begin() + graph.net_offsets[net + 1]);
+				merged.add_net(pins, graph.net_weights[net]);
+			}
+		}
+		std::swap(graph, merged);
+	}
+
+	/** \brief Coarsens a hypergraph by clustering every vertex with its best rated neighbour.
+	 *	\param[in] fine - The hypergraph to coarsen.
+	 *	\param[out] coarse - The coarse hypergraph.
+	 *	\param[out] map - Coarse vertex of every fine vertex.
+	 *	\param[in] max_weight - Maximal weight of a coarse vertex.
+	 *	\param[in,out] random - State of the random generator.
+	 *	\param[in] thread_count - Number of threads to use.
+	 */
+	void coarsen(const Hypergraph& fine, Hypergraph& coarse, std::vector<Flat_id>& map, unsigned max_weight, boost::uint64_t& random, unsigned thread_count)
+	{
+		size_t vertex_count = fine.get_vertex_count();
+		std::vector<Flat_id> proposals(vertex_count, no_vertex);
+		std::vector<std::vector<double> > scores((0 == thread_count) ? Parallel::get_thread_count() : thread_count);
+		Rate_vertices rate = { &fine, max_weight, &proposals, &scores };
+		Parallel::for_range(vertex_count, rate, thread_count, 1024);
+
+		// Vertices are visited in random order and join the cluster of their choice while it is light enough.
+		std::vector<Flat_id> order(vertex_count);
+		for (size_t i = 0; i < vertex_count; ++i)
+		{
+			order[i] = static_cast<Flat_id>(i);
+		}
+		for (size_t i = vertex_count; i > 1; --i)
+		{
+			std::swap(order[i - 1], order[next_random(random) % i]);
+		}
+		map.assign(vertex_count, no_vertex);
+		coarse = Hypergraph();
+		std::vector<Flat_id>::const_iterator I;
+		for (I = order.begin(); I != order.end(); ++I)
+		{
+			if (no_vertex != map[*I])
+			{
+				continue;
+			}
+			Flat_id other = proposals[*I];
+			if (no_vertex != other && no_vertex != map[other])
+			{
+				if (coarse.vertex_weights[map[other]] + fine.vertex_weights[*I] <= max_weight)
+				{
+					map[*I] = map[other];
+					coarse.vertex_weights[map[other]] += fine.vertex_weights[*I];
+					continue;
+				}
+				other = no_vertex;
+			}
+			Flat_id id = static_cast<Flat_id>(coarse.vertex_weights.size());
+			map[*I] = id;
+			coarse.vertex_weights.push_back(fine.vertex_weights[*I]);
+			if (no_vertex != other)
+			{
+				map[other] = id;
+				coarse.vertex_weights.back() += fine.vertex_weights[other];
+			}
+		}
+
+		std::vector<Flat_id> pins;
+		for (size_t net = 0; net < fine.get_net_count(); ++net)
+		{
+			pins.clear();
+			for (Flat_id i = fine.net_offsets[net]; i < fine.net_offsets[net + 1]; ++i)
+			{
+				pins.push_back(map[fine.net_pins[i]]);
+			}
+			coarse.add_net(pins, fine.net_weights[net]);
+		}
+		merge_parallel_nets(coarse);
+		coarse.build_incidence();
+	}
+
+	/** \brief Returns the weight of the nets with pins on both sides.
+	 *	\param[in] graph - The hypergraph.
+	 *	\param[in] sides - Side of every vertex.
+	 */
+	boost::uint64_t get_cut(const Hypergraph& graph, const std::vector<unsigned char>& sides)
+	{
+		boost::uint64_t cut = 0;
+		for (size_t net = 0; net < graph.get_net_count(); ++net)
+		{
+			for (Flat_id i = graph.net_offsets[net] + 1; i < graph.net_offsets[net + 1]; ++i)
+			{
+				if (sides[graph.net_pins[i]] != sides[graph.net_pins[graph.net_offsets[net]]])
+				{
+					cut += graph.net_weights[net];
+					break;
+				}
+			}
+		}
+		return cut;
+	}
+
+	/** \brief Returns true if the side weights respect the maximal weights.
+	 *	\param[in] graph - The hypergraph.
+	 *	\param[in] sides - Side of every vertex.
+	 *	\param[in] max_weights - Maximal weights of the sides.
+	 */
+	bool is_balanced(const Hypergraph& graph, const std::vector<unsigned char>& sides, const boost::uint64_t* max_weights)
+	{
+		boost::uint64_t weights[2] = { 0, 0 };
+		for (size_t vertex = 0; vertex < graph.get_vertex_count(); ++vertex)
+		{
+			weights[sides[vertex]] += graph.vertex_weights[vertex];
+		}
+		return weights[0] <= max_weights[0] && weights[1] <= max_weights[1];
+	}
+
+	/** \brief Changes the gain of a free vertex and queues it with the new gain.
+	 *	\param[in] vertex - The vertex.
+	 *	\param[in] delta - The change of the gain.
+	 *	\param[in,out] gains - Gains of all vertices.
+	 *	\param[in,out] queue - The gain queue.
+	 */
+	void update_gain(Flat_id vertex, long delta, std::vector<long>& gains, std::priority_queue<std::pair<long, Flat_id> >& queue)
+	{
+		gains[vertex] += delta;
+		queue.push(std::make_pair(gains[vertex], vertex));
+	}
+
+	/** \brief Improves a bisection with Fiduccia-Mattheyses passes: every pass moves the vertices of best gain once,
+	 *	respecting the maximal weights, and keeps the best prefix of the moves.
+	 *	\param[in] graph - The hypergraph.
+	 *	\param[in,out] sides - Side of every vertex.
+	 *	\param[in] max_weights - Maximal weights of the sides.
+	 */
+	void refine(const Hypergraph& graph, std::vector<unsigned char>& sides, const boost::uint64_t* max_weights)
+	{
+		size_t vertex_count = graph.get_vertex_count();
+		size_t net_count = graph.get_net_count();
+		size_t move_limit = std::max<size_t>(64, vertex_count / 32);
+		std::vector<Flat_id> counts(2 * net_count);
+		std::vector<long> gains(vertex_count);
+		std::vector<char> locked(vertex_count);
+		std::vector<Flat_id> moves;
+
+		for (int pass = 0; pass < refinement_passes; ++pass)
+		{
+			std::fill(counts.begin(), counts.end(), 0);
+			boost::uint64_t weights[2] = { 0, 0 };
+			for (size_t vertex = 0; vertex < vertex_count; ++vertex)
+			{
+				weights[sides[vertex]] += graph.vertex_weights[vertex];
+			}
+			for (size_t net = 0; net < net_count; ++net)
+			{
+				for (Flat_id i = graph.net_offsets[net]; i < graph.net_offsets[net + 1]; ++i)
+				{
+					++counts[2 * net + sides[graph.net_pins[i]]];
+				}
+			}
+
+			// Only vertices on cut nets start in the queue, others join when their gains change.
+			std::priority_queue<std::pair<long, Flat_id> > queue;
+			for (size_t vertex = 0; vertex < vertex_count; ++vertex)
+			{
+				long gain = 0;
+				bool is_boundary = false;
+				unsigned char from = sides[vertex];
+				for (Flat_id i = graph.vertex_offsets[vertex]; i < graph.vertex_offsets[vertex + 1]; ++i)
+				{
+					Flat_id net = graph.vertex_nets[i];
+					long weight = graph.net_weights[net];
+					gain += weight * ((1 == counts[2 * net + from]) - (0 == counts[2 * net + 1 - from]));
+					is_boundary |= (0 != counts[2 * net + 1 - from]);
+				}
+				gains[vertex] = gain;
+				if (is_boundary)
+				{
+					queue.push(std::make_pair(gain, static_cast<Flat_id>(vertex)));
+				}
+			}
+
+			std::fill(locked.begin(), locked.end(), 0);
+			moves.clear();
+			long improvement = 0;
+			long best_improvement = 0;
+			size_t best_move_count = 0;
+			while (!queue.empty() && moves.size() - best_move_count < move_limit)
+			{
+				long gain = queue.top().first;
+				Flat_id vertex = queue.top().second;
+				queue.pop();
+				unsigned char from = sides[vertex];
+				unsigned char to = 1 - from;
+				if (locked[vertex] || gain != gains[vertex] || weights[to] + graph.vertex_weights[vertex] > max_weights[to])
+				{
+					continue;
+				}
+
+				locked[vertex] = 1;
+				for (Flat_id i = graph.vertex_offsets[vertex]; i < graph.vertex_offsets[vertex + 1]; ++i)
+				{
+					Flat_id net = graph.vertex_nets[i];
+					Flat_id first = graph.net_offsets[net];
+					Flat_id last = graph.net_offsets[net + 1];
+					long weight = graph.net_weights[net];
+					bool is_updated = (last - first <= max_updated_net_size);
+					Flat_id to_count = counts[2 * net + to];
+					for (Flat_id j = first; is_updated && j < last && to_count <= 1; ++j)
+					{
+						Flat_id pin = graph.net_pins[j];
+						if (!locked[pin] && (0 == to_count || to == sides[pin]))
+						{
+							update_gain(pin, (0 == to_count) ? weight : -weight, gains, queue);
+						}
+					}
+					--counts[2 * net + from];
+					++counts[2 * net + to];
+					Flat_id from_count = counts[2 * net + from];
+					for (Flat_id j = first; is_updated && j < last && from_count <= 1; ++j)
+					{
+						Flat_id pin = graph.net_pins[j];
+						if (!locked[pin] && (0 == from_count || from == sides[pin]))
+						{
+							update_gain(pin, (0 == from_count) ? -weight : weight, gains, queue);
+						}
+					}
+				}
+				sides[vertex] = to;
+				weights[from] -= graph.vertex_weights[vertex];
+				weights[to] += graph.vertex_weights[vertex];
+				moves.push_back(vertex);
+				improvement += gain;
+				if (improvement > best_improvement)
+				{
+					best_improvement = improvement;
+					best_move_count = moves.size();
+				}
+			}
+
+			for (size_t i = moves.size(); i > best_move_count; --i)
+			{
+				sides[moves[i - 1]] = 1 - sides[moves[i - 1]];
+			}
+			if (0 == best_improvement)
+			{
+				break;
+			}
+		}
+	}
+
+	/** \brief Bisects a hypergraph by growing side 0 breadth first from a start vertex up to the target weight.
+	 *	\param[in] graph - The hypergraph.
+	 *	\param[in] target - Target weight of side 0.
+	 *	\param[in] start - The start vertex.
+	 *	\param[out] sides - Side of every vertex.
+	 */
+	void grow(const Hypergraph& graph, boost::uint64_t target, Flat_id start, std::vector<unsigned char>& sides)
+	{
+		size_t vertex_count = graph.get_vertex_count();
+		sides.assign(vertex_count, 1);
+		std::vector<char> queued(vertex_count, 0);
+		std::deque<Flat_id> pending(1, start);
+		queued[start] = 1;
+		boost::uint64_t weight = 0;
+		size_t next_seed = 0;
+		while (weight < target)
+		{
+			if (pending.empty())
+			{
+				while (next_seed < vertex_count && queued[next_seed])
+				{
+					++next_seed;
+				}
+				if (next_seed == vertex_count)
+				{
+					break;
+				}
+				queued[next_seed] = 1;
+				pending.push_back(static_cast<Flat_id>(next_seed));
+			}
+			Flat_id vertex = pending.front();
+			pending.pop_front();
+			sides[vertex] = 0;
+			weight += graph.vertex_weights[vertex];
+			for (Flat_id i = graph.vertex_offsets[vertex]; i < graph.vertex_offsets[vertex + 1]; ++i)
+			{
+				Flat_id net = graph.vertex_nets[i];
+				if (graph.net_offsets[net + 1] - graph.net_offsets[net] > max_rated_net_size)
+				{
+					continue;
+				}
+				for (Flat_id j = graph.net_offsets[net]; j < graph.net_offsets[net + 1]; ++j)
+				{
+					if (!queued[graph.net_pins[j]])
+					{
+						queued[graph.net_pins[j]] = 1;
+						pending.push_back(graph.net_pins[j]);
+					}
+				}
+			}
+		}
+	}
+
+	/** \brief Bisects a hypergraph with multilevel coarsening, greedy growing and refinement.
+	 *	\param[in] graph - The hypergraph.
+	 *	\param[in] max_weights - Maximal weights of the sides.
+	 *	\param[in] target - Target weight of side 0.
+	 *	\param[in,out] random - State of the random generator.
+	 *	\param[in] thread_count - Number of threads to use.
+	 *	\param[out] sides - Side of every vertex.
+	 */
+	void bisect(const Hypergraph& graph, const boost::uint64_t* max_weights, boost::uint64_t target, boost::uint64_t& random,
+		unsigned thread_count, std::vector<unsigned char>& sides)
+	{
+		// Coarse vertices stay small against the part weights, so the coarse bisections can be balanced.
+		unsigned max_vertex_weight = static_cast<unsigned>(std::max<boost::uint64_t>(1, graph.get_total_weight() / (coarsest_vertex_count / 2)));
+		// Deques keep the finer levels in place while coarser ones are added.
+		std::deque<Hypergraph> levels;
+		std::deque<std::vector<Flat_id> > maps;
+		const Hypergraph* current = &graph;
+		while (current->get_vertex_count() > coarsest_vertex_count)
+		{
+			levels.push_back(Hypergraph());
+			maps.push_back(std::vector<Flat_id>());
+			coarsen(*current, levels.back(), maps.back(), max_vertex_weight, random, thread_count);
+			if (levels.back().get_vertex_count() > 0.95 * current->get_vertex_count())
+			{
+				levels.pop_back();
+				maps.pop_back();
+				break;
+			}
+			current = &levels.back();
+		}
+
+		// Keep the best of a few grown and refined bisections of the coarsest hypergraph.
+		boost::uint64_t best_cut = 0;
+		bool has_best = false;
+		std::vector<unsigned char> tried;
+		for (int i = 0; i < initial_tries && 0 != current->get_vertex_count(); ++i)
+		{
+			grow(*current, target, static_cast<Flat_id>(next_random(random) % current->get_vertex_count()), tried);
+			refine(*current, tried, max_weights);
+			boost::uint64_t cut = get_cut(*current, tried);
+			bool is_better = !has_best || (is_balanced(*current, tried, max_weights) && cut < best_cut)
+				|| (is_balanced(*current, tried, max_weights) && !is_balanced(*current, sides, max_weights));
+			if (is_better)
+			{
+				best_cut = cut;
+				has_best = true;
+				sides = tried;
+			}
+		}
+
+		for (size_t level = levels.size(); level > 0; --level)
+		{
+			const std::vector<Flat_id>& map = maps[level - 1];
+			const Hypergraph& finer = (1 == level) ? graph : levels[level - 2];
+			std::vector<unsigned char> projected(finer.get_vertex_count());
+			for (size_t vertex = 0; vertex < projected.size(); ++vertex)
+			{
+				projected[vertex] = sides[map[vertex]];
+			}
+			sides.swap(projected);
+			refine(finer, sides, max_weights);
+		}
+		sides.resize(graph.get_vertex_count(), 0);
+	}
+
+	/** \brief Extracts the sub-hypergraph of the vertices of one side.
+	 *	\param[in] graph - The hypergraph.
+	 *	\param[in] sides - Side of every vertex.
+	 *	\param[in] side - The extracted side.
+	 *	\param[out] sub - The sub-hypergraph.
+	 *	\param[out] vertices - Vertex of the hypergraph for every sub-hypergraph vertex.
+	 */
+	void extract(const Hypergraph& graph, const std::vector<unsigned char>& sides, unsigned char side, Hypergraph& sub, std::vector<Flat_id>& vertices)
+	{
+		std::vector<Flat_id> map(graph.get_vertex_count(), no_vertex);
+		vertices.clear();
+		for (size_t vertex = 0; vertex < graph.get_vertex_count(); ++vertex)
+		{
+			if (side == sides[vertex])
+			{
+				map[vertex] = static_cast<Flat_id>(vertices.size());
+				vertices.push_back(static_cast<Flat_id>(vertex));
+				sub.vertex_weights.push_back(graph.vertex_weights[vertex]);
+			}
+		}
+		std::vector<Flat_id> pins;
+		for (size_t net = 0; net < graph.get_net_count(); ++net)
+		{
+			pins.clear();
+			for (Flat_id i = graph.net_offsets[net]; i < graph.net_offsets[net + 1]; ++i)
+			{
+				if (no_vertex != map[graph.net_pins[i]])
+				{
+					pins.push_back(map[graph.net_pins[i]]);
+				}
+			}
+			sub.add_net(pins, graph.net_weights[net]);
+		}
+		sub.build_incidence();
+	}
+
+	/** \brief Splits a hypergraph into parts by recursive bisection.
+	 *	\param[in] graph - The hypergraph.
+	 *	\param[in] vertices - Gate of every vertex.
+	 *	\param[in] first_part - First part to assign.
+	 *	\param[in] part_count - Number of parts to make.
+	 *	\param[in] imbalance - Allowed imbalance of one bisection.
+	 *	\param[in,out] random - State of the random generator.
+	 *	\param[in] thread_count - Number of threads to use.
+	 *	\param[out] partitions - Part of every gate.
+	 */
+	void split(const Hypergraph& graph, const std::vector<Flat_id>& vertices, unsigned first_part, unsigned part_count, double imbalance,
+		boost::uint64_t& random, unsigned thread_count, std::vector<unsigned>& partitions)
+	{
+		if (1 == part_count || 0 == graph.get_vertex_count())
+		{
+			for (size_t i = 0; i < vertices.size(); ++i)
+			{
+				partitions[vertices[i]] = first_part;
+			}
+			return;
+		}
+
+		unsigned first_count = part_count / 2;
+		boost::uint64_t total = graph.get_total_weight();
+		boost::uint64_t target = total * first_count / part_count;
+		boost::uint64_t max_weights[2] = {
+			static_cast<boost::uint64_t>((1 + imbalance) * target),
+			static_cast<boost::uint64_t>((1 + imbalance) * (total - target)) };
+		std::vector<unsigned char> sides;
+		bisect(graph, max_weights, target, random, thread_count, sides);
+
+		for (unsigned char side = 0; side < 2; ++side)
+		{
+			Hypergraph sub;
+			std::vector<Flat_id> sub_vertices;
+			extract(graph, sides, side, sub, sub_vertices);
+			for (size_t i = 0; i < sub_vertices.size(); ++i)
+			{
+				sub_vertices[i] = vertices[sub_vertices[i]];
+			}
+			split(sub, sub_vertices, (0 == side) ? first_part : first_part + first_count,
+				(0 == side) ? first_count : part_count - first_count, imbalance, random, thread_count, partitions);
+		}
+	}
+}
+
+/** \brief Constructor with the netlist to partition, all gate weights are 1.
+ *	\param[in] netlist - The Flat Netlist, must outlive the Partitioner.
+ *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+ */
+Partitioner::Partitioner(const Flat_netlist& netlist, unsigned thread_count)
+	: m_netlist( netlist )
+	, m_thread_count( thread_count )
+	, m_part_count( 1 )
+	, m_gate_weights( netlist.get_gate_count(), 1 )
+	, m_partitions( netlist.get_gate_count(), 0 )
+{
+}
+
+/** \brief Sets the weights of the gates.
+ *	\param[in] weights - One weight per gate.
+ */
+void Partitioner::set_gate_weights(const std::vector<unsigned>& weights)
+{
+	if (weights.size() != m_netlist.get_gate_count())
+	{
+		throw std::string("The number of gate weights differs from the number of gates.");
+	}
+	m_gate_weights = weights;
+}
+
+/** \brief Partitions the gates.
+ *	\param[in] part_count - Number of parts, at least 1.
+ *	\param[in] imbalance - Allowed relative excess of a part weight over the average part weight.
+ *	\param[in] seed - Seed of the random choices.
+ */
+void Partitioner::partition(unsigned part_count, double imbalance, boost::uint64_t seed)
+{
+	m_part_count = std::max(1u, part_count);
+
+	Hypergraph graph;
+	graph.vertex_weights = m_gate_weights;
+	const std::vector<Flat_id>& drivers = m_netlist.get_net_drivers();
+	const std::vector<Flat_id>& fanout_offsets = m_netlist.get_net_fanout_offsets();
+	const std::vector<Flat_id>& fanouts = m_netlist.get_net_fanouts();
+	std::vector<Flat_id> pins;
+	for (size_t net = 0; net < m_netlist.get_net_count(); ++net)
+	{
+		pins.assign(fanouts.begin() + fanout_offsets[net], fanouts.begin() + fanout_offsets[net + 1]);
+		if (Flat_netlist::invalid_id != drivers[net])
+		{
+			pins.push_back(drivers[net]);
+		}
+		graph.add_net(pins, 1);
+	}
+	graph.build_incidence();
+
+	// The imbalance compounds over the bisection levels.
+	double levels = std::ceil(std::log(double(m_part_count)) / std::log(2.0));
+	double level_imbalance = (levels > 0) ? std::pow(1 + imbalance, 1 / levels) - 1 : imbalance;
+	std::vector<Flat_id> vertices(m_netlist.get_gate_count());
+	for (size_t gate = 0; gate < vertices.size(); ++gate)
+	{
+		vertices[gate] = static_cast<Flat_id>(gate);
+	}
+	boost::uint64_t random = (0 == seed) ? 1 : seed;
+	m_partitions.assign(m_netlist.get_gate_count(), 0);
+	split(graph, vertices, 0, m_part_count, level_imbalance, random, m_thread_count, m_partitions);
+}
+
+/// \brief Returns the part of every gate.
+const std::vector<unsigned>& Partitioner::get_partitions() const
+{
+	return m_partitions;
+}
+
+/// \brief Returns the weights of the parts.
+std::vector<boost::uint64_t> Partitioner::get_part_weights() const
+{
+	std::vector<boost::uint64_t> weights(m_part_count, 0);
+	for (size_t gate = 0; gate < m_partitions.size(); ++gate)
+	{
+		weights[m_partitions[gate]] += m_gate_weights[gate];
+	}
+	return weights;
+}
+
+/// \brief Returns the number of nets connecting gates of different parts.
+size_t Partitioner::get_cut_count() const
+{
+	const std::vector<Flat_id>& drivers = m_netlist.get_net_drivers();
+	const std::vector<Flat_id>& fanout_offsets = m_netlist.get_net_fanout_offsets();
+	const std::vector<Flat_id>& fanouts = m_netlist.get_net_fanouts();
+	size_t cut = 0;
+	for (size_t net = 0; net < m_netlist.get_net_count(); ++net)
+	{
+		Flat_id first = (Flat_netlist::invalid_id != drivers[net]) ? drivers[net]
+			: ((fanout_offsets[net] < fanout_offsets[net + 1]) ? fanouts[fanout_offsets[net]] : Flat_netlist::invalid_id);
+		for (Flat_id i = fanout_offsets[net]; Flat_netlist::invalid_id != first && i < fanout_offsets[net + 1]; ++i)
+		{
+			if (m_partitions[fanouts[i]] != m_partitions[first])
+			{
+				++cut;
+				break;
+			}
+		}
+	}
+	return cut;
+}
+
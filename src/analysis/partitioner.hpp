@@ -0,0 +1,67 @@
+#ifndef PARTITIONER_HPP
+#define PARTITIONER_HPP
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "flat_netlist.hpp"
+
+/** \brief Class for partitioning the gates of a Flat Netlist into balanced parts with few cut nets.
+ *	The netlist is seen as a hypergraph with the gates as vertices and the nets as hyperedges.
+ *	Parts are made by recursive multilevel bisection: the hypergraph is coarsened by clustering gates
+ *	that share many small nets, the ratings being computed in parallel and parallel nets being merged
+ *	into weighted nets, the coarsest hypergraph
+ *	is bisected by greedy growing, and the bisection is refined with Fiduccia-Mattheyses passes
+ *	while it is projected back to the finer levels.
+ */
+class Partitioner
+{
+public:
+
+	/** \brief Constructor with the netlist to partition, all gate weights are 1.
+	 *	\param[in] netlist - The Flat Netlist, must outlive the Partitioner.
+	 *	\param[in] thread_count - Number of threads to use, 0 for the hardware thread count.
+	 */
+	Partitioner(const Flat_netlist& netlist, unsigned thread_count = 0);
+
+	/** \brief Sets the weights of the gates.
+	 *	\param[in] weights - One weight per gate.
+	 */
+	void set_gate_weights(const std::vector<unsigned>& weights);
+
+	/** \brief Partitions the gates.
+	 *	\param[in] part_count - Number of parts, at least 1.
+	 *	\param[in] imbalance - Allowed relative excess of a part weight over the average part weight.
+	 *	\param[in] seed - Seed of the random choices.
+	 */
+	void partition(unsigned part_count, double imbalance = 0.03, boost::uint64_t seed = 1);
+
+	/// \brief Returns the part of every gate.
+	const std::vector<unsigned>& get_partitions() const;
+
+	/// \brief Returns the weights of the parts.
+	std::vector<boost::uint64_t> get_part_weights() const;
+
+	/// \brief Returns the number of nets connecting gates of different parts.
+	size_t get_cut_count() const;
+
+private:
+
+	/// The netlist.
+	const Flat_netlist& m_netlist;
+
+	/// Number of threads to use.
+	unsigned m_thread_count;
+
+	/// Number of parts.
+	unsigned m_part_count;
+
+	/// Weights of the gates.
+	std::vector<unsigned> m_gate_weights;
+
+	/// Parts of the gates.
+	std::vector<unsigned> m_partitions;
+
+};
+
+#endif // PARTITIONER_HPP
@@ -0,0 +1,142 @@
+#include "uniquifier.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+
+#include <sstream>
+#include <boost/shared_ptr.hpp>
+
+/** \brief Constructor, counts the references to all masters of the Netlist.
+ *	\param[in,out] netlist - The Netlist, instances must already point to their Module Descriptions. Must outlive the uniquifier.
+ *	\param[in] top_name - Name of the top module the paths start from.
+ */
+Uniquifier::Uniquifier(Netlist& netlist, const std::string& top_name)
+	: m_netlist( netlist )
+	, m_top_name( top_name )
+	, m_clone_count( 0 )
+{
+	const std::map<std::string, boost::shared_ptr<Module_description> >& modules = netlist.get_modules();
+	std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator I;
+	for (I = modules.begin(); I != modules.end(); ++I)
+	{
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = I->second->get_module_instances();
+		for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J = instances.begin(); J != instances.end(); ++J)
+		{
+			if (J->second->has_description())
+			{
+				++m_reference_counts[&J->second->get_module_description()];
+			}
+		}
+	}
+}
+
+/** \brief Makes every module on the instance path private to the path and returns the last one, ready for editing.
+ *	If the path ends with an instance of a built-in or undefined module, the module holding it is returned.
+ *	Throws if an instance of the path does not exist.
+ *	\param[in] path - Instance names separated by '/', empty for the top module.
+ *	\ret The Module Description of the last instance of the path, only used by that instance.
+ */
+Module_description& Uniquifier::uniquify(const std::string& path)
+{
+	std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator top = m_netlist.get_modules().find(m_top_name);
+	if (m_netlist.get_modules().end() == top)
+	{
+		throw std::string("Unable to find the top module: " + m_top_name);
+	}
+
+	// The current module is private: the top, or a master referenced once from a private module.
+	Module_description* current = top->second.get();
+	size_t begin = 0;
+	while (begin < path.size())
+	{
+		size_t end = path.find('/', begin);
+		if (std::string::npos == end)
+		{
+			end = path.size();
+		}
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator found = current->get_module_instances().find(path.substr(begin, end - begin));
+		if (current->get_module_instances().end() == found)
+		{
+			throw std::string("Unable to find the instance: " + path.substr(0, end));
+		}
+		Module_instance& instance = *found->second;
+		if (!instance.has_description())
+		{
+			if (end < path.size())
+			{
+				throw std::string("Unable to find the instance: " + path.substr(0, path.find('/', end + 1)));
+			}
+			break;
+		}
+
+		const Module_description& master = instance.get_module_description();
+		size_t& references = m_reference_counts[&master];
+		if (1 < references)
+		{
+			--references;
+			Module_description& copy = clone(master);
+			instance.set_module_description(copy);
+			++m_reference_counts[&copy];
+			current->mark_changed();
+			current = &copy;
+		}
+		else
+		{
+			current = m_netlist.get_module(master.get_name()).get();
+		}
+		begin = end + 1;
+	}
+	return *current;
+}
+
+/** \brief Returns the number of instances pointing to the module.
+ *	\param[in] module - The Module Description.
+ */
+size_t Uniquifier::get_reference_count(const Module_description& module) const
+{
+	std::map<const Module_description*, size_t>::const_iterator found = m_reference_counts.find(&module);
+	return (m_reference_counts.end() == found) ? 0 : found->second;
+}
+
+/// \brief Returns the number of modules cloned since the construction.
+size_t Uniquifier::get_clone_count() const
+{
+	return m_clone_count;
+}
+
+/** \brief Returns a name for a clone of the master, not used by any module of the Netlist.
+ *	\param[in] master - Name of the master.
+ */
+std::string Uniquifier::get_clone_name(const std::string& master)
+{
+	unsigned& suffix = m_next_suffixes[master];
+	std::string name;
+	do
+	{
+		std::ostringstream stream;
+		stream << master << "_" << ++suffix;
+		name = stream.str();
+	}
+	while (m_netlist.get_modules().count(name));
+	return name;
+}
+
+/** \brief Clones the module, adds the clone to the Netlist and counts the references of its instances.
+ *	\param[in] module - The Module Description to clone.
+ *	\ret The clone.
+ */
+Module_description& Uniquifier::clone(const Module_description& module)
+{
+	boost::shared_ptr<Module_description> copy = module.clone(get_clone_name(module.get_name()));
+	m_netlist.add_module(copy);
+	++m_clone_count;
+	const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = copy->get_module_instances();
+	for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+	{
+		if (I->second->has_description())
+		{
+			++m_reference_counts[&I->second->get_module_description()];
+		}
+	}
+	return *copy;
+}
@@ -0,0 +1,184 @@
+#include "work_stealing_pool.hpp"
+#include "parallel.hpp"
+
+#include <boost/bind.hpp>
+
+/** \brief Constructor, starts the workers.
+ *	\param[in] thread_count - Number of workers, 0 for the hardware thread count.
+ */
+Work_stealing_pool::Work_stealing_pool(unsigned thread_count)
+	: m_queued_count( 0 )
+	, m_unfinished_count( 0 )
+	, m_idle_count( 0 )
+	, m_next_queue( 0 )
+	, m_failed( false )
+	, m_stopping( false )
+{
+	if (0 == thread_count)
+	{
+		thread_count = Parallel::get_thread_count();
+	}
+	for (unsigned i = 0; i < thread_count; ++i)
+	{
+		m_queues.push_back(boost::shared_ptr<Worker_queue>(new Worker_queue()));
+	}
+	for (unsigned i = 0; i < thread_count; ++i)
+	{
+		m_threads.create_thread(boost::bind(&Work_stealing_pool::run_worker, this, i));
+	}
+}
+
+/// \brief Destructor, waits for the submitted tasks and stops the workers.
+Work_stealing_pool::~Work_stealing_pool()
+{
+	{
+		boost::unique_lock<boost::mutex> lock(m_mutex);
+		while (0 != m_unfinished_count)
+		{
+			m_all_done.wait(lock);
+		}
+		m_stopping = true;
+	}
+	m_work_available.notify_all();
+	m_threads.join_all();
+}
+
+/// \brief Returns the number of workers.
+unsigned Work_stealing_pool::get_thread_count() const
+{
+	return static_cast<unsigned>(m_queues.size());
+}
+
+/** \brief Submits a task. Can be called from tasks.
+ *	\param[in] task - The task to run.
+ */
+void Work_stealing_pool::submit(const Task& task)
+{
+	++m_unfinished_count;
+	unsigned queue = (0 != m_worker_index.get()) ? *m_worker_index : m_next_queue++ % m_queues.size();
+	{
+		boost::lock_guard<boost::mutex> lock(m_queues[queue]->mutex);
+		m_queues[queue]->tasks.push_back(task);
+	}
+
+	// The task is counted once it can be taken. A worker counts itself idle before it checks the count under the mutex,
+	// so either it sees the task or the submitter sees it idle and wakes it under the mutex.
+	++m_queued_count;
+	if (0 != m_idle_count)
+	{
+		boost::lock_guard<boost::mutex> lock(m_mutex);
+		m_work_available.notify_one();
+	}
+}
+
+/// \brief Waits until all submitted tasks are finished. Rethrows the first string thrown by a task. Must not be called from tasks.
+void Work_stealing_pool::wait()
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	while (0 != m_unfinished_count)
+	{
+		m_all_done.wait(lock);
+	}
+	if (m_failed)
+	{
+		std::string error = m_error;
+		m_failed = false;
+		m_error.clear();
+		throw error;
+	}
+}
+
+/** \brief Main loop of a worker.
+ *	\param[in] index - Index of the worker.
+ */
+void Work_stealing_pool::run_worker(unsigned index)
+{
+	m_worker_index.reset(new unsigned(index));
+	Task task;
+	while (true)
+	{
+		if (!take_task(index, task))
+		{
+			// A counted task not found is being taken by another worker, look again instead of sleeping.
+			if (m_queued_count > 0)
+			{
+				boost::this_thread::yield();
+				continue;
+			}
+			boost::unique_lock<boost::mutex> lock(m_mutex);
+			++m_idle_count;
+			while (m_queued_count <= 0 && !m_stopping)
+			{
+				m_work_available.wait(lock);
+			}
+			--m_idle_count;
+			if (m_queued_count <= 0 && m_stopping)
+			{
+				return;
+			}
+			continue;
+		}
+
+		try
+		{
+			task(index);
+		}
+		catch (const std::string& error)
+		{
+			boost::lock_guard<boost::mutex> lock(m_mutex);
+			if (!m_failed)
+			{
+				m_failed = true;
+				m_error = error;
+			}
+		}
+		catch (...)
+		{
+			boost::lock_guard<boost::mutex> lock(m_mutex);
+			if (!m_failed)
+			{
+				m_failed = true;
+				m_error = "Unknown error in a pool task.";
+			}
+		}
+		task.clear();
+
+		if (0 == --m_unfinished_count)
+		{
+			boost::lock_guard<boost::mutex> lock(m_mutex);
+			m_all_done.notify_all();
+		}
+	}
+}
+
+/** \brief Takes a task from the own deque or steals one from the others.
+ *	\param[in] index - Index of the worker.
+ *	\param[out] task - The found task.
+ *	\ret True if a task was found.
+ */
+bool Work_stealing_pool::take_task(unsigned index, Task& task)
+{
+	size_t count = m_queues.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		Worker_queue& queue = *m_queues[(index + i) % count];
+		boost::lock_guard<boost::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+		{
+			continue;
+		}
+		if (0 == i)
+		{
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+		}
+		--m_queued_count;
+		return true;
+	}
+	return false;
+}
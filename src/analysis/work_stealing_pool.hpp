@@ -0,0 +1,116 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/tss.hpp>
+
+/** \brief Thread pool with one task deque per worker.
+ *	A worker pops its own tasks from the back of its deque (newest first) and, when it runs out,
+ *	steals from the front of the other deques (oldest first). Tasks submitted by a worker go to its
+ *	own deque, tasks submitted from other threads are spread over the deques round-robin.
+ *	Submitting, taking and finishing a task only lock the deque it is in and update atomic counters;
+ *	the pool mutex is only taken by idle workers going to sleep, by their wake-up and by waiting.
+ */
+class Work_stealing_pool
+{
+public:
+
+	/// Task of the pool. The argument is the index of the worker running it, in [0, get_thread_count()).
+	typedef boost::function<void (unsigned)> Task;
+
+	/** \brief Constructor, starts the workers.
+	 *	\param[in] thread_count - Number of workers, 0 for the hardware thread count.
+	 */
+	Work_stealing_pool(unsigned thread_count = 0);
+
+	/// \brief Destructor, waits for the submitted tasks and stops the workers.
+	~Work_stealing_pool();
+
+	/// \brief Returns the number of workers.
+	unsigned get_thread_count() const;
+
+	/** \brief Submits a task. Can be called from tasks.
+	 *	\param[in] task - The task to run.
+	 */
+	void submit(const Task& task);
+
+	/// \brief Waits until all submitted tasks are finished. Rethrows the first string thrown by a task. Must not be called from tasks.
+	void wait();
+
+private:
+
+	/// Deque of tasks of one worker.
+	struct Worker_queue
+	{
+		/// Protects the tasks.
+		boost::mutex mutex;
+
+		/// Tasks of the worker.
+		std::deque<Task> tasks;
+	};
+
+	/** \brief Main loop of a worker.
+	 *	\param[in] index - Index of the worker.
+	 */
+	void run_worker(unsigned index);
+
+	/** \brief Takes a task from the own deque or steals one from the others.
+	 *	\param[in] index - Index of the worker.
+	 *	\param[out] task - The found task.
+	 *	\ret True if a task was found.
+	 */
+	bool take_task(unsigned index, Task& task);
+
+private:
+
+	/// Deques of the workers.
+	std::vector<boost::shared_ptr<Worker_queue> > m_queues;
+
+	/// The worker threads.
+	boost::thread_group m_threads;
+
+	/// Index of the worker on the current thread, not set on other threads.
+	boost::thread_specific_ptr<unsigned> m_worker_index;
+
+	/// Protects the sleep of idle workers, the error and the stop flag.
+	boost::mutex m_mutex;
+
+	/// Signaled when tasks are submitted to sleeping workers or the pool stops.
+	boost::condition_variable m_work_available;
+
+	/// Signaled when all tasks are finished.
+	boost::condition_variable m_all_done;
+
+	/// Number of tasks pushed to a deque and not yet taken, counted after the push and before the pop,
+	/// so it is briefly negative when a task is taken before its submitter counts it.
+	boost::atomic<long> m_queued_count;
+
+	/// Number of submitted tasks not yet finished.
+	boost::atomic<size_t> m_unfinished_count;
+
+	/// Number of workers sleeping or going to sleep, changed under the mutex.
+	boost::atomic<unsigned> m_idle_count;
+
+	/// Deque receiving the next task submitted from outside the pool.
+	boost::atomic<unsigned> m_next_queue;
+
+	/// First error thrown by a task since the last wait.
+	std::string m_error;
+
+	/// True if a task threw since the last wait.
+	bool m_failed;
+
+	/// Set when the pool is destroyed.
+	bool m_stopping;
+
+};
+
+#endif // WORK_STEALING_POOL_HPP
@@ -0,0 +1,256 @@
+#include "edit_journal.hpp"
+#include "netlist.hpp"
+#include "module_description.hpp"
+#include "module_instance.hpp"
+#include "module_port.hpp"
+#include "net.hpp"
+#include "netlist_transaction.hpp"
+
+#include <string>
+#include <utility>
+
+/// Helper classes.
+namespace
+{
+	/// Guard setting a flag for its lifetime, also when an exception leaves the scope.
+	class Flag_guard
+	{
+	public:
+
+		/** \brief Constructor, sets the flag.
+		 *	\param[in,out] flag - The flag, must outlive the guard.
+		 */
+		Flag_guard(bool& flag)
+			: m_flag( flag )
+		{
+			m_flag = true;
+		}
+
+		/// \brief Destructor, clears the flag.
+		~Flag_guard()
+		{
+			m_flag = false;
+		}
+
+	private:
+
+		/// The flag.
+		bool& m_flag;
+
+	};
+}
+
+/** \brief Constructor with the journaled Netlist.
+ *	\param[in] netlist - The Netlist owning the journal.
+ */
+Edit_journal::Edit_journal(Netlist& netlist)
+	: m_netlist( netlist )
+	, m_version( 0 )
+	, m_is_enabled( false )
+	, m_is_replaying( false )
+	, m_group_depth( 0 )
+	, m_is_group_edited( false )
+{
+}
+
+/** \brief Enables or disables recording. Disabling drops the recorded edits.
+ *	\param[in] is_enabled - True to record the edits.
+ */
+void Edit_journal::set_enabled(bool is_enabled)
+{
+	m_is_enabled = is_enabled;
+	if (!is_enabled)
+	{
+		m_edits.clear();
+		m_version = 0;
+	}
+}
+
+/// \brief Returns true if the edits are recorded.
+bool Edit_journal::is_enabled() const
+{
+	return m_is_enabled;
+}
+
+/// \brief Starts a group of edits undone and redone as one step. Groups can be nested, the outermost one is the step.
+void Edit_journal::begin_group()
+{
+	if (0 == m_group_depth++)
+	{
+		m_is_group_edited = false;
+	}
+}
+
+/// \brief Ends the current group of edits.
+void Edit_journal::end_group()
+{
+	if (0 != m_group_depth)
+	{
+		--m_group_depth;
+	}
+}
+
+/** \brief Records an edit, called by the Netlist after the edit is made.
+ *	Does nothing if recording is disabled or while an edit is undone or redone.
+ *	\param[in] kind - Kind of the edit.
+ *	\param[in] module - The edited Module Description, NULL for the edits of the Netlist.
+ *	\param[in] object - The added or removed object: Module Description, Module Instance, Module Port, Net, or the (target, source) pair of an assignment.
+ */
+void Edit_journal::record(EditKind kind, Module_description* module, const boost::shared_ptr<void>& object)
+{
+	if (!m_is_enabled || m_is_replaying)
+	{
+		return;
+	}
+	m_edits.erase(m_edits.begin() + m_version, m_edits.end());
+	Edit edit = { kind, module, object, 0 == m_group_depth || !m_is_group_edited };
+	m_edits.push_back(edit);
+	m_is_group_edited = true;
+	++m_version;
+}
+
+/// \brief Returns the current version, the number of applied edits.
+size_t Edit_journal::get_version() const
+{
+	return m_version;
+}
+
+/** \brief Undoes or redoes the edits up to the version, which can be inside a step. Throws if the version was dropped.
+ *	\param[in] version - A version returned by get_version.
+ */
+void Edit_journal::restore(size_t version)
+{
+	if (version > m_edits.size())
+	{
+		throw std::string("Unable to restore a dropped version.");
+	}
+	Netlist_transaction transaction(m_netlist);
+	while (m_version > version)
+	{
+		apply(m_edits[--m_version], true);
+	}
+	while (m_version < version)
+	{
+		apply(m_edits[m_version++], false);
+	}
+	transaction.commit();
+}
+
+/// \brief Undoes the last applied step, returns false if there is none.
+bool Edit_journal::undo()
+{
+	if (0 == m_version)
+	{
+		return false;
+	}
+	size_t version = m_version - 1;
+	while (0 != version && !m_edits[version].is_step_start)
+	{
+		--version;
+	}
+	restore(version);
+	return true;
+}
+
+/// \brief Redoes the last undone step, returns false if there is none.
+bool Edit_journal::redo()
+{
+	if (m_edits.size() == m_version)
+	{
+		return false;
+	}
+	size_t version = m_version + 1;
+	while (m_edits.size() != version && !m_edits[version].is_step_start)
+	{
+		++version;
+	}
+	restore(version);
+	return true;
+}
+
+/// \brief Returns the number of recorded edits, applied or undone.
+size_t Edit_journal::get_edit_count() const
+{
+	return m_edits.size();
+}
+
+/** \brief Applies the edit or its inverse.
+ *	\param[in] edit - The edit.
+ *	\param[in] is_inverse - True to apply the inverse operation.
+ */
+void Edit_journal::apply(const Edit& edit, bool is_inverse)
+{
+	// Removals are undone by adding back, so only the direction of the edit matters.
+	bool is_adding = is_inverse != (EDIT_REMOVE_MODULE != edit.kind && EDIT_REMOVE_INSTANCE != edit.kind);
+	Flag_guard replaying(m_is_replaying);
+	switch (edit.kind)
+	{
+	case EDIT_ADD_MODULE:
+	case EDIT_REMOVE_MODULE:
+		{
+			boost::shared_ptr<Module_description> module = boost::static_pointer_cast<Module_description>(edit.object);
+			if (is_adding)
+			{
+				m_netlist.add_module(module);
+			}
+			else
+			{
+				m_netlist.remove_module(module->get_name());
+			}
+		}
+		break;
+	case EDIT_ADD_INSTANCE:
+	case EDIT_REMOVE_INSTANCE:
+		{
+			boost::shared_ptr<Module_instance> instance = boost::static_pointer_cast<Module_instance>(edit.object);
+			if (is_adding)
+			{
+				edit.module->add_module_instance(instance);
+			}
+			else
+			{
+				edit.module->remove_module_instance(instance->get_name());
+			}
+		}
+		break;
+	case EDIT_ADD_PORT:
+		{
+			boost::shared_ptr<Module_port> port = boost::static_pointer_cast<Module_port>(edit.object);
+			if (is_adding)
+			{
+				edit.module->add_port(port);
+			}
+			else
+			{
+				edit.module->remove_port(port->get_name());
+			}
+		}
+		break;
+	case EDIT_ADD_NET:
+		{
+			boost::shared_ptr<Net> net = boost::static_pointer_cast<Net>(edit.object);
+			if (is_adding)
+			{
+				edit.module->add_net(net);
+			}
+			else
+			{
+				edit.module->remove_net(net->get_name());
+			}
+		}
+		break;
+	case EDIT_ADD_ASSIGN:
+		{
+			const std::pair<std::string, std::string>& assign = *boost::static_pointer_cast<std::pair<std::string, std::string> >(edit.object);
+			if (is_adding)
+			{
+				edit.module->add_assign(assign.first, assign.second);
+			}
+			else
+			{
+				edit.module->remove_last_assign();
+			}
+		}
+		break;
+	}
+}
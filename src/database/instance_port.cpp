@@ -5,10 +5,13 @@
  *	\param[in] name - Name of the Port.
  *	\param[in] type - Type of the Port. 
  *	\param[in] parent_module_instance - Instance of the parent Module.
+ *	\param[in] net_name - Name of the Net connected to this port in the parent Module Description, empty if unconnected.
  */
-Instance_port::Instance_port(const std::string name, PortType type, const Module_instance * const parent_module_instance)
+Instance_port::Instance_port(const std::string name, PortType type, const Module_instance * const parent_module_instance, const std::string& net_name)
 	: Port(name, type)
 	, m_parent_module_instance( parent_module_instance )
+	, m_net_name( net_name )
+	, m_written_net_name( net_name )
 {
 	
 }
@@ -19,3 +22,31 @@ const Module_instance * Instance_port::get_parent_module_instance() const
 	return m_parent_module_instance;	
 }
 
+/// \brief Getter for the name of the connected Net, the canonical name of its alias class once the nets are connected. Empty if the port is unconnected.
+const std::string& Instance_port::get_net_name() const
+{
+	return m_net_name;
+}
+
+/// \brief Getter for the net name the port was connected to, before aliasing.
+const std::string& Instance_port::get_written_net_name() const
+{
+	return m_written_net_name;
+}
+
+/** \brief Setter for the name of the connected Net.
+ *	\param[in] net_name - Name of the Net, empty to disconnect the port.
+ */
+void Instance_port::set_net_name(const std::string& net_name)
+{
+	m_net_name = net_name;
+	m_written_net_name = net_name;
+}
+
+/** \brief Sets the name of the Net standing for the written net name, which is kept.
+ *	\param[in] net_name - Canonical name of the alias class of the written net name.
+ */
+void Instance_port::resolve_net_name(const std::string& net_name)
+{
+	m_net_name = net_name;
+}
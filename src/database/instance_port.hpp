@@ -15,12 +15,29 @@ public:
 	 *	\param[in] name - Name of the Port.
 	 *	\param[in] type - Type of the Port. 
 	 *	\param[in] parent_module_instance - Instance of the parent Module.
+	 *	\param[in] net_name - Name of the Net connected to this port in the parent Module Description, empty if unconnected.
 	 */
-	Instance_port(const std::string name, PortType type, const Module_instance * const parent_module_instance);
+	Instance_port(const std::string name, PortType type, const Module_instance * const parent_module_instance, const std::string& net_name = "");
 
 	/// \brief Getter for the parent Module Instance.
 	const Module_instance * get_parent_module_instance() const;
 
+	/// \brief Getter for the name of the connected Net, the canonical name of its alias class once the nets are connected. Empty if the port is unconnected.
+	const std::string& get_net_name() const;
+
+	/// \brief Getter for the net name the port was connected to, before aliasing.
+	const std::string& get_written_net_name() const;
+
+	/** \brief Setter for the name of the connected Net.
+	 *	\param[in] net_name - Name of the Net, empty to disconnect the port.
+	 */
+	void set_net_name(const std::string& net_name);
+
+	/** \brief Sets the name of the Net standing for the written net name, which is kept.
+	 *	\param[in] net_name - Canonical name of the alias class of the written net name.
+	 */
+	void resolve_net_name(const std::string& net_name);
+
 private:
 
 	/// The name of the same port in Module Description.
@@ -28,6 +45,12 @@ private:
 
 	/// Pointer to the parent Module Description.
 	const Module_instance * m_parent_module_instance;
+
+	/// Name of the Net in the parent Module Description this port is connected to.
+	std::string m_net_name;
+
+	/// Net name the port was connected to, before aliasing.
+	std::string m_written_net_name;
 	
 };
 
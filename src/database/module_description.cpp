@@ -3,12 +3,15 @@
 #include "instance_port.hpp"
 #include "module_port.hpp"
 #include "net.hpp"
+#include "netlist.hpp"
 
 /** \brief Constructor with name.
  *	\param[in] name - Name of the Module Description.
  */
 Module_description::Module_description( const std::string& name)
-	: m_name( name )
+	: m_name( name ),
+	m_revision( 0 ),
+	m_netlist( 0 )
 {
 	
 }
@@ -33,7 +36,11 @@ Module_description::get_module_instances() const
  */
 void Module_description::add_module_instance(boost::shared_ptr<Module_instance> module_instance)
 {
-	m_modules.insert( std::pair<std::string, boost::shared_ptr<Module_instance> >(module_instance->get_name(), module_instance) );
+	if (m_modules.insert( std::pair<std::string, boost::shared_ptr<Module_instance> >(module_instance->get_name(), module_instance) ).second)
+	{
+		record(EDIT_ADD_INSTANCE, module_instance);
+	}
+	mark_changed();
 }
 
 /** \brief Adds module instance based on it's name, module_description name, and Wire-port name pairs.
@@ -51,7 +58,7 @@ void Module_description::add_module_instance(const std::string& module_name, con
 	// Create instance ports.
 	for (int i = 0; i < len; ++i)
 	{
-		new_instance->create_new_port( wire_port_name_pairs[i].second );
+		new_instance->create_new_port( wire_port_name_pairs[i].second, wire_port_name_pairs[i].first );
 	}
 }
 
@@ -68,6 +75,24 @@ boost::shared_ptr<Module_instance>& Module_description::get_module_instance_by_n
 return iter->second;
 }
 
+/** \brief Removes the Module Instance with the given name. Nets must be connected again afterwards.
+ *	\param[in] name - Name of the Instance.
+ *	\ret True if the Instance existed.
+ */
+bool Module_description::remove_module_instance(const std::string& name)
+{
+	std::map<std::string, boost::shared_ptr<Module_instance> >::iterator found = m_modules.find(name);
+	if (m_modules.end() == found)
+	{
+		return false;
+	}
+	boost::shared_ptr<Module_instance> instance = found->second;
+	m_modules.erase(found);
+	record(EDIT_REMOVE_INSTANCE, instance);
+	mark_changed();
+	return true;
+}
+
 /** \brief Function to get all ports in the module description.
  *	\ret The vector containing ports of the current module description.
  */
@@ -82,7 +107,26 @@ Module_description::get_ports() const
  */
 void Module_description::add_port(boost::shared_ptr<Module_port> port)
 {
-	m_ports.insert( std::pair<std::string, boost::shared_ptr<Module_port> >( port->get_name(), port) );
+	if (m_ports.insert( std::pair<std::string, boost::shared_ptr<Module_port> >( port->get_name(), port) ).second)
+	{
+		record(EDIT_ADD_PORT, port);
+	}
+	mark_changed();
+}
+
+/** \brief Removes the Port with the given name. Nets must be connected again afterwards.
+ *	\param[in] name - Name of the Port.
+ *	\ret True if the Port existed.
+ */
+bool Module_description::remove_port(const std::string& name)
+{
+	if (0 == m_ports.erase(name))
+	{
+		return false;
+	}
+	mark_edited(EDIT_ADD_PORT);
+	mark_changed();
+	return true;
 }
 
 /** \brief Returns Port by its name. Throws if does not exist.
@@ -113,7 +157,32 @@ Module_description::get_nets() const
  */
 void Module_description::add_net(boost::shared_ptr<Net> net)
 {
-	m_nets.insert( std::pair<std::string, boost::shared_ptr<Net> >(net->get_name(), net) );
+	// A net created by connect_nets is declared now.
+	if (0 != m_connected_nets.erase(net->get_name()))
+	{
+		m_nets.erase(net->get_name());
+	}
+	if (m_nets.insert( std::pair<std::string, boost::shared_ptr<Net> >(net->get_name(), net) ).second)
+	{
+		record(EDIT_ADD_NET, net);
+	}
+	mark_changed();
+}
+
+/** \brief Removes the Net with the given name. Nets must be connected again afterwards.
+ *	\param[in] name - Name of the Net.
+ *	\ret True if the Net existed.
+ */
+bool Module_description::remove_net(const std::string& name)
+{
+	if (0 == m_nets.erase(name) + m_aliased_nets.erase(name))
+	{
+		return false;
+	}
+	m_connected_nets.erase(name);
+	mark_edited(EDIT_ADD_NET);
+	mark_changed();
+	return true;
 }
 
 /** \brief Returns Net by its name. Throws if does not exist.
@@ -129,3 +198,300 @@ boost::shared_ptr<Net>& Module_description::get_net_by_name(const std::string& n
 return iter->second;
 }
 
+/** \brief Aliases two nets, as done by "assign target = source;". Aliased nets become one Net when the nets are connected,
+ *	named after the source unless a port is aliased.
+ *	\param[in] target - Name of the assigned net.
+ *	\param[in] source - Name of the assigning net.
+ */
+void Module_description::add_assign(const std::string& target, const std::string& source)
+{
+	m_assigns.push_back(std::make_pair(Net::normalize_name(target), Net::normalize_name(source)));
+	m_aliases.merge(m_assigns.back().second, m_assigns.back().first);
+	record(EDIT_ADD_ASSIGN, boost::shared_ptr<void>(new std::pair<std::string, std::string>(m_assigns.back())));
+	mark_changed();
+}
+
+/// \brief Removes the last assignment. Nets must be connected again afterwards.
+void Module_description::remove_last_assign()
+{
+	if (m_assigns.empty())
+	{
+		return;
+	}
+
+	// The union-find cannot split classes, the aliases are merged again.
+	m_assigns.pop_back();
+	m_aliases.clear();
+	std::vector< std::pair<std::string, std::string> >::const_iterator I;
+	for (I = m_assigns.begin(); I != m_assigns.end(); ++I)
+	{
+		m_aliases.merge(I->second, I->first);
+	}
+	mark_edited(EDIT_ADD_ASSIGN);
+	mark_changed();
+}
+
+/// \brief Returns the (target, source) net name pairs of the assignments, in the order they were added.
+const std::vector< std::pair<std::string, std::string> >& Module_description::get_assigns() const
+{
+	return m_assigns;
+}
+
+/** \brief Returns the name of the Net standing for the net name: the canonical name of its alias class,
+ *	a port name if the class contains a port. Returns the name itself if it is not aliased.
+ *	\param[in] name - Net name.
+ */
+const std::string& Module_description::get_canonical_net_name(const std::string& name) const
+{
+	return m_aliases.get_canonical(name);
+}
+
+/** \brief Connects the Nets to the ports of the module and the ports of its instances.
+ *	Creates a Net for every module port and an implicit Net for every undeclared net name used by an instance.
+ *	Literal net names (1'b0, 1'b1) become constant Nets, shared by all their users.
+ *	Aliased nets are represented by the Net of their canonical name and instance ports are resolved to it, but the aliased
+ *	declared nets and the written net names of the instance ports are kept: connecting again starts from the nets as declared,
+ *	so removing an assignment restores them. Nets created by the previous connection are created again.
+ *	Instances must already point to their Module Descriptions.
+ */
+void Module_description::connect_nets()
+{
+	std::set<std::string>::const_iterator iter_connected;
+	for (iter_connected = m_connected_nets.begin(); iter_connected != m_connected_nets.end(); ++iter_connected)
+	{
+		m_nets.erase(*iter_connected);
+	}
+	m_connected_nets.clear();
+	m_nets.insert(m_aliased_nets.begin(), m_aliased_nets.end());
+	m_aliased_nets.clear();
+
+	// Ports are kept as canonical names, the first port of a class wins. Constants win over ports, so tied ports stay tied.
+	if (!m_aliases.is_empty())
+	{
+		std::map<std::string, boost::shared_ptr<Module_port> >::const_reverse_iterator R;
+		for (R = m_ports.rbegin(); R != m_ports.rend(); ++R)
+		{
+			if (m_aliases.is_aliased(R->first))
+			{
+				m_aliases.set_canonical(R->first);
+			}
+		}
+		m_aliases.set_canonical(Net::get_constant_name(CONSTANT_ZERO));
+		m_aliases.set_canonical(Net::get_constant_name(CONSTANT_ONE));
+		m_aliases.compress();
+
+		std::map<std::string, boost::shared_ptr<Net> >::iterator iter_aliased = m_nets.begin();
+		while (iter_aliased != m_nets.end())
+		{
+			if (m_aliases.get_canonical(iter_aliased->first) != iter_aliased->first)
+			{
+				m_aliased_nets.insert(*iter_aliased);
+				m_nets.erase(iter_aliased++);
+			}
+			else
+			{
+				++iter_aliased;
+			}
+		}
+	}
+	std::map<std::string, boost::shared_ptr<Module_instance> >::iterator iter_resolved;
+	for (iter_resolved = m_modules.begin(); iter_resolved != m_modules.end(); ++iter_resolved)
+	{
+		iter_resolved->second->resolve_net_names(m_aliases);
+	}
+
+	std::map<std::string, boost::shared_ptr<Net> >::iterator iter_nets;
+	for (iter_nets = m_nets.begin(); iter_nets != m_nets.end(); ++iter_nets)
+	{
+		iter_nets->second->clear_connections();
+	}
+
+	// Module ports drive the nets of inputs and are driven by the nets of outputs.
+	std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator iter_ports;
+	for (iter_ports = m_ports.begin(); iter_ports != m_ports.end(); ++iter_ports)
+	{
+		Net& net = get_or_create_net(m_aliases.get_canonical(iter_ports->first), false);
+		if (OUT == iter_ports->second->get_type())
+		{
+			net.add_destination_port(iter_ports->second.get());
+		}
+		else
+		{
+			net.set_source_port(*iter_ports->second);
+		}
+	}
+
+	// Instance outputs drive the nets, all other instance ports are destinations.
+	std::map<std::string, boost::shared_ptr<Module_instance> >::iterator iter_instances;
+	for (iter_instances = m_modules.begin(); iter_instances != m_modules.end(); ++iter_instances)
+	{
+		iter_instances->second->resolve_port_types();
+		const std::vector<Instance_port>& ports = iter_instances->second->get_ports();
+		std::vector<Instance_port>::const_iterator I;
+		for (I = ports.begin(); I != ports.end(); ++I)
+		{
+			if (I->get_net_name().empty())
+			{
+				continue;
+			}
+			Net& net = get_or_create_net(I->get_net_name(), true);
+			if (OUT == I->get_type() && !net.has_source_port())
+			{
+				net.set_source_port(*I);
+			}
+			else
+			{
+				net.add_destination_port(&*I);
+			}
+		}
+	}
+	mark_changed();
+}
+
+/** \brief Returns a copy of the module under a new name: its ports, declared nets, instances and assignments.
+ *	The instances of the copy share the Module Descriptions of the original instances. The copy is connected.
+ *	\param[in] name - Name of the copy.
+ */
+boost::shared_ptr<Module_description> Module_description::clone(const std::string& name) const
+{
+	boost::shared_ptr<Module_description> copy(new Module_description(name));
+	std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator iter_ports;
+	for (iter_ports = m_ports.begin(); iter_ports != m_ports.end(); ++iter_ports)
+	{
+		copy->m_ports.insert(std::make_pair(iter_ports->first, boost::shared_ptr<Module_port>(new Module_port(iter_ports->first, iter_ports->second->get_type(), copy.get()))));
+	}
+
+	// Nets created by connect_nets are created again, aliased declared nets are declared again.
+	std::map<std::string, boost::shared_ptr<Net> > declared_nets(m_aliased_nets);
+	declared_nets.insert(m_nets.begin(), m_nets.end());
+	std::map<std::string, boost::shared_ptr<Net> >::const_iterator iter_nets;
+	for (iter_nets = declared_nets.begin(); iter_nets != declared_nets.end(); ++iter_nets)
+	{
+		if (0 == m_connected_nets.count(iter_nets->first))
+		{
+			copy->m_nets.insert(std::make_pair(iter_nets->first, boost::shared_ptr<Net>(new Net(iter_nets->first))));
+		}
+	}
+
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator iter_instances;
+	for (iter_instances = m_modules.begin(); iter_instances != m_modules.end(); ++iter_instances)
+	{
+		const Module_instance& instance = *iter_instances->second;
+		boost::shared_ptr<Module_instance> instance_copy(new Module_instance(instance.get_name(), instance.get_description_name()));
+		const std::vector<Instance_port>& pins = instance.get_ports();
+		for (std::vector<Instance_port>::const_iterator I = pins.begin(); I != pins.end(); ++I)
+		{
+			instance_copy->create_new_port(I->get_name(), I->get_written_net_name());
+		}
+		if (instance.has_description())
+		{
+			instance_copy->set_module_description(instance.get_module_description());
+		}
+		instance_copy->set_parent_module_description(copy.get());
+		copy->m_modules.insert(std::make_pair(iter_instances->first, instance_copy));
+	}
+
+	std::vector< std::pair<std::string, std::string> >::const_iterator iter_assigns;
+	for (iter_assigns = m_assigns.begin(); iter_assigns != m_assigns.end(); ++iter_assigns)
+	{
+		copy->add_assign(iter_assigns->first, iter_assigns->second);
+	}
+	copy->connect_nets();
+	return copy;
+}
+
+/** \brief Returns the revision of the module, changed by every edit made through the Module Description.
+ *	Used by caches of derived data to detect stale entries.
+ */
+unsigned long Module_description::get_revision() const
+{
+	return m_revision;
+}
+
+/// \brief Changes the revision, to be called after editing the module through the returned Instances, Ports or Nets.
+void Module_description::mark_changed()
+{
+	++m_revision;
+}
+
+/** \brief Sets the Netlist holding the module, which records and notifies the edits. Called by the Netlist.
+ *	\param[in] netlist - The Netlist, NULL if the module is not held by a Netlist.
+ */
+void Module_description::set_netlist(Netlist* netlist)
+{
+	m_netlist = netlist;
+}
+
+/// \brief Returns the Netlist holding the module, NULL if none.
+Netlist* Module_description::get_netlist() const
+{
+	return m_netlist;
+}
+
+/** \brief Points the instances without a Module Description to the modules of the map with their description names.
+ *	\param[in] modules - Module Descriptions by name, usually the modules of the Netlist.
+ *	\ret The number of instances bound.
+ */
+size_t Module_description::bind_instances(const std::map<std::string, boost::shared_ptr<Module_description> >& modules)
+{
+	size_t bound_count = 0;
+	std::map<std::string, boost::shared_ptr<Module_instance> >::iterator I;
+	for (I = m_modules.begin(); I != m_modules.end(); ++I)
+	{
+		if (I->second->has_description() || PRIMITIVE_NONE != I->second->get_primitive_type())
+		{
+			continue;
+		}
+		std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator found = modules.find(I->second->get_description_name());
+		if (modules.end() != found && found->second)
+		{
+			I->second->set_module_description(*found->second);
+			++bound_count;
+		}
+	}
+	if (0 != bound_count)
+	{
+		mark_changed();
+	}
+	return bound_count;
+}
+
+/** \brief Records the edit in the Netlist holding the module, if any.
+ *	\param[in] kind - Kind of the edit.
+ *	\param[in] object - The added or removed object.
+ */
+void Module_description::record(EditKind kind, const boost::shared_ptr<void>& object)
+{
+	if (0 != m_netlist)
+	{
+		m_netlist->record_edit(kind, this, object);
+	}
+}
+
+/** \brief Marks the module edited in the Netlist holding it, if any, without recording the edit.
+ *	\param[in] kind - Kind of the recorded edit the operation undoes.
+ */
+void Module_description::mark_edited(EditKind kind)
+{
+	if (0 != m_netlist)
+	{
+		m_netlist->mark_edited(kind, this);
+	}
+}
+
+/** \brief Returns the Net with the given name, creates it if it does not exist.
+ *	\param[in] name - Name of the Net.
+ *	\param[in] is_implicit - True if a created Net is not declared, i.e. not a port. Constant Nets are never implicit.
+ */
+Net& Module_description::get_or_create_net(const std::string& name, bool is_implicit)
+{
+	std::map< std::string, boost::shared_ptr<Net> >::iterator iter = m_nets.find(name);
+	if (iter == m_nets.end())
+	{
+		iter = m_nets.insert( std::pair<std::string, boost::shared_ptr<Net> >(name, boost::shared_ptr<Net>( new Net(name) )) ).first;
+		iter->second->set_implicit(is_implicit && !iter->second->is_constant());
+		m_connected_nets.insert(name);
+	}
+	return *iter->second;
+}
+
@@ -3,12 +3,17 @@
 
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 #include <boost/shared_ptr.hpp>
 
+#include "net_aliases.hpp"
+#include "edit_journal.hpp"
+
 class Module_instance;
 class Module_port;
 class Net;
+class Netlist;
 
 /// Class for holding descriptions of Modules.
 class Module_description
@@ -45,6 +50,12 @@ public:
 	 */	
 	boost::shared_ptr<Module_instance>& get_module_instance_by_name(const std::string& name);
 
+	/** \brief Removes the Module Instance with the given name. Nets must be connected again afterwards.
+	 *	\param[in] name - Name of the Instance.
+	 *	\ret True if the Instance existed.
+	 */
+	bool remove_module_instance(const std::string& name);
+
 	/** \brief Function to get all ports in the module description.
 	 *	\ret The vector containing ports of the current module description.
 	 */
@@ -54,13 +65,20 @@ public:
 	 *  \param[in] port - Port to add.
 	 */
 	void add_port(boost::shared_ptr<Module_port> port);
+
+	/** \brief Removes the Port with the given name. Nets must be connected again afterwards.
+	 *	\param[in] name - Name of the Port.
+	 *	\ret True if the Port existed.
+	 */
+	bool remove_port(const std::string& name);
 	
 	/** \brief Returns Port by its name. Throws if does not exist.
 	 *	\param[in] name - Name of the Port.
 	 */	
 	boost::shared_ptr<Module_port>& get_module_port_by_name(const std::string& name);
 
-	/** \brief Function to get all nets in the module description.
+	/** \brief Function to get all nets in the module description: the declared nets standing for their alias class
+	 *	and the nets created by connect_nets.
 	 *	\ret The vector containing nets of the current module description.
 	 */
     const std::map<std::string, boost::shared_ptr<Net> >& get_nets() const;
@@ -69,14 +87,95 @@ public:
 	 *	\param[in] net - Net to add.
 	 */
 	void add_net(boost::shared_ptr<Net> net);
+
+	/** \brief Removes the Net with the given name. Nets must be connected again afterwards.
+	 *	\param[in] name - Name of the Net.
+	 *	\ret True if the Net existed.
+	 */
+	bool remove_net(const std::string& name);
 	
 	/** \brief Returns Net by its name. Throws if does not exist.
 	 *	\param[in] name - Name of the Net.
 	 */	
 	boost::shared_ptr<Net>& get_net_by_name(const std::string& name);
 
+	/** \brief Aliases two nets, as done by "assign target = source;". Aliased nets become one Net when the nets are connected,
+	 *	named after the source unless a port is aliased.
+	 *	\param[in] target - Name of the assigned net.
+	 *	\param[in] source - Name of the assigning net.
+	 */
+	void add_assign(const std::string& target, const std::string& source);
+
+	/// \brief Removes the last assignment. Nets must be connected again afterwards.
+	void remove_last_assign();
+
+	/// \brief Returns the (target, source) net name pairs of the assignments, in the order they were added.
+	const std::vector< std::pair<std::string, std::string> >& get_assigns() const;
+
+	/** \brief Returns the name of the Net standing for the net name: the canonical name of its alias class,
+	 *	a port name if the class contains a port. Returns the name itself if it is not aliased.
+	 *	\param[in] name - Net name.
+	 */
+	const std::string& get_canonical_net_name(const std::string& name) const;
+
+	/** \brief Connects the Nets to the ports of the module and the ports of its instances.
+	 *	Creates a Net for every module port and an implicit Net for every undeclared net name used by an instance.
+	 *	Literal net names (1'b0, 1'b1) become constant Nets, shared by all their users.
+	 *	Aliased nets are represented by the Net of their canonical name and instance ports are resolved to it, but the aliased
+	 *	declared nets and the written net names of the instance ports are kept: connecting again starts from the nets as declared,
+	 *	so removing an assignment restores them. Nets created by the previous connection are created again.
+	 *	Instances must already point to their Module Descriptions.
+	 */
+	void connect_nets();
+
+	/** \brief Returns a copy of the module under a new name: its ports, declared nets, instances and assignments.
+	 *	The instances of the copy share the Module Descriptions of the original instances. The copy is connected.
+	 *	\param[in] name - Name of the copy.
+	 */
+	boost::shared_ptr<Module_description> clone(const std::string& name) const;
+
+	/** \brief Returns the revision of the module, changed by every edit made through the Module Description.
+	 *	Used by caches of derived data to detect stale entries.
+	 */
+	unsigned long get_revision() const;
+
+	/// \brief Changes the revision, to be called after editing the module through the returned Instances, Ports or Nets.
+	void mark_changed();
+
+	/** \brief Sets the Netlist holding the module, which records and notifies the edits. Called by the Netlist.
+	 *	\param[in] netlist - The Netlist, NULL if the module is not held by a Netlist.
+	 */
+	void set_netlist(Netlist* netlist);
+
+	/// \brief Returns the Netlist holding the module, NULL if none.
+	Netlist* get_netlist() const;
+
+	/** \brief Points the instances without a Module Description to the modules of the map with their description names.
+	 *	\param[in] modules - Module Descriptions by name, usually the modules of the Netlist.
+	 *	\ret The number of instances bound.
+	 */
+	size_t bind_instances(const std::map<std::string, boost::shared_ptr<Module_description> >& modules);
+
 private:
 
+	/** \brief Records the edit in the Netlist holding the module, if any.
+	 *	\param[in] kind - Kind of the edit.
+	 *	\param[in] object - The added or removed object.
+	 */
+	void record(EditKind kind, const boost::shared_ptr<void>& object);
+
+	/** \brief Marks the module edited in the Netlist holding it, if any, without recording the edit.
+	 *	\param[in] kind - Kind of the recorded edit the operation undoes.
+	 */
+	void mark_edited(EditKind kind);
+
+	/** \brief Returns the Net with the given name, creates it if it does not exist.
+	 *	\param[in] name - Name of the Net.
+	 *	\param[in] is_implicit - True if a created Net is not declared, i.e. not a port. Constant Nets are never implicit.
+	 */
+	Net& get_or_create_net(const std::string& name, bool is_implicit);
+
+
 	/// Name of the module.
 	std::string m_name;
 
@@ -86,9 +185,27 @@ private:
     /// All net Instances used in this module description.
     std::map<std::string, boost::shared_ptr<Net> > m_nets;
 
+	/// Declared nets standing for another net of their alias class, kept out of m_nets.
+	std::map<std::string, boost::shared_ptr<Net> > m_aliased_nets;
+
+	/// Names of the nets created by connect_nets rather than declared.
+	std::set<std::string> m_connected_nets;
+
     /// All the Module Instances used in this module description.
     std::map<std::string, boost::shared_ptr<Module_instance> > m_modules;
 
+	/// Assignments as (target, source) net names.
+	std::vector< std::pair<std::string, std::string> > m_assigns;
+
+	/// Classes of the nets aliased by the assignments.
+	Net_aliases m_aliases;
+
+	/// Revision of the module, incremented on every edit.
+	unsigned long m_revision;
+
+	/// Netlist holding the module, NULL if none.
+	Netlist* m_netlist;
+
 };
 
 #endif // MODULE_DESCRIPTION_H
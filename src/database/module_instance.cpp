@@ -1,6 +1,9 @@
 #include "module_instance.hpp"
 #include "module_description.hpp"
 #include "instance_port.hpp"
+#include "module_port.hpp"
+#include "net_aliases.hpp"
+#include "net.hpp"
 
 /** \brief Constructor with name.
  *	\param[in] name - Name of the instance.
@@ -9,6 +12,7 @@
 Module_instance::Module_instance(const std::string& name, const std::string& description_name)
 	: m_name( name )
 	, m_description_name( description_name )
+	, m_primitive_type( Primitives::get_type(description_name) )
 	, m_module_description( 0 )
 	, m_parent_module_description( 0 )
 {
@@ -34,18 +38,25 @@ bool Module_instance::has_description() const
 	return (0 != m_module_description);
 }
 
+/// \brief Returns the primitive type of the instance, PRIMITIVE_NONE if the instance is not a built-in primitive.
+PrimitiveType Module_instance::get_primitive_type() const
+{
+	return m_primitive_type;
+}
+
 /// \brief Returns the Module Description if available( not available to built-in modules and not found modules), else throws an error string.
 const Module_description& Module_instance::get_module_description() const
 {
 	return *m_module_description;
 }
 
-/** \brief Sets Module description for current instance to given.
+/** \brief Sets Module description for current instance to given, the description name follows the description.
  *  \param[in] description - The new description of current module instance.
  */
 void Module_instance::set_module_description(const Module_description& description)
 {
 	m_module_description = &description;
+	m_description_name = description.get_name();
 }
 
 /// \brief Returns the Parent Module Description.
@@ -81,10 +92,47 @@ void Module_instance::add_port(const Instance_port& port)
 
 /** Creates an instance port with given name. The type will be set later when mapping description ports with instance ports.
  *	\param[in] name - The name of the new port.
+ *	\param[in] net_name - The name of the Net connected to the new port.
  */	
-void Module_instance::create_new_port(const std::string& name)
+void Module_instance::create_new_port(const std::string& name, const std::string& net_name)
 {
-	add_port(Instance_port(name, IN, this));
+	add_port(Instance_port(name, IN, this, Net::normalize_name(net_name)));
 }
 
+/// \brief Sets the types of the instance ports from the Module Description ports, or from the primitive pin names for built-in primitives.
+void Module_instance::resolve_port_types()
+{
+	std::vector<Instance_port>::iterator I;
+	for (I = m_ports.begin(); I != m_ports.end(); ++I)
+	{
+		if (has_description())
+		{
+			const std::map<std::string, boost::shared_ptr<Module_port> >& description_ports = m_module_description->get_ports();
+			std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator iter_found = description_ports.find(I->get_name());
+			if (iter_found != description_ports.end())
+			{
+				I->set_type(iter_found->second->get_type());
+			}
+		}
+		else if (PRIMITIVE_NONE != m_primitive_type)
+		{
+			I->set_type(Primitives::is_output_pin(I->get_name()) ? OUT : IN);
+		}
+	}
+}
 
+/** \brief Resolves the written net names of the instance ports to the canonical names of their alias classes.
+ *	\param[in] aliases - Net aliases of the parent Module Description.
+ */
+void Module_instance::resolve_net_names(const Net_aliases& aliases)
+{
+	std::vector<Instance_port>::iterator I;
+	for (I = m_ports.begin(); I != m_ports.end(); ++I)
+	{
+		const std::string& canonical = aliases.get_canonical(I->get_written_net_name());
+		if (canonical != I->get_net_name())
+		{
+			I->resolve_net_name(canonical);
+		}
+	}
+}
@@ -4,8 +4,11 @@
 #include <vector>
 #include <string>
 
+#include "primitives.hpp"
+
 class Module_description;
 class Instance_port;
+class Net_aliases;
 
 /// Class for holding single instance of a Modules.
 class Module_instance
@@ -27,10 +30,13 @@ public:
 	/// \brief Returns if current instance has description. If this is an instance of built-in module, or the descriptio was not found in the netlist will return false.
 	bool has_description() const;
 
+	/// \brief Returns the primitive type of the instance, PRIMITIVE_NONE if the instance is not a built-in primitive.
+	PrimitiveType get_primitive_type() const;
+
 	/// \brief Returns the Module Description if available( not available to built-in modules and not found modules), else throws an error string.
 	const Module_description& get_module_description() const;
 
-	/** \brief Sets Module description for current instance to given.
+	/** \brief Sets Module description for current instance to given, the description name follows the description.
 	 *  \param[in] description - The new description of current module instance.
 	 */
 	void set_module_description(const Module_description& description);
@@ -55,8 +61,17 @@ public:
 
 	/** Creates an instance port with given name. The type will be set later when mapping description ports with instance ports.
 	 *	\param[in] name - The name of the new port.
+	 *	\param[in] net_name - The name of the Net connected to the new port.
 	 */	
-	void create_new_port(const std::string& name);
+	void create_new_port(const std::string& name, const std::string& net_name = "");
+
+	/// \brief Sets the types of the instance ports from the Module Description ports, or from the primitive pin names for built-in primitives.
+	void resolve_port_types();
+
+	/** \brief Resolves the written net names of the instance ports to the canonical names of their alias classes.
+	 *	\param[in] aliases - Net aliases of the parent Module Description.
+	 */
+	void resolve_net_names(const Net_aliases& aliases);
 
 private:
 
@@ -69,6 +84,9 @@ private:
 	/// Name of the Module description for this instance. It can be got from the m_module_description too, but this is needed not to read the file twice.
 	std::string m_description_name;
 
+	/// Type of the built-in primitive, PRIMITIVE_NONE for instances of other modules.
+	PrimitiveType m_primitive_type;
+
 	/// Pointer to the description of this object. Is set to null for built-in models(and, or, ... etc.), or when model description was not found in the netlist.
 	const Module_description * m_module_description;
 
@@ -1,4 +1,5 @@
 #include "net.hpp"
+#include "netlist_keywords.hpp"
 
 /** \brief Constructor by name.
  *	\param[in] name - Name of the Net.
@@ -7,6 +8,8 @@
 Net::Net(const std::string name, const Port * source_port)
 	: m_name( name )
 	, m_source_port( source_port )
+	, m_is_implicit( false )
+	, m_constant( parse_constant(name) )
 {
 }
 
@@ -27,6 +30,12 @@ const Port& Net::get_source_port() const
 	return *m_source_port;
 }
 
+/// \brief Returns true if the Net has a source port.
+bool Net::has_source_port() const
+{
+	return 0 != m_source_port;
+}
+
 /** \brief Sets source port.
  *	\param[in] source_port - New Source Port.
  */
@@ -49,3 +58,88 @@ void Net::add_destination_port( const Port * destination_port)
 	m_destination_ports.push_back( destination_port );
 }
 
+/// \brief Removes the source and all destination ports of the Net.
+void Net::clear_connections()
+{
+	m_source_port = 0;
+	m_destination_ports.clear();
+}
+
+/// \brief Returns true if the Net was not declared but created for a net name used by an instance.
+bool Net::is_implicit() const
+{
+	return m_is_implicit;
+}
+
+/** \brief Sets whether the Net is implicit.
+ *	\param[in] implicit - True if the Net was not declared.
+ */
+void Net::set_implicit(bool implicit)
+{
+	m_is_implicit = implicit;
+}
+
+/// \brief Returns the value of a literal constant Net ("1'b0", "1'b1"), CONSTANT_NONE for other Nets.
+LogicConstant Net::get_constant() const
+{
+	return m_constant;
+}
+
+/// \brief Returns true if the Net is a literal constant.
+bool Net::is_constant() const
+{
+	return CONSTANT_NONE != m_constant;
+}
+
+/** \brief Returns the value of a net name if it is a 1 bit literal: 0, 1, 1'b0, 1'b1, 1'h1, 1'd0 ... (base case-insensitive).
+ *	\param[in] name - Net name.
+ *	\ret The value, CONSTANT_NONE if the name is not a literal.
+ */
+LogicConstant Net::parse_constant(const std::string& name)
+{
+	std::string digit = name;
+	if (4 == name.size() && '1' == name[0] && '\'' == name[1])
+	{
+		if (std::string("bBoOdDhH").find(name[2]) == std::string::npos)
+		{
+			return CONSTANT_NONE;
+		}
+		digit = name.substr(3);
+	}
+	if ("0" == digit)
+	{
+		return CONSTANT_ZERO;
+	}
+	if ("1" == digit)
+	{
+		return CONSTANT_ONE;
+	}
+	return CONSTANT_NONE;
+}
+
+/** \brief Returns the net name standing for the constant, "1'b0" or "1'b1". Empty for CONSTANT_NONE.
+ *	\param[in] constant - The constant.
+ */
+const std::string& Net::get_constant_name(LogicConstant constant)
+{
+	static const std::string none;
+	if (CONSTANT_ZERO == constant)
+	{
+		return Netlist_keywords::constant_zero;
+	}
+	if (CONSTANT_ONE == constant)
+	{
+		return Netlist_keywords::constant_one;
+	}
+	return none;
+}
+
+/** \brief Returns the name of the Net for a net name: the constant name for literals, the name itself otherwise.
+ *	All spellings of a literal share one Net.
+ *	\param[in] name - Net name.
+ */
+const std::string& Net::normalize_name(const std::string& name)
+{
+	LogicConstant constant = parse_constant(name);
+	return (CONSTANT_NONE == constant) ? name : get_constant_name(constant);
+}
@@ -6,6 +6,14 @@
 
 class Port;
 
+/// Enum for holding the value of a Net tied to a literal constant.
+enum LogicConstant
+{
+	CONSTANT_NONE = 0,
+	CONSTANT_ZERO = 1,
+	CONSTANT_ONE = 2
+};
+
 /// Class for Net.
 class Net
 {
@@ -23,6 +31,9 @@ public:
 	/// \brief Returns the source port if exists, else throws an exception.
 	const Port& get_source_port() const;
 
+	/// \brief Returns true if the Net has a source port.
+	bool has_source_port() const;
+
 	/** \brief Sets source port.
 	 *	\param[in] source_port - New Source Port.
 	 */
@@ -36,6 +47,40 @@ public:
 	 */
 	void add_destination_port( const Port * destination_port);
 
+	/// \brief Removes the source and all destination ports of the Net.
+	void clear_connections();
+
+	/// \brief Returns true if the Net was not declared but created for a net name used by an instance.
+	bool is_implicit() const;
+
+	/** \brief Sets whether the Net is implicit.
+	 *	\param[in] implicit - True if the Net was not declared.
+	 */
+	void set_implicit(bool implicit);
+
+	/// \brief Returns the value of a literal constant Net ("1'b0", "1'b1"), CONSTANT_NONE for other Nets.
+	LogicConstant get_constant() const;
+
+	/// \brief Returns true if the Net is a literal constant.
+	bool is_constant() const;
+
+	/** \brief Returns the value of a net name if it is a 1 bit literal: 0, 1, 1'b0, 1'b1, 1'h1, 1'd0 ... (base case-insensitive).
+	 *	\param[in] name - Net name.
+	 *	\ret The value, CONSTANT_NONE if the name is not a literal.
+	 */
+	static LogicConstant parse_constant(const std::string& name);
+
+	/** \brief Returns the net name standing for the constant, "1'b0" or "1'b1". Empty for CONSTANT_NONE.
+	 *	\param[in] constant - The constant.
+	 */
+	static const std::string& get_constant_name(LogicConstant constant);
+
+	/** \brief Returns the name of the Net for a net name: the constant name for literals, the name itself otherwise.
+	 *	All spellings of a literal share one Net.
+	 *	\param[in] name - Net name.
+	 */
+	static const std::string& normalize_name(const std::string& name);
+
 private:
 
 	/// Name of the wire.
@@ -47,6 +92,12 @@ private:
 	/// The collection of destination ports for this net.
 	std::vector<const Port*> m_destination_ports;
 
+	/// True if the Net was not declared.
+	bool m_is_implicit;
+
+	/// Value of the literal constant.
+	LogicConstant m_constant;
+
 };
 
 #endif // NET_H
@@ -0,0 +1,139 @@
+#include "net_aliases.hpp"
+
+#include <algorithm>
+
+/// Helper functions.
+namespace
+{
+	/// \brief Returns the index of the name, adds it as a single name class if it is new.
+	size_t get_index(std::map<std::string, size_t>& indices, std::vector<const std::string*>& names, std::vector<size_t>& parents, std::vector<size_t>& sizes, std::vector<size_t>& canonicals, const std::string& name)
+	{
+		std::pair<std::map<std::string, size_t>::iterator, bool> inserted = indices.insert(std::make_pair(name, names.size()));
+		if (inserted.second)
+		{
+			names.push_back(&inserted.first->first);
+			parents.push_back(inserted.first->second);
+			sizes.push_back(1);
+			canonicals.push_back(inserted.first->second);
+		}
+		return inserted.first->second;
+	}
+}
+
+/// \brief Constructor, no name is aliased.
+Net_aliases::Net_aliases()
+{
+}
+
+/** \brief Merges the classes of the two names. The canonical name of the first class stays canonical.
+ *	\param[in] first - First net name.
+ *	\param[in] second - Second net name.
+ */
+void Net_aliases::merge(const std::string& first, const std::string& second)
+{
+	size_t first_root = find_root(get_index(m_indices, m_names, m_parents, m_sizes, m_canonicals, first));
+	size_t second_root = find_root(get_index(m_indices, m_names, m_parents, m_sizes, m_canonicals, second));
+	if (first_root == second_root)
+	{
+		return;
+	}
+
+	// The smaller class hangs below the larger one.
+	size_t canonical = m_canonicals[first_root];
+	if (m_sizes[first_root] < m_sizes[second_root])
+	{
+		std::swap(first_root, second_root);
+	}
+	m_parents[second_root] = first_root;
+	m_sizes[first_root] += m_sizes[second_root];
+	m_canonicals[first_root] = canonical;
+}
+
+/** \brief Makes the name the canonical name of its class. Does nothing for names that are not aliased.
+ *	\param[in] name - Net name.
+ */
+void Net_aliases::set_canonical(const std::string& name)
+{
+	std::map<std::string, size_t>::const_iterator found = m_indices.find(name);
+	if (m_indices.end() != found)
+	{
+		m_canonicals[find_root(found->second)] = found->second;
+	}
+}
+
+/** \brief Returns the canonical name of the class of the name, the name itself if it is not aliased.
+ *	Does not modify the structure once compress() was called after the last merge, so it can then be called concurrently.
+ *	\param[in] name - Net name.
+ */
+const std::string& Net_aliases::get_canonical(const std::string& name) const
+{
+	std::map<std::string, size_t>::const_iterator found = m_indices.find(name);
+	if (m_indices.end() == found)
+	{
+		return name;
+	}
+	return *m_names[m_canonicals[find_root(found->second)]];
+}
+
+/** \brief Returns true if the name was merged with another name.
+ *	\param[in] name - Net name.
+ */
+bool Net_aliases::is_aliased(const std::string& name) const
+{
+	return m_indices.end() != m_indices.find(name);
+}
+
+/// \brief Returns true if no names are aliased.
+bool Net_aliases::is_empty() const
+{
+	return m_indices.empty();
+}
+
+/// \brief Returns all aliased names, sorted.
+std::vector<std::string> Net_aliases::get_names() const
+{
+	std::vector<std::string> names;
+	for (std::map<std::string, size_t>::const_iterator I = m_indices.begin(); I != m_indices.end(); ++I)
+	{
+		names.push_back(I->first);
+	}
+	return names;
+}
+
+/// \brief Points every name directly to the root of its class.
+void Net_aliases::compress()
+{
+	for (size_t i = 0; i < m_parents.size(); ++i)
+	{
+		find_root(i);
+	}
+}
+
+/// \brief Removes all aliases.
+void Net_aliases::clear()
+{
+	m_indices.clear();
+	m_names.clear();
+	m_parents.clear();
+	m_sizes.clear();
+	m_canonicals.clear();
+}
+
+/** \brief Returns the root of the class of the name, compressing the path.
+ *	\param[in] index - Index of the name.
+ */
+size_t Net_aliases::find_root(size_t index) const
+{
+	size_t root = index;
+	while (m_parents[root] != root)
+	{
+		root = m_parents[root];
+	}
+	while (m_parents[index] != root)
+	{
+		size_t next = m_parents[index];
+		m_parents[index] = root;
+		index = next;
+	}
+	return root;
+}
@@ -1,20 +1,373 @@
 #include "netlist.hpp"
 #include "module_description.hpp"
+#include "module_instance.hpp"
+#include <climits>
 #include <boost/shared_ptr.hpp>
 
+/// Helper functions.
+namespace
+{
+	/** \brief Returns true if the module has an instance of one of the modules.
+	 *	\param[in] module - The Module Description.
+	 *	\param[in] masters - The instantiated Module Descriptions.
+	 */
+	bool is_instantiating(const Module_description& module, const std::set<const Module_description*>& masters)
+	{
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I;
+		for (I = instances.begin(); I != instances.end(); ++I)
+		{
+			if (I->second->has_description() && 0 != masters.count(&I->second->get_module_description()))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
 /// \brief Constructor by name.
 Netlist::Netlist(const std::string& name)
 	: m_name( name )
+	, m_journal( *this )
+	, m_transaction_depth( 0 )
+	, m_is_module_added( false )
+	, m_is_interface_changed( false )
+	, m_reader_version( 0 )
+	, m_epoch( 1 )
 {
+	for (unsigned i = 0; i < max_readers; ++i)
+	{
+		m_reader_slots[i].epoch.store(0);
+	}
+}
 
+const unsigned Netlist::max_readers;
+
+/// \brief Destructor, detaches the held modules, which may still be shared by other Netlists.
+Netlist::~Netlist()
+{
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator I;
+	for (I = m_modules.begin(); I != m_modules.end(); ++I)
+	{
+		if (I->second && this == I->second->get_netlist())
+		{
+			I->second->set_netlist(0);
+		}
+	}
 }
 
 /** \brief Adds given Module Description to the collection.
+ *	A module already held by another Netlist is only shared: its edits are still recorded and notified by that Netlist.
  *	\param[in] module - The new Module Description.
  */
 void Netlist::add_module( const boost::shared_ptr<Module_description>& module)
 {
-	m_modules.insert( std::pair<std::string, boost::shared_ptr<Module_description> >(module->get_name(), module));
+	if (m_modules.insert( std::pair<std::string, boost::shared_ptr<Module_description> >(module->get_name(), module)).second)
+	{
+		if (0 == module->get_netlist())
+		{
+			module->set_netlist(this);
+		}
+		record_edit(EDIT_ADD_MODULE, module.get(), module);
+	}
+}
+
+/** \brief Removes the Module Description with the given name. Instances of it must be removed or rebound before.
+ *	\param[in] name - The name of the module description.
+ *	\ret True if the module was found.
+ */
+bool Netlist::remove_module(const std::string& name)
+{
+	std::map< std::string, boost::shared_ptr<Module_description> >::iterator found = m_modules.find(name);
+	if (m_modules.end() == found)
+	{
+		return false;
+	}
+	boost::shared_ptr<Module_description> module = found->second;
+	m_modules.erase(found);
+	if (this == module->get_netlist())
+	{
+		module->set_netlist(0);
+	}
+	record_edit(EDIT_REMOVE_MODULE, module.get(), module);
+	return true;
+}
+
+/// \brief Returns the journal recording the edits of the Netlist and its Module Descriptions.
+Edit_journal& Netlist::get_journal()
+{
+	return m_journal;
+}
+
+/** \brief Sets the function called after the Netlist changed.
+ *	\param[in] listener - The listener, an empty function for none.
+ */
+void Netlist::set_change_listener(const Change_listener& listener)
+{
+	m_change_listener = listener;
+}
+
+/// \brief Starts a transaction. Transactions can be nested, the outermost one is committed.
+void Netlist::begin_transaction()
+{
+	++m_transaction_depth;
+	m_journal.begin_group();
+}
+
+/// \brief Commits the current transaction. Throws if there is none.
+void Netlist::commit_transaction()
+{
+	if (0 == m_transaction_depth)
+	{
+		throw std::string("No transaction to commit.");
+	}
+	m_journal.end_group();
+	if (0 != --m_transaction_depth || m_edited_modules.empty())
+	{
+		return;
+	}
+
+	// Only the modules still in the Netlist are updated, the removed ones are compared and never used.
+	// Modules instantiating a module whose ports changed are connected again for the new port types.
+	std::set<const Module_description*> edited_modules;
+	edited_modules.swap(m_edited_modules);
+	bool is_module_added = m_is_module_added;
+	bool is_interface_changed = m_is_interface_changed;
+	m_is_module_added = false;
+	m_is_interface_changed = false;
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator I;
+	for (I = m_modules.begin(); I != m_modules.end(); ++I)
+	{
+		if (!I->second)
+		{
+			continue;
+		}
+		Module_description& module = *I->second;
+		bool is_edited = 0 != edited_modules.count(&module);
+		bool is_bound = (is_edited || is_module_added) && 0 != module.bind_instances(m_modules);
+		if (is_edited || is_bound || (is_interface_changed && is_instantiating(module, edited_modules)))
+		{
+			module.connect_nets();
+		}
+	}
+	if (m_version)
+	{
+		publish();
+	}
+	if (m_change_listener)
+	{
+		m_change_listener(*this);
+	}
+}
+
+/// \brief Returns true inside a transaction.
+bool Netlist::is_in_transaction() const
+{
+	return 0 != m_transaction_depth;
+}
+
+/** \brief Records an edit made to the Netlist or to one of its Module Descriptions. Called by the Module Descriptions.
+ *	\param[in] kind - Kind of the edit.
+ *	\param[in] module - The edited Module Description, the added or removed one for the edits of the Netlist.
+ *	\param[in] object - The added or removed object.
+ */
+void Netlist::record_edit(EditKind kind, Module_description* module, const boost::shared_ptr<void>& object)
+{
+	m_journal.record(kind, (EDIT_ADD_MODULE == kind || EDIT_REMOVE_MODULE == kind) ? 0 : module, object);
+	mark_edited(kind, module);
+}
+
+/** \brief Marks a module edited without recording the edit, for the inverse operations replayed by the Edit Journal.
+ *	The module is updated at the commit of the transaction, outside transactions the listener is called.
+ *	\param[in] kind - Kind of the recorded edit the operation undoes.
+ *	\param[in] module - The edited Module Description.
+ */
+void Netlist::mark_edited(EditKind kind, Module_description* module)
+{
+	if (0 == m_transaction_depth)
+	{
+		if (m_change_listener)
+		{
+			m_change_listener(*this);
+		}
+		return;
+	}
+	m_edited_modules.insert(module);
+	m_is_module_added = m_is_module_added || EDIT_ADD_MODULE == kind;
+	m_is_interface_changed = m_is_interface_changed || EDIT_ADD_PORT == kind;
+}
+
+/** \brief Publishes the current state as an immutable version for the readers and deletes the unused retired versions.
+ *	Called by the writer, outside transactions. Every outermost commit publishes after the first call.
+ */
+void Netlist::publish()
+{
+	// A module is copied if it changed or was replaced, or if a module it instantiates is copied or removed,
+	// so the instances of the version never point to a module of an older version.
+	std::map< std::string, std::pair<const Module_description*, unsigned long> > revisions;
+	std::map< std::string, std::vector<std::string> > parents;
+	std::set<std::string> copied_names;
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator I;
+	for (I = m_modules.begin(); I != m_modules.end(); ++I)
+	{
+		if (!I->second)
+		{
+			continue;
+		}
+		std::pair<const Module_description*, unsigned long> revision(I->second.get(), I->second->get_revision());
+		revisions.insert(revisions.end(), std::make_pair(I->first, revision));
+		std::map< std::string, std::pair<const Module_description*, unsigned long> >::const_iterator found = m_version_revisions.find(I->first);
+		if (m_version_revisions.end() == found || found->second != revision)
+		{
+			copied_names.insert(I->first);
+		}
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = I->second->get_module_instances();
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J;
+		for (J = instances.begin(); J != instances.end(); ++J)
+		{
+			if (J->second->has_description())
+			{
+				parents[J->second->get_description_name()].push_back(I->first);
+			}
+		}
+	}
+	std::map< std::string, std::pair<const Module_description*, unsigned long> >::const_iterator R;
+	for (R = m_version_revisions.begin(); R != m_version_revisions.end(); ++R)
+	{
+		if (0 == revisions.count(R->first))
+		{
+			copied_names.insert(R->first);
+		}
+	}
+	std::vector<std::string> pending(copied_names.begin(), copied_names.end());
+	while (!pending.empty())
+	{
+		std::map< std::string, std::vector<std::string> >::const_iterator found = parents.find(pending.back());
+		pending.pop_back();
+		if (parents.end() == found)
+		{
+			continue;
+		}
+		for (std::vector<std::string>::const_iterator P = found->second.begin(); P != found->second.end(); ++P)
+		{
+			if (copied_names.insert(*P).second)
+			{
+				pending.push_back(*P);
+			}
+		}
+	}
+
+	// The copies are not held by the version, so they never record edits.
+	boost::shared_ptr<Netlist> version(new Netlist(m_name));
+	std::vector<Module_description*> copies;
+	for (I = m_modules.begin(); I != m_modules.end(); ++I)
+	{
+		if (!I->second)
+		{
+			continue;
+		}
+		boost::shared_ptr<Module_description> module;
+		if (m_version && 0 == copied_names.count(I->first))
+		{
+			module = m_version->m_modules.find(I->first)->second;
+		}
+		else
+		{
+			module = I->second->clone(I->first);
+			copies.push_back(module.get());
+		}
+		version->m_modules.insert(version->m_modules.end(), std::make_pair(I->first, module));
+	}
+	for (std::vector<Module_description*>::const_iterator C = copies.begin(); C != copies.end(); ++C)
+	{
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = (*C)->get_module_instances();
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J;
+		for (J = instances.begin(); J != instances.end(); ++J)
+		{
+			std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator found = version->m_modules.find(J->second->get_description_name());
+			if (J->second->has_description() && version->m_modules.end() != found)
+			{
+				J->second->set_module_description(*found->second);
+			}
+		}
+	}
+	m_version_revisions.swap(revisions);
+
+	// Readers pinning the new epoch load the new version, the replaced one waits for the readers of older epochs.
+	boost::shared_ptr<Netlist> retired = m_version;
+	m_version = version;
+	m_reader_version.store(version.get());
+	unsigned long epoch = ++m_epoch;
+	if (retired)
+	{
+		m_retired_versions.push_back(std::make_pair(epoch, retired));
+	}
+	reclaim_versions();
+}
+
+/// \brief Returns true if a version was published.
+bool Netlist::is_published() const
+{
+	return 0 != m_version.get();
+}
+
+/** \brief Pins the published version for a reader and returns it. Called by Netlist_reader.
+ *	Throws if the reader index is not valid or no version was published.
+ *	\param[in] reader - Index of the reader, used by one thread at a time.
+ */
+const Netlist& Netlist::enter_read(unsigned reader) const
+{
+	if (reader >= max_readers)
+	{
+		throw std::string("Invalid reader index.");
+	}
+
+	// The epoch is stored before the version is loaded, both sequentially consistent, so the writer sees the epoch
+	// before deleting a version this reader may load.
+	Reader_slot& slot = m_reader_slots[reader];
+	slot.epoch.store(m_epoch.load());
+	const Netlist* version = m_reader_version.load();
+	if (0 == version)
+	{
+		slot.epoch.store(0, boost::memory_order_release);
+		throw std::string("No published version of the Netlist.");
+	}
+	return *version;
+}
+
+/** \brief Unpins the version of a reader. Called by Netlist_reader.
+ *	\param[in] reader - Index of the reader.
+ */
+void Netlist::exit_read(unsigned reader) const
+{
+	m_reader_slots[reader].epoch.store(0, boost::memory_order_release);
+}
+
+/// \brief Returns the number of retired versions not deleted yet.
+size_t Netlist::get_retired_count() const
+{
+	return m_retired_versions.size();
+}
+
+/// \brief Deletes the retired versions no reader can hold.
+void Netlist::reclaim_versions()
+{
+	unsigned long oldest = ULONG_MAX;
+	for (unsigned i = 0; i < max_readers; ++i)
+	{
+		unsigned long epoch = m_reader_slots[i].epoch.load();
+		if (0 != epoch && epoch < oldest)
+		{
+			oldest = epoch;
+		}
+	}
+	size_t reclaimed = 0;
+	while (reclaimed < m_retired_versions.size() && m_retired_versions[reclaimed].first <= oldest)
+	{
+		++reclaimed;
+	}
+	m_retired_versions.erase(m_retired_versions.begin(), m_retired_versions.begin() + reclaimed);
 }
 
 /// \brief Returns all Module Descriptions of the current Netlist.
@@ -33,7 +386,7 @@ std::string Netlist::get_name() const
  */
 void Netlist::create_new_module(const std::string& name)
 {
-	m_modules.insert( std::pair<std::string, boost::shared_ptr<Module_description> >(name, boost::shared_ptr<Module_description>( new Module_description(name))));
+	add_module(boost::shared_ptr<Module_description>( new Module_description(name)));
 }
 
 /** \brief Gets module description by name.
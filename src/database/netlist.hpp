@@ -4,18 +4,52 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <utility>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/atomic.hpp>
+
+#include "edit_journal.hpp"
 
 class Module_description;
 
-/// Class for holding a complete Netlist.
+/** \brief Class for holding a complete Netlist.
+ *	Edits of the Netlist and of its Module Descriptions are recorded by the Edit Journal and reported to the change listener.
+ *	Edits between begin_transaction and commit_transaction are one undo step, and the work depending on them is done once
+ *	at the commit: the new instances of the edited modules are bound to their Module Descriptions (all modules are
+ *	checked if a module was added), the nets of the edited modules and of the modules instantiating a module with new
+ *	ports are connected, and the listener is called once.
+ *	Outside transactions the listener is called after every edit and nothing else is updated.
+ *
+ *	Concurrency: a Netlist has a single writer and any number of lock-free readers. Only one thread at a time edits the
+ *	Netlist and its Module Descriptions, Instances and Nets, commits and publishes; nothing of the live Netlist is safe
+ *	to read from other threads. Readers see published versions instead: publish() makes an immutable Netlist holding
+ *	connected copies of the modules, and once a version was published every outermost commit publishes a new one.
+ *	A version copies only the modules changed since the previous version and the modules instantiating them, the
+ *	others are shared, and the instances of a version point to the modules of the same version.
+ *	A reader thread pins the current version with a Netlist_reader and its own reader index: this stores the global
+ *	epoch in the reader slot and loads the version pointer, without locks and without copying shared pointers, so
+ *	readers on different cores do not write to shared cache lines. A replaced version is retired with the next epoch
+ *	and deleted by a later publish once no reader slot holds an older epoch. Readers must not copy the shared pointers
+ *	of a version, they are only valid while the version is pinned.
+ */
 class Netlist
 {
 public:
 
+	/// Function called with the Netlist after it changed.
+	typedef boost::function<void (Netlist&)> Change_listener;
+
+	/// Maximal number of concurrent readers, reader indices are in [0, max_readers).
+	static const unsigned max_readers = 64;
+
 	/// \brief Constructor by name.
 	Netlist(const std::string& name);
 
+	/// \brief Destructor, detaches the held modules, which may still be shared by other Netlists.
+	~Netlist();
+
 
 	/** \brief Creates a new empty module description.
 	 *	\param[in] name - The name of the new module.
@@ -28,15 +62,90 @@ public:
 	boost::shared_ptr<Module_description> get_module(const std::string& name);
 
 	/** \brief Adds given Module Description to the collection.
+	 *	A module already held by another Netlist is only shared: its edits are still recorded and notified by that Netlist.
 	 *	\param[in] module - The new Module Description.
 	 */
 	void add_module( const boost::shared_ptr<Module_description>& module);
 
+	/** \brief Removes the Module Description with the given name. Instances of it must be removed or rebound before.
+	 *	\param[in] name - The name of the module description.
+	 *	\ret True if the module was found.
+	 */
+	bool remove_module(const std::string& name);
+
+	/// \brief Returns the journal recording the edits of the Netlist and its Module Descriptions.
+	Edit_journal& get_journal();
+
+	/** \brief Sets the function called after the Netlist changed.
+	 *	\param[in] listener - The listener, an empty function for none.
+	 */
+	void set_change_listener(const Change_listener& listener);
+
+	/// \brief Starts a transaction. Transactions can be nested, the outermost one is committed.
+	void begin_transaction();
+
+	/// \brief Commits the current transaction. Throws if there is none.
+	void commit_transaction();
+
+	/// \brief Returns true inside a transaction.
+	bool is_in_transaction() const;
+
+	/** \brief Records an edit made to the Netlist or to one of its Module Descriptions. Called by the Module Descriptions.
+	 *	\param[in] kind - Kind of the edit.
+	 *	\param[in] module - The edited Module Description, the added or removed one for the edits of the Netlist.
+	 *	\param[in] object - The added or removed object.
+	 */
+	void record_edit(EditKind kind, Module_description* module, const boost::shared_ptr<void>& object);
+
+	/** \brief Marks a module edited without recording the edit, for the inverse operations replayed by the Edit Journal.
+	 *	The module is updated at the commit of the transaction, outside transactions the listener is called.
+	 *	\param[in] kind - Kind of the recorded edit the operation undoes.
+	 *	\param[in] module - The edited Module Description.
+	 */
+	void mark_edited(EditKind kind, Module_description* module);
+
+	/** \brief Publishes the current state as an immutable version for the readers and deletes the unused retired versions.
+	 *	Called by the writer, outside transactions. Every outermost commit publishes after the first call.
+	 */
+	void publish();
+
+	/// \brief Returns true if a version was published.
+	bool is_published() const;
+
+	/** \brief Pins the published version for a reader and returns it. Called by Netlist_reader.
+	 *	Throws if the reader index is not valid or no version was published.
+	 *	\param[in] reader - Index of the reader, used by one thread at a time.
+	 */
+	const Netlist& enter_read(unsigned reader) const;
+
+	/** \brief Unpins the version of a reader. Called by Netlist_reader.
+	 *	\param[in] reader - Index of the reader.
+	 */
+	void exit_read(unsigned reader) const;
+
+	/// \brief Returns the number of retired versions not deleted yet.
+	size_t get_retired_count() const;
+
 	/// \brief Returns all Module Descriptions of the current Netlist.
 	const std::map< std::string, boost::shared_ptr<Module_description> >& get_modules() const;
 
     std::string get_name() const;
 
+private:
+
+	/// Epoch of a reader, alone in its cache line.
+	struct Reader_slot
+	{
+		/// Global epoch when the reader pinned its version, 0 if the reader is not reading.
+		boost::atomic<unsigned long> epoch;
+
+		/// Padding up to the cache line size.
+		char padding[64 - sizeof(boost::atomic<unsigned long>)];
+	};
+
+	/// \brief Deletes the retired versions no reader can hold.
+	void reclaim_versions();
+
 private:
 
 	/// Name for the Netlist.
@@ -45,6 +154,42 @@ private:
 	/// Collection of the Modules in the Netlist.
 	std::map< std::string, boost::shared_ptr<Module_description> > m_modules;
 
+	/// Journal of the edits.
+	Edit_journal m_journal;
+
+	/// Function called after the Netlist changed.
+	Change_listener m_change_listener;
+
+	/// Depth of the nested transactions.
+	unsigned m_transaction_depth;
+
+	/// Modules edited by the current transaction.
+	std::set<const Module_description*> m_edited_modules;
+
+	/// True if the current transaction added a module.
+	bool m_is_module_added;
+
+	/// True if the current transaction added a port.
+	bool m_is_interface_changed;
+
+	/// Last published version, owned by the writer.
+	boost::shared_ptr<Netlist> m_version;
+
+	/// Last published version, loaded by the readers.
+	boost::atomic<const Netlist*> m_reader_version;
+
+	/// Global epoch, incremented by every publish.
+	boost::atomic<unsigned long> m_epoch;
+
+	/// Epochs of the readers.
+	mutable Reader_slot m_reader_slots[max_readers];
+
+	/// Replaced versions with the epoch from which no new reader can pin them.
+	std::vector< std::pair<unsigned long, boost::shared_ptr<Netlist> > > m_retired_versions;
+
+	/// Module Descriptions and revisions copied into the last version, by name.
+	std::map< std::string, std::pair<const Module_description*, unsigned long> > m_version_revisions;
+
 };
 
 #endif // NETLIST_H
@@ -62,14 +62,22 @@ Netlist_builder::Netlist_builder(std::istream& source_stream, const std::string&
 /// \brief The main routine for netlist parsing and constructing. Reads from the constructed stream and creates a Netlist Object.
 void Netlist_builder::construct_netlist()
 {
+	if (!m_source_stream->good())
+	{
+		throw std::string("Unable to read the netlist stream.");
+	}
+
 	/// Read all the Modules.
-	while (!m_source_stream->eof())
+	while (m_source_stream->good())
 	{
 		read_next_module_description();
 	}
 
 	/// Fix the references to the Module Descriptions from instances.
 	fix_instance_to_description_pointers();
+
+	/// Connect the nets to the module and instance ports.
+	connect_nets_to_ports();
 }
 
 /// \brief Reads next Module description from the stream.
@@ -143,6 +151,14 @@ void Netlist_builder::read_next_module_description()
 			continue;
 		}
 
+		// Check if it's an assignment, it must not be read as an instance.
+		if ( (info.size() > Netlist_keywords::assign.size()) && (info.substr(0, Netlist_keywords::assign.size()) == Netlist_keywords::assign)
+			&& (' ' == info[Netlist_keywords::assign.size()]) )
+		{
+			add_assign( info, comment );
+			continue;
+		}
+
 		// If nothing was found till now, then we must have an instance declaration(or invalid something). 
 		add_module_instance( info, comment );
 	}
@@ -174,6 +190,17 @@ void Netlist_builder::fix_instance_to_description_pointers()
 	}
 }
 
+/// \brief Connects the Nets of all modules to their ports. Must be called after fixing instance to description pointers.
+void Netlist_builder::connect_nets_to_ports()
+{
+	const std::map< std::string, boost::shared_ptr<Module_description> >& modules = m_netlist->get_modules();
+	std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator I;
+	for (I = modules.begin(); I != modules.end(); ++I)
+	{
+		I->second->connect_nets();
+	}
+}
+
 /// \brief Returns a shared pointer to the Netlist constructed. Must be called after @construct_netlist.
 boost::shared_ptr<Netlist> Netlist_builder::get_netlist()
 {
@@ -185,8 +212,9 @@ boost::shared_ptr<Netlist> Netlist_builder::get_netlist()
  */
 void Netlist_builder::start_new_module( const std::string& info )
 {
-	int st = info.find(" "), end = info.find("(");
+	int st = info.find(" "), end = info.find_first_of("(;");
 	std::string name = info.substr(st + 1, end - st - 1);
+	trim_leading_trailing_spaces( name );
 
 	m_netlist->create_new_module(name);
 	current_module = m_netlist->get_module(name);
@@ -242,6 +270,36 @@ void Netlist_builder::add_wire( const std::string& info, const std::string& comm
 	current_module->add_net(  boost::shared_ptr<Net>( new Net(name) )  );
 }
 
+/** \brief Called by parser to add assignments "assign a = b, c = d;" to current module description.
+ *	\param[in] info - The information part of the current string.
+ *	\param[in] comment - The comment part of the current string.
+ */
+void Netlist_builder::add_assign( const std::string& info, const std::string& comment )
+{
+	std::string rest = info.substr(Netlist_keywords::assign.size(), info.find(";") - Netlist_keywords::assign.size());
+	while (!rest.empty())
+	{
+		size_t comma = rest.find(",");
+		std::string assignment = rest.substr(0, comma);
+		rest = (std::string::npos == comma) ? std::string() : rest.substr(comma + 1);
+
+		size_t equal_sign = assignment.find("=");
+		if (std::string::npos == equal_sign)
+		{
+			throw std::string("Invalid assignment: " + info);
+		}
+		std::string target = assignment.substr(0, equal_sign);
+		std::string source = assignment.substr(equal_sign + 1);
+		trim_leading_trailing_spaces( target );
+		trim_leading_trailing_spaces( source );
+		if (target.empty() || source.empty())
+		{
+			throw std::string("Invalid assignment: " + info);
+		}
+		current_module->add_assign(target, source);
+	}
+}
+
 /** \brief Called by parser to add new instance to current module description. Parses the parameters from string line and calls another "add_module_instance".
  *	\param[in] info - The information part of the current string.
  *	\param[in] comment - The comment part of the current string.
@@ -274,19 +332,21 @@ void Netlist_builder::add_module_instance( const std::string& info, const std::s
 			break;
 		}
 		
-		open_brack = rest.find("(");
+		open_brack = rest.find("(", dot_position);
 		if (open_brack == std::string::npos)	
 		{
 			break;
 		}
 
-		close_brack = rest.find(")");
+		close_brack = rest.find(")", open_brack);
 		if (close_brack == std::string::npos)	
 		{
 			break;
 		}
-		wire_name = rest.substr(dot_position + 1, open_brack - dot_position - 1);
-		port_name = rest.substr(open_brack + 1, close_brack - open_brack - 1);
+		port_name = rest.substr(dot_position + 1, open_brack - dot_position - 1);
+		trim_leading_trailing_spaces( port_name );
+		wire_name = rest.substr(open_brack + 1, close_brack - open_brack - 1);
+		trim_leading_trailing_spaces( wire_name );
 		wire_port_pairs.push_back( std::make_pair(wire_name, port_name) );	
 		rest = rest.substr(close_brack + 1);
 	}
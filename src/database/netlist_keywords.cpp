@@ -6,3 +6,6 @@ const std::string Netlist_keywords::input = "input";
 const std::string Netlist_keywords::output = "output";
 const std::string Netlist_keywords::inout = "inout";
 const std::string Netlist_keywords::wire = "wire";
+const std::string Netlist_keywords::assign = "assign";
+const std::string Netlist_keywords::constant_zero = "1'b0";
+const std::string Netlist_keywords::constant_one = "1'b1";
@@ -14,6 +14,9 @@ public:
 	static const std::string inout;
 	static const std::string endmodule;
 	static const std::string wire;
+	static const std::string assign;
+	static const std::string constant_zero;
+	static const std::string constant_one;
 
 };
 
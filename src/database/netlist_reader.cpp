@@ -0,0 +1,25 @@
+#include "netlist_reader.hpp"
+#include "netlist.hpp"
+
+/** \brief Constructor, pins the last published version. Throws if nothing was published or the index is not valid.
+ *	\param[in] netlist - The live Netlist.
+ *	\param[in] reader - Index of the reader in [0, Netlist::max_readers), used by one guard at a time.
+ */
+Netlist_reader::Netlist_reader(const Netlist& netlist, unsigned reader)
+	: m_netlist( netlist )
+	, m_reader( reader )
+	, m_version( netlist.enter_read(reader) )
+{
+}
+
+/// \brief Destructor, unpins the version.
+Netlist_reader::~Netlist_reader()
+{
+	m_netlist.exit_read(m_reader);
+}
+
+/// \brief Returns the pinned version, an immutable Netlist.
+const Netlist& Netlist_reader::get_netlist() const
+{
+	return m_version;
+}
@@ -0,0 +1,41 @@
+#include "netlist_transaction.hpp"
+#include "netlist.hpp"
+
+/** \brief Constructor, begins a transaction.
+ *	\param[in] netlist - The Netlist, must outlive the guard.
+ */
+Netlist_transaction::Netlist_transaction(Netlist& netlist)
+	: m_netlist( netlist )
+	, m_is_committed( false )
+{
+	m_netlist.begin_transaction();
+}
+
+/// \brief Destructor, commits the transaction unless it was committed.
+Netlist_transaction::~Netlist_transaction()
+{
+	if (m_is_committed)
+	{
+		return;
+	}
+
+	// A destructor must not throw, it may run while an exception leaves the scope.
+	try
+	{
+		commit();
+	}
+	catch (...)
+	{
+	}
+}
+
+/// \brief Commits the transaction, throws what the commit throws.
+void Netlist_transaction::commit()
+{
+	if (m_is_committed)
+	{
+		return;
+	}
+	m_is_committed = true;
+	m_netlist.commit_transaction();
+}
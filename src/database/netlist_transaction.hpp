@@ -0,0 +1,34 @@
+#ifndef NETLIST_TRANSACTION_H
+#define NETLIST_TRANSACTION_H
+
+class Netlist;
+
+/** \brief Guard running a transaction of a Netlist for its lifetime.
+ *	The transaction is committed by the destructor, also when an exception leaves the scope, so it is never left open.
+ */
+class Netlist_transaction
+{
+public:
+
+	/** \brief Constructor, begins a transaction.
+	 *	\param[in] netlist - The Netlist, must outlive the guard.
+	 */
+	Netlist_transaction(Netlist& netlist);
+
+	/// \brief Destructor, commits the transaction unless it was committed.
+	~Netlist_transaction();
+
+	/// \brief Commits the transaction, throws what the commit throws.
+	void commit();
+
+private:
+
+	/// The Netlist.
+	Netlist& m_netlist;
+
+	/// True after the commit.
+	bool m_is_committed;
+
+};
+
+#endif // NETLIST_TRANSACTION_H
@@ -23,3 +23,11 @@ PortType Port::get_type() const
 	return m_type;
 }
 
+/** \brief Setter for the type.
+ *	\param[in] type - New type of the Port.
+ */
+void Port::set_type(PortType type)
+{
+	m_type = type;
+}
+
@@ -0,0 +1,46 @@
+#include "primitives.hpp"
+
+const std::string Primitives::output_pin = "Z";
+
+/// Helper data.
+namespace
+{
+	/// Netlist keywords of the primitives, indexed by PrimitiveType.
+	const std::string primitive_names[] = { "", "and", "or", "nand", "nor", "xor", "xnor", "not", "buf" };
+
+	/// Number of entries in primitive_names.
+	const int primitive_count = sizeof(primitive_names) / sizeof(primitive_names[0]);
+}
+
+/** \brief Returns the primitive type for the given Module Description name.
+ *	\param[in] description_name - Name of the Module Description of an instance.
+ *	\ret The primitive type, PRIMITIVE_NONE if the name is not a built-in primitive.
+ */
+PrimitiveType Primitives::get_type(const std::string& description_name)
+{
+	for (int i = 1; i < primitive_count; ++i)
+	{
+		if (primitive_names[i] == description_name)
+		{
+			return static_cast<PrimitiveType>(i);
+		}
+	}
+	return PRIMITIVE_NONE;
+}
+
+/** \brief Returns the netlist keyword of the given primitive type.
+ *	\param[in] type - Type of the primitive.
+ */
+const std::string& Primitives::get_name(PrimitiveType type)
+{
+	return primitive_names[type];
+}
+
+/** \brief Checks if the given pin of a primitive is its output.
+ *	\param[in] pin_name - Name of the primitive pin.
+ */
+bool Primitives::is_output_pin(const std::string& pin_name)
+{
+	return pin_name == output_pin;
+}
+
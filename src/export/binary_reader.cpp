@@ -0,0 +1,170 @@
+#include "binary_reader.hpp"
+#include "binary_writer.hpp"
+#include "analysis/parallel.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/net.hpp"
+
+#include <vector>
+#include <boost/bind.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// \brief Reads an unsigned LEB128 varint, throws at the end of the stream.
+	unsigned long long read_varint(std::istream& stream)
+	{
+		unsigned long long number = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			int byte = stream.get();
+			if (std::istream::traits_type::eof() == byte)
+			{
+				throw std::string("Truncated binary netlist.");
+			}
+			number |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+			if (0 == (byte & 0x80))
+			{
+				return number;
+			}
+		}
+		throw std::string("Invalid number in the binary netlist.");
+	}
+
+	/// \brief Reads a byte, throws at the end of the stream.
+	int read_byte(std::istream& stream)
+	{
+		int byte = stream.get();
+		if (std::istream::traits_type::eof() == byte)
+		{
+			throw std::string("Truncated binary netlist.");
+		}
+		return byte;
+	}
+
+	/// \brief Reads a string with its length, throws at the end of the stream.
+	void read_string(std::istream& stream, std::string& text)
+	{
+		text.resize(static_cast<size_t>(read_varint(stream)));
+		if (!text.empty() && !stream.read(&text[0], text.size()))
+		{
+			throw std::string("Truncated binary netlist.");
+		}
+	}
+
+	/// \brief Binds the instances of a chunk of modules to their Module Descriptions and connects the modules.
+	void connect_modules(const Netlist* netlist, std::vector<Module_description*>* modules, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			Module_description& module = *(*modules)[i];
+			const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+			for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+			{
+				std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator found = netlist->get_modules().find(I->second->get_description_name());
+				if (netlist->get_modules().end() != found)
+				{
+					I->second->set_module_description(*found->second);
+				}
+				I->second->set_parent_module_description(&module);
+			}
+			module.connect_nets();
+		}
+	}
+}
+
+/** \brief Constructor.
+ *	\param[in] thread_count - Number of threads used to connect the modules, 0 for the hardware thread count.
+ */
+Binary_reader::Binary_reader(unsigned thread_count)
+	: m_thread_count( thread_count )
+{
+}
+
+/** \brief Reads a Netlist. Throws if the stream is not a binary netlist or is truncated.
+ *	\param[in,out] stream - The input stream, opened in binary mode.
+ *	\ret The Netlist.
+ */
+boost::shared_ptr<Netlist> Binary_reader::read(std::istream& stream) const
+{
+	char magic[4];
+	if (!stream.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != "NLBN" || Binary_writer::version != read_byte(stream))
+	{
+		throw std::string("Not a binary netlist.");
+	}
+	std::string name;
+	read_string(stream, name);
+	boost::shared_ptr<Netlist> netlist(new Netlist(name));
+
+	std::vector<Module_description*> modules;
+	std::vector<std::string> net_names;
+	std::vector<std::string> masters;
+	std::vector< std::pair<std::string, std::string> > pins;
+	std::string target, source, instance_name;
+	for (unsigned long long module_count = read_varint(stream); 0 != module_count; --module_count)
+	{
+		read_string(stream, name);
+		boost::shared_ptr<Module_description> module(new Module_description(name));
+		for (unsigned long long count = read_varint(stream); 0 != count; --count)
+		{
+			read_string(stream, name);
+			int direction = read_byte(stream);
+			if (direction < IN || direction > INOUT)
+			{
+				throw std::string("Invalid port direction in the binary netlist.");
+			}
+			module->add_port(boost::shared_ptr<Module_port>(new Module_port(name, static_cast<PortType>(direction), module.get())));
+		}
+
+		// Implicit nets are created again by connect_nets.
+		net_names.resize(static_cast<size_t>(read_varint(stream)));
+		for (std::vector<std::string>::iterator I = net_names.begin(); I != net_names.end(); ++I)
+		{
+			read_string(stream, *I);
+			if (0 == (read_byte(stream) & 1))
+			{
+				module->add_net(boost::shared_ptr<Net>(new Net(*I)));
+			}
+		}
+		for (unsigned long long count = read_varint(stream); 0 != count; --count)
+		{
+			read_string(stream, target);
+			read_string(stream, source);
+			module->add_assign(target, source);
+		}
+		masters.resize(static_cast<size_t>(read_varint(stream)));
+		for (std::vector<std::string>::iterator I = masters.begin(); I != masters.end(); ++I)
+		{
+			read_string(stream, *I);
+		}
+
+		for (unsigned long long count = read_varint(stream); 0 != count; --count)
+		{
+			read_string(stream, instance_name);
+			unsigned long long master = read_varint(stream);
+			if (master >= masters.size())
+			{
+				throw std::string("Invalid index in the binary netlist.");
+			}
+			pins.resize(static_cast<size_t>(read_varint(stream)));
+			for (std::vector< std::pair<std::string, std::string> >::iterator I = pins.begin(); I != pins.end(); ++I)
+			{
+				read_string(stream, I->second);
+				unsigned long long net = read_varint(stream);
+				if (net > net_names.size() + 2)
+				{
+					throw std::string("Invalid index in the binary netlist.");
+				}
+				I->first = (net < 3) ? Net::get_constant_name(static_cast<LogicConstant>(net)) : net_names[static_cast<size_t>(net - 3)];
+			}
+			module->add_module_instance(masters[static_cast<size_t>(master)], instance_name, pins);
+		}
+		netlist->add_module(module);
+		modules.push_back(module.get());
+	}
+
+	Parallel::for_range(modules.size(), boost::bind(&connect_modules, netlist.get(), &modules, _1, _2), m_thread_count, 1);
+	return netlist;
+}
@@ -0,0 +1,154 @@
+#include "binary_writer.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+
+/// Helper functions.
+namespace
+{
+	/// \brief Appends the number as an unsigned LEB128 varint.
+	void append_varint(unsigned long long number, std::string& buffer)
+	{
+		while (number >= 0x80)
+		{
+			buffer += static_cast<char>((number & 0x7f) | 0x80);
+			number >>= 7;
+		}
+		buffer += static_cast<char>(number);
+	}
+
+	/// \brief Appends the string with its length.
+	void append_string(const std::string& text, std::string& buffer)
+	{
+		append_varint(text.size(), buffer);
+		buffer += text;
+	}
+}
+
+/// Version of the format written.
+const unsigned char Binary_writer::version = 1;
+
+/** \brief Constructor, numbers the nets and masters of the module.
+ *	\param[in] module - The Module Description, must outlive the table.
+ */
+Binary_writer::Module_table::Module_table(const Module_description& module)
+	: nets( module )
+{
+	const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+	for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+	{
+		const std::string& master = I->second->get_description_name();
+		if (master_indices.end() == master_indices.find(master))
+		{
+			master_indices.insert(std::make_pair(master, masters.size()));
+			masters.push_back(&master);
+		}
+	}
+}
+
+/** \brief Constructor with the Netlist.
+ *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+ *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+ */
+Binary_writer::Binary_writer(const Netlist& netlist, unsigned thread_count)
+	: Netlist_writer( netlist, thread_count )
+{
+}
+
+/** \brief Builds the tables of the modules of the batch.
+ *	\param[in] tasks - Tasks of the batch.
+ */
+void Binary_writer::prepare_batch(const std::vector<Task>& tasks)
+{
+	// A module continued from the previous batch keeps its table.
+	std::map<const Module_description*, boost::shared_ptr<Module_table> > tables;
+	for (std::vector<Task>::const_iterator I = tasks.begin(); I != tasks.end(); ++I)
+	{
+		boost::shared_ptr<Module_table>& table = tables[I->module];
+		if (!table)
+		{
+			std::map<const Module_description*, boost::shared_ptr<Module_table> >::const_iterator found = m_tables.find(I->module);
+			table = (m_tables.end() != found) ? found->second : boost::shared_ptr<Module_table>(new Module_table(*I->module));
+		}
+	}
+	m_tables.swap(tables);
+}
+
+/** \brief Appends the file header.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Binary_writer::format_begin(std::string& buffer) const
+{
+	buffer += "NLBN";
+	buffer += static_cast<char>(version);
+	append_string(get_netlist().get_name(), buffer);
+	append_varint(get_netlist().get_modules().size(), buffer);
+}
+
+/** \brief Appends a task to the buffer.
+ *	\param[in] task - The task.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Binary_writer::format_task(const Task& task, std::string& buffer) const
+{
+	const Module_description& module = *task.module;
+	const Module_table& table = *m_tables.find(task.module)->second;
+	if (task.is_first)
+	{
+		append_string(module.get_name(), buffer);
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = module.get_ports();
+		append_varint(ports.size(), buffer);
+		for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I = ports.begin(); I != ports.end(); ++I)
+		{
+			append_string(I->first, buffer);
+			buffer += static_cast<char>(I->second->get_type());
+		}
+
+		const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+		append_varint(nets.size() - nets.count(Net::get_constant_name(CONSTANT_ZERO)) - nets.count(Net::get_constant_name(CONSTANT_ONE)), buffer);
+		for (std::map<std::string, boost::shared_ptr<Net> >::const_iterator J = nets.begin(); J != nets.end(); ++J)
+		{
+			if (J->second->is_constant())
+			{
+				continue;
+			}
+			append_string(J->first, buffer);
+			buffer += static_cast<char>(J->second->is_implicit() ? 1 : 0);
+		}
+
+		const std::vector< std::pair<std::string, std::string> >& assigns = module.get_assigns();
+		append_varint(assigns.size(), buffer);
+		for (std::vector< std::pair<std::string, std::string> >::const_iterator K = assigns.begin(); K != assigns.end(); ++K)
+		{
+			append_string(K->first, buffer);
+			append_string(K->second, buffer);
+		}
+
+		append_varint(table.masters.size(), buffer);
+		for (std::vector<const std::string*>::const_iterator L = table.masters.begin(); L != table.masters.end(); ++L)
+		{
+			append_string(**L, buffer);
+		}
+		append_varint(module.get_module_instances().size(), buffer);
+	}
+
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = task.first_instance;
+	for (size_t i = 0; i < task.instance_count; ++i, ++I)
+	{
+		const Module_instance& instance = *I->second;
+		append_string(instance.get_name(), buffer);
+		append_varint(table.master_indices.find(instance.get_description_name())->second, buffer);
+		const std::vector<Instance_port>& pins = instance.get_ports();
+		append_varint(pins.size(), buffer);
+		for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end(); ++J)
+		{
+			append_string(J->get_name(), buffer);
+			LogicConstant constant = Net::parse_constant(J->get_net_name());
+			size_t net = (J->get_net_name().empty() || CONSTANT_NONE != constant) ? Net_index::npos : table.nets.find(J->get_net_name());
+			append_varint((Net_index::npos != net) ? net + 3 : static_cast<size_t>(constant), buffer);
+		}
+	}
+}
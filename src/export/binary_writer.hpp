@@ -0,0 +1,79 @@
+#ifndef BINARY_WRITER_HPP
+#define BINARY_WRITER_HPP
+
+#include <map>
+
+#include "netlist_writer.hpp"
+
+/** \brief Class for writing a Netlist in a compact binary interchange format, read back by the Binary Reader.
+ *	Numbers are unsigned LEB128 varints, strings are a varint length followed by the bytes:
+ *	\code
+ *	file     := "NLBN" version:byte netlist_name:string module_count:varint module*
+ *	module   := name:string port_count:varint port* net_count:varint net* assign_count:varint assign*
+ *	            master_count:varint master_name:string* instance_count:varint instance*
+ *	port     := name:string direction:byte (1 input, 2 output, 3 inout)
+ *	net      := name:string flags:byte (1 implicit), literal constants are not listed
+ *	assign   := target:string source:string
+ *	instance := name:string master_index:varint pin_count:varint pin*
+ *	pin      := name:string net:varint (0 unconnected, 1 constant 0, 2 constant 1, index of the net in the module plus 3)
+ *	\endcode
+ *	Nets and masters are numbered per module, so modules can be serialized independently. Formatting runs in parallel,
+ *	see Netlist_writer; memory is bounded by the batch and the net and master tables of the modules being written.
+ */
+class Binary_writer : public Netlist_writer
+{
+public:
+
+	/// Version of the format written.
+	static const unsigned char version;
+
+	/** \brief Constructor with the Netlist.
+	 *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+	 *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+	 */
+	Binary_writer(const Netlist& netlist, unsigned thread_count = 0);
+
+protected:
+
+	/// Nets and masters of a module, numbered for the module.
+	struct Module_table
+	{
+		/** \brief Constructor, numbers the nets and masters of the module.
+		 *	\param[in] module - The Module Description, must outlive the table.
+		 */
+		explicit Module_table(const Module_description& module);
+
+		/// Indices of the nets.
+		Net_index nets;
+
+		/// Names of the masters in the order of their first instance.
+		std::vector<const std::string*> masters;
+
+		/// Indices of the masters by name.
+		std::map<std::string, size_t> master_indices;
+	};
+
+	/** \brief Builds the tables of the modules of the batch.
+	 *	\param[in] tasks - Tasks of the batch.
+	 */
+	virtual void prepare_batch(const std::vector<Task>& tasks);
+
+	/** \brief Appends the file header.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_begin(std::string& buffer) const;
+
+	/** \brief Appends a task to the buffer.
+	 *	\param[in] task - The task.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_task(const Task& task, std::string& buffer) const;
+
+private:
+
+	/// Tables of the modules of the current batch.
+	std::map<const Module_description*, boost::shared_ptr<Module_table> > m_tables;
+
+};
+
+#endif // BINARY_WRITER_HPP
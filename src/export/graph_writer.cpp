@@ -0,0 +1,429 @@
+#include "graph_writer.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+
+#include <climits>
+#include <sstream>
+
+/// Helper functions.
+namespace
+{
+	/// \brief Returns the text quoted for DOT, line breaks become "\n".
+	std::string quote_dot(const std::string& text)
+	{
+		std::string quoted(1, '"');
+		for (std::string::const_iterator I = text.begin(); I != text.end(); ++I)
+		{
+			if ('\n' == *I)
+			{
+				quoted += "\\n";
+				continue;
+			}
+			if ('"' == *I || '\\' == *I)
+			{
+				quoted += '\\';
+			}
+			quoted += *I;
+		}
+		return quoted + '"';
+	}
+
+	/// \brief Returns the text escaped for XML.
+	std::string escape_xml(const std::string& text)
+	{
+		std::string escaped;
+		for (std::string::const_iterator I = text.begin(); I != text.end(); ++I)
+		{
+			switch (*I)
+			{
+			case '&': escaped += "&amp;"; break;
+			case '<': escaped += "&lt;"; break;
+			case '>': escaped += "&gt;"; break;
+			case '"': escaped += "&quot;"; break;
+			case '\'': escaped += "&apos;"; break;
+			default: escaped += *I;
+			}
+		}
+		return escaped;
+	}
+
+	/// \brief Returns the direction name of the port type.
+	const char* get_direction(PortType type)
+	{
+		if (IN == type)
+		{
+			return "input";
+		}
+		return (OUT == type) ? "output" : "inout";
+	}
+
+	/// \brief Writes a node with its label and kind.
+	void write_node(std::ostream& stream, Graph_writer::Format format, const std::string& id, const std::string& label, const std::string& kind, const char* dot_style)
+	{
+		if (Graph_writer::FORMAT_DOT == format)
+		{
+			stream << "  " << quote_dot(id) << " [label=" << quote_dot(label) << dot_style << "];\n";
+		}
+		else
+		{
+			stream << "    <node id=\"" << escape_xml(id) << "\"><data key=\"label\">" << escape_xml(label)
+				<< "</data><data key=\"kind\">" << escape_xml(kind) << "</data></node>\n";
+		}
+	}
+
+	/// \brief Writes an edge labeled with the net name.
+	void write_edge(std::ostream& stream, Graph_writer::Format format, const std::string& source, const std::string& target, const std::string& net)
+	{
+		if (Graph_writer::FORMAT_DOT == format)
+		{
+			stream << "  " << quote_dot(source) << " -> " << quote_dot(target) << " [label=" << quote_dot(net) << "];\n";
+		}
+		else
+		{
+			stream << "    <edge source=\"" << escape_xml(source) << "\" target=\"" << escape_xml(target)
+				<< "\"><data key=\"label\">" << escape_xml(net) << "</data></edge>\n";
+		}
+	}
+}
+
+/** \brief Constructor with the module, nothing is selected.
+ *	\param[in] module - The connected Module Description, must outlive the writer.
+ *	\param[in] max_nodes - Maximal number of selected instances and ports.
+ *	\param[in] max_fanout - Nets with more sinks are clustered into a hub node.
+ */
+Graph_writer::Graph_writer(const Module_description& module, size_t max_nodes, size_t max_fanout)
+	: m_module( module )
+	, m_max_nodes( max_nodes )
+	, m_max_fanout( max_fanout )
+	, m_is_truncated( false )
+{
+}
+
+/// \brief Selects the ports and instances of the module in name order, up to the node limit.
+void Graph_writer::select_all()
+{
+	clear();
+	const std::map<std::string, boost::shared_ptr<Module_port> >& ports = m_module.get_ports();
+	for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I = ports.begin(); I != ports.end(); ++I)
+	{
+		select(*I->second);
+	}
+	const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = m_module.get_module_instances();
+	for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator J = instances.begin(); J != instances.end() && !m_is_truncated; ++J)
+	{
+		if (m_nodes.size() >= m_max_nodes)
+		{
+			m_is_truncated = true;
+			break;
+		}
+		Node node = { J->second.get(), 0 };
+		m_node_indices.insert(std::make_pair(node.instance, m_nodes.size()));
+		m_nodes.push_back(node);
+	}
+}
+
+/** \brief Selects the instances and ports within a number of nets of the seeds, breadth first, up to the node limit.
+ *	\param[in] seeds - Names of the seed instances or ports. Throws if a name is not found.
+ *	\param[in] radius - Number of nets to cross from the seeds, 0 for the seeds only.
+ */
+void Graph_writer::select_region(const std::vector<std::string>& seeds, unsigned radius)
+{
+	clear();
+	std::vector<Pending_node> pending;
+	for (std::vector<std::string>::const_iterator I = seeds.begin(); I != seeds.end(); ++I)
+	{
+		std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator instance = m_module.get_module_instances().find(*I);
+		std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator port = m_module.get_ports().find(*I);
+		if (m_module.get_module_instances().end() == instance && m_module.get_ports().end() == port)
+		{
+			throw std::string("Unable to find the instance or port: " + *I);
+		}
+		size_t count = m_nodes.size();
+		if (m_module.get_ports().end() != port)
+		{
+			select(*port->second);
+		}
+		else if (m_nodes.size() < m_max_nodes)
+		{
+			if (m_node_indices.insert(std::make_pair(instance->second.get(), m_nodes.size())).second)
+			{
+				Node node = { instance->second.get(), 0 };
+				m_nodes.push_back(node);
+			}
+		}
+		else
+		{
+			m_is_truncated = true;
+		}
+		if (count != m_nodes.size())
+		{
+			pending.push_back(Pending_node(count, 0));
+		}
+	}
+	expand(pending, radius, false);
+}
+
+/** \brief Selects the fan-in cone of a net, breadth first through the drivers, up to the node limit.
+ *	\param[in] net_name - Name of the net. Throws if the module has no such net.
+ *	\param[in] depth - Number of instances to cross, 0 for the complete cone.
+ */
+void Graph_writer::select_cone(const std::string& net_name, unsigned depth)
+{
+	clear();
+	std::map<std::string, boost::shared_ptr<Net> >::const_iterator net = m_module.get_nets().find(m_module.get_canonical_net_name(Net::normalize_name(net_name)));
+	if (m_module.get_nets().end() == net)
+	{
+		throw std::string("Unable to find the net: " + net_name);
+	}
+	std::vector<Pending_node> pending;
+	if (net->second->has_source_port())
+	{
+		select(net->second->get_source_port());
+	}
+	if (!m_nodes.empty())
+	{
+		pending.push_back(Pending_node(0, 0));
+	}
+	expand(pending, (0 == depth) ? UINT_MAX : depth - 1, true);
+}
+
+/** \brief Writes the selected nodes and the nets between them.
+ *	\param[in,out] stream - The output stream.
+ *	\param[in] format - The output format.
+ */
+void Graph_writer::write(std::ostream& stream, Format format) const
+{
+	if (FORMAT_DOT == format)
+	{
+		stream << "digraph " << quote_dot(m_module.get_name()) << " {\n  rankdir=LR;\n  node [shape=box];\n";
+	}
+	else
+	{
+		stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			<< "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+			<< "  <key id=\"label\" for=\"all\" attr.name=\"label\" attr.type=\"string\"/>\n"
+			<< "  <key id=\"kind\" for=\"node\" attr.name=\"kind\" attr.type=\"string\"/>\n"
+			<< "  <graph id=\"" << escape_xml(m_module.get_name()) << "\" edgedefault=\"directed\">\n";
+	}
+
+	// Nets are written in name order, so the output does not depend on the selection order.
+	std::map<std::string, const Net*> nets;
+	std::vector<std::pair<const Net*, bool> > node_nets;
+	for (std::vector<Node>::const_iterator I = m_nodes.begin(); I != m_nodes.end(); ++I)
+	{
+		if (0 != I->instance)
+		{
+			write_node(stream, format, get_node_id(*I), I->instance->get_name() + "\n" + I->instance->get_description_name(), I->instance->get_description_name(), "");
+		}
+		else
+		{
+			const char* styles[] = { "", ", shape=invhouse", ", shape=house", ", shape=diamond" };
+			write_node(stream, format, get_node_id(*I), I->port->get_name(), get_direction(I->port->get_type()), styles[I->port->get_type()]);
+		}
+		get_nets(*I, node_nets);
+		for (std::vector<std::pair<const Net*, bool> >::const_iterator J = node_nets.begin(); J != node_nets.end(); ++J)
+		{
+			nets.insert(std::make_pair(J->first->get_name(), J->first));
+		}
+	}
+
+	for (std::map<std::string, const Net*>::const_iterator I = nets.begin(); I != nets.end(); ++I)
+	{
+		const Net& net = *I->second;
+		if (net.is_constant())
+		{
+			continue;
+		}
+		std::string driver;
+		if (net.has_source_port())
+		{
+			size_t index = find_node(net.get_source_port());
+			driver = (m_nodes.size() != index) ? get_node_id(m_nodes[index]) : std::string();
+		}
+		const std::vector<const Port*>& sinks = net.get_destination_ports();
+		bool is_clustered = sinks.size() > m_max_fanout;
+		if (is_clustered)
+		{
+			std::ostringstream label;
+			label << net.get_name() << "\n" << sinks.size() << " sinks";
+			std::string hub = "n:" + net.get_name();
+			write_node(stream, format, hub, label.str(), "net", ", shape=ellipse, style=dashed");
+			if (!driver.empty())
+			{
+				write_edge(stream, format, driver, hub, net.get_name());
+			}
+			driver = hub;
+		}
+		if (driver.empty())
+		{
+			continue;
+		}
+		for (std::vector<const Port*>::const_iterator J = sinks.begin(); J != sinks.end(); ++J)
+		{
+			size_t index = find_node(**J);
+			if (m_nodes.size() != index)
+			{
+				write_edge(stream, format, driver, get_node_id(m_nodes[index]), net.get_name());
+			}
+		}
+	}
+
+	if (m_is_truncated)
+	{
+		std::ostringstream label;
+		label << "truncated at " << m_max_nodes << " nodes";
+		write_node(stream, format, "truncated", label.str(), "note", ", shape=note");
+	}
+	stream << ((FORMAT_DOT == format) ? "}\n" : "  </graph>\n</graphml>\n");
+}
+
+/// \brief Returns the number of selected instances and ports.
+size_t Graph_writer::get_node_count() const
+{
+	return m_nodes.size();
+}
+
+/// \brief Returns true if the last selection stopped at the node limit.
+bool Graph_writer::is_truncated() const
+{
+	return m_is_truncated;
+}
+
+/// \brief Clears the selection.
+void Graph_writer::clear()
+{
+	m_nodes.clear();
+	m_node_indices.clear();
+	m_is_truncated = false;
+}
+
+/** \brief Selects the node owning the port, if it is not selected yet and the limit is not reached.
+ *	\param[in] port - A module or instance port.
+ *	\ret Index of the node, or the node count if it was not selected.
+ */
+size_t Graph_writer::select(const Port& port)
+{
+	size_t index = find_node(port);
+	if (m_nodes.size() != index)
+	{
+		return index;
+	}
+	if (m_nodes.size() >= m_max_nodes)
+	{
+		m_is_truncated = true;
+		return m_nodes.size();
+	}
+
+	// Module ports are told from instance ports by their address.
+	Node node = { 0, 0 };
+	std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator found = m_module.get_ports().find(port.get_name());
+	if (m_module.get_ports().end() != found && &port == found->second.get())
+	{
+		node.port = found->second.get();
+		m_node_indices.insert(std::make_pair(static_cast<const void*>(node.port), m_nodes.size()));
+	}
+	else
+	{
+		node.instance = static_cast<const Instance_port&>(port).get_parent_module_instance();
+		m_node_indices.insert(std::make_pair(static_cast<const void*>(node.instance), m_nodes.size()));
+	}
+	m_nodes.push_back(node);
+	return m_nodes.size() - 1;
+}
+
+/** \brief Selects the nodes reached from the pending nodes, breadth first.
+ *	\param[in] pending - Seed nodes with distance 0.
+ *	\param[in] max_distance - Nodes at this distance from the seeds are not expanded.
+ *	\param[in] is_fanin_only - True to cross nets only from their sinks to their drivers.
+ */
+void Graph_writer::expand(std::vector<Pending_node>& pending, unsigned max_distance, bool is_fanin_only)
+{
+	std::vector<std::pair<const Net*, bool> > nets;
+	for (size_t head = 0; head < pending.size(); ++head)
+	{
+		unsigned distance = pending[head].second;
+		if (distance >= max_distance)
+		{
+			continue;
+		}
+		get_nets(m_nodes[pending[head].first], nets);
+		for (std::vector<std::pair<const Net*, bool> >::const_iterator I = nets.begin(); I != nets.end(); ++I)
+		{
+			// Constants and clustered nets are not followed.
+			const Net& net = *I->first;
+			if ((is_fanin_only && I->second) || net.is_constant() || net.get_destination_ports().size() > m_max_fanout)
+			{
+				continue;
+			}
+			std::vector<const Port*> ports;
+			if (net.has_source_port())
+			{
+				ports.push_back(&net.get_source_port());
+			}
+			if (!is_fanin_only)
+			{
+				ports.insert(ports.end(), net.get_destination_ports().begin(), net.get_destination_ports().end());
+			}
+			for (std::vector<const Port*>::const_iterator J = ports.begin(); J != ports.end(); ++J)
+			{
+				size_t count = m_nodes.size();
+				size_t index = select(**J);
+				if (count != m_nodes.size())
+				{
+					pending.push_back(Pending_node(index, distance + 1));
+				}
+			}
+		}
+	}
+}
+
+/** \brief Returns the Nets connected to the node with the type of its port on them.
+ *	\param[in] node - The node.
+ *	\param[out] nets - The Nets, with true for the nets driven by the node.
+ */
+void Graph_writer::get_nets(const Node& node, std::vector<std::pair<const Net*, bool> >& nets) const
+{
+	nets.clear();
+	const std::map<std::string, boost::shared_ptr<Net> >& module_nets = m_module.get_nets();
+	if (0 != node.port)
+	{
+		std::map<std::string, boost::shared_ptr<Net> >::const_iterator found = module_nets.find(m_module.get_canonical_net_name(node.port->get_name()));
+		if (module_nets.end() != found)
+		{
+			nets.push_back(std::make_pair(found->second.get(), OUT != node.port->get_type()));
+		}
+		return;
+	}
+	const std::vector<Instance_port>& pins = node.instance->get_ports();
+	for (std::vector<Instance_port>::const_iterator I = pins.begin(); I != pins.end(); ++I)
+	{
+		std::map<std::string, boost::shared_ptr<Net> >::const_iterator found = module_nets.find(I->get_net_name());
+		if (!I->get_net_name().empty() && module_nets.end() != found)
+		{
+			nets.push_back(std::make_pair(found->second.get(), OUT == I->get_type()));
+		}
+	}
+}
+
+/** \brief Returns the index of the selected node owning the port, the node count if it is not selected.
+ *	\param[in] port - A module or instance port.
+ */
+size_t Graph_writer::find_node(const Port& port) const
+{
+	std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator found = m_module.get_ports().find(port.get_name());
+	const void* owner = (m_module.get_ports().end() != found && &port == found->second.get())
+		? static_cast<const void*>(&port) : static_cast<const void*>(static_cast<const Instance_port&>(port).get_parent_module_instance());
+	std::map<const void*, size_t>::const_iterator index = m_node_indices.find(owner);
+	return (m_node_indices.end() != index) ? index->second : m_nodes.size();
+}
+
+/** \brief Returns the identifier of a node in the output.
+ *	\param[in] node - The node.
+ */
+std::string Graph_writer::get_node_id(const Node& node) const
+{
+	return (0 != node.instance) ? "i:" + node.instance->get_name() : "p:" + node.port->get_name();
+}
@@ -0,0 +1,233 @@
+#include "json_writer.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+
+#include <set>
+#include <cstdio>
+
+/// Helper functions.
+namespace
+{
+	/// First number given to the nets, 0 and 1 stand for the constants in Yosys.
+	const size_t first_net_bit = 2;
+
+	/// \brief Returns the JSON direction of the port type.
+	const char* get_direction(PortType type)
+	{
+		if (IN == type)
+		{
+			return "\"input\"";
+		}
+		return (OUT == type) ? "\"output\"" : "\"inout\"";
+	}
+
+	/// \brief Appends the string as a quoted JSON string.
+	void append_string(const std::string& text, std::string& buffer)
+	{
+		buffer += '"';
+		for (std::string::const_iterator I = text.begin(); I != text.end(); ++I)
+		{
+			if ('"' == *I || '\\' == *I)
+			{
+				buffer += '\\';
+				buffer += *I;
+			}
+			else if (static_cast<unsigned char>(*I) < 0x20)
+			{
+				char escaped[8];
+				std::sprintf(escaped, "\\u%04x", static_cast<unsigned>(*I));
+				buffer += escaped;
+			}
+			else
+			{
+				buffer += *I;
+			}
+		}
+		buffer += '"';
+	}
+
+	/// \brief Appends the number.
+	void append_number(size_t number, std::string& buffer)
+	{
+		char digits[24];
+		int size = std::sprintf(digits, "%lu", static_cast<unsigned long>(number));
+		buffer.append(digits, size);
+	}
+}
+
+/** \brief Constructor with the Netlist.
+ *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+ *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+ */
+Json_writer::Json_writer(const Netlist& netlist, unsigned thread_count)
+	: Netlist_writer( netlist, thread_count )
+{
+}
+
+/** \brief Indexes the nets of the modules of the batch.
+ *	\param[in] tasks - Tasks of the batch.
+ */
+void Json_writer::prepare_batch(const std::vector<Task>& tasks)
+{
+	// A module continued from the previous batch keeps its index.
+	std::map<const Module_description*, boost::shared_ptr<Net_index> > indices;
+	for (std::vector<Task>::const_iterator I = tasks.begin(); I != tasks.end(); ++I)
+	{
+		boost::shared_ptr<Net_index>& index = indices[I->module];
+		if (!index)
+		{
+			std::map<const Module_description*, boost::shared_ptr<Net_index> >::const_iterator found = m_net_indices.find(I->module);
+			index = (m_net_indices.end() != found) ? found->second : boost::shared_ptr<Net_index>(new Net_index(*I->module));
+		}
+	}
+	m_net_indices.swap(indices);
+}
+
+/** \brief Appends the opening of the document.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Json_writer::format_begin(std::string& buffer) const
+{
+	buffer += "{\n  \"creator\": \"netlist export\",\n  \"modules\": {\n";
+}
+
+/** \brief Appends the closing of the document.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Json_writer::format_end(std::string& buffer) const
+{
+	buffer += "\n  }\n}\n";
+}
+
+/** \brief Appends a task to the buffer.
+ *	\param[in] task - The task.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Json_writer::format_task(const Task& task, std::string& buffer) const
+{
+	const Module_description& module = *task.module;
+	const Net_index& nets = *m_net_indices.find(task.module)->second;
+	if (task.is_first)
+	{
+		buffer += (0 == task.module_index) ? "    " : ",\n    ";
+		append_string(module.get_name(), buffer);
+		buffer += ": {\n      \"ports\": {";
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = module.get_ports();
+		for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I = ports.begin(); I != ports.end(); ++I)
+		{
+			buffer += (ports.begin() == I) ? "\n        " : ",\n        ";
+			append_string(I->first, buffer);
+			buffer += ": { \"direction\": ";
+			buffer += get_direction(I->second->get_type());
+			buffer += ", \"bits\": ";
+			format_bits(module, nets, I->first, buffer);
+			buffer += " }";
+		}
+
+		// Constants have no net name, names aliased away by assignments share the bits of their canonical net.
+		buffer += "\n      },\n      \"netnames\": {";
+		bool is_first_net = true;
+		const std::map<std::string, boost::shared_ptr<Net> >& declared = module.get_nets();
+		for (std::map<std::string, boost::shared_ptr<Net> >::const_iterator J = declared.begin(); J != declared.end(); ++J)
+		{
+			if (J->second->is_constant())
+			{
+				continue;
+			}
+			buffer += is_first_net ? "\n        " : ",\n        ";
+			is_first_net = false;
+			append_string(J->first, buffer);
+			buffer += ": { \"bits\": ";
+			format_bits(module, nets, J->first, buffer);
+			buffer += " }";
+		}
+		std::set<std::string> aliased;
+		const std::vector< std::pair<std::string, std::string> >& assigns = module.get_assigns();
+		for (std::vector< std::pair<std::string, std::string> >::const_iterator K = assigns.begin(); K != assigns.end(); ++K)
+		{
+			const std::string* names[] = { &K->first, &K->second };
+			for (int i = 0; i < 2; ++i)
+			{
+				if (declared.count(*names[i]) || CONSTANT_NONE != Net::parse_constant(*names[i]) || !aliased.insert(*names[i]).second)
+				{
+					continue;
+				}
+				buffer += is_first_net ? "\n        " : ",\n        ";
+				is_first_net = false;
+				append_string(*names[i], buffer);
+				buffer += ": { \"bits\": ";
+				format_bits(module, nets, *names[i], buffer);
+				buffer += " }";
+			}
+		}
+		buffer += "\n      },\n      \"cells\": {";
+	}
+
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = task.first_instance;
+	for (size_t i = 0; i < task.instance_count; ++i, ++I)
+	{
+		const Module_instance& instance = *I->second;
+		buffer += (0 == task.instance_index + i) ? "\n        " : ",\n        ";
+		append_string(instance.get_name(), buffer);
+		buffer += ": {\n          \"type\": ";
+		append_string(instance.get_description_name(), buffer);
+		buffer += ",\n          \"port_directions\": {";
+		const std::vector<Instance_port>& pins = instance.get_ports();
+		std::vector<Instance_port>::const_iterator J;
+		for (J = pins.begin(); J != pins.end(); ++J)
+		{
+			buffer += (pins.begin() == J) ? " " : ", ";
+			append_string(J->get_name(), buffer);
+			buffer += ": ";
+			buffer += get_direction(J->get_type());
+		}
+		buffer += " },\n          \"connections\": {";
+		for (J = pins.begin(); J != pins.end(); ++J)
+		{
+			buffer += (pins.begin() == J) ? " " : ", ";
+			append_string(J->get_name(), buffer);
+			buffer += ": ";
+			format_bits(module, nets, J->get_net_name(), buffer);
+		}
+		buffer += " }\n        }";
+	}
+
+	if (task.is_last)
+	{
+		buffer += "\n      }\n    }";
+	}
+}
+
+/** \brief Appends the bits of a net name as a JSON array.
+ *	\param[in] module - The module of the net.
+ *	\param[in] nets - Net index of the module.
+ *	\param[in] name - Name of the net, empty for an unconnected pin.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Json_writer::format_bits(const Module_description& module, const Net_index& nets, const std::string& name, std::string& buffer) const
+{
+	if (name.empty())
+	{
+		buffer += "[ ]";
+		return;
+	}
+	const std::string& canonical = module.get_canonical_net_name(name);
+	LogicConstant constant = Net::parse_constant(canonical);
+	if (CONSTANT_NONE != constant)
+	{
+		buffer += (CONSTANT_ONE == constant) ? "[ \"1\" ]" : "[ \"0\" ]";
+		return;
+	}
+	size_t index = nets.find(canonical);
+	if (Net_index::npos == index)
+	{
+		buffer += "[ \"x\" ]";
+		return;
+	}
+	buffer += "[ ";
+	append_number(first_net_bit + index, buffer);
+	buffer += " ]";
+}
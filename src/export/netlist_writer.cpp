@@ -0,0 +1,337 @@
+#include "netlist_writer.hpp"
+#include "analysis/parallel.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/net.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <zlib.h>
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// Maximal number of instances formatted by one task.
+	const size_t instances_per_task = 4096;
+
+	/// Number of tasks per thread in a batch.
+	const size_t tasks_per_thread = 4;
+
+	/// Closes a file descriptor when leaving the scope.
+	struct File_closer
+	{
+		explicit File_closer(int file) : file( file ) {}
+		~File_closer() { ::close(file); }
+		int file;
+	};
+
+	/// \brief Writes the buffers to the stream.
+	void write_stream(std::ostream* stream, std::vector<std::string>& buffers)
+	{
+		for (std::vector<std::string>::const_iterator I = buffers.begin(); I != buffers.end(); ++I)
+		{
+			stream->write(I->data(), I->size());
+		}
+		if (!stream->good())
+		{
+			throw std::string("Unable to write the netlist stream.");
+		}
+	}
+
+	/// \brief Writes the non-empty buffers to the file with vectored writes.
+	void write_file(int file, std::vector<std::string>& buffers)
+	{
+		std::vector<iovec> vectors;
+		for (std::vector<std::string>::iterator I = buffers.begin(); I != buffers.end(); ++I)
+		{
+			if (!I->empty())
+			{
+				iovec vector = { &(*I)[0], I->size() };
+				vectors.push_back(vector);
+			}
+		}
+
+		size_t index = 0;
+		while (index < vectors.size())
+		{
+			ssize_t written = ::writev(file, &vectors[index], static_cast<int>(std::min<size_t>(vectors.size() - index, IOV_MAX)));
+			if (written < 0)
+			{
+				if (EINTR == errno)
+				{
+					continue;
+				}
+				throw std::string("Unable to write the netlist file.");
+			}
+			// Skip the written vectors, a partial write resumes inside a vector.
+			size_t remaining = static_cast<size_t>(written);
+			while (index < vectors.size() && remaining >= vectors[index].iov_len)
+			{
+				remaining -= vectors[index].iov_len;
+				++index;
+			}
+			if (0 != remaining)
+			{
+				vectors[index].iov_base = static_cast<char*>(vectors[index].iov_base) + remaining;
+				vectors[index].iov_len -= remaining;
+			}
+		}
+	}
+
+	/// \brief Deflates a chunk of buffers in place, each into a gzip member.
+	void compress_buffers(std::vector<std::string>* buffers, size_t begin, size_t end)
+	{
+		std::string compressed;
+		for (size_t i = begin; i < end; ++i)
+		{
+			std::string& buffer = (*buffers)[i];
+			if (buffer.empty())
+			{
+				continue;
+			}
+			z_stream stream;
+			stream.zalloc = Z_NULL;
+			stream.zfree = Z_NULL;
+			stream.opaque = Z_NULL;
+			// 16 added to the window bits selects the gzip wrapper.
+			if (Z_OK != deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY))
+			{
+				throw std::string("Unable to initialize the compression.");
+			}
+			compressed.resize(deflateBound(&stream, buffer.size()));
+			stream.next_in = reinterpret_cast<Bytef*>(&buffer[0]);
+			stream.avail_in = static_cast<uInt>(buffer.size());
+			stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+			stream.avail_out = static_cast<uInt>(compressed.size());
+			int result = deflate(&stream, Z_FINISH);
+			compressed.resize(stream.total_out);
+			deflateEnd(&stream);
+			if (Z_STREAM_END != result)
+			{
+				throw std::string("Unable to compress the netlist file.");
+			}
+			buffer.swap(compressed);
+		}
+	}
+
+	/// \brief Compresses the buffers in parallel and writes them to the file.
+	void write_compressed_file(int file, unsigned thread_count, std::vector<std::string>& buffers)
+	{
+		Parallel::for_range(buffers.size(), boost::bind(&compress_buffers, &buffers, _1, _2), thread_count, 1);
+		write_file(file, buffers);
+	}
+}
+
+/** \brief Constructor with the Netlist.
+ *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+ *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+ */
+Netlist_writer::Netlist_writer(const Netlist& netlist, unsigned thread_count)
+	: m_netlist( netlist )
+	, m_thread_count( (0 == thread_count) ? Parallel::get_thread_count() : thread_count )
+	, m_byte_count( 0 )
+{
+}
+
+/// \brief Destructor.
+Netlist_writer::~Netlist_writer()
+{
+}
+
+/** \brief Writes the Netlist to the stream. Throws if the stream fails.
+ *	\param[in,out] stream - The output stream.
+ */
+void Netlist_writer::write(std::ostream& stream)
+{
+	write_batches(boost::bind(&write_stream, &stream, _1));
+	stream.flush();
+}
+
+/** \brief Writes the Netlist to a file. Throws if the file can not be written.
+ *	\param[in] file_name - Name of the file, replaced if it exists.
+ *	\param[in] is_compressed - True to write a gzip file.
+ */
+void Netlist_writer::write(const std::string& file_name, bool is_compressed)
+{
+	int file = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+	{
+		throw std::string("Unable to open the file: " + file_name);
+	}
+	File_closer closer(file);
+	if (is_compressed)
+	{
+		write_batches(boost::bind(&write_compressed_file, file, m_thread_count, _1));
+	}
+	else
+	{
+		write_batches(boost::bind(&write_file, file, _1));
+	}
+}
+
+/// \brief Returns the number of bytes formatted by the last write, before compression.
+unsigned long long Netlist_writer::get_byte_count() const
+{
+	return m_byte_count;
+}
+
+/** \brief Called on the writing thread before a batch is formatted, to prepare the data shared by its tasks.
+ *	\param[in] tasks - Tasks of the batch.
+ */
+void Netlist_writer::prepare_batch(const std::vector<Task>& tasks)
+{
+}
+
+/** \brief Appends the text written before the first module.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Netlist_writer::format_begin(std::string& buffer) const
+{
+}
+
+/** \brief Appends the text written after the last module.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Netlist_writer::format_end(std::string& buffer) const
+{
+}
+
+/// \brief Returns the Netlist.
+const Netlist& Netlist_writer::get_netlist() const
+{
+	return m_netlist;
+}
+
+/** \brief Formats all modules in batches and hands the buffers of each batch to the output function.
+ *	\param[in] output - Function writing the buffers.
+ */
+void Netlist_writer::write_batches(const Buffer_function& output)
+{
+	m_byte_count = 0;
+	m_buffers.resize(m_thread_count);
+	const size_t batch_size = m_thread_count * tasks_per_thread;
+
+	const std::map<std::string, boost::shared_ptr<Module_description> >& modules = m_netlist.get_modules();
+	std::map<std::string, boost::shared_ptr<Module_description> >::const_iterator I = modules.begin();
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator next_instance;
+	size_t module_index = 0;
+	size_t instance_index = 0;
+	size_t remaining = 0;
+	bool is_started = false;
+	bool is_first_batch = true;
+	do
+	{
+		// Cut the modules into tasks until the batch is full.
+		m_tasks.clear();
+		while (modules.end() != I && m_tasks.size() < batch_size)
+		{
+			const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = I->second->get_module_instances();
+			if (!is_started)
+			{
+				next_instance = instances.begin();
+				instance_index = 0;
+				remaining = instances.size();
+			}
+			Task task;
+			task.module = I->second.get();
+			task.module_index = module_index;
+			task.first_instance = next_instance;
+			task.instance_index = instance_index;
+			task.instance_count = std::min(remaining, instances_per_task);
+			task.is_first = !is_started;
+			task.is_last = (remaining == task.instance_count);
+			m_tasks.push_back(task);
+			std::advance(next_instance, task.instance_count);
+			instance_index += task.instance_count;
+			remaining -= task.instance_count;
+			is_started = !task.is_last;
+			if (task.is_last)
+			{
+				++I;
+				++module_index;
+			}
+		}
+		prepare_batch(m_tasks);
+
+		for (std::vector<std::string>::iterator J = m_buffers.begin(); J != m_buffers.end(); ++J)
+		{
+			J->clear();
+		}
+		if (is_first_batch)
+		{
+			format_begin(m_buffers.front());
+			is_first_batch = false;
+		}
+		Parallel::for_range(m_tasks.size(), boost::bind(&Netlist_writer::format_tasks, this, _1, _2, _3), m_thread_count, 1);
+		if (modules.end() == I)
+		{
+			format_end(m_buffers.back());
+		}
+		for (std::vector<std::string>::const_iterator J = m_buffers.begin(); J != m_buffers.end(); ++J)
+		{
+			m_byte_count += J->size();
+		}
+		output(m_buffers);
+	}
+	while (modules.end() != I);
+}
+
+/** \brief Formats a chunk of tasks of the current batch into the buffer of the thread.
+ *	\param[in] begin - First task of the chunk.
+ *	\param[in] end - Task after the last one of the chunk.
+ *	\param[in] thread - Index of the thread.
+ */
+void Netlist_writer::format_tasks(size_t begin, size_t end, unsigned thread)
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		format_task(m_tasks[i], m_buffers[thread]);
+	}
+}
+
+/// Index returned for unknown net names.
+const size_t Net_index::npos = static_cast<size_t>(-1);
+
+/** \brief Constructor, indexes the nets of the module.
+ *	\param[in] module - The Module Description, must outlive the index.
+ */
+Net_index::Net_index(const Module_description& module)
+{
+	const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+	m_indices.rehash(nets.size());
+	for (std::map<std::string, boost::shared_ptr<Net> >::const_iterator I = nets.begin(); I != nets.end(); ++I)
+	{
+		if (!I->second->is_constant())
+		{
+			m_indices.insert(std::make_pair(&I->first, m_indices.size()));
+		}
+	}
+}
+
+/** \brief Returns the index of the net, npos for literal constants and names the module has no net for.
+ *	\param[in] name - Name of the net.
+ */
+size_t Net_index::find(const std::string& name) const
+{
+	boost::unordered_map<const std::string*, size_t, Name_hash, Name_equal>::const_iterator found = m_indices.find(&name);
+	return (m_indices.end() != found) ? found->second : npos;
+}
+
+/// \brief Hashes the pointed name.
+size_t Net_index::Name_hash::operator()(const std::string* name) const
+{
+	return boost::hash_range(name->begin(), name->end());
+}
+
+/// \brief Compares the pointed names.
+bool Net_index::Name_equal::operator()(const std::string* first, const std::string* second) const
+{
+	return *first == *second;
+}
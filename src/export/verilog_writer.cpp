@@ -0,0 +1,118 @@
+#include "verilog_writer.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+#include "database/netlist_keywords.hpp"
+
+/// Helper functions.
+namespace
+{
+	/// \brief Returns the Verilog keyword of the port type.
+	const std::string& get_direction(PortType type)
+	{
+		if (IN == type)
+		{
+			return Netlist_keywords::input;
+		}
+		return (OUT == type) ? Netlist_keywords::output : Netlist_keywords::inout;
+	}
+}
+
+/** \brief Constructor with the Netlist.
+ *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+ *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+ */
+Verilog_writer::Verilog_writer(const Netlist& netlist, unsigned thread_count)
+	: Netlist_writer( netlist, thread_count )
+{
+}
+
+/** \brief Appends a task to the buffer.
+ *	\param[in] task - The task.
+ *	\param[in,out] buffer - The buffer.
+ */
+void Verilog_writer::format_task(const Task& task, std::string& buffer) const
+{
+	const Module_description& module = *task.module;
+	if (task.is_first)
+	{
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = module.get_ports();
+		std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I;
+		buffer += Netlist_keywords::module;
+		buffer += ' ';
+		buffer += module.get_name();
+		buffer += '(';
+		for (I = ports.begin(); I != ports.end(); ++I)
+		{
+			if (ports.begin() != I)
+			{
+				buffer += ", ";
+			}
+			buffer += I->first;
+		}
+		buffer += ");\n";
+		for (I = ports.begin(); I != ports.end(); ++I)
+		{
+			buffer += get_direction(I->second->get_type());
+			buffer += ' ';
+			buffer += I->first;
+			buffer += ";\n";
+		}
+
+		// Implicit nets and literal constants are not declared.
+		const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+		for (std::map<std::string, boost::shared_ptr<Net> >::const_iterator J = nets.begin(); J != nets.end(); ++J)
+		{
+			if (!J->second->is_implicit() && !J->second->is_constant() && !ports.count(J->first))
+			{
+				buffer += Netlist_keywords::wire;
+				buffer += ' ';
+				buffer += J->first;
+				buffer += ";\n";
+			}
+		}
+
+		const std::vector< std::pair<std::string, std::string> >& assigns = module.get_assigns();
+		for (std::vector< std::pair<std::string, std::string> >::const_iterator K = assigns.begin(); K != assigns.end(); ++K)
+		{
+			buffer += Netlist_keywords::assign;
+			buffer += ' ';
+			buffer += K->first;
+			buffer += " = ";
+			buffer += K->second;
+			buffer += ";\n";
+		}
+	}
+
+	std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = task.first_instance;
+	for (size_t i = 0; i < task.instance_count; ++i, ++I)
+	{
+		const Module_instance& instance = *I->second;
+		buffer += instance.get_description_name();
+		buffer += ' ';
+		buffer += instance.get_name();
+		buffer += " (";
+		const std::vector<Instance_port>& pins = instance.get_ports();
+		for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end(); ++J)
+		{
+			if (pins.begin() != J)
+			{
+				buffer += ", ";
+			}
+			buffer += '.';
+			buffer += J->get_name();
+			buffer += '(';
+			buffer += J->get_net_name();
+			buffer += ')';
+		}
+		buffer += ");\n";
+	}
+
+	if (task.is_last)
+	{
+		buffer += Netlist_keywords::endmodule;
+		buffer += "\n\n";
+	}
+}
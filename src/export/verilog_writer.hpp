@@ -0,0 +1,30 @@
+#ifndef VERILOG_WRITER_HPP
+#define VERILOG_WRITER_HPP
+
+#include "netlist_writer.hpp"
+
+/** \brief Class for writing a Netlist as structural Verilog, in the line oriented form read by the Netlist Builder.
+ *	Every module is written with its ports, declared wires, assignments and instances with named connections;
+ *	literal constants are written as 1'b0 and 1'b1. Formatting runs in parallel, see Netlist_writer.
+ */
+class Verilog_writer : public Netlist_writer
+{
+public:
+
+	/** \brief Constructor with the Netlist.
+	 *	\param[in] netlist - The Netlist to write, its modules must be connected. Must outlive the writer.
+	 *	\param[in] thread_count - Number of threads used for formatting, 0 for the hardware thread count.
+	 */
+	Verilog_writer(const Netlist& netlist, unsigned thread_count = 0);
+
+protected:
+
+	/** \brief Appends a task to the buffer.
+	 *	\param[in] task - The task.
+	 *	\param[in,out] buffer - The buffer.
+	 */
+	virtual void format_task(const Task& task, std::string& buffer) const;
+
+};
+
+#endif // VERILOG_WRITER_HPP
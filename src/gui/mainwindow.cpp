@@ -1,5 +1,8 @@
 #include "mainwindow.h"
 #include "treeview_model.h"
+#include "../analysis/flat_netlist.hpp"
+#include "../analysis/cone_extractor.hpp"
+#include "../database/netlist_transaction.hpp"
 
 #include <tcl.h>
 
@@ -43,6 +46,7 @@ void MainWindow::registerTclCommands()
     Tcl_CreateObjCommand(m_interp, "create_new_module", createNewModule, 0, 0);
     Tcl_CreateObjCommand(m_interp, "add_module_instance", addModuleInstance, 0, 0);
     Tcl_CreateObjCommand(m_interp, "add_module_port", addModulePort, 0, 0);
+    Tcl_CreateObjCommand(m_interp, "extract_cone", extractCone, 0, 0);
 }
 
 void MainWindow::updateModel()
@@ -50,12 +54,29 @@ void MainWindow::updateModel()
     m_treeViewModel = TreeViewModel::get();
     m_treeView->setModel(m_treeViewModel);
     expandTreeView();
+    updateEditActions();
+}
+
+void MainWindow::updateEditActions()
+{
+    m_undoAction->setEnabled(m_treeViewModel->canUndo());
+    m_redoAction->setEnabled(m_treeViewModel->canRedo());
 }
 
 void MainWindow::executeTclCommand()
 {
     std::string command = m_textEdit->getLastCommand();
-    Tcl_Eval(m_interp, m_textEdit->getLastCommand().c_str());
+
+    // one command is one transaction: one undo step and one update of the tree view,
+    // committed by the guard even if the command throws
+    boost::shared_ptr<Netlist> netlist = m_treeViewModel->getActiveNetlist();
+    if (!netlist)
+    {
+        Tcl_Eval(m_interp, command.c_str());
+        return;
+    }
+    Netlist_transaction transaction(*netlist);
+    Tcl_Eval(m_interp, command.c_str());
 }
 
 void MainWindow::createMenus()
@@ -89,13 +110,16 @@ void MainWindow::createMenus()
     m_fileMenu->addAction(exitAction);
 
     // edit menu actions
-    QAction* undoAction = new QAction(tr("&Undo"), this);
-    connect(undoAction, SIGNAL(triggered()), this, SLOT(undo()));
-    m_editMenu->addAction(undoAction);
+    // enabled only while the journal of the active netlist has a step to undo or redo
+    m_undoAction = new QAction(tr("&Undo"), this);
+    m_undoAction->setEnabled(false);
+    connect(m_undoAction, SIGNAL(triggered()), this, SLOT(undo()));
+    m_editMenu->addAction(m_undoAction);
 
-    QAction* redoAction = new QAction(tr("&Redo"), this);
-    connect(redoAction, SIGNAL(triggered()), this, SLOT(redo()));
-    m_editMenu->addAction(redoAction);
+    m_redoAction = new QAction(tr("&Redo"), this);
+    m_redoAction->setEnabled(false);
+    connect(m_redoAction, SIGNAL(triggered()), this, SLOT(redo()));
+    m_editMenu->addAction(m_redoAction);
 
     m_editMenu->addSeparator();
 
@@ -207,12 +231,14 @@ void MainWindow::closeProject()
 
 void MainWindow::undo()
 {
-    qDebug()<<"undo";
+    m_treeViewModel->undo();
+    updateEditActions();
 }
 
 void MainWindow::redo()
 {
-    qDebug()<<"redo";
+    m_treeViewModel->redo();
+    updateEditActions();
 }
 
 void MainWindow::cut()
@@ -312,4 +338,47 @@ int addModulePort(ClientData clientData, Tcl_Interp *interp, int objc,
 
 }
 
+// extract_cone top_module netlist_name ?-depth levels? net ?net ...?
+// Extracts the fan-in cone of the nets of the active netlist into a new netlist, which becomes active.
+int extractCone(ClientData clientData, Tcl_Interp *interp, int objc,
+         Tcl_Obj *const objv[])
+{
+    if (objc < 4)
+    {
+        Tcl_WrongNumArgs(interp, 1, objv, "top_module netlist_name ?-depth levels? net ?net ...?");
+        return TCL_ERROR;
+    }
+    std::string topModuleName = Tcl_GetString(objv[1]);
+    std::string netlistName = Tcl_GetString(objv[2]);
+    int first = 3;
+    int depth = 0;
+    if (std::string("-depth") == Tcl_GetString(objv[first]))
+    {
+        if (objc < 6 || TCL_OK != Tcl_GetIntFromObj(interp, objv[first + 1], &depth) || depth < 0)
+        {
+            return TCL_ERROR;
+        }
+        first += 2;
+    }
+    std::vector<std::string> netNames;
+    for (int i = first; i < objc; ++i)
+    {
+        netNames.push_back(Tcl_GetString(objv[i]));
+    }
 
+    TreeViewModel* model = TreeViewModel::get();
+    try
+    {
+        Flat_netlist flat(*model->getActiveNetlist(), topModuleName);
+        Cone_extractor extractor(flat, *model->getActiveNetlist());
+        boost::shared_ptr<Netlist> cone = extractor.extract(extractor.find_nets(netNames), netlistName, depth);
+        model->addNetlist(cone);
+        Tcl_SetObjResult(interp, Tcl_NewLongObj(static_cast<long>(extractor.get_cone_gates().size())));
+    }
+    catch (const std::string& error)
+    {
+        Tcl_SetObjResult(interp, Tcl_NewStringObj(error.c_str(), -1));
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
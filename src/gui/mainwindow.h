@@ -26,6 +26,7 @@ private:
     void createMenus();
     void createViews();
     void expandTreeView() const;
+    void updateEditActions();
 
     void registerTclCommands();
 
@@ -52,6 +53,9 @@ private:
     QMenu* m_toolsMenu;
     QMenu* m_helpMenu;
 
+    QAction* m_undoAction;
+    QAction* m_redoAction;
+
     QTreeView* m_treeView;
     QGraphicsView* m_graphicsView;
     QGraphicsScene* m_scene;
@@ -76,5 +80,8 @@ int addModuleInstance(ClientData clientData, Tcl_Interp *interp, int objc,
 int addModulePort(ClientData clientData, Tcl_Interp *interp, int objc,
          Tcl_Obj *const objv[]);
 
+int extractCone(ClientData clientData, Tcl_Interp *interp, int objc,
+         Tcl_Obj *const objv[]);
+
 
 #endif // MAINWINDOW_H
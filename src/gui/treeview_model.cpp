@@ -3,6 +3,7 @@
 #include "../database/module_instance.hpp"
 
 #include <iostream>
+#include <boost/bind.hpp>
 #include <QDebug>
 
 TreeViewModel* TreeViewModel::m_model = 0;
@@ -119,6 +120,8 @@ void TreeViewModel::addNetlist(const QString& netlistPath)
     Netlist_builder* netlistBuilder = new Netlist_builder(netlistPath.toStdString());
     netlistBuilder->construct_netlist();
     m_currentNetlist = netlistBuilder->get_netlist();
+    m_currentNetlist->get_journal().set_enabled(true);
+    m_currentNetlist->set_change_listener(boost::bind(&TreeViewModel::updateModel, this));
     
     // adding netlist
     std::string netlistName = m_currentNetlist->get_name();
@@ -127,18 +130,41 @@ void TreeViewModel::addNetlist(const QString& netlistPath)
     updateModel();
 }
 
+void TreeViewModel::addNetlist(const boost::shared_ptr<Netlist>& netlist)
+{
+    m_currentNetlist = netlist;
+    m_currentNetlist->get_journal().set_enabled(true);
+    m_currentNetlist->set_change_listener(boost::bind(&TreeViewModel::updateModel, this));
+    m_netlists[netlist->get_name()] = m_currentNetlist;
+
+    updateModel();
+}
+
 void TreeViewModel::updateModel()
 {
-    //removeRows(0, rowCount());
-    
+    // rebuilt from scratch, called once per change of a netlist
+    removeRows(0, rowCount());
+    m_expandedNodes.clear();
+
+    std::map<std::string, boost::shared_ptr<Netlist> >::const_iterator netlistIt;
+    for (netlistIt = m_netlists.begin(); netlistIt != m_netlists.end(); ++netlistIt)
+    {
+        addNetlistItem(*netlistIt->second);
+    }
+
+    Q_EMIT modelChanged();
+}
+
+void TreeViewModel::addNetlistItem(const Netlist& netlist)
+{
     // show netlist in treeView
-    std::string netlistName = m_currentNetlist->get_name();
+    std::string netlistName = netlist.get_name();
     QStandardItem* newNetlistItem = new QStandardItem(QString::fromStdString(netlistName));
     m_rootNode->appendRow(newNetlistItem);
     m_expandedNodes.push_back(newNetlistItem->index());
 
     // get netlist modules
-    m_modules = m_currentNetlist->get_modules();
+    m_modules = netlist.get_modules();
     std::map< std::string, boost::shared_ptr<Module_description> >::const_iterator moduleIt;
     for (moduleIt = m_modules.begin(); moduleIt != m_modules.end(); ++moduleIt)
     {
@@ -191,14 +217,11 @@ void TreeViewModel::updateModel()
         }
 
     }
-
-    Q_EMIT modelChanged();
 }
 
 void TreeViewModel::addModule(const std::string& moduleName)
 {
     m_currentNetlist->create_new_module(moduleName);
-    updateModel();
 }
 
 void TreeViewModel::addModuleInstance(const std::string& sourceModule, const std::string& moduleDesc, const std::string&  instanceName)
@@ -209,8 +232,6 @@ void TreeViewModel::addModuleInstance(const std::string& sourceModule, const std
         return;
     }
     sourceModuleDesc->add_module_instance(moduleDesc, instanceName, std::vector< std::pair< std::string, std::string> >());
-    
-    updateModel();
 }
 
 void TreeViewModel::addModulePort(const std::string& sourceModule, const std::string& portName, const std::string& portType)
@@ -236,8 +257,27 @@ void TreeViewModel::addModulePort(const std::string& sourceModule, const std::st
 
     boost::shared_ptr<Module_port> port(new Module_port(portName, type, sourceModuleDesc.get()));
     sourceModuleDesc->add_port(port);
-    
-    updateModel();
+}
+
+bool TreeViewModel::undo()
+{
+    // every undone edit kind notifies the change listener, which refreshes the view
+    return m_currentNetlist && m_currentNetlist->get_journal().undo();
+}
+
+bool TreeViewModel::redo()
+{
+    return m_currentNetlist && m_currentNetlist->get_journal().redo();
+}
+
+bool TreeViewModel::canUndo() const
+{
+    return m_currentNetlist && 0 < m_currentNetlist->get_journal().get_version();
+}
+
+bool TreeViewModel::canRedo() const
+{
+    return m_currentNetlist && m_currentNetlist->get_journal().get_version() < m_currentNetlist->get_journal().get_edit_count();
 }
 
 boost::shared_ptr<Netlist> TreeViewModel::getActiveNetlist() const
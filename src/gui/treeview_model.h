@@ -33,12 +33,19 @@ public:
     void updateModel();
 
     void addNetlist(const QString& netlistPath);
+    void addNetlist(const boost::shared_ptr<Netlist>& netlist);
     void addModule(const std::string& moduleName);
     void addModuleInstance(const std::string& sourceModule, const std::string& moduleDesc, const std::string&  instanceName); 
     void addModulePort(const std::string& sourceModule, const std::string& portName, const std::string& portType);
 
+    bool undo();
+    bool redo();
+    bool canUndo() const;
+    bool canRedo() const;
+
     void addModulePort(QStandardItem* item, std::map<std::string, boost::shared_ptr<Module_port> > ports);
     void addInstancePort(QStandardItem* item, std::vector<Instance_port> ports);
+    void addNetlistItem(const Netlist& netlist);
 
     boost::shared_ptr<Netlist> getActiveNetlist() const;
 
@@ -0,0 +1,455 @@
+#include "compiled_simulator.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// Helper functions.
+namespace
+{
+	/// Version of the generated code, part of the hash so that old cache entries are not reused.
+	const boost::uint64_t generator_version = 2;
+
+	/// Number of gates emitted into one generated function.
+	const Flat_id block_size = 2048;
+
+	/** \brief Runs a program with its output written to a log file, without a shell, so paths are never interpreted.
+	 *	\param[in] arguments - The program and its arguments.
+	 *	\param[in] log_path - Path of the log file for the standard output and error.
+	 *	\ret True if the program ran and exited with 0.
+	 */
+	bool run_program(const std::vector<std::string>& arguments, const std::string& log_path)
+	{
+		std::vector<char*> argv;
+		for (std::vector<std::string>::const_iterator I = arguments.begin(); I != arguments.end(); ++I)
+		{
+			argv.push_back(const_cast<char*>(I->c_str()));
+		}
+		argv.push_back(0);
+
+		pid_t child = ::fork();
+		if (child < 0)
+		{
+			return false;
+		}
+		if (0 == child)
+		{
+			int log = ::open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (log >= 0)
+			{
+				::dup2(log, 1);
+				::dup2(log, 2);
+				::close(log);
+			}
+			::execvp(argv[0], &argv[0]);
+			::_exit(127);
+		}
+		int status = 0;
+		while (::waitpid(child, &status, 0) < 0)
+		{
+			if (EINTR != errno)
+			{
+				return false;
+			}
+		}
+		return WIFEXITED(status) && 0 == WEXITSTATUS(status);
+	}
+
+	/// \brief Mixes the value into the FNV-1a hash.
+	void hash_value(boost::uint64_t& hash, boost::uint64_t value)
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	/// \brief Returns true if the file exists.
+	bool file_exists(const std::string& path)
+	{
+		struct stat status;
+		return 0 == ::stat(path.c_str(), &status);
+	}
+
+	/** \brief Creates the directory and its missing parents. Throws with the system error if one cannot be created.
+	 *	\param[in] path - Path of the directory.
+	 */
+	void create_directories(const std::string& path)
+	{
+		for (size_t end = path.find('/', 1); ; end = path.find('/', end + 1))
+		{
+			std::string prefix = path.substr(0, end);
+			if (0 != ::mkdir(prefix.c_str(), 0755) && EEXIST != errno)
+			{
+				throw std::string("Unable to create the simulation cache directory " + prefix + ": " + std::strerror(errno));
+			}
+			if (std::string::npos == end)
+			{
+				break;
+			}
+		}
+		struct stat status;
+		if (0 != ::stat(path.c_str(), &status) || !S_ISDIR(status.st_mode))
+		{
+			throw std::string("The simulation cache path is not a directory: " + path);
+		}
+	}
+
+	/// \brief Returns the C++ operator combining the inputs of the primitive.
+	const char* get_operator(PrimitiveType type)
+	{
+		switch (type)
+		{
+			case PRIMITIVE_AND:
+			case PRIMITIVE_NAND:
+				return " & ";
+			case PRIMITIVE_OR:
+			case PRIMITIVE_NOR:
+				return " | ";
+			default:
+				return " ^ ";
+		}
+	}
+}
+
+/** \brief Constructor, compiles the program or loads it from the cache. Throws if the compilation or loading fails.
+ *	\param[in] program - The Simulation Program, must outlive the simulator.
+ *	\param[in] cache_directory - Directory for the generated sources and shared objects, created with its parents if missing.
+ */
+Compiled_simulator::Compiled_simulator(const Simulation_program& program, const std::string& cache_directory)
+	: m_program( program )
+	, m_hash( compute_hash(program) )
+	, m_cached( false )
+	, m_library( 0 )
+	, m_simulate( 0 )
+	, m_values( program.get_initial_values() )
+	, m_cycle_count( 0 )
+{
+	create_directories(cache_directory);
+
+	char name[32];
+	std::sprintf(name, "/sim_%016llx", static_cast<unsigned long long>(m_hash));
+	std::string base_path = cache_directory + name;
+	m_library_path = base_path + ".so";
+
+	// A cached object that cannot be loaded or was built for another program is compiled again.
+	m_cached = file_exists(m_library_path);
+	if (m_cached)
+	{
+		try
+		{
+			load();
+		}
+		catch (const std::string&)
+		{
+			m_cached = false;
+		}
+	}
+	if (!m_cached)
+	{
+		generate_source(base_path + ".cpp");
+		compile(base_path + ".cpp", m_library_path);
+		load();
+	}
+}
+
+/// \brief Destructor, unloads the shared object.
+Compiled_simulator::~Compiled_simulator()
+{
+	if (0 != m_library)
+	{
+		::dlclose(m_library);
+	}
+}
+
+/// \brief Getter for the Simulation Program.
+const Simulation_program& Compiled_simulator::get_program() const
+{
+	return m_program;
+}
+
+/// \brief Returns the structural hash of the program, used as the cache key.
+boost::uint64_t Compiled_simulator::get_hash() const
+{
+	return m_hash;
+}
+
+/// \brief Returns the path of the loaded shared object.
+const std::string& Compiled_simulator::get_library_path() const
+{
+	return m_library_path;
+}
+
+/// \brief Returns true if the shared object was found in the cache instead of being compiled.
+bool Compiled_simulator::was_cached() const
+{
+	return m_cached;
+}
+
+/** \brief Sets the value of a net, usually an input net.
+ *	\param[in] net - Id of the net.
+ *	\param[in] value - The new value for all patterns.
+ */
+void Compiled_simulator::set_value(Flat_id net, const Logic_word& value)
+{
+	m_values[net] = value;
+}
+
+/** \brief Returns the value of a net.
+ *	\param[in] net - Id of the net.
+ */
+const Logic_word& Compiled_simulator::get_value(Flat_id net) const
+{
+	return m_values[net];
+}
+
+/// \brief Returns the values of all nets.
+const std::vector<Logic_word>& Compiled_simulator::get_values() const
+{
+	return m_values;
+}
+
+/** \brief Sets all input nets to random values.
+ *	\param[in,out] state - State of the random generator, must not be 0.
+ */
+void Compiled_simulator::randomize_inputs(boost::uint64_t& state)
+{
+	const std::vector<Flat_id>& inputs = m_program.get_netlist().get_input_nets();
+	std::vector<Flat_id>::const_iterator I;
+	for (I = inputs.begin(); I != inputs.end(); ++I)
+	{
+		m_values[*I] = Logic_words::random(state);
+	}
+}
+
+/// \brief Evaluates all gates once.
+void Compiled_simulator::simulate()
+{
+	if (!m_values.empty())
+	{
+		m_simulate(&m_values[0]);
+	}
+	++m_cycle_count;
+}
+
+/// \brief Returns the number of gate evaluations done so far, counting every pattern separately.
+boost::uint64_t Compiled_simulator::get_evaluation_count() const
+{
+	return m_cycle_count * m_program.get_gate_count() * Logic_words::pattern_count;
+}
+
+/** \brief Computes the structural hash of the whole flattened program: gate types and connectivity, word size and code generator version.
+ *	\param[in] program - The Simulation Program.
+ */
+boost::uint64_t Compiled_simulator::compute_hash(const Simulation_program& program)
+{
+	boost::uint64_t hash = 14695981039346656037ULL;
+	hash_value(hash, generator_version);
+	hash_value(hash, Logic_words::lane_count);
+	hash_value(hash, program.get_netlist().get_net_count());
+	hash_value(hash, program.get_gate_count());
+
+	size_t gate_count = program.get_gate_count();
+	for (size_t i = 0; i < gate_count; ++i)
+	{
+		hash_value(hash, program.get_types()[i]);
+		hash_value(hash, program.get_outputs()[i]);
+		hash_value(hash, program.get_input_offsets()[i + 1] - program.get_input_offsets()[i]);
+	}
+	std::vector<Flat_id>::const_iterator I;
+	for (I = program.get_inputs().begin(); I != program.get_inputs().end(); ++I)
+	{
+		hash_value(hash, *I);
+	}
+	return hash;
+}
+
+/** \brief Writes the C++ source of the program.
+ *	\param[in] path - Path of the source file.
+ */
+void Compiled_simulator::generate_source(const std::string& path) const
+{
+	std::ofstream source(path.c_str());
+	if (!source)
+	{
+		throw std::string("Unable to write the generated simulation source: " + path);
+	}
+
+	const std::vector<PrimitiveType>& types = m_program.get_types();
+	const std::vector<Flat_id>& outputs = m_program.get_outputs();
+	const std::vector<Flat_id>& input_offsets = m_program.get_input_offsets();
+	const std::vector<Flat_id>& inputs = m_program.get_inputs();
+	Flat_id gate_count = static_cast<Flat_id>(m_program.get_gate_count());
+
+	source << "// Generated by Compiled_simulator, do not edit.\n";
+	source << "#include <stdint.h>\n#include <string.h>\n\n";
+	if (1 == Logic_words::lane_count)
+	{
+		source << "typedef uint64_t W;\n";
+	}
+	else
+	{
+		source << "typedef uint64_t W __attribute__((vector_size(" << sizeof(Logic_word) << ")));\n";
+	}
+	source << "static inline W zero_word() { W w; memset(&w, 0, sizeof(w)); return w; }\n\n";
+
+	// Every block loads the nets it reads from the values, keeps its results in locals and stores them back.
+	Flat_id block_count = 0;
+	std::vector<std::string> locals(m_program.get_netlist().get_net_count());
+	std::vector<Flat_id> used_nets;
+	for (Flat_id begin = 0; begin < gate_count; begin += block_size, ++block_count)
+	{
+		Flat_id end = (begin + block_size < gate_count) ? begin + block_size : gate_count;
+		source << "static void block_" << block_count << "(W* v)\n{\n";
+		for (Flat_id position = begin; position < end; ++position)
+		{
+			std::ostringstream expression;
+			Flat_id first = input_offsets[position];
+			Flat_id last = input_offsets[position + 1];
+			for (Flat_id i = first; i < last; ++i)
+			{
+				Flat_id net = inputs[i];
+				if (locals[net].empty())
+				{
+					std::ostringstream local;
+					local << "l" << net;
+					locals[net] = local.str();
+					used_nets.push_back(net);
+					source << "\tconst W " << locals[net] << " = v[" << net << "];\n";
+				}
+				expression << ((i == first) ? "" : get_operator(types[position])) << locals[net];
+			}
+
+			std::string value = expression.str();
+			switch (types[position])
+			{
+				case PRIMITIVE_AND:
+					value = (first == last) ? "~zero_word()" : value;
+					break;
+				case PRIMITIVE_NAND:
+					value = (first == last) ? "zero_word()" : "~(" + value + ")";
+					break;
+				case PRIMITIVE_OR:
+				case PRIMITIVE_XOR:
+				case PRIMITIVE_BUF:
+					value = (first == last) ? "zero_word()" : ((PRIMITIVE_BUF == types[position]) ? locals[inputs[first]] : value);
+					break;
+				case PRIMITIVE_NOR:
+				case PRIMITIVE_XNOR:
+				case PRIMITIVE_NOT:
+					value = (first == last) ? "~zero_word()" : "~(" + ((PRIMITIVE_NOT == types[position]) ? locals[inputs[first]] : value) + ")";
+					break;
+				case PRIMITIVE_NONE:
+					break;
+			}
+
+			Flat_id output = outputs[position];
+			std::ostringstream local;
+			local << "g" << position;
+			if (locals[output].empty())
+			{
+				used_nets.push_back(output);
+			}
+			locals[output] = local.str();
+			source << "\tconst W " << locals[output] << " = " << value << ";\n";
+			source << "\tv[" << output << "] = " << locals[output] << ";\n";
+		}
+		source << "}\n\n";
+
+		std::vector<Flat_id>::const_iterator I;
+		for (I = used_nets.begin(); I != used_nets.end(); ++I)
+		{
+			locals[*I].clear();
+		}
+		used_nets.clear();
+	}
+
+	source << "extern \"C\" unsigned compiled_lane_count()\n{\n\treturn " << Logic_words::lane_count << ";\n}\n\n";
+	source << "extern \"C\" unsigned long long compiled_net_count()\n{\n\treturn " << m_program.get_netlist().get_net_count() << "ULL;\n}\n\n";
+	source << "extern \"C\" unsigned long long compiled_signature()\n{\n\treturn " << m_hash << "ULL;\n}\n\n";
+	source << "extern \"C\" void compiled_simulate(W* v)\n{\n";
+	for (Flat_id block = 0; block < block_count; ++block)
+	{
+		source << "\tblock_" << block << "(v);\n";
+	}
+	source << "}\n";
+
+	if (!source)
+	{
+		throw std::string("Unable to write the generated simulation source: " + path);
+	}
+}
+
+/** \brief Compiles the source into a shared object.
+ *	\param[in] source_path - Path of the source file.
+ *	\param[in] library_path - Path of the shared object.
+ */
+void Compiled_simulator::compile(const std::string& source_path, const std::string& library_path) const
+{
+	const char* compiler = std::getenv("CXX");
+	std::ostringstream temporary_path;
+	temporary_path << library_path << "." << ::getpid() << ".tmp";
+
+	// Compile into a temporary file first, so concurrent runs never load a partially written object.
+	// CXX is split at spaces only, as in "ccache c++"; the paths are passed as single arguments.
+	std::vector<std::string> arguments;
+	std::istringstream words((0 != compiler && 0 != *compiler) ? compiler : "c++");
+	std::string word;
+	while (words >> word)
+	{
+		arguments.push_back(word);
+	}
+	arguments.push_back("-O2");
+	arguments.push_back("-fPIC");
+	arguments.push_back("-shared");
+	if (1 != Logic_words::lane_count)
+	{
+		arguments.push_back("-mavx2");
+	}
+	arguments.push_back("-o");
+	arguments.push_back(temporary_path.str());
+	arguments.push_back(source_path);
+	if (arguments.size() < 7 || !run_program(arguments, source_path + ".log")
+		|| 0 != std::rename(temporary_path.str().c_str(), library_path.c_str()))
+	{
+		std::remove(temporary_path.str().c_str());
+		throw std::string("Unable to compile the generated simulation source, see " + source_path + ".log");
+	}
+}
+
+/// \brief Loads the shared object and finds the entry point. Throws if the object was not generated for this program and build.
+void Compiled_simulator::load()
+{
+	m_library = ::dlopen(m_library_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (0 == m_library)
+	{
+		throw std::string("Unable to load the compiled simulation: " + std::string(::dlerror()));
+	}
+
+	typedef unsigned (*Lane_count_function)();
+	typedef unsigned long long (*Value_function)();
+	Lane_count_function lane_count = reinterpret_cast<Lane_count_function>(::dlsym(m_library, "compiled_lane_count"));
+	Value_function net_count = reinterpret_cast<Value_function>(::dlsym(m_library, "compiled_net_count"));
+	Value_function signature = reinterpret_cast<Value_function>(::dlsym(m_library, "compiled_signature"));
+	m_simulate = reinterpret_cast<Simulate_function>(::dlsym(m_library, "compiled_simulate"));
+	if (0 == lane_count || 0 == net_count || 0 == signature || 0 == m_simulate || Logic_words::lane_count != lane_count()
+		|| m_program.get_netlist().get_net_count() != net_count() || m_hash != signature())
+	{
+		m_simulate = 0;
+		::dlclose(m_library);
+		m_library = 0;
+		throw std::string("The compiled simulation does not match this build: " + m_library_path);
+	}
+}
+
@@ -0,0 +1,124 @@
+#ifndef COMPILED_SIMULATOR_HPP
+#define COMPILED_SIMULATOR_HPP
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "logic_word.hpp"
+#include "simulation_program.hpp"
+
+/** \brief Compiled-code bit-parallel logic simulator.
+ *	Emits straight-line C++ for the Simulation Program, with nets as local words and gates as bitwise
+ *	operations, compiles it into a shared object with the system compiler and loads it with dlopen.
+ *	Shared objects are cached in a directory, keyed by the structural hash of the program, so a
+ *	netlist is compiled only once. The generated code exports its net count and the hash, a cached
+ *	object that does not match them is compiled again. The program is flat, so this is a whole-design
+ *	cache: any change anywhere in the design is a new key and compiles the whole design again, there is
+ *	no reuse per module.
+ *	The compiler is taken from the CXX environment variable, "c++" by default, and run without a shell.
+ *	Results are identical to the Cycle Simulator, including the loop semantics.
+ */
+class Compiled_simulator
+{
+public:
+
+	/** \brief Constructor, compiles the program or loads it from the cache. Throws if the compilation or loading fails.
+	 *	\param[in] program - The Simulation Program, must outlive the simulator.
+	 *	\param[in] cache_directory - Directory for the generated sources and shared objects, created with its parents if missing.
+	 */
+	Compiled_simulator(const Simulation_program& program, const std::string& cache_directory);
+
+	/// \brief Destructor, unloads the shared object.
+	~Compiled_simulator();
+
+	/// \brief Getter for the Simulation Program.
+	const Simulation_program& get_program() const;
+
+	/// \brief Returns the structural hash of the program, used as the cache key.
+	boost::uint64_t get_hash() const;
+
+	/// \brief Returns the path of the loaded shared object.
+	const std::string& get_library_path() const;
+
+	/// \brief Returns true if the shared object was found in the cache instead of being compiled.
+	bool was_cached() const;
+
+	/** \brief Sets the value of a net, usually an input net.
+	 *	\param[in] net - Id of the net.
+	 *	\param[in] value - The new value for all patterns.
+	 */
+	void set_value(Flat_id net, const Logic_word& value);
+
+	/** \brief Returns the value of a net.
+	 *	\param[in] net - Id of the net.
+	 */
+	const Logic_word& get_value(Flat_id net) const;
+
+	/// \brief Returns the values of all nets.
+	const std::vector<Logic_word>& get_values() const;
+
+	/** \brief Sets all input nets to random values.
+	 *	\param[in,out] state - State of the random generator, must not be 0.
+	 */
+	void randomize_inputs(boost::uint64_t& state);
+
+	/// \brief Evaluates all gates once.
+	void simulate();
+
+	/// \brief Returns the number of gate evaluations done so far, counting every pattern separately.
+	boost::uint64_t get_evaluation_count() const;
+
+	/** \brief Computes the structural hash of the whole flattened program: gate types and connectivity, word size and code generator version.
+	 *	\param[in] program - The Simulation Program.
+	 */
+	static boost::uint64_t compute_hash(const Simulation_program& program);
+
+private:
+
+	/// Type of the entry point of the generated code.
+	typedef void (*Simulate_function)(Logic_word* values);
+
+	/** \brief Writes the C++ source of the program.
+	 *	\param[in] path - Path of the source file.
+	 */
+	void generate_source(const std::string& path) const;
+
+	/** \brief Compiles the source into a shared object.
+	 *	\param[in] source_path - Path of the source file.
+	 *	\param[in] library_path - Path of the shared object.
+	 */
+	void compile(const std::string& source_path, const std::string& library_path) const;
+
+	/// \brief Loads the shared object and finds the entry point. Throws if the object was not generated for this program and build.
+	void load();
+
+private:
+
+	/// The Simulation Program.
+	const Simulation_program& m_program;
+
+	/// Structural hash of the program.
+	boost::uint64_t m_hash;
+
+	/// Path of the shared object.
+	std::string m_library_path;
+
+	/// True if the shared object was found in the cache.
+	bool m_cached;
+
+	/// Handle of the loaded shared object.
+	void* m_library;
+
+	/// Entry point of the generated code.
+	Simulate_function m_simulate;
+
+	/// Values of all nets.
+	std::vector<Logic_word> m_values;
+
+	/// Number of simulated cycles.
+	boost::uint64_t m_cycle_count;
+
+};
+
+#endif // COMPILED_SIMULATOR_HPP
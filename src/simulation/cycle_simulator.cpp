@@ -0,0 +1,85 @@
+#include "cycle_simulator.hpp"
+#include "gate_kernels.hpp"
+
+/** \brief Constructor with the program to simulate. All nets start at 0.
+ *	\param[in] program - The Simulation Program, must outlive the simulator.
+ */
+Cycle_simulator::Cycle_simulator(const Simulation_program& program)
+	: m_program( program )
+	, m_values( program.get_initial_values() )
+	, m_cycle_count( 0 )
+{
+
+}
+
+/// \brief Getter for the Simulation Program.
+const Simulation_program& Cycle_simulator::get_program() const
+{
+	return m_program;
+}
+
+/** \brief Sets the value of a net, usually an input net.
+ *	\param[in] net - Id of the net.
+ *	\param[in] value - The new value for all patterns.
+ */
+void Cycle_simulator::set_value(Flat_id net, const Logic_word& value)
+{
+	m_values[net] = value;
+}
+
+/** \brief Returns the value of a net.
+ *	\param[in] net - Id of the net.
+ */
+const Logic_word& Cycle_simulator::get_value(Flat_id net) const
+{
+	return m_values[net];
+}
+
+/// \brief Returns the values of all nets.
+const std::vector<Logic_word>& Cycle_simulator::get_values() const
+{
+	return m_values;
+}
+
+/** \brief Sets all input nets to random values.
+ *	\param[in,out] state - State of the random generator, must not be 0.
+ */
+void Cycle_simulator::randomize_inputs(boost::uint64_t& state)
+{
+	const std::vector<Flat_id>& inputs = m_program.get_netlist().get_input_nets();
+	std::vector<Flat_id>::const_iterator I;
+	for (I = inputs.begin(); I != inputs.end(); ++I)
+	{
+		m_values[*I] = Logic_words::random(state);
+	}
+}
+
+/// \brief Evaluates all gates once.
+void Cycle_simulator::simulate()
+{
+	if (0 == m_program.get_gate_count())
+	{
+		++m_cycle_count;
+		return;
+	}
+
+	Logic_word* values = &m_values[0];
+	const Flat_id* outputs = &m_program.get_outputs()[0];
+	const Flat_id* input_offsets = &m_program.get_input_offsets()[0];
+	const Flat_id* inputs = m_program.get_inputs().empty() ? 0 : &m_program.get_inputs()[0];
+
+	const std::vector<Simulation_program::Run>& runs = m_program.get_runs();
+	std::vector<Simulation_program::Run>::const_iterator I;
+	for (I = runs.begin(); I != runs.end(); ++I)
+	{
+		Gate_kernels::evaluate_run(I->type, values, outputs, input_offsets, inputs, I->begin, I->end);
+	}
+	++m_cycle_count;
+}
+
+/// \brief Returns the number of gate evaluations done so far, counting every pattern separately.
+boost::uint64_t Cycle_simulator::get_evaluation_count() const
+{
+	return m_cycle_count * m_program.get_gate_count() * Logic_words::pattern_count;
+}
+
@@ -0,0 +1,65 @@
+#ifndef CYCLE_SIMULATOR_HPP
+#define CYCLE_SIMULATOR_HPP
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "logic_word.hpp"
+#include "simulation_program.hpp"
+
+/** \brief Cycle-based bit-parallel logic simulator.
+ *	Every cycle evaluates all gates of the Simulation Program once in level order, for
+ *	Logic_words::pattern_count input patterns at a time. Gates of a combinational loop are evaluated
+ *	once per cycle, reading the values of the previous cycle for the loop nets.
+ */
+class Cycle_simulator
+{
+public:
+
+	/** \brief Constructor with the program to simulate. All nets start at 0.
+	 *	\param[in] program - The Simulation Program, must outlive the simulator.
+	 */
+	Cycle_simulator(const Simulation_program& program);
+
+	/// \brief Getter for the Simulation Program.
+	const Simulation_program& get_program() const;
+
+	/** \brief Sets the value of a net, usually an input net.
+	 *	\param[in] net - Id of the net.
+	 *	\param[in] value - The new value for all patterns.
+	 */
+	void set_value(Flat_id net, const Logic_word& value);
+
+	/** \brief Returns the value of a net.
+	 *	\param[in] net - Id of the net.
+	 */
+	const Logic_word& get_value(Flat_id net) const;
+
+	/// \brief Returns the values of all nets.
+	const std::vector<Logic_word>& get_values() const;
+
+	/** \brief Sets all input nets to random values.
+	 *	\param[in,out] state - State of the random generator, must not be 0.
+	 */
+	void randomize_inputs(boost::uint64_t& state);
+
+	/// \brief Evaluates all gates once.
+	void simulate();
+
+	/// \brief Returns the number of gate evaluations done so far, counting every pattern separately.
+	boost::uint64_t get_evaluation_count() const;
+
+private:
+
+	/// The Simulation Program.
+	const Simulation_program& m_program;
+
+	/// Values of all nets.
+	std::vector<Logic_word> m_values;
+
+	/// Number of simulated cycles.
+	boost::uint64_t m_cycle_count;
+
+};
+
+#endif // CYCLE_SIMULATOR_HPP
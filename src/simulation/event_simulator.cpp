@@ -0,0 +1,172 @@
+#include "event_simulator.hpp"
+#include "gate_kernels.hpp"
+
+#include <ctime>
+
+const unsigned Event_simulator::no_level = ~0u;
+
+/** \brief Constructor with the program to simulate. All inputs start at 0 and all gates are evaluated once.
+ *	\param[in] program - The Simulation Program, must outlive the simulator.
+ */
+Event_simulator::Event_simulator(const Simulation_program& program)
+	: m_program( program )
+	, m_values( program.get_initial_values() )
+	, m_wheel( program.get_level_offsets().size() )
+	, m_scheduled( program.get_gate_count(), 0 )
+	, m_first_level( static_cast<unsigned>(m_wheel.size()) )
+	, m_event_count( 0 )
+	, m_evaluation_count( 0 )
+	, m_seconds( 0 )
+{
+	// Make the gate outputs consistent with the initial inputs.
+	if (0 != program.get_gate_count())
+	{
+		const std::vector<Simulation_program::Run>& runs = m_program.get_runs();
+		std::vector<Simulation_program::Run>::const_iterator I;
+		for (I = runs.begin(); I != runs.end(); ++I)
+		{
+			Gate_kernels::evaluate_run(I->type, &m_values[0], &program.get_outputs()[0], &program.get_input_offsets()[0],
+				program.get_inputs().empty() ? 0 : &program.get_inputs()[0], I->begin, I->end);
+		}
+	}
+}
+
+/// \brief Getter for the Simulation Program.
+const Simulation_program& Event_simulator::get_program() const
+{
+	return m_program;
+}
+
+/** \brief Sets the value of a net, usually an input net, and schedules its fanouts if it changes.
+ *	\param[in] net - Id of the net.
+ *	\param[in] value - The new value for all patterns.
+ */
+void Event_simulator::set_value(Flat_id net, const Logic_word& value)
+{
+	if (Logic_words::equal(m_values[net], value))
+	{
+		return;
+	}
+	m_values[net] = value;
+	++m_event_count;
+	schedule_fanouts(net, no_level);
+}
+
+/** \brief Returns the value of a net.
+ *	\param[in] net - Id of the net.
+ */
+const Logic_word& Event_simulator::get_value(Flat_id net) const
+{
+	return m_values[net];
+}
+
+/// \brief Returns the values of all nets.
+const std::vector<Logic_word>& Event_simulator::get_values() const
+{
+	return m_values;
+}
+
+/// \brief Evaluates the scheduled gates until no more events are left in this cycle.
+void Event_simulator::simulate()
+{
+	std::clock_t start = std::clock();
+
+	const std::vector<PrimitiveType>& types = m_program.get_types();
+	const std::vector<Flat_id>& outputs = m_program.get_outputs();
+	const std::vector<Flat_id>& input_offsets = m_program.get_input_offsets();
+	const Flat_id* inputs = m_program.get_inputs().empty() ? 0 : &m_program.get_inputs()[0];
+	const Logic_word* values = m_values.empty() ? 0 : &m_values[0];
+
+	unsigned level_count = static_cast<unsigned>(m_wheel.size());
+	for (unsigned level = m_first_level; level < level_count; ++level)
+	{
+		std::vector<Flat_id>& bucket = m_wheel[level];
+		for (size_t i = 0; i < bucket.size(); ++i)
+		{
+			Flat_id position = bucket[i];
+			m_scheduled[position] = 0;
+			Logic_word value = Gate_kernels::evaluate(types[position], values,
+				inputs + input_offsets[position], inputs + input_offsets[position + 1]);
+			++m_evaluation_count;
+
+			Flat_id output = outputs[position];
+			if (!Logic_words::equal(m_values[output], value))
+			{
+				m_values[output] = value;
+				++m_event_count;
+				schedule_fanouts(output, level);
+			}
+		}
+		bucket.clear();
+	}
+	m_first_level = level_count;
+
+	// Loop gates deferred during this cycle start the next one.
+	std::vector<Flat_id> deferred;
+	deferred.swap(m_deferred);
+	std::vector<Flat_id>::const_iterator I;
+	for (I = deferred.begin(); I != deferred.end(); ++I)
+	{
+		unsigned level = m_program.get_levels()[*I];
+		m_wheel[level].push_back(*I);
+		if (level < m_first_level)
+		{
+			m_first_level = level;
+		}
+	}
+
+	m_seconds += double(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+/// \brief Returns the number of events processed so far, i.e. net value changes.
+boost::uint64_t Event_simulator::get_event_count() const
+{
+	return m_event_count;
+}
+
+/// \brief Returns the number of gate evaluations done so far, counting words, not patterns.
+boost::uint64_t Event_simulator::get_evaluation_count() const
+{
+	return m_evaluation_count;
+}
+
+/// \brief Returns the processed events per second of time spent in simulate.
+double Event_simulator::get_events_per_second() const
+{
+	return (m_seconds > 0) ? m_event_count / m_seconds : 0;
+}
+
+/** \brief Schedules the fanout gates of the changed net.
+ *	\param[in] net - Id of the net.
+ *	\param[in] current_level - Level being processed, gates at or below it are deferred to the next cycle. no_level outside of simulate.
+ */
+void Event_simulator::schedule_fanouts(Flat_id net, unsigned current_level)
+{
+	const Flat_netlist& netlist = m_program.get_netlist();
+	const std::vector<Flat_id>& fanout_offsets = netlist.get_net_fanout_offsets();
+	const std::vector<Flat_id>& fanouts = netlist.get_net_fanouts();
+	const std::vector<Flat_id>& positions = m_program.get_positions();
+	const std::vector<unsigned>& levels = m_program.get_levels();
+
+	for (Flat_id i = fanout_offsets[net]; i < fanout_offsets[net + 1]; ++i)
+	{
+		Flat_id position = positions[fanouts[i]];
+		if (Flat_netlist::invalid_id == position || m_scheduled[position])
+		{
+			continue;
+		}
+		m_scheduled[position] = 1;
+		unsigned level = levels[position];
+		if (no_level != current_level && level <= current_level)
+		{
+			m_deferred.push_back(position);
+			continue;
+		}
+		m_wheel[level].push_back(position);
+		if (level < m_first_level)
+		{
+			m_first_level = level;
+		}
+	}
+}
+
@@ -0,0 +1,406 @@
+#include "fault_simulator.hpp"
+#include "gate_kernels.hpp"
+#include "analysis/work_stealing_pool.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+/// Helper functions.
+namespace
+{
+	/// Level passed when no level is being processed.
+	const unsigned no_level = ~0u;
+
+	/** \brief Returns the faults of the gate inputs that are equivalent to a fault on the gate output.
+	 *	\param[in] type - Type of the gate.
+	 *	\param[out] stuck_at_0 - True if the input stuck-at 0 fault is equivalent to an output fault.
+	 *	\param[out] stuck_at_1 - True if the input stuck-at 1 fault is equivalent to an output fault.
+	 */
+	void get_equivalent_input_faults(PrimitiveType type, bool& stuck_at_0, bool& stuck_at_1)
+	{
+		stuck_at_0 = (PRIMITIVE_AND == type || PRIMITIVE_NAND == type || PRIMITIVE_NOT == type || PRIMITIVE_BUF == type);
+		stuck_at_1 = (PRIMITIVE_OR == type || PRIMITIVE_NOR == type || PRIMITIVE_NOT == type || PRIMITIVE_BUF == type);
+	}
+}
+
+/** \brief Constructor with the program to grade patterns on.
+ *	\param[in] program - The Simulation Program, must outlive the simulator.
+ *	\param[in] thread_count - Number of worker threads, 0 for the hardware thread count.
+ */
+Fault_simulator::Fault_simulator(const Simulation_program& program, unsigned thread_count)
+	: m_program( program )
+	, m_thread_count( thread_count )
+	, m_uncollapsed_fault_count( 0 )
+	, m_good_values( program.get_initial_values() )
+	, m_is_output( program.get_netlist().get_net_count(), 0 )
+	, m_pattern_count( 0 )
+	, m_fault_pattern_count( 0 )
+	, m_seconds( 0 )
+{
+	const std::vector<Flat_id>& outputs = program.get_netlist().get_output_nets();
+	std::vector<Flat_id>::const_iterator I;
+	for (I = outputs.begin(); I != outputs.end(); ++I)
+	{
+		m_is_output[*I] = 1;
+	}
+}
+
+/** \brief Generates the stuck-at 0 and 1 faults of all nets and of the gate inputs of nets with several fanouts.
+ *	Resets the detection results.
+ *	\param[in] collapse - If true, faults equivalent to a fault on the gate output are left out.
+ */
+void Fault_simulator::generate_faults(bool collapse)
+{
+	const Flat_netlist& netlist = m_program.get_netlist();
+	const std::vector<Flat_id>& fanout_offsets = netlist.get_net_fanout_offsets();
+	const std::vector<Flat_id>& drivers = netlist.get_net_drivers();
+	const std::vector<Flat_id>& positions = m_program.get_positions();
+	const std::vector<PrimitiveType>& types = m_program.get_types();
+	const std::vector<Flat_id>& input_offsets = m_program.get_input_offsets();
+	const std::vector<Flat_id>& inputs = m_program.get_inputs();
+	const std::vector<unsigned>& levels = m_program.get_levels();
+	size_t net_count = netlist.get_net_count();
+	size_t gate_count = m_program.get_gate_count();
+
+	// Removal flags of the stuck-at 0 and 1 faults of the nets and of the gate inputs.
+	std::vector<char> net_removed(2 * net_count, 0);
+	std::vector<char> input_removed(2 * inputs.size(), 0);
+	if (collapse)
+	{
+		for (size_t position = 0; position < gate_count; ++position)
+		{
+			bool stuck_at_0, stuck_at_1;
+			get_equivalent_input_faults(types[position], stuck_at_0, stuck_at_1);
+			for (Flat_id i = input_offsets[position]; i < input_offsets[position + 1]; ++i)
+			{
+				Flat_id net = inputs[i];
+				Flat_id driver = drivers[net];
+				Flat_id driver_position = (Flat_netlist::invalid_id == driver) ? Flat_netlist::invalid_id : positions[driver];
+
+				// Faults are only merged forward along acyclic edges, and not away from observable nets.
+				if (m_is_output[net] || (Flat_netlist::invalid_id != driver_position && levels[driver_position] >= levels[position]))
+				{
+					continue;
+				}
+				bool is_branch = (fanout_offsets[net + 1] - fanout_offsets[net] > 1);
+				std::vector<char>& removed = is_branch ? input_removed : net_removed;
+				size_t index = is_branch ? i : net;
+				removed[2 * index] |= stuck_at_0;
+				removed[2 * index + 1] |= stuck_at_1;
+			}
+		}
+	}
+
+	m_faults.clear();
+	m_uncollapsed_fault_count = 0;
+	for (size_t net = 0; net < net_count; ++net)
+	{
+		bool is_driven = (Flat_netlist::invalid_id != drivers[net] && Flat_netlist::invalid_id != positions[drivers[net]]);
+		if (!is_driven && fanout_offsets[net] == fanout_offsets[net + 1] && !m_is_output[net])
+		{
+			continue;
+		}
+		for (int value = 0; value < 2; ++value)
+		{
+			++m_uncollapsed_fault_count;
+			if (!net_removed[2 * net + value])
+			{
+				Stuck_at_fault fault = { static_cast<Flat_id>(net), Flat_netlist::invalid_id, 0, 1 == value };
+				m_faults.push_back(fault);
+			}
+		}
+	}
+	for (size_t position = 0; position < gate_count; ++position)
+	{
+		for (Flat_id i = input_offsets[position]; i < input_offsets[position + 1]; ++i)
+		{
+			Flat_id net = inputs[i];
+			if (fanout_offsets[net + 1] - fanout_offsets[net] <= 1)
+			{
+				continue;
+			}
+			for (int value = 0; value < 2; ++value)
+			{
+				++m_uncollapsed_fault_count;
+				if (!input_removed[2 * i + value])
+				{
+					Stuck_at_fault fault = { net, static_cast<Flat_id>(position), i - input_offsets[position], 1 == value };
+					m_faults.push_back(fault);
+				}
+			}
+		}
+	}
+
+	m_detected.assign(m_faults.size(), 0);
+	m_pattern_count = 0;
+	m_fault_pattern_count = 0;
+	m_seconds = 0;
+}
+
+/// \brief Returns the faults.
+const std::vector<Stuck_at_fault>& Fault_simulator::get_faults() const
+{
+	return m_faults;
+}
+
+/// \brief Returns the number of faults before collapsing.
+size_t Fault_simulator::get_uncollapsed_fault_count() const
+{
+	return m_uncollapsed_fault_count;
+}
+
+/** \brief Grades a word of patterns.
+ *	\param[in] input_values - One word of patterns per input net, in the order of the Flat Netlist input nets.
+ */
+void Fault_simulator::simulate_patterns(const std::vector<Logic_word>& input_values)
+{
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+	// Good circuit simulation.
+	const std::vector<Flat_id>& input_nets = m_program.get_netlist().get_input_nets();
+	for (size_t i = 0; i < input_nets.size() && i < input_values.size(); ++i)
+	{
+		m_good_values[input_nets[i]] = input_values[i];
+	}
+	if (0 != m_program.get_gate_count())
+	{
+		const std::vector<Simulation_program::Run>& runs = m_program.get_runs();
+		std::vector<Simulation_program::Run>::const_iterator I;
+		for (I = runs.begin(); I != runs.end(); ++I)
+		{
+			Gate_kernels::evaluate_run(I->type, &m_good_values[0], &m_program.get_outputs()[0], &m_program.get_input_offsets()[0],
+				m_program.get_inputs().empty() ? 0 : &m_program.get_inputs()[0], I->begin, I->end);
+		}
+	}
+
+	// Fault dropping: only undetected faults are simulated.
+	m_active_faults.clear();
+	for (size_t i = 0; i < m_faults.size(); ++i)
+	{
+		if (!m_detected[i])
+		{
+			m_active_faults.push_back(i);
+		}
+	}
+
+	if (!m_active_faults.empty())
+	{
+		if (!m_pool)
+		{
+			m_pool.reset(new Work_stealing_pool(m_thread_count));
+		}
+		Work_stealing_pool& pool = *m_pool;
+		unsigned worker_count = pool.get_thread_count();
+		if (m_states.size() != worker_count)
+		{
+			m_states.assign(worker_count, Worker_state());
+			for (unsigned i = 0; i < worker_count; ++i)
+			{
+				m_states[i].wheel.resize(m_program.get_level_offsets().size());
+				m_states[i].scheduled.assign(m_program.get_gate_count(), 0);
+			}
+		}
+		for (unsigned i = 0; i < worker_count; ++i)
+		{
+			m_states[i].values = m_good_values;
+		}
+
+		// Small batches keep the workers balanced, since faults differ a lot in their cone sizes.
+		size_t batch_size = m_active_faults.size() / (8 * worker_count);
+		batch_size = (batch_size < 16) ? 16 : ((batch_size > 1024) ? 1024 : batch_size);
+		for (size_t begin = 0; begin < m_active_faults.size(); begin += batch_size)
+		{
+			size_t end = (begin + batch_size < m_active_faults.size()) ? begin + batch_size : m_active_faults.size();
+			pool.submit(boost::bind(&Fault_simulator::simulate_batch, this, begin, end, _1));
+		}
+		pool.wait();
+	}
+
+	m_pattern_count += Logic_words::pattern_count;
+	m_fault_pattern_count += static_cast<boost::uint64_t>(m_active_faults.size()) * Logic_words::pattern_count;
+	m_seconds += (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+}
+
+/** \brief Grades random patterns.
+ *	\param[in] word_count - Number of pattern words to simulate.
+ *	\param[in] seed - Seed of the random generator, must not be 0.
+ */
+void Fault_simulator::simulate_random_patterns(size_t word_count, boost::uint64_t seed)
+{
+	std::vector<Logic_word> input_values(m_program.get_netlist().get_input_nets().size());
+	for (size_t word = 0; word < word_count && get_detected_count() < m_faults.size(); ++word)
+	{
+		for (size_t i = 0; i < input_values.size(); ++i)
+		{
+			input_values[i] = Logic_words::random(seed);
+		}
+		simulate_patterns(input_values);
+	}
+}
+
+/// \brief Returns the detection flags of the faults.
+const std::vector<char>& Fault_simulator::get_detected() const
+{
+	return m_detected;
+}
+
+/// \brief Returns the number of detected faults.
+size_t Fault_simulator::get_detected_count() const
+{
+	size_t count = 0;
+	std::vector<char>::const_iterator I;
+	for (I = m_detected.begin(); I != m_detected.end(); ++I)
+	{
+		count += (0 != *I);
+	}
+	return count;
+}
+
+/// \brief Returns the ratio of detected faults.
+double Fault_simulator::get_coverage() const
+{
+	return m_faults.empty() ? 1.0 : double(get_detected_count()) / m_faults.size();
+}
+
+/// \brief Returns the number of simulated patterns.
+boost::uint64_t Fault_simulator::get_pattern_count() const
+{
+	return m_pattern_count;
+}
+
+/// \brief Returns the fault-pattern pairs simulated per second, undetected faults times patterns.
+double Fault_simulator::get_fault_patterns_per_second() const
+{
+	return (m_seconds > 0) ? m_fault_pattern_count / m_seconds : 0;
+}
+
+/** \brief Simulates a batch of faults on one worker.
+ *	\param[in] begin - Index of the first fault in the active faults.
+ *	\param[in] end - Index after the last fault.
+ *	\param[in] worker - Index of the worker.
+ */
+void Fault_simulator::simulate_batch(size_t begin, size_t end, unsigned worker)
+{
+	Worker_state& state = m_states[worker];
+	for (size_t i = begin; i < end; ++i)
+	{
+		size_t fault = m_active_faults[i];
+		if (Logic_words::any(propagate_fault(m_faults[fault], state)))
+		{
+			m_detected[fault] = 1;
+		}
+	}
+}
+
+/** \brief Injects a fault into the worker values and propagates it.
+ *	\param[in] fault - The fault.
+ *	\param[in,out] state - State of the worker.
+ *	\ret The patterns detecting the fault.
+ */
+Logic_word Fault_simulator::propagate_fault(const Stuck_at_fault& fault, Worker_state& state) const
+{
+	const std::vector<PrimitiveType>& types = m_program.get_types();
+	const std::vector<Flat_id>& outputs = m_program.get_outputs();
+	const std::vector<Flat_id>& input_offsets = m_program.get_input_offsets();
+	const Flat_id* inputs = m_program.get_inputs().empty() ? 0 : &m_program.get_inputs()[0];
+	const std::vector<unsigned>& levels = m_program.get_levels();
+	Logic_word* values = &state.values[0];
+	Logic_word forced = fault.value ? Logic_words::ones() : Logic_words::zeros();
+
+	// Inject the fault, a branch fault is visible only to its gate.
+	Flat_id changed = fault.net;
+	unsigned level = no_level;
+	if (Flat_netlist::invalid_id == fault.gate)
+	{
+		if (Logic_words::equal(values[fault.net], forced))
+		{
+			return Logic_words::zeros();
+		}
+		values[fault.net] = forced;
+	}
+	else
+	{
+		Logic_word good = values[fault.net];
+		values[fault.net] = forced;
+		Logic_word value = Gate_kernels::evaluate(types[fault.gate], values,
+			inputs + input_offsets[fault.gate], inputs + input_offsets[fault.gate + 1]);
+		values[fault.net] = good;
+
+		changed = outputs[fault.gate];
+		if (Logic_words::equal(values[changed], value))
+		{
+			return Logic_words::zeros();
+		}
+		values[changed] = value;
+		level = levels[fault.gate];
+	}
+	state.changed_nets.push_back(changed);
+	schedule_fanouts(changed, level, state);
+
+	// Propagate level by level through the fanout cone.
+	size_t level_count = state.wheel.size();
+	for (size_t current = (no_level == level) ? 0 : level + 1; current < level_count; ++current)
+	{
+		std::vector<Flat_id>& bucket = state.wheel[current];
+		for (size_t i = 0; i < bucket.size(); ++i)
+		{
+			Flat_id position = bucket[i];
+			state.scheduled[position] = 0;
+			Logic_word value = Gate_kernels::evaluate(types[position], values,
+				inputs + input_offsets[position], inputs + input_offsets[position + 1]);
+			Flat_id output = outputs[position];
+			if (!Logic_words::equal(values[output], value))
+			{
+				values[output] = value;
+				state.changed_nets.push_back(output);
+				schedule_fanouts(output, static_cast<unsigned>(current), state);
+			}
+		}
+		bucket.clear();
+	}
+
+	// Compare the outputs and restore the good values.
+	Logic_word detected = Logic_words::zeros();
+	std::vector<Flat_id>::const_iterator I;
+	for (I = state.changed_nets.begin(); I != state.changed_nets.end(); ++I)
+	{
+		if (m_is_output[*I])
+		{
+			detected |= values[*I] ^ m_good_values[*I];
+		}
+		values[*I] = m_good_values[*I];
+	}
+	state.changed_nets.clear();
+	return detected;
+}
+
+/** \brief Schedules the fanouts of a changed faulty net.
+ *	\param[in] net - The net.
+ *	\param[in] current_level - Level being processed, gates at or below it are not scheduled.
+ *	\param[in,out] state - State of the worker.
+ */
+void Fault_simulator::schedule_fanouts(Flat_id net, unsigned current_level, Worker_state& state) const
+{
+	const Flat_netlist& netlist = m_program.get_netlist();
+	const std::vector<Flat_id>& fanout_offsets = netlist.get_net_fanout_offsets();
+	const std::vector<Flat_id>& fanouts = netlist.get_net_fanouts();
+	const std::vector<Flat_id>& positions = m_program.get_positions();
+	const std::vector<unsigned>& levels = m_program.get_levels();
+
+	for (Flat_id i = fanout_offsets[net]; i < fanout_offsets[net + 1]; ++i)
+	{
+		Flat_id position = positions[fanouts[i]];
+		if (Flat_netlist::invalid_id == position || state.scheduled[position])
+		{
+			continue;
+		}
+		unsigned level = levels[position];
+		if (no_level != current_level && level <= current_level)
+		{
+			continue;
+		}
+		state.scheduled[position] = 1;
+		state.wheel[level].push_back(position);
+	}
+}
+
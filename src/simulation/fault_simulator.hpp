@@ -0,0 +1,165 @@
+#ifndef FAULT_SIMULATOR_HPP
+#define FAULT_SIMULATOR_HPP
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "logic_word.hpp"
+#include "simulation_program.hpp"
+
+class Work_stealing_pool;
+
+/// A single stuck-at fault, on a net (stem) or on one gate input (branch).
+struct Stuck_at_fault
+{
+	/// The faulty net.
+	Flat_id net;
+
+	/// Position of the gate in the Simulation Program for branch faults, invalid_id for stem faults.
+	Flat_id gate;
+
+	/// Index of the faulty input among the gate inputs for branch faults.
+	Flat_id input;
+
+	/// The stuck value.
+	bool value;
+};
+
+/** \brief Parallel-pattern single-fault-propagation stuck-at fault simulator.
+ *	For every word of patterns the good circuit is simulated once, then each undetected fault is
+ *	injected and propagated event-driven through its fanout cone only, and compared at the output nets.
+ *	Detected faults are dropped. Batches of faults are run as tasks of a Work Stealing Pool, started
+ *	on the first word and kept for all later words, each worker keeping its own faulty copy of the net values.
+ */
+class Fault_simulator
+{
+public:
+
+	/** \brief Constructor with the program to grade patterns on.
+	 *	\param[in] program - The Simulation Program, must outlive the simulator.
+	 *	\param[in] thread_count - Number of worker threads, 0 for the hardware thread count.
+	 */
+	Fault_simulator(const Simulation_program& program, unsigned thread_count = 0);
+
+	/** \brief Generates the stuck-at 0 and 1 faults of all nets and of the gate inputs of nets with several fanouts.
+	 *	Resets the detection results.
+	 *	\param[in] collapse - If true, faults equivalent to a fault on the gate output are left out.
+	 */
+	void generate_faults(bool collapse = true);
+
+	/// \brief Returns the faults.
+	const std::vector<Stuck_at_fault>& get_faults() const;
+
+	/// \brief Returns the number of faults before collapsing.
+	size_t get_uncollapsed_fault_count() const;
+
+	/** \brief Grades a word of patterns.
+	 *	\param[in] input_values - One word of patterns per input net, in the order of the Flat Netlist input nets.
+	 */
+	void simulate_patterns(const std::vector<Logic_word>& input_values);
+
+	/** \brief Grades random patterns.
+	 *	\param[in] word_count - Number of pattern words to simulate.
+	 *	\param[in] seed - Seed of the random generator, must not be 0.
+	 */
+	void simulate_random_patterns(size_t word_count, boost::uint64_t seed);
+
+	/// \brief Returns the detection flags of the faults.
+	const std::vector<char>& get_detected() const;
+
+	/// \brief Returns the number of detected faults.
+	size_t get_detected_count() const;
+
+	/// \brief Returns the ratio of detected faults.
+	double get_coverage() const;
+
+	/// \brief Returns the number of simulated patterns.
+	boost::uint64_t get_pattern_count() const;
+
+	/// \brief Returns the fault-pattern pairs simulated per second, undetected faults times patterns.
+	double get_fault_patterns_per_second() const;
+
+private:
+
+	/// State of a worker: the faulty values and the event queue of the fault propagation.
+	struct Worker_state
+	{
+		/// Faulty values of the nets.
+		std::vector<Logic_word> values;
+
+		/// Pending gate positions by level.
+		std::vector<std::vector<Flat_id> > wheel;
+
+		/// Flags of the scheduled gate positions.
+		std::vector<char> scheduled;
+
+		/// Nets changed by the current fault.
+		std::vector<Flat_id> changed_nets;
+	};
+
+	/** \brief Simulates a batch of faults on one worker.
+	 *	\param[in] begin - Index of the first fault in the active faults.
+	 *	\param[in] end - Index after the last fault.
+	 *	\param[in] worker - Index of the worker.
+	 */
+	void simulate_batch(size_t begin, size_t end, unsigned worker);
+
+	/** \brief Injects a fault into the worker values and propagates it.
+	 *	\param[in] fault - The fault.
+	 *	\param[in,out] state - State of the worker.
+	 *	\ret The patterns detecting the fault.
+	 */
+	Logic_word propagate_fault(const Stuck_at_fault& fault, Worker_state& state) const;
+
+	/** \brief Schedules the fanouts of a changed faulty net.
+	 *	\param[in] net - The net.
+	 *	\param[in] current_level - Level being processed, gates at or below it are not scheduled.
+	 *	\param[in,out] state - State of the worker.
+	 */
+	void schedule_fanouts(Flat_id net, unsigned current_level, Worker_state& state) const;
+
+private:
+
+	/// The Simulation Program.
+	const Simulation_program& m_program;
+
+	/// Number of worker threads.
+	unsigned m_thread_count;
+
+	/// The faults.
+	std::vector<Stuck_at_fault> m_faults;
+
+	/// Number of faults before collapsing.
+	size_t m_uncollapsed_fault_count;
+
+	/// Detection flags of the faults.
+	std::vector<char> m_detected;
+
+	/// Indices of the faults simulated in the current word.
+	std::vector<size_t> m_active_faults;
+
+	/// Good values of the current word.
+	std::vector<Logic_word> m_good_values;
+
+	/// Flags of the output nets.
+	std::vector<char> m_is_output;
+
+	/// Pool running the fault batches, created by the first simulated word.
+	boost::shared_ptr<Work_stealing_pool> m_pool;
+
+	/// States of the workers.
+	std::vector<Worker_state> m_states;
+
+	/// Number of simulated patterns.
+	boost::uint64_t m_pattern_count;
+
+	/// Number of simulated fault-pattern pairs.
+	boost::uint64_t m_fault_pattern_count;
+
+	/// Wall time spent in fault simulation, in seconds.
+	double m_seconds;
+
+};
+
+#endif // FAULT_SIMULATOR_HPP
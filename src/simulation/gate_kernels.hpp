@@ -0,0 +1,176 @@
+#ifndef GATE_KERNELS_HPP
+#define GATE_KERNELS_HPP
+
+#include "logic_word.hpp"
+#include "analysis/flat_netlist.hpp"
+
+/** \brief Bit-parallel evaluation kernel of a built-in primitive, selected at compile time by the primitive type.
+ *	Evaluates the gate for all patterns of a word at once from the values of its input nets.
+ *	Instances of undefined modules (PRIMITIVE_NONE) have no kernel and are never evaluated.
+ */
+template <PrimitiveType type>
+struct Gate_kernel;
+
+/// Kernel of the and primitive.
+template <>
+struct Gate_kernel<PRIMITIVE_AND>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		Logic_word result = Logic_words::ones();
+		for (; first != last; ++first)
+		{
+			result &= values[*first];
+		}
+		return result;
+	}
+};
+
+/// Kernel of the or primitive.
+template <>
+struct Gate_kernel<PRIMITIVE_OR>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		Logic_word result = Logic_words::zeros();
+		for (; first != last; ++first)
+		{
+			result |= values[*first];
+		}
+		return result;
+	}
+};
+
+/// Kernel of the xor primitive.
+template <>
+struct Gate_kernel<PRIMITIVE_XOR>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		Logic_word result = Logic_words::zeros();
+		for (; first != last; ++first)
+		{
+			result ^= values[*first];
+		}
+		return result;
+	}
+};
+
+/// Kernel of the nand primitive.
+template <>
+struct Gate_kernel<PRIMITIVE_NAND>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		return ~Gate_kernel<PRIMITIVE_AND>::evaluate(values, first, last);
+	}
+};
+
+/// Kernel of the nor primitive.
+template <>
+struct Gate_kernel<PRIMITIVE_NOR>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		return ~Gate_kernel<PRIMITIVE_OR>::evaluate(values, first, last);
+	}
+};
+
+/// Kernel of the xnor primitive.
+template <>
+struct Gate_kernel<PRIMITIVE_XNOR>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		return ~Gate_kernel<PRIMITIVE_XOR>::evaluate(values, first, last);
+	}
+};
+
+/// Kernel of the not primitive, an unconnected input reads as 0.
+template <>
+struct Gate_kernel<PRIMITIVE_NOT>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		return (first == last) ? Logic_words::ones() : ~values[*first];
+	}
+};
+
+/// Kernel of the buf primitive, an unconnected input reads as 0.
+template <>
+struct Gate_kernel<PRIMITIVE_BUF>
+{
+	static Logic_word evaluate(const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		return (first == last) ? Logic_words::zeros() : values[*first];
+	}
+};
+
+/// This class has only static functions dispatching gates to their kernels.
+class Gate_kernels
+{
+public:
+
+	/** \brief Evaluates consecutive gates of the same type, writing their outputs into the values.
+	 *	\param[in,out] values - Values of all nets.
+	 *	\param[in] outputs - Output nets of the gates.
+	 *	\param[in] input_offsets - Offsets of the gate inputs.
+	 *	\param[in] inputs - Input nets of the gates.
+	 *	\param[in] begin - First gate to evaluate.
+	 *	\param[in] end - The gate after the last one to evaluate.
+	 */
+	template <PrimitiveType type>
+	static void evaluate_run(Logic_word* values, const Flat_id* outputs, const Flat_id* input_offsets, const Flat_id* inputs, Flat_id begin, Flat_id end)
+	{
+		for (Flat_id i = begin; i < end; ++i)
+		{
+			values[outputs[i]] = Gate_kernel<type>::evaluate(values, inputs + input_offsets[i], inputs + input_offsets[i + 1]);
+		}
+	}
+
+	/** \brief Evaluates consecutive gates of the given type, the type is dispatched once for the whole run.
+	 *	\param[in] type - Type of all gates of the run.
+	 *	For the other parameters see evaluate_run above.
+	 */
+	static void evaluate_run(PrimitiveType type, Logic_word* values, const Flat_id* outputs, const Flat_id* input_offsets, const Flat_id* inputs, Flat_id begin, Flat_id end)
+	{
+		switch (type)
+		{
+			case PRIMITIVE_AND: evaluate_run<PRIMITIVE_AND>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_OR: evaluate_run<PRIMITIVE_OR>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_NAND: evaluate_run<PRIMITIVE_NAND>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_NOR: evaluate_run<PRIMITIVE_NOR>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_XOR: evaluate_run<PRIMITIVE_XOR>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_XNOR: evaluate_run<PRIMITIVE_XNOR>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_NOT: evaluate_run<PRIMITIVE_NOT>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_BUF: evaluate_run<PRIMITIVE_BUF>(values, outputs, input_offsets, inputs, begin, end); break;
+			case PRIMITIVE_NONE: break;
+		}
+	}
+
+	/** \brief Evaluates a single gate and returns its output value.
+	 *	\param[in] type - Type of the gate.
+	 *	\param[in] values - Values of all nets.
+	 *	\param[in] first - First input net of the gate.
+	 *	\param[in] last - The input after the last input net of the gate.
+	 */
+	static Logic_word evaluate(PrimitiveType type, const Logic_word* values, const Flat_id* first, const Flat_id* last)
+	{
+		switch (type)
+		{
+			case PRIMITIVE_AND: return Gate_kernel<PRIMITIVE_AND>::evaluate(values, first, last);
+			case PRIMITIVE_OR: return Gate_kernel<PRIMITIVE_OR>::evaluate(values, first, last);
+			case PRIMITIVE_NAND: return Gate_kernel<PRIMITIVE_NAND>::evaluate(values, first, last);
+			case PRIMITIVE_NOR: return Gate_kernel<PRIMITIVE_NOR>::evaluate(values, first, last);
+			case PRIMITIVE_XOR: return Gate_kernel<PRIMITIVE_XOR>::evaluate(values, first, last);
+			case PRIMITIVE_XNOR: return Gate_kernel<PRIMITIVE_XNOR>::evaluate(values, first, last);
+			case PRIMITIVE_NOT: return Gate_kernel<PRIMITIVE_NOT>::evaluate(values, first, last);
+			case PRIMITIVE_BUF: return Gate_kernel<PRIMITIVE_BUF>::evaluate(values, first, last);
+			case PRIMITIVE_NONE: break;
+		}
+		return Logic_words::zeros();
+	}
+
+};
+
+#endif // GATE_KERNELS_HPP
@@ -0,0 +1,120 @@
+#ifndef LOGIC_WORD_HPP
+#define LOGIC_WORD_HPP
+
+#include <cstring>
+#include <boost/cstdint.hpp>
+
+/** \brief Machine word holding the values of a net for several input patterns, one pattern per bit.
+ *	When compiled with AVX2 support a word is a 256 bit vector, otherwise a 64 bit integer.
+ *	All bitwise operators apply to both forms.
+ */
+#ifdef __AVX2__
+typedef boost::uint64_t Logic_word __attribute__((vector_size(32)));
+#else
+typedef boost::uint64_t Logic_word;
+#endif
+
+/// This class has only static helpers for Logic Words.
+class Logic_words
+{
+public:
+
+	/// Number of 64 bit lanes in a word.
+	static const unsigned lane_count = sizeof(Logic_word) / sizeof(boost::uint64_t);
+
+	/// Number of patterns held by a word.
+	static const unsigned pattern_count = lane_count * 64;
+
+	/// \brief Returns a word with all patterns at 0.
+	static Logic_word zeros()
+	{
+		Logic_word word;
+		std::memset(&word, 0, sizeof(word));
+		return word;
+	}
+
+	/// \brief Returns a word with all patterns at 1.
+	static Logic_word ones()
+	{
+		return ~zeros();
+	}
+
+	/** \brief Returns a lane of the word.
+	 *	\param[in] word - The word.
+	 *	\param[in] lane - Index of the lane, less than lane_count.
+	 */
+	static boost::uint64_t get_lane(const Logic_word& word, unsigned lane)
+	{
+		boost::uint64_t value;
+		std::memcpy(&value, reinterpret_cast<const char*>(&word) + lane * sizeof(value), sizeof(value));
+		return value;
+	}
+
+	/** \brief Sets a lane of the word.
+	 *	\param[in,out] word - The word.
+	 *	\param[in] lane - Index of the lane, less than lane_count.
+	 *	\param[in] value - New value of the lane.
+	 */
+	static void set_lane(Logic_word& word, unsigned lane, boost::uint64_t value)
+	{
+		std::memcpy(reinterpret_cast<char*>(&word) + lane * sizeof(value), &value, sizeof(value));
+	}
+
+	/** \brief Returns the value of a pattern in the word.
+	 *	\param[in] word - The word.
+	 *	\param[in] pattern - Index of the pattern, less than pattern_count.
+	 */
+	static bool get_pattern(const Logic_word& word, unsigned pattern)
+	{
+		return 0 != ((get_lane(word, pattern / 64) >> (pattern % 64)) & 1);
+	}
+
+	/** \brief Checks if the words hold the same values for all patterns.
+	 *	\param[in] first - The first word.
+	 *	\param[in] second - The second word.
+	 */
+	static bool equal(const Logic_word& first, const Logic_word& second)
+	{
+		return 0 == std::memcmp(&first, &second, sizeof(Logic_word));
+	}
+
+	/** \brief Checks if any pattern is set in the word.
+	 *	\param[in] word - The word.
+	 */
+	static bool any(const Logic_word& word)
+	{
+		return !equal(word, zeros());
+	}
+
+	/** \brief Returns the number of patterns set in the word.
+	 *	\param[in] word - The word.
+	 */
+	static unsigned count(const Logic_word& word)
+	{
+		unsigned result = 0;
+		for (unsigned lane = 0; lane < lane_count; ++lane)
+		{
+			result += __builtin_popcountll(get_lane(word, lane));
+		}
+		return result;
+	}
+
+	/** \brief Returns a pseudo-random word and advances the generator state (xorshift64*).
+	 *	\param[in,out] state - State of the generator, must not be 0.
+	 */
+	static Logic_word random(boost::uint64_t& state)
+	{
+		Logic_word word;
+		for (unsigned lane = 0; lane < lane_count; ++lane)
+		{
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			set_lane(word, lane, state * 2685821657736338717ULL);
+		}
+		return word;
+	}
+
+};
+
+#endif // LOGIC_WORD_HPP
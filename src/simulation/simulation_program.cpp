@@ -0,0 +1,155 @@
+#include "simulation_program.hpp"
+
+#include <algorithm>
+
+/// Helper functions.
+namespace
+{
+	/// Orders gates by primitive type.
+	struct Type_less
+	{
+		const std::vector<PrimitiveType>* types;
+
+		bool operator()(Flat_id first, Flat_id second) const
+		{
+			return (*types)[first] < (*types)[second];
+		}
+	};
+}
+
+/** \brief Constructor from a levelized netlist.
+ *	\param[in] levelizer - The Levelizer, levelize must already be called. The netlist must outlive the program.
+ */
+Simulation_program::Simulation_program(const Levelizer& levelizer)
+	: m_netlist( levelizer.get_netlist() )
+{
+	const std::vector<PrimitiveType>& types = m_netlist.get_gate_types();
+	const std::vector<Flat_id>& outputs = m_netlist.get_gate_outputs();
+	const std::vector<Flat_id>& input_offsets = m_netlist.get_gate_input_offsets();
+	const std::vector<Flat_id>& inputs = m_netlist.get_gate_inputs();
+	const std::vector<Flat_id>& levelized = levelizer.get_levelized_gates();
+	const std::vector<Flat_id>& level_offsets = levelizer.get_level_offsets();
+	unsigned level_count = levelizer.get_level_count();
+
+	m_positions.assign(m_netlist.get_gate_count(), Flat_netlist::invalid_id);
+	m_input_offsets.push_back(0);
+	m_level_offsets.push_back(0);
+	Type_less type_less = { &types };
+	std::vector<Flat_id> level_gates;
+	for (unsigned level = 0; level < level_count; ++level)
+	{
+		level_gates.clear();
+		for (Flat_id i = level_offsets[level]; i < level_offsets[level + 1]; ++i)
+		{
+			Flat_id gate = levelized[i];
+			if (PRIMITIVE_NONE != types[gate] && Flat_netlist::invalid_id != outputs[gate])
+			{
+				level_gates.push_back(gate);
+			}
+		}
+		std::stable_sort(level_gates.begin(), level_gates.end(), type_less);
+
+		std::vector<Flat_id>::const_iterator I;
+		for (I = level_gates.begin(); I != level_gates.end(); ++I)
+		{
+			Flat_id position = static_cast<Flat_id>(m_gates.size());
+			if (m_runs.empty() || m_runs.back().type != types[*I] || m_runs.back().end != position || position == m_level_offsets.back())
+			{
+				Run run = { position, position, types[*I] };
+				m_runs.push_back(run);
+			}
+			++m_runs.back().end;
+
+			m_positions[*I] = position;
+			m_gates.push_back(*I);
+			m_types.push_back(types[*I]);
+			m_outputs.push_back(outputs[*I]);
+			m_levels.push_back(level);
+			m_inputs.insert(m_inputs.end(), inputs.begin() + input_offsets[*I], inputs.begin() + input_offsets[*I + 1]);
+			m_input_offsets.push_back(static_cast<Flat_id>(m_inputs.size()));
+		}
+		m_level_offsets.push_back(static_cast<Flat_id>(m_gates.size()));
+	}
+}
+
+/// \brief Getter for the Flat Netlist.
+const Flat_netlist& Simulation_program::get_netlist() const
+{
+	return m_netlist;
+}
+
+/// \brief Returns the number of gates in the program.
+size_t Simulation_program::get_gate_count() const
+{
+	return m_gates.size();
+}
+
+/// \brief Returns the Flat Netlist gates by position.
+const std::vector<Flat_id>& Simulation_program::get_gates() const
+{
+	return m_gates;
+}
+
+/// \brief Returns the positions of the Flat Netlist gates, invalid_id for gates left out.
+const std::vector<Flat_id>& Simulation_program::get_positions() const
+{
+	return m_positions;
+}
+
+/// \brief Returns the types of the gates by position.
+const std::vector<PrimitiveType>& Simulation_program::get_types() const
+{
+	return m_types;
+}
+
+/// \brief Returns the output nets of the gates by position.
+const std::vector<Flat_id>& Simulation_program::get_outputs() const
+{
+	return m_outputs;
+}
+
+/// \brief Returns the offsets of the gate inputs by position.
+const std::vector<Flat_id>& Simulation_program::get_input_offsets() const
+{
+	return m_input_offsets;
+}
+
+/// \brief Returns the input nets of all gates.
+const std::vector<Flat_id>& Simulation_program::get_inputs() const
+{
+	return m_inputs;
+}
+
+/// \brief Returns the levels of the gates by position.
+const std::vector<unsigned>& Simulation_program::get_levels() const
+{
+	return m_levels;
+}
+
+/// \brief Returns the offsets of the levels, gates of level l are at positions [offsets[l], offsets[l + 1]).
+const std::vector<Flat_id>& Simulation_program::get_level_offsets() const
+{
+	return m_level_offsets;
+}
+
+/// \brief Returns the runs of gates of the same type, in evaluation order.
+const std::vector<Simulation_program::Run>& Simulation_program::get_runs() const
+{
+	return m_runs;
+}
+
+/// \brief Returns the values of all nets before simulation: nets tied to 1'b1 are all ones, the other nets all zeros.
+std::vector<Logic_word> Simulation_program::get_initial_values() const
+{
+	const std::vector<LogicConstant>& constants = m_netlist.get_net_constants();
+	std::vector<Logic_word> values(constants.size(), Logic_words::zeros());
+	for (size_t net = 0; net < constants.size(); ++net)
+	{
+		if (CONSTANT_ONE == constants[net])
+		{
+			values[net] = Logic_words::ones();
+		}
+	}
+	return values;
+}
+
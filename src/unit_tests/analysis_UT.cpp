@@ -0,0 +1,1816 @@
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include <utility>
+#include <ctime>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "database/netlist_builder.hpp"
+#include "database/module_description.hpp"
+#include "database/module_port.hpp"
+#include "database/net.hpp"
+#include "database/instance_port.hpp"
+#include "analysis/flat_netlist.hpp"
+#include "analysis/levelizer.hpp"
+#include "analysis/aig.hpp"
+#include "analysis/module_hasher.hpp"
+#include "analysis/module_scheduler.hpp"
+#include "analysis/module_summary.hpp"
+#include "analysis/netlist_diff.hpp"
+#include "analysis/depth_analyzer.hpp"
+#include "analysis/cone_estimator.hpp"
+#include "analysis/partitioner.hpp"
+#include "analysis/lint_engine.hpp"
+#include "analysis/constant_propagator.hpp"
+#include "analysis/cone_extractor.hpp"
+#include "analysis/uniquifier.hpp"
+#include "analysis/hierarchy_query.hpp"
+#include "database/module_instance.hpp"
+#include "database/edit_journal.hpp"
+#include "database/netlist_reader.hpp"
+#include "analysis/parallel.hpp"
+#include "analysis/work_stealing_pool.hpp"
+
+/// Helper functions.
+namespace
+{
+	/// \brief Prints the failure message and returns false if the condition does not hold.
+	bool check(bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cout << "FAILED: " << message << "\n";
+		}
+		return condition;
+	}
+
+	/// \brief Adds a two pin primitive instance to the module.
+	void add_gate(Module_description& module, const std::string& type, const std::string& name, const std::string& in, const std::string& out)
+	{
+		std::vector< std::pair< std::string, std::string> > pins;
+		pins.push_back(std::make_pair(in, std::string("I")));
+		pins.push_back(std::make_pair(out, std::string("Z")));
+		module.add_module_instance(type, name, pins);
+	}
+
+	/// \brief Adds a three pin primitive instance to the module.
+	void add_gate(Module_description& module, const std::string& type, const std::string& name, const std::string& in0, const std::string& in1, const std::string& out)
+	{
+		std::vector< std::pair< std::string, std::string> > pins;
+		pins.push_back(std::make_pair(in0, std::string("I0")));
+		pins.push_back(std::make_pair(in1, std::string("I1")));
+		pins.push_back(std::make_pair(out, std::string("Z")));
+		module.add_module_instance(type, name, pins);
+	}
+
+	/// \brief Adds a port to the module.
+	void add_port(Module_description& module, const std::string& name, PortType type)
+	{
+		module.add_port(boost::shared_ptr<Module_port>(new Module_port(name, type, &module)));
+	}
+
+	/// \brief Levelizes the sample netlist.
+	bool test_sample_levels(Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat, 2);
+		levelizer.levelize();
+
+		bool passed = check(39 == flat.get_gate_count(), "ALU_PLUS_MINUS flattens to 39 gates");
+		passed &= check(5 == flat.get_input_nets().size(), "ALU_PLUS_MINUS has 5 inputs");
+		passed &= check(!levelizer.has_loops(), "ALU_PLUS_MINUS has no loops");
+
+		// Every gate is above the drivers of its inputs.
+		const std::vector<unsigned>& levels = levelizer.get_gate_levels();
+		for (size_t gate = 0; gate < flat.get_gate_count(); ++gate)
+		{
+			for (Flat_id i = flat.get_gate_input_offsets()[gate]; i < flat.get_gate_input_offsets()[gate + 1]; ++i)
+			{
+				Flat_id driver = flat.get_net_drivers()[flat.get_gate_inputs()[i]];
+				if (Flat_netlist::invalid_id != driver)
+				{
+					passed &= check(levels[driver] < levels[gate], "gate is above its drivers: " + flat.get_gate_name(gate));
+				}
+			}
+		}
+		passed &= check(flat.get_gate_count() == levelizer.get_levelized_gates().size(), "all gates levelized");
+		return passed;
+	}
+
+	/// \brief Levelizes a ring of inverters closed through a buffer chain.
+	bool test_loop_detection()
+	{
+		Netlist netlist("loop");
+		netlist.create_new_module("ring");
+		Module_description& ring = *netlist.get_module("ring");
+		add_gate(ring, "not", "n0", "a", "b");
+		add_gate(ring, "not", "n1", "b", "c");
+		add_gate(ring, "not", "n2", "c", "a");
+		add_gate(ring, "buf", "b0", "c", "d");
+		add_gate(ring, "buf", "b1", "d", "d");
+		ring.connect_nets();
+
+		Flat_netlist flat(netlist, "ring");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+
+		bool passed = check(2 == levelizer.get_loop_count(), "ring has two loops");
+		passed &= check(3 == levelizer.get_loop_offsets()[1] - levelizer.get_loop_offsets()[0]
+			|| 3 == levelizer.get_loop_offsets()[2] - levelizer.get_loop_offsets()[1], "three gates in the inverter ring");
+		passed &= check(3 == levelizer.get_level_count(), "ring, buffer and self loop are on three levels");
+		return passed;
+	}
+
+	/// \brief Flattens primitives with two output pins, bound to one net and to two nets.
+	bool test_multi_output_leaf()
+	{
+		Netlist netlist("outputs");
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		std::vector< std::pair< std::string, std::string> > pins;
+		pins.push_back(std::make_pair(std::string("a"), std::string("I")));
+		pins.push_back(std::make_pair(std::string("x"), std::string("Z")));
+		pins.push_back(std::make_pair(std::string("x"), std::string("Z")));
+		top.add_module_instance("buf", "b0", pins);
+		top.connect_nets();
+
+		Flat_netlist joined(netlist, "top");
+		bool passed = check(1 == joined.get_gate_count() && joined.find_net("x") == joined.get_gate_outputs()[0], "output pins bound to one net drive it");
+		passed &= check(1 == joined.get_gate_input_offsets()[1] - joined.get_gate_input_offsets()[0], "second output pin is not an input");
+
+		pins.back().first = "y";
+		top.add_module_instance("buf", "b1", pins);
+		top.connect_nets();
+		bool is_rejected = false;
+		try
+		{
+			Flat_netlist split(netlist, "top");
+		}
+		catch (const std::string& error)
+		{
+			is_rejected = ("Leaf instance drives several nets: b1" == error);
+		}
+		passed &= check(is_rejected, "leaf instance driving two nets rejected");
+		return passed;
+	}
+
+	/// \brief Converts the FA module to an AIG and compares it with the function of its gates.
+	bool test_aig_conversion(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "FA");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Aig aig(levelizer);
+
+		bool passed = check(3 == aig.get_input_count() && 2 == aig.get_outputs().size(), "FA AIG has 3 inputs and 2 outputs");
+		std::vector<boost::uint64_t> inputs(aig.get_input_count()), outputs;
+		boost::uint64_t state = 88172645463325252ull;
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			inputs[i] = state;
+		}
+		aig.evaluate(inputs, outputs);
+
+		std::vector<boost::uint64_t> nets(flat.get_net_count(), 0);
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			nets[flat.get_input_nets()[i]] = inputs[i];
+		}
+		boost::uint64_t a = nets[flat.find_net("a")], b = nets[flat.find_net("b")], ci = nets[flat.find_net("ci")];
+		for (size_t i = 0; i < outputs.size(); ++i)
+		{
+			boost::uint64_t expected = (flat.find_net("co") == flat.get_output_nets()[i]) ? (ci & a & b) : ((a ^ b) | (ci ^ (a & b)));
+			passed &= check(expected == outputs[i], "FA AIG output matches the gate function");
+		}
+		return passed;
+	}
+
+	/// \brief Checks the structural hashing and the binary AIGER encoding.
+	bool test_aig_hashing()
+	{
+		Netlist netlist("hashing");
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		add_port(top, "a", IN);
+		add_port(top, "b", IN);
+		add_port(top, "x", OUT);
+		add_port(top, "y", OUT);
+		add_gate(top, "and", "g0", "a", "b", "n0");
+		add_gate(top, "and", "g1", "b", "a", "n1");
+		add_gate(top, "nand", "g2", "n0", "n1", "x");
+		add_gate(top, "or", "g3", "n1", "n0", "y");
+		top.connect_nets();
+
+		Flat_netlist flat(netlist, "top");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Aig aig(levelizer);
+		bool passed = check(1 == aig.get_and_count(), "identical AND nodes are merged");
+
+		std::ostringstream stream;
+		aig.write_aiger(stream);
+		std::istringstream input(stream.str());
+		std::string format;
+		size_t max_variable, input_count, latch_count, output_count, and_count;
+		input >> format >> max_variable >> input_count >> latch_count >> output_count >> and_count;
+		passed &= check("aig" == format && 3 == max_variable && 2 == input_count && 0 == latch_count && 2 == output_count && 1 == and_count, "AIGER header");
+		std::vector<Aig::Literal> outputs(output_count);
+		for (size_t i = 0; i < output_count; ++i)
+		{
+			input >> outputs[i];
+		}
+		passed &= check(outputs == aig.get_outputs(), "AIGER outputs");
+		input.get();
+		for (size_t node = 0; node < and_count; ++node)
+		{
+			Aig::Literal deltas[2] = { 0, 0 };
+			for (int d = 0; d < 2; ++d)
+			{
+				int shift = 0;
+				int byte;
+				do
+				{
+					byte = input.get();
+					deltas[d] |= (byte & 0x7f) << shift;
+					shift += 7;
+				} while (byte & 0x80);
+			}
+			Aig::Literal literal = 2 * (input_count + 1 + node);
+			passed &= check(literal - deltas[0] == aig.get_and_fanins()[2 * node] && literal - deltas[0] - deltas[1] == aig.get_and_fanins()[2 * node + 1], "AIGER AND encoding");
+		}
+		std::string symbol;
+		input >> symbol;
+		passed &= check("i0" == symbol, "AIGER symbol table");
+
+		// More nodes than the initial table holds, the literals must survive the growth of the table.
+		Aig chain;
+		const Aig::Literal first_input = chain.create_input("a");
+		const Aig::Literal second_input = chain.create_input("b");
+		const size_t node_count = 5000;
+		std::vector<Aig::Literal> literals;
+		Aig::Literal literal = first_input;
+		bool is_numbered = true;
+		for (size_t node = 0; node < node_count; ++node)
+		{
+			literal = chain.create_and(literal, (0 == node % 2) ? second_input : Aig::negate(second_input));
+			literal = Aig::negate(literal);
+			is_numbered &= (2 * (2 + node + 1) == Aig::negate(literal));
+			literals.push_back(literal);
+		}
+		passed &= check(is_numbered && node_count == chain.get_and_count(), "new nodes numbered across table growth");
+		bool is_found = true;
+		literal = first_input;
+		for (size_t node = 0; node < node_count; ++node)
+		{
+			literal = Aig::negate(chain.create_and(literal, (0 == node % 2) ? second_input : Aig::negate(second_input)));
+			is_found &= (literals[node] == literal);
+		}
+		passed &= check(is_found && node_count == chain.get_and_count(), "existing nodes found after table growth");
+		return passed;
+	}
+
+	/// \brief Builds a half adder module, the names and the gate order depend on the variant.
+	void add_half_adder(Netlist& netlist, const std::string& name, int variant)
+	{
+		netlist.create_new_module(name);
+		Module_description& module = *netlist.get_module(name);
+		add_port(module, "a", IN);
+		add_port(module, "b", IN);
+		add_port(module, "s", OUT);
+		add_port(module, "c", OUT);
+		if (0 == variant)
+		{
+			add_gate(module, "xor", "x", "a", "b", "n0");
+			add_gate(module, "and", "y", "a", "b", "n1");
+		}
+		else
+		{
+			add_gate(module, "and", "u1", "a", "b", "carry");
+			add_gate(module, "xor", "u0", "a", (1 == variant) ? "b" : "a", "sum");
+		}
+		add_gate(module, "buf", "z0", (0 == variant) ? "n0" : "sum", "s");
+		add_gate(module, "buf", "z1", (0 == variant) ? "n1" : "carry", "c");
+		module.connect_nets();
+	}
+
+	/// \brief Builds a netlist with a top module instantiating three half adders, the last one of the given variant.
+	void build_hashing_netlist(Netlist& netlist, int last_variant)
+	{
+		add_half_adder(netlist, "ha0", 0);
+		add_half_adder(netlist, "ha1", 1);
+		add_half_adder(netlist, "ha2", last_variant);
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		add_port(top, "a", IN);
+		add_port(top, "b", IN);
+		const char* masters[] = { "ha0", "ha1", "ha2" };
+		for (int i = 0; i < 3; ++i)
+		{
+			std::vector< std::pair< std::string, std::string> > pins;
+			pins.push_back(std::make_pair(std::string("a"), std::string("a")));
+			pins.push_back(std::make_pair(std::string("b"), std::string("b")));
+			pins.push_back(std::make_pair(std::string("s") + char('0' + i), std::string("s")));
+			top.add_module_instance(masters[i], std::string("h") + char('0' + i), pins);
+			top.get_module_instance_by_name(std::string("h") + char('0' + i))->set_module_description(*netlist.get_module(masters[i]));
+		}
+		top.connect_nets();
+	}
+
+	/// \brief Adds a chain of buffers from the input to the output net, with nets named after the prefix.
+	void add_buffer_chain(Module_description& module, const std::string& prefix, const std::string& in, const std::string& out, int length)
+	{
+		std::string net = in;
+		for (int i = 0; i < length; ++i)
+		{
+			std::ostringstream name;
+			name << prefix << i;
+			std::string next = (length - 1 == i) ? out : name.str() + "_n";
+			add_gate(module, "buf", name.str(), net, next);
+			net = next;
+		}
+	}
+
+	/// \brief Adds a module with two inputs, two outputs and a buffer chain from each input to the given output.
+	void add_chain_module(Netlist& netlist, const std::string& name, const std::string& a_output, const std::string& b_output)
+	{
+		netlist.create_new_module(name);
+		Module_description& module = *netlist.get_module(name);
+		add_port(module, "a", IN);
+		add_port(module, "b", IN);
+		add_port(module, "y", OUT);
+		add_port(module, "z", OUT);
+		add_buffer_chain(module, "p", "a", a_output, 12);
+		add_buffer_chain(module, "q", "b", b_output, 12);
+		module.connect_nets();
+	}
+
+	/** \brief Adds a module without ports holding rings of buffers.
+	 *	\param[in] ring_sizes - Sizes of the rings.
+	 *	\param[in] is_reversed - True to add the instances in the reverse order.
+	 */
+	void add_ring_module(Netlist& netlist, const std::string& name, const std::vector<int>& ring_sizes, bool is_reversed)
+	{
+		netlist.create_new_module(name);
+		Module_description& module = *netlist.get_module(name);
+		std::vector<std::vector<std::string> > gates;
+		for (size_t ring = 0; ring < ring_sizes.size(); ++ring)
+		{
+			for (int i = 0; i < ring_sizes[ring]; ++i)
+			{
+				std::ostringstream gate;
+				std::ostringstream in;
+				std::ostringstream out;
+				gate << "g" << ring << "_" << i;
+				in << "n" << ring << "_" << i;
+				out << "n" << ring << "_" << (i + 1) % ring_sizes[ring];
+				std::vector<std::string> names;
+				names.push_back(gate.str());
+				names.push_back(in.str());
+				names.push_back(out.str());
+				gates.push_back(names);
+			}
+		}
+		if (is_reversed)
+		{
+			std::reverse(gates.begin(), gates.end());
+		}
+		for (size_t i = 0; i < gates.size(); ++i)
+		{
+			add_gate(module, "buf", gates[i][0], gates[i][1], gates[i][2]);
+		}
+		module.connect_nets();
+	}
+
+	/// \brief Checks that different tie-offs, permuted chains and symmetric rings are neither equal nor merged.
+	bool test_module_hash_collisions()
+	{
+		Netlist tied("tied");
+		const char* tie_offs[] = { "1'b0", "1'b1", "1'b0" };
+		for (int i = 0; i < 3; ++i)
+		{
+			std::string name = std::string("tie") + char('0' + i);
+			tied.create_new_module(name);
+			Module_description& module = *tied.get_module(name);
+			add_port(module, "a", IN);
+			add_port(module, "y", OUT);
+			add_gate(module, "and", "u0", "a", tie_offs[i], "y");
+			module.connect_nets();
+		}
+		Module_hasher tied_hashes(tied);
+		bool passed = check(tied_hashes.get_hash("tie0") != tied_hashes.get_hash("tie1"), "tie-off values change the hash");
+		passed &= check(tied_hashes.get_hash("tie0") == tied_hashes.get_hash("tie2"), "equal tie-offs hash equal");
+		passed &= check(1 == Module_hasher::merge_identical_modules(tied) && 1 == tied.get_modules().count("tie1"), "only the equal tie-offs merged");
+
+		Netlist chains("chains");
+		add_chain_module(chains, "straight", "y", "z");
+		add_chain_module(chains, "swapped", "z", "y");
+		add_chain_module(chains, "copy", "y", "z");
+		Module_hasher chain_hashes(chains);
+		passed &= check(chain_hashes.get_hash("straight") != chain_hashes.get_hash("swapped"), "long chains with swapped ends hash differently");
+		passed &= check(!Module_hasher::is_same_structure(chain_hashes, "straight", chain_hashes, "swapped"), "long chains with swapped ends differ");
+		passed &= check(Module_hasher::is_same_structure(chain_hashes, "straight", chain_hashes, "copy"), "equal chains match");
+		passed &= check(1 == Module_hasher::merge_identical_modules(chains) && 1 == chains.get_modules().count("swapped"), "only the equal chains merged");
+
+		// Refinement cannot tell a ring of six from two rings of three, the exact match does.
+		Netlist rings("rings");
+		add_ring_module(rings, "hexagon", std::vector<int>(1, 6), false);
+		add_ring_module(rings, "triangles", std::vector<int>(2, 3), false);
+		add_ring_module(rings, "reversed", std::vector<int>(1, 6), true);
+		Module_hasher ring_hashes(rings);
+		passed &= check(ring_hashes.get_hash("hexagon") == ring_hashes.get_hash("triangles"), "symmetric rings collide in the hash");
+		passed &= check(!Module_hasher::is_same_structure(ring_hashes, "hexagon", ring_hashes, "triangles"), "colliding rings differ");
+		passed &= check(1 == ring_hashes.find_identical_modules().size() && 2 == ring_hashes.find_identical_modules()[0].size(), "only the equal rings are identical");
+
+		Netlist other_rings("other_rings");
+		add_ring_module(other_rings, "hexagon", std::vector<int>(2, 3), true);
+		add_ring_module(other_rings, "reversed", std::vector<int>(1, 6), false);
+		std::vector<std::string> changed = Module_hasher::find_changed_modules(ring_hashes, Module_hasher(other_rings));
+		passed &= check(2 == changed.size() && "hexagon" == changed[0] && "triangles" == changed[1], "colliding module reported as changed");
+		passed &= check(1 == Module_hasher::merge_identical_modules(rings) && 2 == rings.get_modules().size(), "only the equal rings merged");
+		return passed;
+	}
+
+	/// \brief Checks that structural hashes ignore names, detect identical modules and find changed modules.
+	bool test_module_hashing()
+	{
+		Netlist first("first");
+		build_hashing_netlist(first, 1);
+		Netlist second("second");
+		build_hashing_netlist(second, 2);
+
+		Module_hasher first_hashes(first, 2);
+		Module_hasher second_hashes(second, 2);
+		bool passed = check(first_hashes.get_hash("ha0") == first_hashes.get_hash("ha1"), "renamed and reordered module has the same hash");
+		passed &= check(second_hashes.get_hash("ha0") != second_hashes.get_hash("ha2"), "changed connection changes the hash");
+
+		std::vector<std::string> changed = Module_hasher::find_changed_modules(first_hashes, second_hashes);
+		passed &= check(2 == changed.size() && "ha2" == changed[0] && "top" == changed[1], "changed module and its parent are found");
+
+		std::vector<std::vector<std::string> > identical = first_hashes.find_identical_modules();
+		passed &= check(1 == identical.size() && 3 == identical[0].size(), "three identical half adders in the first netlist");
+
+		Module_hasher::Hash top_hash = first_hashes.get_hash("top");
+		passed &= check(2 == Module_hasher::merge_identical_modules(first), "two duplicate modules merged");
+		passed &= check(2 == first.get_modules().size(), "one half adder remains");
+		passed &= check("ha0" == first.get_module("top")->get_module_instance_by_name("h2")->get_description_name(), "instances rebound to the kept module");
+		passed &= check(top_hash == Module_hasher(first).get_hash("top"), "merging keeps the top hash");
+
+		// Pins on an assigned alias of a port are the port net, also before the nets are connected.
+		Netlist aliased("aliased");
+		const char* inputs[] = { "a", "w", "b" };
+		for (int i = 0; i < 3; ++i)
+		{
+			std::string name = std::string("and") + char('0' + i);
+			aliased.create_new_module(name);
+			Module_description& module = *aliased.get_module(name);
+			add_port(module, "a", IN);
+			add_port(module, "b", IN);
+			add_port(module, "y", OUT);
+			module.add_assign("w", "a");
+			add_gate(module, "and", "u0", inputs[i], "b", "y");
+		}
+		Module_hasher aliased_hashes(aliased);
+		passed &= check(aliased_hashes.get_hash("and0") == aliased_hashes.get_hash("and1"), "pin on an alias hashes as the port net");
+		passed &= check(aliased_hashes.get_hash("and0") != aliased_hashes.get_hash("and2"), "pin on another port changes the hash");
+		passed &= check(1 == Module_hasher::merge_identical_modules(aliased), "module with an aliased pin merged");
+		return passed & test_module_hash_collisions();
+	}
+
+	/// Counts the tasks run by a Work Stealing Pool, every task of the first level submits children from its worker.
+	struct Task_counter
+	{
+		boost::atomic<size_t> count;
+		Work_stealing_pool* pool;
+
+		void run(unsigned depth, unsigned worker)
+		{
+			++count;
+			for (unsigned i = 0; 0 != depth && i < 4; ++i)
+			{
+				pool->submit(boost::bind(&Task_counter::run, this, depth - 1, _1));
+			}
+		}
+
+		void fail(unsigned worker)
+		{
+			throw std::string("Task failed.");
+		}
+	};
+
+	/// \brief Runs many small and nested tasks through one pool over several waits, checks that all run and errors are rethrown.
+	bool test_work_stealing_pool()
+	{
+		Work_stealing_pool pool(4);
+		Task_counter counter;
+		counter.count = 0;
+		counter.pool = &pool;
+		bool passed = true;
+		for (unsigned round = 0; round < 20; ++round)
+		{
+			for (unsigned i = 0; i < 500; ++i)
+			{
+				pool.submit(boost::bind(&Task_counter::run, &counter, i % 2, _1));
+			}
+			pool.wait();
+			passed &= check((round + 1) * 1500 == counter.count, "all submitted and nested tasks run before wait returns");
+		}
+
+		pool.submit(boost::bind(&Task_counter::fail, &counter, _1));
+		bool is_rethrown = false;
+		try
+		{
+			pool.wait();
+		}
+		catch (const std::string&)
+		{
+			is_rethrown = true;
+		}
+		pool.submit(boost::bind(&Task_counter::run, &counter, 0u, _1));
+		pool.wait();
+		passed &= check(is_rethrown && 30001 == counter.count, "task error rethrown once, pool still usable");
+		return passed;
+	}
+
+	/// Records the order in which the scheduled modules finish.
+	struct Finish_recorder
+	{
+		boost::atomic<size_t> next;
+		std::vector<size_t> stamps;
+		std::vector<unsigned> run_counts;
+
+		void record(size_t module, unsigned worker)
+		{
+			++run_counts[module];
+			stamps[module] = next.fetch_add(1);
+		}
+	};
+
+	/// \brief Checks that every module runs once, after its submodules bottom-up and after its parents top-down.
+	bool check_schedule(const Module_scheduler& scheduler, Module_scheduler::Direction direction)
+	{
+		Finish_recorder recorder;
+		recorder.next = 0;
+		recorder.stamps.assign(scheduler.get_module_count(), 0);
+		recorder.run_counts.assign(scheduler.get_module_count(), 0);
+		scheduler.run(boost::bind(&Finish_recorder::record, &recorder, _1, _2), direction, 2);
+
+		bool passed = check(std::count(recorder.run_counts.begin(), recorder.run_counts.end(), 1u) == long(scheduler.get_module_count()), "every module runs once");
+		for (size_t module = 0; module < scheduler.get_module_count(); ++module)
+		{
+			for (size_t i = scheduler.get_child_offsets()[module]; i < scheduler.get_child_offsets()[module + 1]; ++i)
+			{
+				size_t child = scheduler.get_children()[i];
+				bool is_ordered = (Module_scheduler::BOTTOM_UP == direction) ? recorder.stamps[child] < recorder.stamps[module] : recorder.stamps[module] < recorder.stamps[child];
+				passed &= check(is_ordered, "module runs after its dependencies");
+			}
+		}
+		return passed;
+	}
+
+	/// \brief Runs tasks bottom-up and top-down over a three level hierarchy and rejects recursive instantiation.
+	bool test_module_scheduling()
+	{
+		Netlist netlist("hierarchy");
+		build_hashing_netlist(netlist, 0);
+		netlist.create_new_module("chip");
+		Module_description& chip = *netlist.get_module("chip");
+		for (int i = 0; i < 2; ++i)
+		{
+			std::vector< std::pair< std::string, std::string> > pins;
+			pins.push_back(std::make_pair(std::string("a"), std::string("a")));
+			chip.add_module_instance("top", std::string("t") + char('0' + i), pins);
+			chip.get_module_instance_by_name(std::string("t") + char('0' + i))->set_module_description(*netlist.get_module("top"));
+		}
+
+		Module_scheduler scheduler(netlist);
+		size_t chip_index = scheduler.get_index(chip);
+		size_t top_index = scheduler.get_index(*netlist.get_module("top"));
+		bool passed = check(5 == scheduler.get_module_count(), "all modules scheduled");
+		passed &= check(2 == scheduler.get_depths()[chip_index] && 0 == scheduler.get_depths()[scheduler.get_index(*netlist.get_module("ha0"))], "module depths");
+		passed &= check(1 == scheduler.get_child_offsets()[chip_index + 1] - scheduler.get_child_offsets()[chip_index], "repeated instances give one edge");
+		passed &= check(1 == scheduler.get_parent_offsets()[top_index + 1] - scheduler.get_parent_offsets()[top_index], "top has one parent");
+		passed &= check_schedule(scheduler, Module_scheduler::BOTTOM_UP);
+		passed &= check_schedule(scheduler, Module_scheduler::TOP_DOWN);
+
+		netlist.create_new_module("loop");
+		Module_description& loop = *netlist.get_module("loop");
+		loop.add_module_instance("loop", "self", std::vector< std::pair< std::string, std::string> >());
+		loop.get_module_instance_by_name("self")->set_module_description(loop);
+		bool is_rejected = false;
+		try
+		{
+			Module_scheduler recursive(netlist);
+		}
+		catch (const std::string& error)
+		{
+			is_rejected = ("Module instantiates itself: loop" == error);
+		}
+		passed &= check(is_rejected, "recursive instantiation rejected");
+		return passed;
+	}
+
+	/// \brief Returns the summary path between the ports, NULL if there is none.
+	const Port_path* find_port_path(const Module_summary& summary, const std::string& input, const std::string& output)
+	{
+		for (std::vector<Port_path>::const_iterator I = summary.paths.begin(); I != summary.paths.end(); ++I)
+		{
+			if (input == I->input && output == I->output)
+			{
+				return &*I;
+			}
+		}
+		return 0;
+	}
+
+	/// \brief Compares the hierarchical summary of the ALU with gate paths of its flattened netlist and checks cache invalidation.
+	bool test_module_summaries(const Netlist& netlist)
+	{
+		Module_summary_cache cache(2);
+		cache.update(netlist);
+		bool passed = check(netlist.get_modules().size() == cache.get_computed_count(), "every module summarized once");
+		const Module_description& alu = *netlist.get_modules().find("ALU_PLUS_MINUS")->second;
+		const Module_summary& summary = cache.get_summary(alu);
+		passed &= check(netlist.get_modules().size() == cache.get_computed_count(), "fresh summaries are not recomputed");
+		passed &= check(!summary.has_loops && !summary.paths.empty(), "ALU summary has paths and no loops");
+
+		// Reference depths from every top input over the levelized flat gates.
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		std::vector<std::string> input_names;
+		std::vector<std::string> output_names;
+		const std::map<std::string, boost::shared_ptr<Module_port> >& ports = alu.get_ports();
+		for (std::map<std::string, boost::shared_ptr<Module_port> >::const_iterator I = ports.begin(); I != ports.end(); ++I)
+		{
+			(OUT == I->second->get_type() ? output_names : input_names).push_back(I->first);
+		}
+		const unsigned unreached = ~0u;
+		size_t reference_count = 0;
+		for (size_t input = 0; input < input_names.size(); ++input)
+		{
+			std::vector<unsigned> min_depths(flat.get_net_count(), unreached);
+			std::vector<unsigned> max_depths(flat.get_net_count(), 0);
+			min_depths[flat.get_input_nets()[input]] = 0;
+			const std::vector<Flat_id>& gates = levelizer.get_levelized_gates();
+			for (std::vector<Flat_id>::const_iterator G = gates.begin(); G != gates.end(); ++G)
+			{
+				Flat_id output = flat.get_gate_outputs()[*G];
+				for (Flat_id i = flat.get_gate_input_offsets()[*G]; i < flat.get_gate_input_offsets()[*G + 1] && Flat_netlist::invalid_id != output; ++i)
+				{
+					Flat_id net = flat.get_gate_inputs()[i];
+					if (unreached != min_depths[net])
+					{
+						min_depths[output] = std::min(min_depths[output], min_depths[net] + 1);
+						max_depths[output] = std::max(max_depths[output], max_depths[net] + 1);
+					}
+				}
+			}
+			for (size_t output = 0; output < output_names.size(); ++output)
+			{
+				Flat_id net = flat.get_output_nets()[output];
+				if (unreached == min_depths[net])
+				{
+					continue;
+				}
+				++reference_count;
+				const Port_path* path = find_port_path(summary, input_names[input], output_names[output]);
+				passed &= check(0 != path && min_depths[net] == path->min_depth && max_depths[net] == path->max_depth, "summary path matches the flat depths");
+			}
+		}
+		passed &= check(reference_count == summary.paths.size(), "summary has exactly the flat port paths");
+
+		// Editing one master recomputes it and the modules above it only.
+		Netlist hierarchy("hierarchy");
+		build_hashing_netlist(hierarchy, 0);
+		Module_summary_cache hierarchy_cache;
+		hierarchy_cache.get_summary(*hierarchy.get_module("top"));
+		passed &= check(4 == hierarchy_cache.get_computed_count(), "top and three half adders summarized");
+		const Port_path* path = find_port_path(hierarchy_cache.get_summary(*hierarchy.get_module("ha2")), "a", "s");
+		passed &= check(0 != path && 2 == path->min_depth && 2 == path->max_depth, "half adder path through the xor and the buffer");
+		Module_description& edited = *hierarchy.get_module("ha2");
+		add_gate(edited, "not", "n", "a", "s");
+		edited.connect_nets();
+		hierarchy_cache.get_summary(*hierarchy.get_module("top"));
+		passed &= check(6 == hierarchy_cache.get_computed_count(), "edited master and its parent recomputed");
+		path = find_port_path(hierarchy_cache.get_summary(edited), "a", "s");
+		passed &= check(0 != path && 1 == path->min_depth && 2 == path->max_depth, "new shorter path found");
+		hierarchy_cache.get_summary(*hierarchy.get_module("ha0"));
+		passed &= check(6 == hierarchy_cache.get_computed_count(), "unchanged master not recomputed");
+		return passed;
+	}
+
+	/// Custom lint rule reporting instances of XOR gates.
+	class Xor_rule : public Lint_rule
+	{
+	public:
+
+		std::string get_name() const
+		{
+			return "no-xor";
+		}
+
+		void check(const Module_description& module, std::vector<Lint_violation>& violations) const
+		{
+			const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+			for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+			{
+				if (PRIMITIVE_XOR == I->second->get_primitive_type())
+				{
+					Lint_violation violation = { get_name(), module.get_name(), I->first, "xor gate" };
+					violations.push_back(violation);
+				}
+			}
+		}
+	};
+
+	/// \brief Returns true if the violation is in the list.
+	bool has_violation(const std::vector<Lint_violation>& violations, const std::string& rule, const std::string& module, const std::string& object)
+	{
+		for (std::vector<Lint_violation>::const_iterator I = violations.begin(); I != violations.end(); ++I)
+		{
+			if (rule == I->rule && module == I->module && object == I->object)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// \brief Runs the built-in and a custom lint rule on a module with one problem of each kind.
+	bool test_lint()
+	{
+		Netlist netlist("lint");
+		add_half_adder(netlist, "ha", 0);
+		netlist.create_new_module("bad");
+		Module_description& bad = *netlist.get_module("bad");
+		add_port(bad, "x", IN);
+		add_port(bad, "spare", IN);
+		add_port(bad, "y", OUT);
+		bad.add_net(boost::shared_ptr<Net>(new Net("w")));
+		add_gate(bad, "and", "g0", "x", "n", "y");
+		add_gate(bad, "buf", "g1", "x", "y");
+		std::vector< std::pair< std::string, std::string> > pins;
+		pins.push_back(std::make_pair(std::string("x"), std::string("a")));
+		pins.push_back(std::make_pair(std::string("x"), std::string("q")));
+		bad.add_module_instance("ha", "h", pins);
+		bad.get_module_instance_by_name("h")->set_module_description(*netlist.get_module("ha"));
+		bad.add_module_instance("ghost", "u", std::vector< std::pair< std::string, std::string> >());
+		bad.connect_nets();
+
+		Lint_engine engine(2);
+		std::vector<Lint_violation> violations = engine.run(netlist);
+		bool passed = check(has_violation(violations, "multiple-drivers", "bad", "y"), "multiple drivers found");
+		passed &= check(has_violation(violations, "undriven-net", "bad", "n"), "undriven net found");
+		passed &= check(has_violation(violations, "floating-net", "bad", "w") && has_violation(violations, "floating-net", "bad", "spare"), "floating nets found");
+		passed &= check(has_violation(violations, "unconnected-input", "bad", "h/b"), "missing input pin found");
+		passed &= check(has_violation(violations, "pin-count-mismatch", "bad", "h") && has_violation(violations, "pin-count-mismatch", "bad", "h/q"), "pin mismatch found");
+		passed &= check(has_violation(violations, "undefined-module", "bad", "u"), "undefined module found");
+		passed &= check(has_violation(violations, "implicit-net", "bad", "n") && !has_violation(violations, "implicit-net", "bad", "w"), "implicit net found");
+		passed &= check(!has_violation(violations, "floating-net", "ha", "n0") && !has_violation(violations, "undriven-net", "ha", "n0"), "clean nets not reported");
+		passed &= check("bad" == violations.front().module && "ha" == violations.back().module, "violations ordered by module");
+
+		std::vector<Lint_violation> sequential = Lint_engine(1).run(netlist);
+		bool is_same = (sequential.size() == violations.size());
+		for (size_t i = 0; i < sequential.size() && is_same; ++i)
+		{
+			is_same = (sequential[i].rule == violations[i].rule && sequential[i].object == violations[i].object);
+		}
+		passed &= check(is_same, "same violations with one thread");
+
+		engine.add_rule(boost::shared_ptr<Lint_rule>(new Xor_rule()));
+		passed &= check(has_violation(engine.run(netlist), "no-xor", "ha", "x"), "custom rule runs");
+		bool is_rejected = false;
+		try
+		{
+			engine.add_rule(boost::shared_ptr<Lint_rule>(new Xor_rule()));
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "duplicate rule rejected");
+		passed &= check(engine.remove_rule("floating-net") && 7 == engine.get_rule_names().size(), "rule removed");
+		std::ostringstream stream;
+		Lint_engine::write(violations, stream);
+		passed &= check(0 == stream.str().find("multiple-drivers\tbad\ty\tnet has 2 drivers: g0/Z g1/Z\n"), "violations written");
+		return passed;
+	}
+
+	/// \brief Parses assignments and a feed-through module and checks that the analyses see aliased nets as one net.
+	bool test_aliased_net_analysis()
+	{
+		std::istringstream* text = new std::istringstream(
+			"module FT(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"assign y = a;\n"
+			"endmodule\n"
+			"module top(x, z, w);\n"
+			"input x;\n"
+			"output z;\n"
+			"output w;\n"
+			"wire m;\n"
+			"wire k;\n"
+			"not g0 (.I(x), .Z(m));\n"
+			"assign k = m;\n"
+			"FT f0 (.a(k), .y(z));\n"
+			"buf g1 (.I(k), .Z(w));\n"
+			"endmodule\n");
+		Netlist_builder builder(*text, "aliases");
+		builder.construct_netlist();
+		boost::shared_ptr<Netlist> netlist = builder.get_netlist();
+
+		Module_description& top = *netlist->get_module("top");
+		Flat_netlist flat(*netlist, "top");
+		bool passed = check(3 == flat.get_net_count(), "flat nets joined through the feed-through");
+		Flat_id driven = flat.get_gate_outputs()[0];
+		passed &= check(2 == flat.get_output_nets().size() && driven == flat.get_output_nets()[1], "feed-through output is the inverter net");
+
+		Module_summary_cache cache;
+		const Port_path* path = find_port_path(cache.get_summary(top), "x", "z");
+		passed &= check(0 != path && 1 == path->min_depth && 1 == path->max_depth, "summary path through the feed-through");
+		passed &= check(!has_violation(Lint_engine(1).run(*netlist), "undriven-net", "FT", "y"), "aliased output port is driven");
+		return passed;
+	}
+
+	/// \brief Parses literal constants, propagates them through the hierarchy and sweeps the constant gates.
+	bool test_constant_propagation()
+	{
+		std::istringstream* text = new std::istringstream(
+			"module CT(a, y, t);\n"
+			"input a;\n"
+			"output y;\n"
+			"output t;\n"
+			"and g0 (.A(a), .B(1'b0), .Z(y));\n"
+			"not g1 (.I(1'B1), .Z(t));\n"
+			"endmodule\n"
+			"module top(x, p, q, r, s);\n"
+			"input x;\n"
+			"output p;\n"
+			"output q;\n"
+			"output r;\n"
+			"output s;\n"
+			"wire c;\n"
+			"wire d;\n"
+			"CT u0 (.a(x), .y(c), .t(d));\n"
+			"or g2 (.A(c), .B(x), .Z(p));\n"
+			"nor g3 (.A(d), .B(c), .Z(q));\n"
+			"xor g4 (.A(x), .B(x), .Z(r));\n"
+			"buf g5 (.I(1), .Z(s));\n"
+			"endmodule\n");
+		Netlist_builder builder(*text, "constants");
+		builder.construct_netlist();
+		boost::shared_ptr<Netlist> netlist = builder.get_netlist();
+
+		Module_description& child = *netlist->get_module("CT");
+		bool passed = check(child.get_nets().end() != child.get_nets().find("1'b1") && CONSTANT_ONE == child.get_nets().find("1'b1")->second->get_constant(), "literal spellings share one constant net");
+		passed &= check(!child.get_nets().find("1'b0")->second->is_implicit(), "constant nets are not implicit");
+		std::vector<Lint_violation> violations = Lint_engine(1).run(*netlist);
+		passed &= check(!has_violation(violations, "undriven-net", "CT", "1'b0") && !has_violation(violations, "implicit-net", "top", "1'b1"), "constant nets are driven by their tie");
+
+		Flat_netlist flat(*netlist, "top");
+		passed &= check(1 == flat.get_input_nets().size(), "constant nets are not inputs");
+		Levelizer levelizer(flat, 2);
+		levelizer.levelize();
+		Constant_propagator propagator(levelizer, 2);
+		propagator.propagate();
+		const std::vector<LogicConstant>& values = propagator.get_net_values();
+		passed &= check(CONSTANT_NONE == values[flat.find_net("p")] && CONSTANT_NONE == values[flat.find_net("r")], "non-constant nets stay unknown");
+		passed &= check(CONSTANT_ZERO == values[flat.find_net("c")] && CONSTANT_ONE == values[flat.find_net("q")] && CONSTANT_ONE == values[flat.find_net("s")], "constants propagated through the hierarchy");
+		passed &= check(4 == propagator.get_constant_gates().size(), "constant gates reported");
+		Aig aig(levelizer);
+		passed &= check(Aig::true_literal == aig.get_net_literals()[flat.find_net("s")] && Aig::true_literal == aig.get_net_literals()[flat.find_net("q")],
+			"constant nets converted to constant literals");
+
+		passed &= check(4 == propagator.sweep(*netlist), "constant gates swept");
+		passed &= check(child.get_module_instances().empty() && "1'b0" == child.get_canonical_net_name("y"), "swept outputs tied to the constant");
+		Flat_netlist swept(*netlist, "top");
+		passed &= check(2 == swept.get_gate_count() && CONSTANT_ZERO == swept.get_net_constants()[swept.find_net("c")], "constant ports tie the parent nets");
+
+		// A tie-high input of an AND passes the other input through.
+		Netlist_builder tied(*new std::istringstream(
+			"module T(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"and g0 (.A(a), .B(1'b1), .Z(y));\n"
+			"endmodule\n"), "tied");
+		tied.construct_netlist();
+		Flat_netlist tied_flat(*tied.get_netlist(), "T");
+		Levelizer tied_levelizer(tied_flat);
+		tied_levelizer.levelize();
+		Aig tied_aig(tied_levelizer);
+		passed &= check(tied_aig.get_net_literals()[tied_flat.find_net("a")] == tied_aig.get_net_literals()[tied_flat.find_net("y")]
+			&& 0 == tied_aig.get_and_count(), "tie-high AND input converted to true");
+
+		// Modules left differing only in the tie-off value by the sweep keep different hashes and are not merged.
+		Netlist_builder ties(*new std::istringstream(
+			"module LOW(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"and g0 (.A(a), .B(1'b0), .Z(y));\n"
+			"endmodule\n"
+			"module HIGH(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"or g0 (.A(a), .B(1'b1), .Z(y));\n"
+			"endmodule\n"
+			"module top(x, p, q);\n"
+			"input x;\n"
+			"output p;\n"
+			"output q;\n"
+			"LOW u0 (.a(x), .y(p));\n"
+			"HIGH u1 (.a(x), .y(q));\n"
+			"endmodule\n"), "ties");
+		ties.construct_netlist();
+		Netlist& tie_netlist = *ties.get_netlist();
+		Flat_netlist tie_flat(tie_netlist, "top");
+		Levelizer tie_levelizer(tie_flat);
+		tie_levelizer.levelize();
+		Constant_propagator tie_propagator(tie_levelizer);
+		tie_propagator.propagate();
+		passed &= check(2 == tie_propagator.sweep(tie_netlist), "tie-off gates swept");
+		Module_hasher tie_hashes(tie_netlist);
+		passed &= check(tie_hashes.get_hash("LOW") != tie_hashes.get_hash("HIGH"), "swept tie-off values hash differently");
+		passed &= check(0 == Module_hasher::merge_identical_modules(tie_netlist) && 3 == tie_netlist.get_modules().size(), "swept tie-off modules not merged");
+		return passed;
+	}
+
+	/// \brief Extracts cones of a small hierarchy: shared full modules, copied partial ones and punched boundary ports.
+	bool test_cone_extraction()
+	{
+		std::istringstream* text = new std::istringstream(
+			"module HA(a, b, s, c);\n"
+			"input a;\n"
+			"input b;\n"
+			"output s;\n"
+			"output c;\n"
+			"xor x0 (.A(a), .B(b), .Z(s));\n"
+			"and a0 (.A(a), .B(b), .Z(c));\n"
+			"endmodule\n"
+			"module INV(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"wire m;\n"
+			"not n0 (.I(a), .Z(m));\n"
+			"buf b0 (.I(m), .Z(y));\n"
+			"endmodule\n"
+			"module top(p, q, r, o1, o2);\n"
+			"input p;\n"
+			"input q;\n"
+			"input r;\n"
+			"output o1;\n"
+			"output o2;\n"
+			"wire s1;\n"
+			"wire c1;\n"
+			"wire t;\n"
+			"HA h0 (.a(p), .b(q), .s(s1), .c(c1));\n"
+			"INV i0 (.a(c1), .y(t));\n"
+			"and g0 (.A(s1), .B(r), .Z(o1));\n"
+			"or g1 (.A(t), .B(r), .Z(o2));\n"
+			"endmodule\n");
+		Netlist_builder builder(*text, "source");
+		builder.construct_netlist();
+		boost::shared_ptr<Netlist> netlist = builder.get_netlist();
+		Flat_netlist flat(*netlist, "top");
+		Cone_extractor extractor(flat, *netlist, 2);
+
+		// The complete cone of o2 shares the inverter and copies the half adder without its xor.
+		boost::shared_ptr<Netlist> cone = extractor.extract(extractor.find_nets(std::vector<std::string>(1, "o2")), "cone");
+		bool passed = check(4 == extractor.get_cone_gates().size() && 2 == extractor.get_copied_module_count() && 1 == extractor.get_shared_module_count(), "cone of o2 collected");
+		passed &= check(3 == cone->get_modules().size() && netlist->get_module("INV") == cone->get_modules().find("INV")->second, "full module shared, not copied");
+		boost::shared_ptr<Module_description> half_adder = cone->get_modules().find("HA_cone0")->second;
+		passed &= check(1 == half_adder->get_module_instances().size() && 3 == half_adder->get_ports().size() && !half_adder->get_ports().count("s"), "partial module copied with the cone only");
+		const Module_description& cone_top = *cone->get_modules().find("top")->second;
+		passed &= check(4 == cone_top.get_ports().size() && !cone_top.get_ports().count("o1"), "top keeps the used ports");
+		Flat_netlist cone_flat(*cone, "top");
+		passed &= check(4 == cone_flat.get_gate_count() && 1 == cone_flat.get_output_nets().size() && 3 == cone_flat.get_input_nets().size(), "extracted netlist flattens to the cone");
+		passed &= check(Flat_netlist::invalid_id != cone_flat.get_net_drivers()[cone_flat.get_output_nets()[0]], "extracted output is driven");
+
+		// A depth limit cuts the cone, the cut net becomes a top input.
+		cone = extractor.extract(extractor.find_nets(std::vector<std::string>(1, "o2")), "shallow", 1);
+		const Module_description& shallow_top = *cone->get_modules().find("top")->second;
+		passed &= check(1 == extractor.get_cone_gates().size() && 1 == cone->get_modules().size(), "depth limited cone");
+		passed &= check(shallow_top.get_ports().count("t") && IN == shallow_top.get_ports().find("t")->second->get_type(), "cut net punched as top input");
+
+		// An internal net of a child is punched up to a new top output.
+		cone = extractor.extract(extractor.find_nets(std::vector<std::string>(1, "i0/m")), "deep");
+		const Module_description& deep_top = *cone->get_modules().find("top")->second;
+		passed &= check(deep_top.get_ports().count("i0_m") && OUT == deep_top.get_ports().find("i0_m")->second->get_type(), "internal net punched as top output");
+		Flat_netlist deep_flat(*cone, "top");
+		passed &= check(2 == deep_flat.get_gate_count() && 1 == deep_flat.get_output_nets().size() && PRIMITIVE_NOT == deep_flat.get_gate_types()[deep_flat.get_net_drivers()[deep_flat.get_output_nets()[0]]], "punched output driven by the inverter");
+
+		// The marks of the previous cones are cleared, the complete cone comes out as the first time.
+		cone = extractor.extract(extractor.find_nets(std::vector<std::string>(1, "o2")), "again");
+		passed &= check(4 == extractor.get_cone_gates().size() && 2 == extractor.get_copied_module_count() && 4 == cone->get_modules().find("top")->second->get_ports().size(),
+			"cone extracted again after other cones");
+
+		bool is_rejected = false;
+		try
+		{
+			extractor.find_nets(std::vector<std::string>(1, "h0/missing"));
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "unknown net rejected");
+		return passed;
+	}
+
+	/// \brief Uniquifies instance paths of a shared hierarchy, checking the reference counts, clone names and copy counts.
+	bool test_uniquification()
+	{
+		std::istringstream* text = new std::istringstream(
+			"module LEAF(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"not n0 (.I(a), .Z(y));\n"
+			"endmodule\n"
+			"module LEAF_1(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"buf b0 (.I(a), .Z(y));\n"
+			"endmodule\n"
+			"module MID(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"wire m;\n"
+			"LEAF l0 (.a(a), .y(m));\n"
+			"LEAF l1 (.a(m), .y(y));\n"
+			"endmodule\n"
+			"module top(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"wire m;\n"
+			"MID m0 (.a(a), .y(m));\n"
+			"MID m1 (.a(m), .y(y));\n"
+			"endmodule\n");
+		Netlist_builder builder(*text, "shared");
+		builder.construct_netlist();
+		boost::shared_ptr<Netlist> netlist = builder.get_netlist();
+		const Module_description& leaf = *netlist->get_module("LEAF");
+		const Module_description& mid = *netlist->get_module("MID");
+		Uniquifier uniquifier(*netlist, "top");
+		bool passed = check(2 == uniquifier.get_reference_count(leaf) && 2 == uniquifier.get_reference_count(mid), "masters counted");
+
+		// Only the path is copied, the clone names skip the existing LEAF_1.
+		Module_description& edited = uniquifier.uniquify("m0/l1");
+		passed &= check(2 == uniquifier.get_clone_count() && "LEAF_2" == edited.get_name() && netlist->get_modules().count("MID_1"), "path cloned");
+		passed &= check(1 == uniquifier.get_reference_count(mid) && 3 == uniquifier.get_reference_count(leaf) && 1 == uniquifier.get_reference_count(edited), "references moved to the clones");
+		passed &= check(&edited == &uniquifier.uniquify("m0/l1") && 2 == uniquifier.get_clone_count(), "private path not cloned again");
+		passed &= check(&mid == &uniquifier.uniquify("m1") && 2 == uniquifier.get_clone_count(), "last reference not cloned");
+		passed &= check(&edited == &uniquifier.uniquify("m0/l1/n0"), "primitive edited in its module");
+
+		// The edit is seen by one place only.
+		edited.remove_module_instance("n0");
+		edited.add_assign("y", "a");
+		edited.connect_nets();
+		Flat_netlist flat(*netlist, "top");
+		passed &= check(3 == flat.get_gate_count(), "edit seen by one place");
+
+		bool is_rejected = false;
+		try
+		{
+			uniquifier.uniquify("m0/missing");
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "unknown instance rejected");
+
+		// A deep hierarchy of two instances per level costs one copy per level.
+		const int depth = 16;
+		std::ostringstream deep;
+		deep << "module L0(a, y);\ninput a;\noutput y;\nnot n0 (.I(a), .Z(y));\nendmodule\n";
+		std::string path = "c0";
+		for (int level = 1; level <= depth; ++level)
+		{
+			deep << "module L" << level << "(a, y);\ninput a;\noutput y;\nwire m;\n"
+				<< "L" << level - 1 << " c0 (.a(a), .y(m));\n"
+				<< "L" << level - 1 << " c1 (.a(m), .y(y));\nendmodule\n";
+			path += "/c0";
+		}
+		deep << "module deep_top(a, y);\ninput a;\noutput y;\nL" << depth << " c0 (.a(a), .y(y));\nendmodule\n";
+		Netlist_builder deep_builder(*new std::istringstream(deep.str()), "deep");
+		deep_builder.construct_netlist();
+		boost::shared_ptr<Netlist> deep_netlist = deep_builder.get_netlist();
+		Uniquifier deep_uniquifier(*deep_netlist, "deep_top");
+		Module_description& deep_leaf = deep_uniquifier.uniquify(path);
+		passed &= check("L0_1" == deep_leaf.get_name() && depth == int(deep_uniquifier.get_clone_count()) && 2 * depth + 2 == int(deep_netlist->get_modules().size()), "one copy per level");
+		return passed;
+	}
+
+	/// \brief Matches glob patterns and regular expressions, with their literal prefixes.
+	bool test_name_patterns()
+	{
+		Name_pattern glob("g1?*");
+		bool passed = check(glob.match("g15") && glob.match("g1_mux") && !glob.match("g1") && !glob.match("xg15"), "glob matched");
+		passed &= check("g1" == glob.get_prefix() && !glob.is_literal(), "glob prefix");
+		passed &= check(Name_pattern("*a*b").match("xxaxxbxb") && !Name_pattern("*a*b").match("xxaxxbx"), "stars backtracked");
+		passed &= check(Name_pattern("[a-c]x[!0-9]").match("bxy") && !Name_pattern("[a-c]x[!0-9]").match("bx1"), "character sets matched");
+		passed &= check(Name_pattern("a\\*b").is_literal() && Name_pattern("a\\*b").match("a*b") && !Name_pattern("a\\*b").match("axb"), "escapes matched");
+		passed &= check(Name_pattern("[abc").match("[abc"), "unclosed set is literal");
+
+		Name_pattern regex("mux_(left|right)[0-9]+", true);
+		passed &= check(regex.match("mux_left12") && !regex.match("mux_up1") && !regex.match("mux_left12x"), "regex matched");
+		passed &= check("mux_" == regex.get_prefix() && "mu" == Name_pattern("mux*", true).get_prefix() && Name_pattern("DEMUX", true).is_literal(), "regex prefix");
+		Name_pattern bracketed("ab[(]|cd", true);
+		passed &= check(bracketed.get_prefix().empty() && bracketed.match("cd") && bracketed.match("ab("), "alternative after a bracketed parenthesis");
+		Name_pattern escaped("ab\\(|cd", true);
+		passed &= check(escaped.get_prefix().empty() && escaped.match("cd") && escaped.match("ab("), "alternative after an escaped parenthesis");
+		Name_pattern grouped("a(b[)[:digit:]]|c)d", true);
+		passed &= check("a" == grouped.get_prefix() && grouped.match("acd") && grouped.match("ab)d") && grouped.match("ab7d"), "bracket inside a group");
+		bool is_rejected = false;
+		try
+		{
+			Name_pattern invalid("(unclosed", true);
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "invalid regex rejected");
+		return passed;
+	}
+
+	/// \brief Queries the sample hierarchy and compares the pruned searches with a scan of all occurrences.
+	bool test_hierarchy_query(const Netlist& netlist)
+	{
+		Hierarchy_query query(netlist, "main", 2);
+		std::vector<Hierarchy_handle> top(1, 0);
+		Name_pattern alu("ALU_PLUS_MINUS");
+		std::vector<Hierarchy_handle> scopes = query.find(top, Name_pattern("*"), &alu, 0);
+		bool passed = check(1 == scopes.size() && "g4" == query.get_path(scopes[0]), "scope found by master");
+
+		Name_pattern mux("MUX");
+		std::vector<Hierarchy_handle> found = query.find(scopes, Name_pattern("*g1?*"), &mux);
+		passed &= check(3 == found.size() && "g4/g15" == query.get_path(found[0]) && "g4/g17" == query.get_path(found[1])
+			&& "g4/g19" == query.get_path(found[2]), "instances found below the scope");
+		passed &= check(query.get_visited_count() < query.get_handle_count(), "subtrees pruned");
+		passed &= check(found[1] == query.find_path("g4/g17") && Hierarchy_query::invalid_handle == query.find_path("g4/missing"), "paths found");
+
+		// Every search must return what a scan of all occurrences returns, in preorder.
+		const char* names[] = { "*", "g1*", "[gw]?", "*", "g?" };
+		const char* masters[] = { "and", "D*", "*", "*_*", "" };
+		for (int i = 0; i < 5; ++i)
+		{
+			Name_pattern name(names[i]);
+			Name_pattern master(masters[i]);
+			const Name_pattern* master_filter = (0 == *masters[i]) ? 0 : &master;
+			std::vector<Hierarchy_handle> expected;
+			for (Hierarchy_handle handle = 1; handle < query.get_handle_count(); ++handle)
+			{
+				if (query.get_level(handle) <= 2 && name.match(query.get_name(handle)) && (0 == master_filter || master.match(query.get_master_name(handle))))
+				{
+					expected.push_back(handle);
+				}
+			}
+			passed &= check(expected == query.find(top, name, master_filter, 1, 2), std::string("search equals scan: ") + names[i]);
+		}
+
+		bool is_rejected = false;
+		try
+		{
+			Hierarchy_query missing(netlist, "missing");
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "unknown top rejected");
+		return passed;
+	}
+
+	/// \brief Compares netlists differing in one pin and one added module.
+	bool test_netlist_diff(const Netlist& netlist)
+	{
+		bool passed = check(Netlist_diff(netlist, netlist).is_empty(), "netlist equals itself");
+
+		Netlist first("first");
+		build_hashing_netlist(first, 1);
+		Netlist second("second");
+		build_hashing_netlist(second, 2);
+		add_half_adder(second, "ha3", 0);
+
+		Netlist_diff diff(first, second, 2);
+		const std::vector<Netlist_change>& changes = diff.get_changes();
+		passed &= check(2 == changes.size(), "two changes found");
+		if (2 == changes.size())
+		{
+			passed &= check(Netlist_change::CHANGED == changes[0].kind && Netlist_change::PIN == changes[0].object
+				&& "ha2" == changes[0].module && "u0/I1" == changes[0].name && "b" == changes[0].old_value && "a" == changes[0].new_value, "changed pin reported");
+			passed &= check(Netlist_change::ADDED == changes[1].kind && Netlist_change::MODULE == changes[1].object && "ha3" == changes[1].module, "added module reported");
+		}
+		std::ostringstream stream;
+		diff.write(stream);
+		passed &= check(0 == stream.str().find("changed\tpin\tha2\tu0/I1\tb\ta\n"), "change list written");
+
+		Netlist_diff reverse(second, first);
+		passed &= check(2 == reverse.get_changes().size() && Netlist_change::REMOVED == reverse.get_changes()[1].kind, "reverse diff removes the module");
+
+		// The pin of the first gate is written with an alias of its net.
+		Netlist written("written");
+		Netlist renamed("renamed");
+		Netlist* aliased[] = { &written, &renamed };
+		for (int i = 0; i < 2; ++i)
+		{
+			aliased[i]->create_new_module("top");
+			Module_description& top = *aliased[i]->get_module("top");
+			add_gate(top, "and", "g", (0 == i) ? "x" : "a", "b", "z");
+			top.add_assign("x", "a");
+		}
+		passed &= check(Netlist_diff(written, renamed).is_empty(), "pin moved to an alias of its net is not a change");
+		return passed;
+	}
+
+	/// \brief Checks that the path is connected, runs from a start net to an endpoint and has the reported depth.
+	bool check_depth_path(const Depth_analyzer& analyzer, const Flat_netlist& flat, const Depth_path& path)
+	{
+		bool passed = check(path.nets.size() == path.gates.size() + 1, "path has one more net than gates");
+		passed &= check(0 == analyzer.get_net_depths()[path.nets.front()], "path starts at a start net");
+		passed &= check(analyzer.get_endpoints().end() != std::find(analyzer.get_endpoints().begin(), analyzer.get_endpoints().end(), path.nets.back()), "path ends at an endpoint");
+		unsigned depth = 0;
+		for (size_t i = 0; i < path.gates.size() && passed; ++i)
+		{
+			Flat_id gate = path.gates[i];
+			const Flat_id* first = &flat.get_gate_inputs()[0] + flat.get_gate_input_offsets()[gate];
+			const Flat_id* last = &flat.get_gate_inputs()[0] + flat.get_gate_input_offsets()[gate + 1];
+			passed &= check(last != std::find(first, last, path.nets[i]) && flat.get_gate_outputs()[gate] == path.nets[i + 1], "path gates connect the path nets");
+			depth += analyzer.get_delay(flat.get_gate_types()[gate]);
+		}
+		passed &= check(depth == path.depth, "path depth is the sum of its delays");
+		return passed;
+	}
+
+	/// \brief Computes unit and per-primitive depths of the ALU and traces its deepest paths.
+	bool test_depth_analysis(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Depth_analyzer analyzer(levelizer, 2);
+		analyzer.analyze();
+		bool passed = check(levelizer.get_level_count() == analyzer.get_max_depth(), "unit depth equals the level count");
+
+		analyzer.set_delay(PRIMITIVE_XOR, 3);
+		analyzer.set_delay(PRIMITIVE_BUF, 0);
+		analyzer.analyze();
+		const std::vector<unsigned>& depths = analyzer.get_net_depths();
+		for (size_t gate = 0; gate < flat.get_gate_count(); ++gate)
+		{
+			unsigned depth = 0;
+			for (Flat_id i = flat.get_gate_input_offsets()[gate]; i < flat.get_gate_input_offsets()[gate + 1]; ++i)
+			{
+				depth = std::max(depth, depths[flat.get_gate_inputs()[i]]);
+			}
+			passed &= check(depth + analyzer.get_delay(flat.get_gate_types()[gate]) == depths[flat.get_gate_outputs()[gate]], "net depth is the deepest input plus the delay");
+		}
+
+		std::vector<Depth_path> paths = analyzer.find_deepest_paths(10);
+		passed &= check(10 == paths.size() && analyzer.get_max_depth() == paths[0].depth, "deepest path has the max depth");
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			passed &= check(0 == i || paths[i].depth <= paths[i - 1].depth, "paths are ordered by depth");
+			passed &= check_depth_path(analyzer, flat, paths[i]);
+		}
+
+		std::vector<size_t> histogram = analyzer.get_endpoint_histogram();
+		size_t endpoint_count = 0;
+		for (size_t i = 0; i < histogram.size(); ++i)
+		{
+			endpoint_count += histogram[i];
+		}
+		passed &= check(analyzer.get_endpoints().size() == endpoint_count && 0 != histogram.back(), "endpoint histogram");
+		return passed;
+	}
+
+	/// \brief Returns true if the estimate is within 10% or 1 of the exact count.
+	bool is_close(float estimate, size_t exact)
+	{
+		double error = estimate - double(exact);
+		return error * error <= std::max(1.0, 0.01 * exact * exact);
+	}
+
+	/// \brief Compares the estimated cone sizes of the ALU with exact cone traversals.
+	bool test_cone_estimation(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Cone_estimator estimator(levelizer, 10, 2);
+		estimator.estimate();
+
+		bool passed = true;
+		const std::vector<Flat_id>& drivers = flat.get_net_drivers();
+		for (Flat_id net = 0; net < flat.get_net_count(); ++net)
+		{
+			// Exact fan-in gates and inputs by a backward traversal.
+			std::vector<char> visited_gates(flat.get_gate_count(), 0), visited_nets(flat.get_net_count(), 0);
+			std::vector<Flat_id> pending(1, net);
+			size_t gate_count = 0, input_count = 0;
+			visited_nets[net] = 1;
+			while (!pending.empty())
+			{
+				Flat_id current = pending.back();
+				pending.pop_back();
+				Flat_id driver = drivers[current];
+				if (Flat_netlist::invalid_id == driver)
+				{
+					++input_count;
+					continue;
+				}
+				if (visited_gates[driver]++)
+				{
+					continue;
+				}
+				++gate_count;
+				for (Flat_id i = flat.get_gate_input_offsets()[driver]; i < flat.get_gate_input_offsets()[driver + 1]; ++i)
+				{
+					if (!visited_nets[flat.get_gate_inputs()[i]]++)
+					{
+						pending.push_back(flat.get_gate_inputs()[i]);
+					}
+				}
+			}
+			passed &= check(is_close(estimator.get_fanin_cone_sizes()[net], gate_count), "fan-in cone estimate of " + flat.get_net_name(net));
+			passed &= check(is_close(estimator.get_input_counts()[net], input_count), "input count estimate of " + flat.get_net_name(net));
+
+			// Exact fan-out gates by a forward traversal.
+			std::fill(visited_gates.begin(), visited_gates.end(), 0);
+			pending.assign(1, net);
+			gate_count = 0;
+			while (!pending.empty())
+			{
+				Flat_id current = pending.back();
+				pending.pop_back();
+				for (Flat_id i = flat.get_net_fanout_offsets()[current]; i < flat.get_net_fanout_offsets()[current + 1]; ++i)
+				{
+					Flat_id gate = flat.get_net_fanouts()[i];
+					if (!visited_gates[gate]++)
+					{
+						++gate_count;
+						pending.push_back(flat.get_gate_outputs()[gate]);
+					}
+				}
+			}
+			passed &= check(is_close(estimator.get_fanout_cone_sizes()[net], gate_count), "fan-out cone estimate of " + flat.get_net_name(net));
+		}
+		return passed;
+	}
+
+	/// \brief Builds a module "top" of random two input gates and inverters driven by 64 inputs, the last 16 gates drive output ports.
+	void build_random_netlist(Netlist& netlist, int gate_count)
+	{
+		const int input_count = 64;
+		const char* types[] = { "and", "or", "nand", "nor", "xor", "not" };
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		boost::uint64_t state = 1;
+		for (int gate = 0; gate < gate_count; ++gate)
+		{
+			std::string nets[2];
+			for (int i = 0; i < 2; ++i)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				int source = static_cast<int>((state >> 33) % (gate + input_count));
+				std::ostringstream name;
+				name << ((source < input_count) ? "i" : "n") << ((source < input_count) ? source : source - input_count);
+				nets[i] = name.str();
+			}
+			std::ostringstream name, output;
+			name << "g" << gate;
+			output << "n" << gate;
+			if (5 == gate % 6)
+			{
+				add_gate(top, types[gate % 6], name.str(), nets[0], output.str());
+			}
+			else
+			{
+				add_gate(top, types[gate % 6], name.str(), nets[0], nets[1], output.str());
+			}
+		}
+		for (int gate = gate_count - 16; gate < gate_count; ++gate)
+		{
+			std::ostringstream output;
+			output << "n" << gate;
+			add_port(top, output.str(), OUT);
+		}
+		top.connect_nets();
+	}
+
+	/// \brief Partitions a random netlist and checks the balance and the cut against a round-robin assignment.
+	bool test_partitioning()
+	{
+		Netlist netlist("random");
+		build_random_netlist(netlist, 3000);
+		Flat_netlist flat(netlist, "top");
+
+		Partitioner partitioner(flat, 2);
+		std::vector<unsigned> weights(flat.get_gate_count(), 1);
+		for (size_t gate = 0; gate < weights.size(); gate += 10)
+		{
+			weights[gate] = 5;
+		}
+		partitioner.set_gate_weights(weights);
+		partitioner.partition(4, 0.05);
+
+		boost::uint64_t total = 0;
+		for (size_t gate = 0; gate < weights.size(); ++gate)
+		{
+			total += weights[gate];
+		}
+		std::vector<boost::uint64_t> part_weights = partitioner.get_part_weights();
+		bool passed = check(4 == part_weights.size(), "four parts");
+		for (size_t part = 0; part < part_weights.size(); ++part)
+		{
+			passed &= check(part_weights[part] <= 1.05 * total / 4 + 1, "part weight within the imbalance");
+		}
+
+		// Nets cut by a round robin assignment.
+		size_t round_robin_cut = 0;
+		for (size_t net = 0; net < flat.get_net_count(); ++net)
+		{
+			Flat_id driver = flat.get_net_drivers()[net];
+			for (Flat_id i = flat.get_net_fanout_offsets()[net]; Flat_netlist::invalid_id != driver && i < flat.get_net_fanout_offsets()[net + 1]; ++i)
+			{
+				if (flat.get_net_fanouts()[i] % 4 != driver % 4)
+				{
+					++round_robin_cut;
+					break;
+				}
+			}
+		}
+		passed &= check(partitioner.get_cut_count() < round_robin_cut / 2, "partition cuts far fewer nets than round robin");
+
+		Partitioner single(flat, 1);
+		single.set_gate_weights(weights);
+		single.partition(4, 0.05);
+		passed &= check(single.get_partitions() == partitioner.get_partitions(), "partition does not depend on the thread count");
+		return passed;
+	}
+
+	/// \brief Measures the conversion speed on a random netlist of two input gates.
+	void report_aig_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, gate_count);
+		Flat_netlist flat(netlist, "top");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+
+		std::clock_t start = std::clock();
+		Aig aig(levelizer);
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "AIG conversion: " << gate_count << " gates to " << aig.get_and_count() << " AND nodes, "
+			<< (seconds > 0 ? gate_count / seconds : 0) << " gates per second\n";
+	}
+
+	/// \brief Measures the diff speed on two equal random netlists.
+	void report_diff_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist first("first");
+		build_random_netlist(first, gate_count);
+		Netlist second("second");
+		build_random_netlist(second, gate_count);
+
+		std::clock_t start = std::clock();
+		Netlist_diff diff(first, second);
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Netlist diff: " << diff.get_changes().size() << " changes, "
+			<< (seconds > 0 ? gate_count / seconds : 0) << " instances per second\n";
+	}
+
+	/// \brief Measures the depth analysis speed on a random netlist.
+	void report_depth_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, gate_count);
+		Flat_netlist flat(netlist, "top");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+
+		std::clock_t start = std::clock();
+		Depth_analyzer analyzer(levelizer);
+		analyzer.analyze();
+		std::vector<Depth_path> paths = analyzer.find_deepest_paths(100);
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Depth analysis: depth " << analyzer.get_max_depth() << ", " << paths.size() << " paths, "
+			<< (seconds > 0 ? gate_count / seconds : 0) << " gates per second\n";
+	}
+	/// \brief Measures the cone estimation speed on a random netlist.
+	void report_cone_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, gate_count);
+		Flat_netlist flat(netlist, "top");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+
+		std::clock_t start = std::clock();
+		Cone_estimator estimator(levelizer, 6);
+		estimator.estimate();
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Cone estimation: largest fan-in cone about " << *std::max_element(estimator.get_fanin_cone_sizes().begin(), estimator.get_fanin_cone_sizes().end())
+			<< " gates, " << (seconds > 0 ? gate_count / seconds : 0) << " gates per second\n";
+	}
+	/// \brief Measures the partitioning speed on a random netlist.
+	void report_partitioning_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, gate_count);
+		Flat_netlist flat(netlist, "top");
+
+		std::clock_t start = std::clock();
+		Partitioner partitioner(flat);
+		partitioner.partition(8);
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Partitioning: 8 parts, " << partitioner.get_cut_count() << " of " << flat.get_net_count() << " nets cut, "
+			<< (seconds > 0 ? gate_count / seconds : 0) << " gates per second\n";
+	}
+
+
+	/// \brief Measures the lint speed on a random netlist.
+	void report_lint_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, gate_count);
+
+		std::clock_t start = std::clock();
+		std::vector<Lint_violation> violations = Lint_engine().run(netlist);
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Lint: " << violations.size() << " violations, "
+			<< (seconds > 0 ? gate_count / seconds : 0) << " instances per second\n";
+	}
+	/// \brief Measures the constant propagation speed on a random netlist with 8 tied inputs.
+	void report_constant_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, gate_count);
+		Module_description& top = *netlist.get_module("top");
+		for (int i = 0; i < 8; ++i)
+		{
+			std::ostringstream input;
+			input << "i" << i;
+			top.add_assign(input.str(), (i % 2) ? "1'b1" : "1'b0");
+		}
+		top.connect_nets();
+		Flat_netlist flat(netlist, "top");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+
+		std::clock_t start = std::clock();
+		Constant_propagator propagator(levelizer);
+		propagator.propagate();
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Constant propagation: " << propagator.get_constant_gates().size() << " constant gates, "
+			<< (seconds > 0 ? gate_count / seconds : 0) << " gates per second\n";
+	}
+	/// \brief Measures the cone extraction speed on a random netlist, extracting the cones of all outputs.
+	void report_extraction_throughput()
+	{
+		const int gate_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, gate_count);
+		Flat_netlist flat(netlist, "top");
+
+		// The first extraction counts the gates of the hierarchy once, the cones of single outputs are timed after it.
+		Cone_extractor extractor(flat, netlist);
+		extractor.extract(flat.get_output_nets(), "cone");
+		const std::vector<Flat_id>& outputs = flat.get_output_nets();
+		size_t cone_gate_count = 0;
+		std::clock_t start = std::clock();
+		for (size_t i = 0; i < outputs.size(); ++i)
+		{
+			extractor.extract(std::vector<Flat_id>(1, outputs[i]), "cone");
+			cone_gate_count += extractor.get_cone_gates().size();
+		}
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Cone extraction: " << outputs.size() << " cones of " << cone_gate_count << " gates, "
+			<< (seconds > 0 ? cone_gate_count / seconds : 0) << " gates per second\n";
+	}
+	/// \brief Measures the query speed on a hierarchy of eight instances per module, six levels deep.
+	void report_query_throughput()
+	{
+		const int depth = 5;
+		std::ostringstream text;
+		text << "module T0(a);\ninput a;\n";
+		for (int i = 0; i < 8; ++i)
+		{
+			text << "and g" << i << " (.A(a), .B(a), .Z(w" << i << "));\n";
+		}
+		text << "endmodule\n";
+		for (int level = 1; level <= depth; ++level)
+		{
+			text << "module T" << level << "(a);\ninput a;\n";
+			for (int i = 0; i < 8; ++i)
+			{
+				text << "T" << level - 1 << " u" << i << " (.a(a));\n";
+			}
+			text << "endmodule\n";
+		}
+		Netlist_builder builder(*new std::istringstream(text.str()), "tree");
+		builder.construct_netlist();
+		boost::shared_ptr<Netlist> netlist = builder.get_netlist();
+
+		std::clock_t start = std::clock();
+		Hierarchy_query query(*netlist, "T5");
+		Name_pattern master("and");
+		std::vector<Hierarchy_handle> found = query.find(std::vector<Hierarchy_handle>(1, 0), Name_pattern("g[13]"), &master);
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Hierarchy query: " << query.get_handle_count() << " instances, " << found.size() << " found, "
+			<< (seconds > 0 ? query.get_handle_count() / seconds : 0) << " instances per second\n";
+	}
+	/// \brief Measures the undo and redo speed of single instance edits on a large module.
+	void report_journal_throughput()
+	{
+		const int edit_count = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, edit_count);
+		Module_description& top = *netlist.get_module("top");
+		Edit_journal& journal = netlist.get_journal();
+		journal.set_enabled(true);
+
+		std::clock_t start = std::clock();
+		for (int i = 0; i < edit_count; ++i)
+		{
+			std::ostringstream name;
+			name << "e" << i;
+			add_gate(top, "not", name.str(), "i0", name.str());
+		}
+		size_t edited = journal.get_version();
+		journal.restore(0);
+		journal.restore(edited);
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Edit journal: " << 3 * edit_count << " edits, undos and redos, "
+			<< (seconds > 0 ? 3 * edit_count / seconds : 0) << " edits per second\n";
+	}
+
+	/** \brief Measures edits of a module with a connected netlist, once per edit and once per transaction.
+	 *	\param[in] is_batched - True to make all edits in one transaction.
+	 *	\param[in] edit_count - Number of instances added.
+	 */
+	double time_connected_edits(bool is_batched, int edit_count)
+	{
+		Netlist netlist("random");
+		build_random_netlist(netlist, 2000);
+		Module_description& top = *netlist.get_module("top");
+		top.connect_nets();
+
+		std::clock_t start = std::clock();
+		if (is_batched)
+		{
+			netlist.begin_transaction();
+		}
+		for (int i = 0; i < edit_count; ++i)
+		{
+			std::ostringstream name;
+			name << "e" << i;
+			add_gate(top, "not", name.str(), "i0", name.str());
+			if (!is_batched)
+			{
+				top.connect_nets();
+			}
+		}
+		if (is_batched)
+		{
+			netlist.commit_transaction();
+		}
+		return double(std::clock() - start) / CLOCKS_PER_SEC;
+	}
+
+	/// \brief Compares connecting the nets after every edit with connecting them once per transaction.
+	void report_transaction_throughput()
+	{
+		const int edit_count = 500;
+		double single = time_connected_edits(false, edit_count);
+		double batched = time_connected_edits(true, edit_count);
+		std::cout << "Transactions: " << edit_count << " edits, " << (single > 0 ? edit_count / single : 0)
+			<< " edits per second connected one by one, " << (batched > 0 ? edit_count / batched : 0) << " edits per second in one transaction\n";
+	}
+
+	/// Reads a published netlist from several threads.
+	struct Concurrent_reads
+	{
+		const Netlist* netlist;
+		size_t net_count;
+
+		void run(size_t begin, size_t end, unsigned thread)
+		{
+			size_t connection_count = 0;
+			for (size_t i = begin; i < end; ++i)
+			{
+				Netlist_reader reader(*netlist, thread);
+				const Module_description& top = *reader.get_netlist().get_modules().find("top")->second;
+				std::ostringstream name;
+				name << "n" << (i % net_count);
+				std::map<std::string, boost::shared_ptr<Net> >::const_iterator found = top.get_nets().find(name.str());
+				if (top.get_nets().end() != found)
+				{
+					connection_count += found->second->get_destination_ports().size();
+				}
+			}
+			if (0 == connection_count)
+			{
+				std::cout << "no connections read\n";
+			}
+		}
+	};
+
+	/// \brief Measures the read throughput of a published netlist for 1, 2, 4... threads up to the hardware thread count.
+	void report_read_scaling()
+	{
+		const size_t reads_per_thread = 200000;
+		Netlist netlist("random");
+		build_random_netlist(netlist, 20000);
+		netlist.get_module("top")->connect_nets();
+		netlist.publish();
+		Concurrent_reads reads;
+		reads.netlist = &netlist;
+		reads.net_count = 20000;
+		unsigned max_threads = std::min(Parallel::get_thread_count(), Netlist::max_readers);
+		for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+		{
+			boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+			Parallel::for_range(threads * reads_per_thread, boost::bind(&Concurrent_reads::run, &reads, _1, _2, _3), threads, reads_per_thread);
+			double seconds = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+			std::cout << "Concurrent reads: " << threads << " threads, "
+				<< (seconds > 0 ? threads * reads_per_thread / seconds : 0) << " reads per second\n";
+		}
+	}
+}
+
+/// Runs the tests on the netlist given as argument, and the throughput measurements with --benchmark.
+int main(int argc, char* argv[])
+{
+	const char* netlist_path = "netlist.v";
+	bool is_benchmark = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string("--benchmark") == argv[i])
+		{
+			is_benchmark = true;
+		}
+		else
+		{
+			netlist_path = argv[i];
+		}
+	}
+	Netlist_builder bld( netlist_path );
+	bld.construct_netlist();
+	boost::shared_ptr<Netlist> netlist = bld.get_netlist();
+
+	bool passed = test_sample_levels(*netlist);
+	passed &= test_loop_detection();
+	passed &= test_multi_output_leaf();
+	passed &= test_aig_conversion(*netlist);
+	passed &= test_aig_hashing();
+	passed &= test_work_stealing_pool();
+	passed &= test_module_hashing();
+	passed &= test_module_scheduling();
+	passed &= test_module_summaries(*netlist);
+	passed &= test_lint();
+	passed &= test_aliased_net_analysis();
+	passed &= test_constant_propagation();
+	passed &= test_cone_extraction();
+	passed &= test_uniquification();
+	passed &= test_name_patterns();
+	passed &= test_hierarchy_query(*netlist);
+	passed &= test_netlist_diff(*netlist);
+	passed &= test_depth_analysis(*netlist);
+	passed &= test_cone_estimation(*netlist);
+	passed &= test_partitioning();
+	if (is_benchmark)
+	{
+		report_aig_throughput();
+		report_diff_throughput();
+		report_depth_throughput();
+		report_cone_throughput();
+		report_partitioning_throughput();
+		report_lint_throughput();
+		report_constant_throughput();
+		report_extraction_throughput();
+		report_query_throughput();
+		report_journal_throughput();
+		report_transaction_throughput();
+		report_read_scaling();
+	}
+
+	if (passed)
+	{
+		std::cout << "Analysis UT passed!\n";
+	}
+return passed ? 0 : 1;
+}
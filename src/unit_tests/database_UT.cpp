@@ -1,16 +1,505 @@
 #include <iostream>
+#include <sstream>
+#include <vector>
+#include <utility>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include "database/netlist_builder.hpp"
+#include "database/module_description.hpp"
+#include "database/module_instance.hpp"
+#include "database/module_port.hpp"
+#include "database/instance_port.hpp"
+#include "database/net.hpp"
+#include "database/net_aliases.hpp"
+#include "database/edit_journal.hpp"
+#include "database/netlist_reader.hpp"
+#include "database/netlist_transaction.hpp"
 
-int main()
+/// Helper functions.
+namespace
 {
-    Netlist_builder bld( "test_data/ALU_PLUS_MINUS_last.v" );	
-    bld.construct_netlist();
+	/// \brief Prints the failure message and returns false if the condition does not hold.
+	bool check(bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cout << "FAILED: " << message << "\n";
+		}
+		return condition;
+	}
+
+	/// \brief Adds a two pin primitive instance to the module.
+	void add_gate(Module_description& module, const std::string& type, const std::string& name, const std::string& in, const std::string& out)
+	{
+		std::vector< std::pair< std::string, std::string> > pins;
+		pins.push_back(std::make_pair(in, std::string("I")));
+		pins.push_back(std::make_pair(out, std::string("Z")));
+		module.add_module_instance(type, name, pins);
+	}
+
+	/// \brief Adds a port to the module.
+	void add_port(Module_description& module, const std::string& name, PortType type)
+	{
+		module.add_port(boost::shared_ptr<Module_port>(new Module_port(name, type, &module)));
+	}
+
+	/// \brief Parses assignments and a feed-through module and checks that aliased nets become one net.
+	bool test_net_aliasing()
+	{
+		std::istringstream* text = new std::istringstream(
+			"module FT(a, y);\n"
+			"input a;\n"
+			"output y;\n"
+			"assign y = a;\n"
+			"endmodule\n"
+			"module top(x, z, w);\n"
+			"input x;\n"
+			"output z;\n"
+			"output w;\n"
+			"wire m;\n"
+			"wire k;\n"
+			"not g0 (.I(x), .Z(m));\n"
+			"assign k = m;\n"
+			"FT f0 (.a(k), .y(z));\n"
+			"buf g1 (.I(k), .Z(w));\n"
+			"endmodule\n");
+		Netlist_builder builder(*text, "aliases");
+		builder.construct_netlist();
+		boost::shared_ptr<Netlist> netlist = builder.get_netlist();
+
+		Module_description& feed_through = *netlist->get_module("FT");
+		Module_description& top = *netlist->get_module("top");
+		bool passed = check(1 == feed_through.get_assigns().size() && "a" == feed_through.get_canonical_net_name("y"), "feed-through ports aliased to the first port");
+		passed &= check(1 == feed_through.get_nets().size(), "feed-through has one net");
+		passed &= check("m" == top.get_canonical_net_name("k") && top.get_nets().end() == top.get_nets().find("k"), "assigned wire merged into its source");
+		passed &= check("m" == top.get_module_instance_by_name("g1")->get_ports()[0].get_net_name(), "instance pins renamed to the canonical net");
+
+		// A long chain of merges keeps the canonical name of the first class.
+		Net_aliases aliases;
+		const int chain_length = 100000;
+		for (int i = chain_length - 1; i > 0; --i)
+		{
+			std::ostringstream first, second;
+			first << "n" << i - 1;
+			second << "n" << i;
+			aliases.merge(first.str(), second.str());
+		}
+		aliases.compress();
+		passed &= check("n0" == aliases.get_canonical("n99999") && "n0" == aliases.get_canonical("n5") && "q" == aliases.get_canonical("q"), "chain of merges has one canonical name");
+		return passed;
+	}
+
+
+	/// \brief Change listener failing on every notification.
+	void throw_on_change(Netlist&)
+	{
+		throw std::string("Change rejected.");
+	}
+
+	/// \brief Records edits of a netlist, restores versions and checks that the undone objects come back.
+	bool test_edit_journal()
+	{
+		Netlist netlist("journal");
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		add_gate(top, "not", "n0", "a", "y");
+		bool passed = check(0 == netlist.get_journal().get_edit_count(), "nothing recorded while disabled");
+
+		Edit_journal& journal = netlist.get_journal();
+		journal.set_enabled(true);
+		size_t empty = journal.get_version();
+		netlist.create_new_module("sub");
+		boost::shared_ptr<Module_description> sub = netlist.get_module("sub");
+		top.add_module_instance("sub", "u0", std::vector< std::pair<std::string, std::string> >());
+		size_t with_instance = journal.get_version();
+		sub->add_port(boost::shared_ptr<Module_port>(new Module_port("p", IN, sub.get())));
+		sub->add_net(boost::shared_ptr<Net>(new Net("w")));
+		top.add_assign("b", "y");
+		top.remove_module_instance("n0");
+		passed &= check(6 == journal.get_edit_count() && 6 == journal.get_version(), "edits recorded");
+
+		journal.restore(with_instance);
+		passed &= check(sub->get_ports().empty() && sub->get_nets().empty() && top.get_assigns().empty()
+			&& 2 == top.get_module_instances().size() && "b" == top.get_canonical_net_name("b"), "version restored");
+		journal.restore(empty);
+		passed &= check(1 == netlist.get_modules().size() && 1 == top.get_module_instances().size(), "all edits undone");
+		passed &= check(journal.redo() && sub == netlist.get_module("sub"), "same module redone");
+
+		journal.restore(6);
+		passed &= check(1 == sub->get_ports().size() && 1 == sub->get_nets().count("w") && 1 == top.get_module_instances().size()
+			&& "y" == top.get_canonical_net_name("b"), "all edits redone");
+
+		// A new edit after an undo drops the undone edits.
+		journal.restore(with_instance);
+		netlist.create_new_module("other");
+		passed &= check(3 == journal.get_edit_count() && !journal.redo(), "undone edits dropped");
+		bool is_rejected = false;
+		try
+		{
+			journal.restore(6);
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "dropped version rejected");
+
+		// A shared module stays journaled by its own netlist, also after the sharing netlist is gone.
+		size_t source_count = journal.get_edit_count();
+		{
+			Netlist cone("cone");
+			cone.get_journal().set_enabled(true);
+			cone.add_module(sub);
+			sub->add_net(boost::shared_ptr<Net>(new Net("v")));
+			passed &= check(source_count + 1 == journal.get_edit_count() && 1 == cone.get_journal().get_edit_count(), "shared module edits journaled by the owner");
+		}
+		sub->add_net(boost::shared_ptr<Net>(new Net("u")));
+		passed &= check(&netlist == sub->get_netlist() && source_count + 2 == journal.get_edit_count(), "owner kept after the sharing netlist is destroyed");
+
+		// A replayed edit that throws does not leave the journal replaying.
+		sub->add_net(boost::shared_ptr<Net>(new Net("t")));
+		netlist.remove_module("sub");
+		Netlist owner("owner");
+		owner.add_module(sub);
+		owner.set_change_listener(&throw_on_change);
+		bool is_thrown = false;
+		try
+		{
+			journal.undo();
+			journal.undo();
+		}
+		catch (const std::string&)
+		{
+			is_thrown = true;
+		}
+		size_t version = journal.get_version();
+		netlist.create_new_module("after_throw");
+		passed &= check(is_thrown && version + 1 == journal.get_version() && journal.get_edit_count() == journal.get_version(), "edits recorded after a throwing replay");
+		return passed;
+	}
+
+	/// \brief Returns a description of the whole module: nets, pins with their written and resolved net names, and assignments.
+	std::string describe_module(const Module_description& module)
+	{
+		std::ostringstream text;
+		const std::map<std::string, boost::shared_ptr<Net> >& nets = module.get_nets();
+		for (std::map<std::string, boost::shared_ptr<Net> >::const_iterator I = nets.begin(); I != nets.end(); ++I)
+		{
+			text << "net " << I->first << (I->second->is_implicit() ? " implicit" : "") << (I->second->has_source_port() ? " driven" : "")
+				<< " " << I->second->get_destination_ports().size() << "\n";
+		}
+		const std::map<std::string, boost::shared_ptr<Module_instance> >& instances = module.get_module_instances();
+		for (std::map<std::string, boost::shared_ptr<Module_instance> >::const_iterator I = instances.begin(); I != instances.end(); ++I)
+		{
+			const std::vector<Instance_port>& pins = I->second->get_ports();
+			for (std::vector<Instance_port>::const_iterator J = pins.begin(); J != pins.end(); ++J)
+			{
+				text << "pin " << I->first << "." << J->get_name() << " " << J->get_written_net_name() << " " << J->get_net_name() << "\n";
+			}
+		}
+		for (size_t i = 0; i < module.get_assigns().size(); ++i)
+		{
+			text << "assign " << module.get_assigns()[i].first << " " << module.get_assigns()[i].second << "\n";
+		}
+		return text.str();
+	}
+
+	/// \brief Checks that undoing an assignment or an instance restores the whole module as it was before the edit.
+	bool test_undo_restores_module()
+	{
+		Netlist netlist("restore");
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		netlist.begin_transaction();
+		add_port(top, "a", IN);
+		add_port(top, "y", OUT);
+		top.add_net(boost::shared_ptr<Net>(new Net("w")));
+		add_gate(top, "buf", "u0", "w", "y");
+		add_gate(top, "not", "u1", "a", "v");
+		netlist.commit_transaction();
+		std::string original = describe_module(top);
 
+		Edit_journal& journal = netlist.get_journal();
+		journal.set_enabled(true);
+		netlist.begin_transaction();
+		top.add_assign("w", "a");
+		netlist.commit_transaction();
+		std::string assigned = describe_module(top);
+		bool passed = check(top.get_nets().end() == top.get_nets().find("w") && "a" == top.get_module_instance_by_name("u0")->get_ports()[0].get_net_name(),
+			"assigned net stands for its source");
+		passed &= check("w" == top.get_module_instance_by_name("u0")->get_ports()[0].get_written_net_name(), "written pin net name kept");
+
+		passed &= check(journal.undo() && original == describe_module(top), "undone assignment restores the module");
+		passed &= check(journal.redo() && assigned == describe_module(top), "redone assignment aliases again");
+		passed &= check(journal.undo() && original == describe_module(top), "assignment undone again");
+
+		netlist.begin_transaction();
+		add_gate(top, "buf", "u2", "v", "k");
+		netlist.commit_transaction();
+		passed &= check(1 == top.get_nets().count("k") && top.get_nets().find("k")->second->is_implicit(), "implicit net created");
+		passed &= check(journal.undo() && original == describe_module(top), "undone instance removes its implicit net");
+		return passed;
+	}
+
+	/// Counts the notifications of a netlist.
+	struct Change_counter
+	{
+		unsigned count;
+
+		void notify(Netlist& netlist)
+		{
+			++count;
+		}
+	};
+
+	/// \brief Edits a netlist inside nested transactions, checks the deferred binding, connection and notification.
+	bool test_transactions()
+	{
+		Netlist netlist("transactions");
+		netlist.get_journal().set_enabled(true);
+		Change_counter counter;
+		counter.count = 0;
+		netlist.set_change_listener(boost::bind(&Change_counter::notify, &counter, _1));
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		add_port(top, "a", IN);
+		bool passed = check(2 == counter.count, "every edit notified outside transactions");
+
+		// The instance comes before its module, it is bound and connected at the commit.
+		netlist.begin_transaction();
+		netlist.begin_transaction();
+		add_gate(top, "not", "n0", "a", "x");
+		add_gate(top, "sub", "u0", "x", "y");
+		netlist.commit_transaction();
+		passed &= check(netlist.is_in_transaction() && 2 == counter.count, "inner commit deferred");
+		netlist.create_new_module("sub");
+		Module_description& sub = *netlist.get_module("sub");
+		add_port(sub, "I", IN);
+		add_port(sub, "Z", OUT);
+		netlist.commit_transaction();
+		const Module_instance& instance = *top.get_module_instance_by_name("u0");
+		passed &= check(!netlist.is_in_transaction() && 3 == counter.count, "one notification per transaction");
+		passed &= check(instance.has_description() && &sub == &instance.get_module_description(), "instance bound at the commit");
+		passed &= check(1 == top.get_nets().count("x") && 1 == top.get_nets().find("x")->second->get_destination_ports().size(),
+			"nets connected at the commit");
+
+		// One undo reverts the whole transaction, inside one more notification.
+		passed &= check(netlist.get_journal().undo() && 4 == counter.count, "transaction undone at once");
+		passed &= check(1 == netlist.get_modules().size() && top.get_module_instances().empty() && 1 == top.get_ports().size(),
+			"all edits of the transaction undone");
+		passed &= check(netlist.get_journal().redo() && 2 == netlist.get_modules().size() && 2 == top.get_module_instances().size(),
+			"transaction redone at once");
+
+		bool is_rejected = false;
+		try
+		{
+			netlist.commit_transaction();
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "commit without transaction rejected");
+
+		// A guard commits when an exception leaves its scope.
+		unsigned committed_count = counter.count;
+		try
+		{
+			Netlist_transaction transaction(netlist);
+			add_gate(top, "not", "n2", "y", "w");
+			throw std::string("command failed");
+		}
+		catch (const std::string&)
+		{
+		}
+		passed &= check(!netlist.is_in_transaction() && committed_count + 1 == counter.count, "guard commits on exceptions");
+		passed &= check(netlist.get_journal().undo() && 0 == top.get_module_instances().count("n2"), "guarded edits undone at once");
+
+		// Undoing a port reconnects the nets, no net keeps the removed port as its source.
+		add_gate(top, "not", "n1", "p", "q");
+		netlist.begin_transaction();
+		add_port(top, "p", IN);
+		netlist.commit_transaction();
+		const std::map<std::string, boost::shared_ptr<Net> >& nets = top.get_nets();
+		passed &= check(nets.end() != nets.find("p") && nets.find("p")->second->has_source_port(), "port drives its net");
+		unsigned count = counter.count;
+		passed &= check(netlist.get_journal().undo() && count + 1 == counter.count, "port undo notified");
+		passed &= check(0 == top.get_ports().count("p") && (nets.end() == nets.find("p") || !nets.find("p")->second->has_source_port()),
+			"nets connected after the port undo");
+		return passed;
+	}
+
+	/// \brief Undoes and redoes an edit of every kind, checks that each undo and redo notifies the listener once.
+	bool test_undo_notifications()
+	{
+		Netlist netlist("notifications");
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		add_gate(top, "not", "n0", "a", "y");
+		Edit_journal& journal = netlist.get_journal();
+		journal.set_enabled(true);
+		Change_counter counter;
+		counter.count = 0;
+		netlist.set_change_listener(boost::bind(&Change_counter::notify, &counter, _1));
+
+		netlist.create_new_module("sub");
+		netlist.remove_module("sub");
+		add_gate(top, "not", "n1", "y", "z");
+		top.remove_module_instance("n0");
+		add_port(top, "a", IN);
+		top.add_net(boost::shared_ptr<Net>(new Net("w")));
+		top.add_assign("b", "z");
+		const char* kinds[] = { "assign", "net", "port", "instance removal", "instance", "module removal", "module" };
+		bool passed = check(7 == counter.count && 7 == journal.get_version(), "every edit notified");
+		for (int i = 0; i < 7; ++i)
+		{
+			unsigned count = counter.count;
+			passed &= check(journal.undo() && count + 1 == counter.count, std::string("undo notified: ") + kinds[i]);
+		}
+		passed &= check(1 == netlist.get_modules().size() && 1 == top.get_module_instances().size() && top.get_ports().empty()
+			&& top.get_assigns().empty() && 0 == top.get_nets().count("w"), "every edit undone");
+		for (int i = 6; i >= 0; --i)
+		{
+			unsigned count = counter.count;
+			passed &= check(journal.redo() && count + 1 == counter.count, std::string("redo notified: ") + kinds[i]);
+		}
+		passed &= check(1 == top.get_ports().count("a") && 1 == top.get_module_instances().count("n1") && 1 == top.get_assigns().size()
+			&& 1 == top.get_nets().count("w"), "every edit redone");
+		return passed;
+	}
+
+	/// Runs a writer committing pairs of gates on thread 0 and readers checking the published versions on the others.
+	struct Concurrent_edits
+	{
+		Netlist* netlist;
+		int commit_count;
+		boost::atomic<bool> is_done;
+		boost::atomic<unsigned> failure_count;
+		boost::atomic<size_t> read_count;
+
+		void run(unsigned thread)
+		{
+			if (0 == thread)
+			{
+				Module_description& top = *netlist->get_module("top");
+				for (int i = 0; i < commit_count; ++i)
+				{
+					std::ostringstream first, second;
+					first << "a" << i;
+					second << "b" << i;
+					netlist->begin_transaction();
+					add_gate(top, "not", first.str(), "x", first.str());
+					add_gate(top, "not", second.str(), first.str(), second.str());
+					netlist->commit_transaction();
+				}
+				is_done = true;
+				return;
+			}
+			size_t last_count = 0;
+			while (!is_done)
+			{
+				Netlist_reader reader(*netlist, thread);
+				const Module_description& top = *reader.get_netlist().get_modules().find("top")->second;
+				size_t count = top.get_module_instances().size();
+				const std::map<std::string, boost::shared_ptr<Net> >& nets = top.get_nets();
+				std::map<std::string, boost::shared_ptr<Net> >::const_iterator x = nets.find("x");
+				if (0 != count % 2 || count < last_count || nets.end() == x || count / 2 != x->second->get_destination_ports().size())
+				{
+					++failure_count;
+				}
+				last_count = count;
+				++read_count;
+			}
+		}
+	};
+
+	/// \brief Publishes versions of a netlist, checks their isolation, sharing and reclamation, then reads while editing.
+	bool test_concurrent_reads()
+	{
+		Netlist netlist("concurrent");
+		netlist.create_new_module("top");
+		netlist.create_new_module("sub");
+		netlist.create_new_module("leaf");
+		Module_description& top = *netlist.get_module("top");
+		Module_description& sub = *netlist.get_module("sub");
+		netlist.begin_transaction();
+		add_port(top, "x", IN);
+		add_gate(top, "sub", "u0", "x", "y");
+		add_gate(sub, "leaf", "l0", "a", "b");
+		netlist.commit_transaction();
+		bool is_rejected = false;
+		try
+		{
+			Netlist_reader reader(netlist, 0);
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		bool passed = check(is_rejected, "reading before publishing rejected");
+
+		netlist.publish();
+		{
+			Netlist_reader first(netlist, 0);
+			const Netlist& version = first.get_netlist();
+			const Module_description& frozen_top = *version.get_modules().find("top")->second;
+			passed &= check(&version != &netlist && 3 == version.get_modules().size() && &frozen_top != &top, "version copies the modules");
+			passed &= check(version.get_modules().find("sub")->second.get() == &frozen_top.get_module_instances().find("u0")->second->get_module_description(),
+				"version instances point to version modules");
+
+			// A commit publishes, the pinned version does not change and is retired.
+			netlist.begin_transaction();
+			add_gate(sub, "not", "n0", "b", "c");
+			netlist.commit_transaction();
+			passed &= check(1 == frozen_top.get_module_instances().size() && 1 == version.get_modules().find("sub")->second->get_module_instances().size(),
+				"pinned version unchanged");
+			Netlist_reader second(netlist, 1);
+			const Netlist& next = second.get_netlist();
+			passed &= check(2 == next.get_modules().find("sub")->second->get_module_instances().size(), "new version has the edit");
+			passed &= check(next.get_modules().find("leaf")->second == version.get_modules().find("leaf")->second
+				&& next.get_modules().find("top")->second != version.get_modules().find("top")->second, "unchanged modules shared, parents copied");
+			passed &= check(1 == netlist.get_retired_count(), "pinned version kept");
+		}
+		netlist.publish();
+		passed &= check(0 == netlist.get_retired_count(), "unpinned versions deleted");
+
+		Concurrent_edits edits;
+		edits.netlist = &netlist;
+		edits.commit_count = 200;
+		edits.is_done = false;
+		edits.failure_count = 0;
+		edits.read_count = 0;
+		top.remove_module_instance("u0");
+		netlist.publish();
+		boost::thread_group threads;
+		for (unsigned thread = 0; thread < 4; ++thread)
+		{
+			threads.create_thread(boost::bind(&Concurrent_edits::run, &edits, thread));
+		}
+		threads.join_all();
+		passed &= check(0 == edits.failure_count && 0 != edits.read_count, "readers see whole transactions while the writer commits");
+		return passed;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Netlist_builder bld( (argc > 1) ? argv[1] : "netlist.v" );
+	bld.construct_netlist();
 	boost::shared_ptr<Netlist> netlist = bld.get_netlist();
 
-	if (netlist != 0)
+	bool passed = check(0 != netlist, "sample netlist built");
+	passed &= test_net_aliasing();
+	passed &= test_edit_journal();
+	passed &= test_undo_restores_module();
+	passed &= test_transactions();
+	passed &= test_undo_notifications();
+	passed &= test_concurrent_reads();
+
+	if (passed)
 	{
 		std::cout << "DB UT passed!\n";
 	}
-return 0;
+return passed ? 0 : 1;
 }
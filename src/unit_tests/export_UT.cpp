@@ -0,0 +1,362 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <zlib.h>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "database/netlist_builder.hpp"
+#include "database/netlist.hpp"
+#include "database/module_description.hpp"
+#include "database/module_port.hpp"
+#include "analysis/netlist_diff.hpp"
+#include "export/verilog_writer.hpp"
+#include "export/json_writer.hpp"
+#include "export/binary_writer.hpp"
+#include "export/binary_reader.hpp"
+#include "export/graph_writer.hpp"
+
+/// Helper functions.
+namespace
+{
+	/// \brief Prints the failure message and returns false if the condition does not hold.
+	bool check(bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cout << "FAILED: " << message << "\n";
+		}
+		return condition;
+	}
+
+	/// \brief Returns the Verilog text of the Netlist.
+	std::string write_verilog(const Netlist& netlist, unsigned thread_count)
+	{
+		std::ostringstream stream;
+		Verilog_writer writer(netlist, thread_count);
+		writer.write(stream);
+		return stream.str();
+	}
+
+	/// \brief Parses Verilog text into a Netlist.
+	boost::shared_ptr<Netlist> read_verilog(const std::string& text)
+	{
+		Netlist_builder builder(*new std::istringstream(text), "read");
+		builder.construct_netlist();
+		return builder.get_netlist();
+	}
+
+	/// \brief Returns the content of a file, decompressed if it is a gzip file.
+	std::string read_file(const std::string& file_name)
+	{
+		std::string text;
+		gzFile file = gzopen(file_name.c_str(), "rb");
+		if (0 == file)
+		{
+			return text;
+		}
+		char buffer[1 << 16];
+		int size = 0;
+		while (0 < (size = gzread(file, buffer, sizeof(buffer))))
+		{
+			text.append(buffer, size);
+		}
+		gzclose(file);
+		return text;
+	}
+
+	/// \brief Builds a top module with a chain of random two input gates and a few outputs.
+	void build_chain_netlist(Netlist& netlist, int gate_count)
+	{
+		const char* types[] = { "and", "or", "nand", "nor", "xor" };
+		netlist.create_new_module("top");
+		Module_description& top = *netlist.get_module("top");
+		top.add_port(boost::shared_ptr<Module_port>(new Module_port("n0", IN, &top)));
+		boost::uint64_t state = 1;
+		for (int gate = 0; gate < gate_count; ++gate)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			std::ostringstream name, in0, in1, out;
+			name << "g" << gate;
+			in0 << "n" << gate;
+			in1 << "n" << (state >> 33) % (gate + 1);
+			out << "n" << gate + 1;
+			std::vector< std::pair< std::string, std::string> > pins;
+			pins.push_back(std::make_pair(in0.str(), std::string("I0")));
+			pins.push_back(std::make_pair(in1.str(), std::string("I1")));
+			pins.push_back(std::make_pair(out.str(), std::string("Z")));
+			top.add_module_instance(types[gate % 5], name.str(), pins);
+		}
+		std::ostringstream output;
+		output << "n" << gate_count;
+		top.add_port(boost::shared_ptr<Module_port>(new Module_port(output.str(), OUT, &top)));
+		top.connect_nets();
+	}
+
+	/// \brief Writes the sample netlist and reads it back.
+	bool test_sample_round_trip(const Netlist& netlist)
+	{
+		std::string text = write_verilog(netlist, 4);
+		boost::shared_ptr<Netlist> read = read_verilog(text);
+		bool passed = check(Netlist_diff(netlist, *read).is_empty(), "sample netlist survives a round trip");
+		passed &= check(text == write_verilog(*read, 1), "written text is stable");
+		return passed;
+	}
+
+	/// \brief Writes assignments, literal constants and implicit nets.
+	bool test_assigns_and_constants()
+	{
+		boost::shared_ptr<Netlist> netlist = read_verilog(
+			"module tie(a, y, z);\n"
+			"input a;\n"
+			"output y;\n"
+			"output z;\n"
+			"wire t;\n"
+			"and g0 (.A(a), .B(1'b1), .Z(t));\n"
+			"or g1 (.A(t), .B(1'h0), .Z(u));\n"
+			"assign y = u;\n"
+			"assign z = 1'b0;\n"
+			"endmodule\n");
+		std::string text = write_verilog(*netlist, 2);
+		bool passed = check(std::string::npos != text.find("assign z = 1'b0;\n") && std::string::npos != text.find(".B(1'b0)"), "constants written as literals");
+		passed &= check(std::string::npos != text.find("wire t;\n") && std::string::npos == text.find("wire u;"), "implicit nets stay implicit");
+		passed &= check(Netlist_diff(*netlist, *read_verilog(text)).is_empty(), "assignments survive a round trip");
+		return passed;
+	}
+
+	/// \brief Writes a netlist spanning several batches with different thread counts, to a stream, a file and a gzip file.
+	bool test_batches_and_files()
+	{
+		Netlist netlist("chain");
+		build_chain_netlist(netlist, 100000);
+		std::string text = write_verilog(netlist, 1);
+		bool passed = check(text == write_verilog(netlist, 3) && text == write_verilog(netlist, 8), "output independent of the thread count");
+
+		const std::string file_name = "export_UT.v";
+		const std::string compressed_name = "export_UT.v.gz";
+		Verilog_writer writer(netlist, 3);
+		writer.write(file_name);
+		passed &= check(text.size() == writer.get_byte_count() && text == read_file(file_name), "plain file written");
+		writer.write(compressed_name, true);
+		std::ifstream compressed(compressed_name.c_str(), std::ios::binary | std::ios::ate);
+		passed &= check(text == read_file(compressed_name) && size_t(compressed.tellg()) < text.size() / 2, "gzip file written");
+		std::remove(file_name.c_str());
+		std::remove(compressed_name.c_str());
+
+		bool is_rejected = false;
+		try
+		{
+			writer.write("missing_directory/export_UT.v");
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "unwritable file rejected");
+		return passed;
+	}
+
+	/// \brief Writes JSON in the Yosys layout and checks the structure and the numbering of the bits.
+	bool test_json_export(const Netlist& sample)
+	{
+		boost::shared_ptr<Netlist> netlist = read_verilog(
+			"module tie(a, y, z);\n"
+			"input a;\n"
+			"output y;\n"
+			"output z;\n"
+			"wire t;\n"
+			"and g0 (.A(a), .B(1'b1), .Z(t));\n"
+			"or g1 (.A(t), .B(t), .Z(u));\n"
+			"assign y = u;\n"
+			"assign z = 1'b0;\n"
+			"endmodule\n");
+		std::ostringstream stream;
+		Json_writer writer(*netlist, 2);
+		writer.write(stream);
+		std::string text = stream.str();
+		// Nets in name order: a 2, t 3, y 4 (u is aliased to the port y), z is tied to 0.
+		bool passed = check(0 == text.find("{\n  \"creator\"") && std::string::npos != text.find("\"tie\": {"), "JSON document opened");
+		passed &= check(std::string::npos != text.find("\"a\": { \"direction\": \"input\", \"bits\": [ 2 ] }")
+			&& std::string::npos != text.find("\"z\": { \"direction\": \"output\", \"bits\": [ \"0\" ] }"), "ports with bits");
+		passed &= check(std::string::npos != text.find("\"u\": { \"bits\": [ 4 ] }"), "aliased name shares the bits");
+		passed &= check(std::string::npos != text.find("\"connections\": { \"A\": [ 2 ], \"B\": [ \"1\" ], \"Z\": [ 3 ] }"), "cell connections");
+		passed &= check(std::count(text.begin(), text.end(), '{') == std::count(text.begin(), text.end(), '}')
+			&& std::count(text.begin(), text.end(), '[') == std::count(text.begin(), text.end(), ']'), "balanced JSON");
+
+		Netlist chain("chain");
+		build_chain_netlist(chain, 20000);
+		std::ostringstream single, parallel;
+		Json_writer(chain, 1).write(single);
+		Json_writer(chain, 5).write(parallel);
+		passed &= check(single.str() == parallel.str(), "JSON independent of the thread count");
+		std::ostringstream sample_stream;
+		Json_writer(sample, 3).write(sample_stream);
+		passed &= check(std::string::npos != sample_stream.str().find("\"ALU_PLUS_MINUS\": {"), "sample netlist written");
+		return passed;
+	}
+
+	/// \brief Writes and reads back binary netlists.
+	bool test_binary_round_trip(const Netlist& sample)
+	{
+		std::ostringstream stream;
+		Binary_writer(sample, 3).write(stream);
+		std::istringstream input(stream.str());
+		boost::shared_ptr<Netlist> read = Binary_reader(2).read(input);
+		bool passed = check(Netlist_diff(sample, *read).is_empty() && sample.get_name() == read->get_name(), "sample netlist survives a binary round trip");
+
+		Netlist chain("chain");
+		build_chain_netlist(chain, 100000);
+		std::ostringstream single, parallel;
+		Binary_writer(chain, 1).write(single);
+		Binary_writer(chain, 6).write(parallel);
+		passed &= check(single.str() == parallel.str(), "binary independent of the thread count");
+		std::istringstream chain_input(parallel.str());
+		read = Binary_reader().read(chain_input);
+		passed &= check(Netlist_diff(chain, *read).is_empty(), "large netlist survives a binary round trip");
+		passed &= check(parallel.str().size() < write_verilog(chain, 4).size() * 2 / 3, "binary smaller than Verilog");
+
+		bool is_rejected = false;
+		try
+		{
+			std::istringstream truncated(parallel.str().substr(0, parallel.str().size() / 2));
+			Binary_reader().read(truncated);
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "truncated binary rejected");
+		return passed;
+	}
+
+	/// \brief Writes cones, regions and capped selections of a module as DOT and GraphML.
+	bool test_graph_export()
+	{
+		boost::shared_ptr<Netlist> netlist = read_verilog(
+			"module graph(clk, a, b, y, z);\n"
+			"input clk;\n"
+			"input a;\n"
+			"input b;\n"
+			"output y;\n"
+			"output z;\n"
+			"wire n1;\n"
+			"wire n2;\n"
+			"wire n3;\n"
+			"and g0 (.A(a), .B(b), .Z(n1));\n"
+			"not g1 (.I(n1), .Z(n2));\n"
+			"or g2 (.A(n2), .B(clk), .Z(y));\n"
+			"and g3 (.A(n1), .B(clk), .Z(n3));\n"
+			"buf g4 (.I(n3), .Z(z));\n"
+			"xor g5 (.A(clk), .B(a), .Z(w5));\n"
+			"xor g6 (.A(clk), .B(b), .Z(w6));\n"
+			"endmodule\n");
+		const Module_description& module = *netlist->get_module("graph");
+		Graph_writer writer(module, 100, 3);
+
+		// The clock has four sinks, it is clustered and not followed.
+		writer.select_cone("y", 0);
+		std::ostringstream dot;
+		writer.write(dot, Graph_writer::FORMAT_DOT);
+		bool passed = check(5 == writer.get_node_count() && !writer.is_truncated(), "complete cone selected");
+		passed &= check(0 == dot.str().find("digraph \"graph\" {") && std::string::npos != dot.str().find("\"i:g0\" -> \"i:g1\" [label=\"n1\"];"), "cone edges written");
+		passed &= check(std::string::npos != dot.str().find("\"n:clk\" [label=\"clk\\n4 sinks\"") && std::string::npos != dot.str().find("\"n:clk\" -> \"i:g2\""), "high fanout net clustered");
+		passed &= check(std::string::npos == dot.str().find("i:g3"), "clustered net not followed");
+		writer.select_cone("y", 2);
+		passed &= check(2 == writer.get_node_count(), "depth limited cone");
+
+		writer.select_region(std::vector<std::string>(1, "g3"), 1);
+		std::ostringstream graphml;
+		writer.write(graphml, Graph_writer::FORMAT_GRAPHML);
+		std::string text = graphml.str();
+		passed &= check(4 == writer.get_node_count() && std::string::npos != text.find("<edge source=\"i:g0\" target=\"i:g3\"><data key=\"label\">n1</data></edge>"), "region written as GraphML");
+		size_t opened = 0;
+		for (size_t position = text.find("<node "); std::string::npos != position; position = text.find("<node ", position + 1))
+		{
+			++opened;
+		}
+		passed &= check(5 == opened && std::string::npos != text.find("</graphml>"), "GraphML nodes closed");
+
+		Graph_writer capped(module, 3, 3);
+		capped.select_all();
+		std::ostringstream truncated;
+		capped.write(truncated, Graph_writer::FORMAT_DOT);
+		passed &= check(3 == capped.get_node_count() && capped.is_truncated() && std::string::npos != truncated.str().find("truncated at 3 nodes"), "selection capped");
+
+		bool is_rejected = false;
+		try
+		{
+			writer.select_region(std::vector<std::string>(1, "missing"), 1);
+		}
+		catch (const std::string&)
+		{
+			is_rejected = true;
+		}
+		passed &= check(is_rejected, "unknown seed rejected");
+		return passed;
+	}
+
+	/// \brief Measures the writing speed of a writer to a file.
+	void report_throughput(Netlist_writer& writer, const std::string& format, bool is_compressed)
+	{
+		const std::string file_name = "export_UT.out";
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		writer.write(file_name, is_compressed);
+		double seconds = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+		std::cout << format << " writer" << (is_compressed ? " (gzip)" : "") << ": " << writer.get_byte_count() / 1e6 << " MB, "
+			<< (seconds > 0 ? writer.get_byte_count() / 1e6 / seconds : 0) << " MB per second\n";
+		std::remove(file_name.c_str());
+	}
+
+	/// \brief Measures the writing speeds of a large netlist in all formats.
+	void report_writer_throughput()
+	{
+		Netlist netlist("chain");
+		build_chain_netlist(netlist, 1000000);
+		Verilog_writer verilog(netlist);
+		report_throughput(verilog, "Verilog", false);
+		report_throughput(verilog, "Verilog", true);
+		Json_writer json(netlist);
+		report_throughput(json, "JSON", false);
+		Binary_writer binary(netlist);
+		report_throughput(binary, "Binary", false);
+	}
+}
+
+/// Runs the tests on the netlist given as argument, and the throughput measurements with --benchmark.
+int main(int argc, char* argv[])
+{
+	const char* netlist_path = "netlist.v";
+	bool is_benchmark = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string("--benchmark") == argv[i])
+		{
+			is_benchmark = true;
+		}
+		else
+		{
+			netlist_path = argv[i];
+		}
+	}
+	Netlist_builder bld( netlist_path );
+	bld.construct_netlist();
+	boost::shared_ptr<Netlist> netlist = bld.get_netlist();
+
+	bool passed = test_sample_round_trip(*netlist);
+	passed &= test_assigns_and_constants();
+	passed &= test_batches_and_files();
+	passed &= test_json_export(*netlist);
+	passed &= test_binary_round_trip(*netlist);
+	passed &= test_graph_export();
+	if (is_benchmark)
+	{
+		report_writer_throughput();
+	}
+
+	if (passed)
+	{
+		std::cout << "Export UT passed!\n";
+	}
+return passed ? 0 : 1;
+}
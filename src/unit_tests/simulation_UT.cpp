@@ -0,0 +1,352 @@
+#include <iostream>
+#include <ctime>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "database/netlist_builder.hpp"
+#include "analysis/flat_netlist.hpp"
+#include "analysis/levelizer.hpp"
+#include "simulation/simulation_program.hpp"
+#include "simulation/cycle_simulator.hpp"
+#include "simulation/event_simulator.hpp"
+#include "simulation/compiled_simulator.hpp"
+#include "simulation/fault_simulator.hpp"
+
+/// Helper functions.
+namespace
+{
+	/// \brief Prints the failure message and returns false if the condition does not hold.
+	bool check(bool condition, const std::string& message)
+	{
+		if (!condition)
+		{
+			std::cout << "FAILED: " << message << "\n";
+		}
+		return condition;
+	}
+
+	/// \brief Simulates the MUX module with random patterns and compares with its function.
+	bool test_mux(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "MUX");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Cycle_simulator simulator(program);
+
+		boost::uint64_t state = 12345;
+		bool passed = true;
+		for (int cycle = 0; cycle < 16; ++cycle)
+		{
+			simulator.randomize_inputs(state);
+			simulator.simulate();
+			Logic_word s = simulator.get_value(flat.find_net("s"));
+			Logic_word expected = (s & simulator.get_value(flat.find_net("i2"))) | (~s & simulator.get_value(flat.find_net("i1")));
+			passed &= check(Logic_words::equal(expected, simulator.get_value(flat.find_net("o"))), "MUX output matches s ? i2 : i1");
+		}
+		return passed;
+	}
+
+	/// \brief Simulates the FA module with random patterns and compares with the function of its two half adders and or gate.
+	bool test_full_adder(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "FA");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Cycle_simulator simulator(program);
+
+		boost::uint64_t state = 777;
+		simulator.randomize_inputs(state);
+		simulator.simulate();
+		Logic_word a = simulator.get_value(flat.find_net("a"));
+		Logic_word b = simulator.get_value(flat.find_net("b"));
+		Logic_word ci = simulator.get_value(flat.find_net("ci"));
+		bool passed = check(Logic_words::equal((a ^ b) | (ci ^ (a & b)), simulator.get_value(flat.find_net("o"))), "FA output");
+		passed &= check(Logic_words::equal(ci & a & b, simulator.get_value(flat.find_net("co"))), "FA carry");
+		return passed;
+	}
+
+	/// \brief Simulates gates tied to literal constants, the tied nets keep their values.
+	bool test_constant_ties()
+	{
+		std::istringstream* text = new std::istringstream(
+			"module TIE(a, y, z);\n"
+			"input a;\n"
+			"output y;\n"
+			"output z;\n"
+			"and g0 (.A(a), .B(1'b1), .Z(y));\n"
+			"or g1 (.A(a), .B(1'b0), .Z(z));\n"
+			"endmodule\n");
+		Netlist_builder builder(*text, "ties");
+		builder.construct_netlist();
+		Flat_netlist flat(*builder.get_netlist(), "TIE");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Cycle_simulator simulator(program);
+
+		boost::uint64_t state = 4242;
+		simulator.randomize_inputs(state);
+		simulator.simulate();
+		Logic_word a = simulator.get_value(flat.find_net("a"));
+		bool passed = check(1 == flat.get_input_nets().size(), "tied nets are not inputs");
+		passed &= check(Logic_words::equal(a, simulator.get_value(flat.find_net("y"))) && Logic_words::equal(a, simulator.get_value(flat.find_net("z"))), "tied inputs do not change the gates");
+		return passed;
+	}
+
+	/// \brief Toggles single inputs of the ALU and compares the event-driven simulator with the cycle simulator.
+	bool test_event_simulator(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Cycle_simulator cycle(program);
+		Event_simulator event(program);
+
+		const std::vector<Flat_id>& inputs = flat.get_input_nets();
+		boost::uint64_t state = 99;
+		bool passed = true;
+		for (int step = 0; step < 1000; ++step)
+		{
+			Logic_word value = Logic_words::random(state);
+			cycle.set_value(inputs[step % inputs.size()], value);
+			event.set_value(inputs[step % inputs.size()], value);
+			cycle.simulate();
+			event.simulate();
+			for (size_t net = 0; net < flat.get_net_count(); ++net)
+			{
+				passed &= Logic_words::equal(cycle.get_value(net), event.get_value(net));
+			}
+		}
+		return check(passed, "event-driven values match the cycle simulator");
+	}
+
+	/// \brief Compiles the ALU and compares the compiled simulator with the cycle simulator.
+	bool test_compiled_simulator(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		const char* temporary = std::getenv("TMPDIR");
+		std::string cache = std::string((0 != temporary) ? temporary : "/tmp") + "/netlist_simulation_cache_'quoted'/nested";
+
+		Cycle_simulator cycle(program);
+		Compiled_simulator compiled(program, cache);
+		boost::uint64_t state = 5;
+		bool passed = true;
+		for (int step = 0; step < 100; ++step)
+		{
+			cycle.randomize_inputs(state);
+			for (size_t i = 0; i < flat.get_input_nets().size(); ++i)
+			{
+				compiled.set_value(flat.get_input_nets()[i], cycle.get_value(flat.get_input_nets()[i]));
+			}
+			cycle.simulate();
+			compiled.simulate();
+			for (size_t net = 0; net < flat.get_net_count(); ++net)
+			{
+				passed &= Logic_words::equal(cycle.get_value(net), compiled.get_value(net));
+			}
+		}
+		passed = check(passed, "compiled values match the cycle simulator");
+
+		Compiled_simulator reloaded(program, cache);
+		passed &= check(reloaded.was_cached(), "second compilation is taken from the cache");
+		return passed;
+	}
+
+	/// \brief Replaces the cached ALU object by the MUX one, and creates the cache below a file.
+	bool test_compiled_cache(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		const char* temporary = std::getenv("TMPDIR");
+		std::string cache = std::string((0 != temporary) ? temporary : "/tmp") + "/netlist_simulation_cache_'quoted'/nested";
+		std::string library_path = Compiled_simulator(program, cache).get_library_path();
+
+		// An object compiled for another program under the same key is compiled again.
+		Flat_netlist mux_flat(netlist, "MUX");
+		Levelizer mux_levelizer(mux_flat);
+		mux_levelizer.levelize();
+		Simulation_program mux_program(mux_levelizer);
+		Compiled_simulator mux(mux_program, cache);
+		std::string foreign_path = library_path + ".foreign";
+		{
+			std::ifstream from(mux.get_library_path().c_str(), std::ios::binary);
+			std::ofstream to(foreign_path.c_str(), std::ios::binary);
+			to << from.rdbuf();
+		}
+		std::rename(foreign_path.c_str(), library_path.c_str());
+		Compiled_simulator recompiled(program, cache);
+		bool passed = check(!recompiled.was_cached(), "object of another program is compiled again");
+		Compiled_simulator recached(program, cache);
+		passed &= check(recached.was_cached(), "recompiled object is taken from the cache");
+
+		bool is_rejected = false;
+		try
+		{
+			Compiled_simulator below_file(program, library_path + "/cache");
+		}
+		catch (const std::string& error)
+		{
+			is_rejected = (std::string::npos != error.find("Unable to create the simulation cache directory"));
+		}
+		passed &= check(is_rejected, "cache directory below a file rejected");
+		return passed;
+	}
+
+	/// \brief Grades random patterns on the MUX and the ALU, checks collapsing and thread independence.
+	bool test_fault_simulator(const Netlist& netlist)
+	{
+		bool passed = true;
+		{
+			Flat_netlist flat(netlist, "MUX");
+			Levelizer levelizer(flat);
+			levelizer.levelize();
+			Simulation_program program(levelizer);
+			Fault_simulator simulator(program);
+			simulator.generate_faults();
+			simulator.simulate_random_patterns(4, 99);
+			passed &= check(simulator.get_coverage() == 1.0, "all MUX faults are detected");
+		}
+
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Fault_simulator single(program, 1);
+		Fault_simulator parallel(program, 4);
+		single.generate_faults();
+		parallel.generate_faults();
+		passed &= check(single.get_faults().size() < single.get_uncollapsed_fault_count(), "faults are collapsed");
+
+		single.simulate_random_patterns(8, 2024);
+		parallel.simulate_random_patterns(8, 2024);
+		passed &= check(single.get_detected() == parallel.get_detected(), "detection does not depend on the thread count");
+		passed &= check(single.get_detected_count() > 0, "faults are detected on the ALU");
+		return passed;
+	}
+
+	/// \brief Measures the throughput of the cycle simulator on the ALU.
+	void report_cycle_throughput(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Cycle_simulator simulator(program);
+
+		boost::uint64_t state = 1;
+		std::clock_t start = std::clock();
+		for (int cycle = 0; cycle < 200000; ++cycle)
+		{
+			simulator.set_value(flat.get_input_nets()[cycle % flat.get_input_nets().size()], Logic_words::random(state));
+			simulator.simulate();
+		}
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Cycle simulator: " << Logic_words::pattern_count << " patterns per word, "
+			<< (seconds > 0 ? simulator.get_evaluation_count() / seconds : 0) << " gate evaluations per second\n";
+	}
+
+	/// \brief Measures the event rate of the event-driven simulator toggling single inputs of the ALU.
+	void report_event_throughput(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Event_simulator event(program);
+
+		const std::vector<Flat_id>& inputs = flat.get_input_nets();
+		boost::uint64_t state = 99;
+		for (int step = 0; step < 200000; ++step)
+		{
+			event.set_value(inputs[step % inputs.size()], Logic_words::random(state));
+			event.simulate();
+		}
+		std::cout << "Event simulator: " << event.get_events_per_second() << " events per second, "
+			<< event.get_evaluation_count() << " evaluations for " << event.get_event_count() << " events\n";
+	}
+
+	/// \brief Measures the throughput of the compiled simulator on the ALU.
+	void report_compiled_throughput(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		const char* temporary = std::getenv("TMPDIR");
+		Compiled_simulator simulator(program, std::string((0 != temporary) ? temporary : "/tmp") + "/netlist_simulation_cache_'quoted'/nested");
+
+		std::clock_t start = std::clock();
+		for (int cycle = 0; cycle < 200000; ++cycle)
+		{
+			simulator.simulate();
+		}
+		double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+		std::cout << "Compiled simulator: " << (seconds > 0 ? simulator.get_evaluation_count() / seconds : 0) << " gate evaluations per second\n";
+	}
+
+	/// \brief Measures the fault simulation rate on the ALU with 4 threads.
+	void report_fault_throughput(const Netlist& netlist)
+	{
+		Flat_netlist flat(netlist, "ALU_PLUS_MINUS");
+		Levelizer levelizer(flat);
+		levelizer.levelize();
+		Simulation_program program(levelizer);
+		Fault_simulator simulator(program, 4);
+		simulator.generate_faults();
+		simulator.simulate_random_patterns(8, 2024);
+		std::cout << "Fault simulator: " << simulator.get_faults().size() << " faults (" << simulator.get_uncollapsed_fault_count()
+			<< " uncollapsed), coverage " << 100 * simulator.get_coverage() << "% after " << simulator.get_pattern_count() << " patterns, "
+			<< simulator.get_fault_patterns_per_second() << " fault patterns per second\n";
+	}
+}
+
+/// Runs the tests on the netlist given as argument, and the throughput measurements with --benchmark.
+int main(int argc, char* argv[])
+{
+	const char* netlist_path = "netlist.v";
+	bool is_benchmark = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string("--benchmark") == argv[i])
+		{
+			is_benchmark = true;
+		}
+		else
+		{
+			netlist_path = argv[i];
+		}
+	}
+	Netlist_builder bld( netlist_path );
+	bld.construct_netlist();
+	boost::shared_ptr<Netlist> netlist = bld.get_netlist();
+
+	bool passed = test_mux(*netlist);
+	passed &= test_full_adder(*netlist);
+	passed &= test_constant_ties();
+	passed &= test_event_simulator(*netlist);
+	passed &= test_compiled_simulator(*netlist);
+	passed &= test_compiled_cache(*netlist);
+	passed &= test_fault_simulator(*netlist);
+	if (is_benchmark)
+	{
+		report_cycle_throughput(*netlist);
+		report_event_throughput(*netlist);
+		report_compiled_throughput(*netlist);
+		report_fault_throughput(*netlist);
+	}
+
+	if (passed)
+	{
+		std::cout << "Simulation UT passed!\n";
+	}
+return passed ? 0 : 1;
+}